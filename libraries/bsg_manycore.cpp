@@ -32,8 +32,11 @@
 #include <bsg_manycore_tile.h>
 #include <bsg_manycore_responder.h>
 #include <bsg_manycore_epa.h>
+#include <bsg_manycore_eva.h>
 
-#ifndef COSIM
+#if defined(EMULATION)
+#include <bsg_manycore_emulation.h>
+#elif !defined(COSIM)
 #include <fpga_pci.h>
 #include <fpga_mgmt.h>
 #else
@@ -50,6 +53,7 @@
 #include <climits>
 #include <cstdbool>
 #include <cassert>
+#include <ctime>
 #else
 #include <inttypes>
 #include <stdint.h>
@@ -59,12 +63,23 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <time.h>
 #endif
 
+#include <sched.h>
+
+#include <algorithm>
 #include <type_traits>
 #include <stack>
 #include <queue>
+#include <deque>
 #include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <new>
 
 #define array_size(x)                           \
         (sizeof(x)/sizeof(x[0]))
@@ -72,6 +87,12 @@
 #define sarray_size(x)                          \
         ((ssize_t)array_size(x))
 
+/* maximum number of store requests formatted per burst by write_mem/memset */
+#define HB_MC_MANYCORE_TX_BATCH_PACKETS 256
+
+/* number of packets buffered on the host for each rx FIFO */
+#define HB_MC_MANYCORE_RX_RING_PACKETS 256
+
 /* these are conveniance macros that are only good for one line prints */
 #define manycore_pr_dbg(mc, fmt, ...)                   \
         bsg_pr_dbg("%s: " fmt, mc->name, ##__VA_ARGS__)
@@ -89,16 +110,52 @@
 // #undef manycore_pr_err
 // #define manycore_pr_err(...)
 
+/* packets pulled from an rx FIFO but not yet consumed */
+typedef struct hb_mc_manycore_rx_ring {
+        hb_mc_packet_t packets[HB_MC_MANYCORE_RX_RING_PACKETS];
+        size_t head;  //!< index of the oldest buffered packet
+        size_t count; //!< number of buffered packets
+} hb_mc_manycore_rx_ring_t;
+
+/* host-side estimates of transmit resources, refreshed from MMIO only when they cannot cover a burst */
+typedef struct hb_mc_manycore_flow_control {
+        uint32_t tx_capacity[2]; //!< depth of each tx FIFO in words, indexed by hb_mc_fifo_tx_t
+        uint32_t tx_vacancy[2];  //!< estimated free words in each tx FIFO, indexed by hb_mc_fifo_tx_t
+        uint32_t credits;        //!< estimated host credits available for requests
+        unsigned read_window;    //!< maximum number of outstanding loads
+} hb_mc_manycore_flow_control_t;
+
+typedef struct hb_mc_manycore_async hb_mc_manycore_async_t;
+
 typedef struct hb_mc_manycore_private {
+#if defined(EMULATION)
+        hb_mc_emulation_t *emul;
+#else
         pci_bar_handle_t handle;
+#endif
+        hb_mc_manycore_rx_ring_t rx_ring[2]; //!< indexed by hb_mc_fifo_rx_t
+        hb_mc_manycore_flow_control_t fc;    //!< transmit flow control state
+        std::shared_ptr<hb_mc_manycore_async_t> async; //!< asynchronous transfers; shared with threads that have queues
+        hb_mc_backoff_policy_t backoff;      //!< polling loop backoff policy
+        hb_mc_backoff_stats_t backoff_stats; //!< time spent in each backoff phase
+        long transfer_timeout;               //!< microseconds blocking transfers may wait, or -1
+        hb_mc_manycore_stats_t stats;        //!< hot path counters
+        hb_mc_tx_injection_t tx_injection;   //!< how packets are written into tx FIFOs
+        std::mutex tx_lock;                  //!< serializes bursts into the tx FIFOs
+        std::mutex rx_lock[2];               //!< guards each rx FIFO and its ring, indexed by hb_mc_fifo_rx_t
 } hb_mc_manycore_private_t;
 
 
 static int  hb_mc_manycore_mmio_read_mmio(hb_mc_manycore_t *mc, uintptr_t offset,
                                           void *vo, size_t sz);
 
+#if defined(EMULATION)
+static int  hb_mc_manycore_mmio_read_emulation(hb_mc_manycore_t *mc, uintptr_t offset,
+                                               void *vp, size_t sz);
+#else
 static int  hb_mc_manycore_mmio_read_pci(hb_mc_manycore_t *mc, uintptr_t offset,
                                          void *vp, size_t sz);
+#endif
 static int hb_mc_manycore_mmio_read(hb_mc_manycore_t *mc, uintptr_t offset,
                                     void *vp, size_t sz);
 
@@ -106,6 +163,8 @@ static int  hb_mc_manycore_init_mmio(hb_mc_manycore_t *mc, hb_mc_manycore_id_t i
 static void hb_mc_manycore_cleanup_mmio(hb_mc_manycore_t *mc);
 static int  hb_mc_manycore_init_private_data(hb_mc_manycore_t *mc);
 static void hb_mc_manycore_cleanup_private_data(hb_mc_manycore_t *mc);
+static int  hb_mc_manycore_async_init(hb_mc_manycore_t *mc);
+static void hb_mc_manycore_async_cleanup(hb_mc_manycore_t *mc);
 
 static int hb_mc_manycore_packet_rx_internal(hb_mc_manycore_t *mc,
                                              hb_mc_packet_t *packet,
@@ -116,6 +175,312 @@ static int hb_mc_manycore_packet_rx_internal(hb_mc_manycore_t *mc,
                                              hb_mc_packet_t *packet,
                                              hb_mc_fifo_rx_t type,
                                              long timeout);
+/////////////
+// Backoff //
+/////////////
+
+/* the state of one polling loop */
+typedef struct hb_mc_manycore_waiter {
+        hb_mc_manycore_t *mc;
+        long timeout;           //!< microseconds, or -1 to wait forever
+        uint64_t start_ns;      //!< when the wait started
+        uint64_t last_ns;       //!< when the wait last backed off
+        unsigned long polls;    //!< unsuccessful polls since the wait started or made progress
+        unsigned long sleep_us; //!< length of the next sleep
+} hb_mc_manycore_waiter_t;
+
+static uint64_t hb_mc_manycore_now_ns(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* check that a timeout is -1 (forever) or a number of microseconds */
+static int hb_mc_manycore_check_timeout(hb_mc_manycore_t *mc, const char *caller_name, long timeout)
+{
+        if (timeout < -1) {
+                manycore_pr_err(mc, "%s: Invalid timeout %ld: "
+                                "must be -1 or a number of microseconds\n",
+                                caller_name, timeout);
+                return HB_MC_INVALID;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static void hb_mc_manycore_waiter_init(hb_mc_manycore_t *mc, hb_mc_manycore_waiter_t *w, long timeout)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+
+        w->mc = mc;
+        w->timeout = timeout;
+        w->start_ns = w->last_ns = hb_mc_manycore_now_ns();
+        w->polls = 0;
+        w->sleep_us = pdata->backoff.sleep_min_us;
+}
+
+/* the part of a wait's timeout that is left, so that the calls it makes share its deadline */
+static long hb_mc_manycore_waiter_remaining(const hb_mc_manycore_waiter_t *w)
+{
+        uint64_t elapsed_us;
+
+        if (w->timeout == -1)
+                return -1;
+
+        elapsed_us = (hb_mc_manycore_now_ns() - w->start_ns) / 1000;
+        return elapsed_us >= (uint64_t)w->timeout ? 0 : w->timeout - (long)elapsed_us;
+}
+
+/* restart the backoff schedule after a wait makes progress */
+static void hb_mc_manycore_waiter_reset(hb_mc_manycore_waiter_t *w)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)w->mc->private_data;
+
+        w->polls = 0;
+        w->sleep_us = pdata->backoff.sleep_min_us;
+}
+
+/**
+ * Back off after a poll that found nothing to do.
+ * @param[in] w  The state of a polling loop started with hb_mc_manycore_waiter_init()
+ * @return HB_MC_TIMEOUT if the wait has timed out. HB_MC_SUCCESS if the caller should poll again.
+ */
+static int hb_mc_manycore_waiter_backoff(hb_mc_manycore_waiter_t *w)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)w->mc->private_data;
+        const hb_mc_backoff_policy_t *policy = &pdata->backoff;
+        hb_mc_backoff_stats_t *stats = &pdata->backoff_stats;
+        hb_mc_backoff_phase_t phase;
+        uint64_t now = hb_mc_manycore_now_ns();
+
+        if (w->polls < policy->spin_iterations)
+                phase = HB_MC_BACKOFF_SPIN;
+        else if (w->polls < policy->spin_iterations + policy->yield_iterations)
+                phase = HB_MC_BACKOFF_YIELD;
+        else
+                phase = HB_MC_BACKOFF_SLEEP;
+
+        __atomic_fetch_add(&stats->polls[phase], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stats->ns[phase], now - w->last_ns, __ATOMIC_RELAXED);
+        w->last_ns = now;
+        w->polls++;
+
+        if (w->timeout != -1 && now - w->start_ns >= (uint64_t)w->timeout * 1000) {
+                __atomic_fetch_add(&stats->timeouts, 1, __ATOMIC_RELAXED);
+                return HB_MC_TIMEOUT;
+        }
+
+        switch (phase) {
+        case HB_MC_BACKOFF_YIELD:
+                sched_yield();
+                break;
+        case HB_MC_BACKOFF_SLEEP: {
+                struct timespec ts = {
+                        static_cast<time_t>(w->sleep_us / 1000000),
+                        static_cast<long>((w->sleep_us % 1000000) * 1000)
+                };
+                nanosleep(&ts, nullptr);
+                w->sleep_us = std::min(2 * w->sleep_us, policy->sleep_max_us);
+                break;
+        }
+        default:
+                break;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Set the policy used by a manycore instance's polling loops
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] policy  A backoff policy. sleep_min_us must be non-zero and <= sleep_max_us.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_set_backoff_policy(hb_mc_manycore_t *mc, const hb_mc_backoff_policy_t *policy)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+
+        if (policy->sleep_min_us == 0 || policy->sleep_min_us > policy->sleep_max_us) {
+                manycore_pr_err(mc, "%s: Invalid sleep range [%lu, %lu] us\n",
+                                __func__, policy->sleep_min_us, policy->sleep_max_us);
+                return HB_MC_INVALID;
+        }
+
+        pdata->backoff = *policy;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get the policy used by a manycore instance's polling loops
+ * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[out] policy  Set to the current backoff policy
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_get_backoff_policy(hb_mc_manycore_t *mc, hb_mc_backoff_policy_t *policy)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+
+        *policy = pdata->backoff;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get how much polling a manycore instance has done in each backoff phase
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[out] stats  Set to the statistics accumulated since init or the last reset
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_get_backoff_stats(hb_mc_manycore_t *mc, hb_mc_backoff_stats_t *stats)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+
+        *stats = pdata->backoff_stats;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Reset a manycore instance's backoff statistics
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_reset_backoff_stats(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+
+        memset(&pdata->backoff_stats, 0, sizeof(pdata->backoff_stats));
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Bound how long a manycore instance's blocking transfers may wait on hardware
+ * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] timeout  Microseconds, or -1 to wait forever
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_set_transfer_timeout(hb_mc_manycore_t *mc, long timeout)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        int err;
+
+        if ((err = hb_mc_manycore_check_timeout(mc, __func__, timeout)) != HB_MC_SUCCESS)
+                return err;
+
+        pdata->transfer_timeout = timeout;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get how long a manycore instance's blocking transfers may wait on hardware
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[out] timeout  Set to the timeout in microseconds, or -1 if transfers wait forever
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_get_transfer_timeout(hb_mc_manycore_t *mc, long *timeout)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+
+        *timeout = pdata->transfer_timeout;
+        return HB_MC_SUCCESS;
+}
+
+////////////////
+// Statistics //
+////////////////
+
+static hb_mc_manycore_stats_t *hb_mc_manycore_get_counters(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        return &pdata->stats;
+}
+
+/* counters are shared by every thread using a manycore instance */
+#define hb_mc_manycore_count(mc, counter, n)                            \
+        __atomic_fetch_add(&hb_mc_manycore_get_counters(mc)->counter, (n), __ATOMIC_RELAXED)
+
+/* nesting depth of public API calls made by this thread */
+static thread_local unsigned hb_mc_manycore_api_depth = 0;
+
+/* charges the wall time of a public API call to its counters, unless it was called by another public API */
+class hb_mc_manycore_api_timer {
+public:
+        hb_mc_manycore_api_timer(hb_mc_manycore_t *mc, hb_mc_manycore_api_t api) :
+                pdata(mc != nullptr ? (hb_mc_manycore_private_t*)mc->private_data : nullptr),
+                api(api), start_ns(0) {
+                if (pdata != nullptr && hb_mc_manycore_api_depth++ == 0)
+                        start_ns = hb_mc_manycore_now_ns();
+        }
+
+        ~hb_mc_manycore_api_timer() {
+                if (pdata == nullptr || --hb_mc_manycore_api_depth != 0)
+                        return;
+
+                __atomic_fetch_add(&pdata->stats.api_calls[api], 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&pdata->stats.api_ns[api], hb_mc_manycore_now_ns() - start_ns,
+                                   __ATOMIC_RELAXED);
+        }
+
+private:
+        hb_mc_manycore_private_t *pdata;
+        hb_mc_manycore_api_t api;
+        uint64_t start_ns;
+};
+
+/**
+ * Get the name of a public API counted in hb_mc_manycore_stats_t
+ * @param[in] api  A public API
+ * @return A string naming #api
+ */
+const char *hb_mc_manycore_api_to_string(hb_mc_manycore_api_t api)
+{
+        static const char *strtab [] = {
+                [HB_MC_MANYCORE_API_REQUEST_TX]              = "request_tx",
+                [HB_MC_MANYCORE_API_REQUESTS_TX]             = "requests_tx",
+                [HB_MC_MANYCORE_API_REQUEST_RX]              = "request_rx",
+                [HB_MC_MANYCORE_API_RESPONSE_TX]             = "response_tx",
+                [HB_MC_MANYCORE_API_RESPONSE_RX]             = "response_rx",
+                [HB_MC_MANYCORE_API_READ]                    = "read",
+                [HB_MC_MANYCORE_API_WRITE]                   = "write",
+                [HB_MC_MANYCORE_API_READ_MEM]                = "read_mem",
+                [HB_MC_MANYCORE_API_READ_MEM_SCATTER_GATHER] = "read_mem_scatter_gather",
+                [HB_MC_MANYCORE_API_WRITE_MEM]               = "write_mem",
+                [HB_MC_MANYCORE_API_MEMSET]                  = "memset",
+                [HB_MC_MANYCORE_API_TRANSFER_SUBMIT]         = "transfer_submit",
+                [HB_MC_MANYCORE_API_TRANSFER_POLL]           = "transfer_poll",
+                [HB_MC_MANYCORE_API_TRANSFER_WAIT]           = "transfer_wait",
+        };
+
+        if (api < 0 || api >= HB_MC_MANYCORE_API_COUNT)
+                return "unknown";
+
+        return strtab[api];
+}
+
+/**
+ * Get a manycore instance's hot path counters
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[out] stats  Set to the counters accumulated since init or the last reset
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_get_stats(hb_mc_manycore_t *mc, hb_mc_manycore_stats_t *stats)
+{
+        if (stats == nullptr)
+                return HB_MC_INVALID;
+
+        *stats = *hb_mc_manycore_get_counters(mc);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Reset a manycore instance's hot path counters
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_reset_stats(hb_mc_manycore_t *mc)
+{
+        memset(hb_mc_manycore_get_counters(mc), 0, sizeof(hb_mc_manycore_stats_t));
+        return HB_MC_SUCCESS;
+}
+
 ///////////////////////////
 // FIFO Helper Functions //
 ///////////////////////////
@@ -160,6 +525,8 @@ static int hb_mc_manycore_tx_fifo_get_vacancy(hb_mc_manycore_t *mc,
         uintptr_t vacancy_addr = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_TX_VACANCY_OFFSET);
         int err;
 
+        hb_mc_manycore_count(mc, vacancy_polls, 1);
+
         err = hb_mc_manycore_mmio_read32(mc, vacancy_addr, vacancy);
         if (err != HB_MC_SUCCESS) {
                 manycore_pr_err(mc, "Failed to get %s vacancy\n", typestr);
@@ -180,6 +547,8 @@ static int hb_mc_manycore_rx_fifo_get_occupancy(hb_mc_manycore_t *mc,
         const char *typestr = hb_mc_fifo_rx_to_string(type);
         int err;
 
+        hb_mc_manycore_count(mc, occupancy_polls, 1);
+
         err = hb_mc_manycore_mmio_read32(mc, occupancy_addr, &val);
         if (err != HB_MC_SUCCESS) {
                 manycore_pr_err(mc, "Failed to get %s occupancy\n", typestr);
@@ -199,32 +568,129 @@ static int hb_mc_manycore_rx_fifo_get_occupancy(hb_mc_manycore_t *mc,
         return HB_MC_SUCCESS;
 }
 
+/* get the host-side packet ring of an rx FIFO */
+static hb_mc_manycore_rx_ring_t *hb_mc_manycore_get_rx_ring(hb_mc_manycore_t *mc,
+                                                            hb_mc_fifo_rx_t type)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        return &pdata->rx_ring[type];
+}
+
+/* read one packet from an rx FIFO that is known to hold at least one packet */
+static int hb_mc_manycore_rx_fifo_read_packet(hb_mc_manycore_t *mc,
+                                              hb_mc_fifo_rx_t type,
+                                              hb_mc_packet_t *packet)
+{
+        const char *typestr = hb_mc_fifo_rx_to_string(type);
+        uintptr_t length_addr = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_RX_LENGTH_OFFSET);
+        uintptr_t data_addr   = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_RX_DATA_OFFSET);
+        uint32_t length;
+        int err;
+
+        /* get FIFO length */
+        err = hb_mc_manycore_mmio_read32(mc, length_addr, &length);
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to read %s FIFO length register: %s\n",
+                                __func__, typestr, hb_mc_strerror(err));
+                return err;
+        }
+
+        if (length != sizeof(*packet)) {
+                manycore_pr_err(mc, "%s: Read bad length %" PRId32 " from %s FIFO length register\n",
+                                __func__, length, typestr);
+                return HB_MC_FAIL;
+        }
+
+        manycore_pr_dbg(mc, "%s: From %s FIFO: Read the receive length register "
+                        "@ 0x%08" PRIxPTR " to be %" PRIu32 "\n",
+                        __func__, typestr, length_addr, length);
+
+        /* read in the packet one word at a time */
+        for (unsigned i = 0; i < array_size(packet->words); i++) {
+                err = hb_mc_manycore_mmio_read32(mc, data_addr, &packet->words[i]);
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed read data from %s FIFO: %s\n",
+                                        __func__, typestr, hb_mc_strerror(err));
+                        return err;
+                }
+        }
+
+        hb_mc_manycore_count(mc, rx_packets[type], 1);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Pull every packet available in an rx FIFO into its host-side ring.
+ * Occupancy is read once, and no more packets are read than the ring has room for.
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  type   Which rx FIFO to pull packets from
+ * @param[out] count  Set to the number of packets buffered in the ring. May be NULL.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_rx_ring_fill(hb_mc_manycore_t *mc,
+                                       hb_mc_fifo_rx_t type,
+                                       uint32_t *count)
+{
+        hb_mc_manycore_rx_ring_t *ring = hb_mc_manycore_get_rx_ring(mc, type);
+        size_t room = array_size(ring->packets) - ring->count;
+        uint32_t occupancy;
+        int err;
+
+        if (room > 0) {
+                err = hb_mc_manycore_rx_fifo_get_occupancy(mc, type, &occupancy);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                for (size_t n = std::min(room, (size_t)occupancy); n > 0; n--) {
+                        size_t tail = (ring->head + ring->count) % array_size(ring->packets);
+
+                        err = hb_mc_manycore_rx_fifo_read_packet(mc, type, &ring->packets[tail]);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+
+                        ring->count++;
+                }
+        }
+
+        if (count != nullptr)
+                *count = ring->count;
+
+        return HB_MC_SUCCESS;
+}
+
+/* remove the oldest packet from a non-empty rx ring */
+static void hb_mc_manycore_rx_ring_pop(hb_mc_manycore_rx_ring_t *ring, hb_mc_packet_t *packet)
+{
+        *packet = ring->packets[ring->head];
+        ring->head = (ring->head + 1) % array_size(ring->packets);
+        ring->count--;
+}
+
 /* read all unread packets from a fifo (rx only) */
 static int hb_mc_manycore_rx_fifo_drain(hb_mc_manycore_t *mc, hb_mc_fifo_rx_t type)
 {
         const char *typestr = hb_mc_fifo_rx_to_string(type);
-        hb_mc_request_packet_t recv;
+        hb_mc_manycore_rx_ring_t *ring = hb_mc_manycore_get_rx_ring(mc, type);
+        hb_mc_packet_t recv;
         uint32_t occupancy;
         int rc;
 
         for (int drains = 0; drains < 20; drains++) {
-                /* first check how many unread packets are currently in the FIFO */
-                rc = hb_mc_manycore_rx_fifo_get_occupancy(mc, type, &occupancy);
-                if (rc != HB_MC_SUCCESS)
-                        return rc;
+                /* pull all unread packets into the host-side ring */
+                rc = hb_mc_manycore_rx_ring_fill(mc, type, &occupancy);
+                if (rc != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to read packets from %s fifo\n",
+                                        __func__, typestr);
+                        return HB_MC_FAIL;
+                }
 
                 /* break if occupancy is zero */
                 if (occupancy == 0)
                         break;
 
-                /* Read stale packets from fifo */
-                for (unsigned i = 0; i < occupancy; i++){
-                        rc = hb_mc_manycore_packet_rx_internal(mc, (hb_mc_packet_t*) &recv, type, -1);
-                        if (rc != HB_MC_SUCCESS) {
-                                manycore_pr_err(mc, "%s: Failed to read packet from %s fifo\n",
-                                                __func__, typestr);
-                                return HB_MC_FAIL;
-                        }
+                /* discard stale packets */
+                while (ring->count > 0) {
+                        hb_mc_manycore_rx_ring_pop(ring, &recv);
 
                         manycore_pr_dbg(mc,
                                         "%s: packet drained from %s fifo: "
@@ -233,10 +699,10 @@ static int hb_mc_manycore_rx_fifo_drain(hb_mc_manycore_t *mc, hb_mc_fifo_rx_t ty
                                         "addr: 0x%08x, "
                                         "data: 0x%08x\n",
                                         __func__, typestr,
-                                        recv.x_src, recv.y_src,
-                                        recv.x_dst, recv.y_dst,
-                                        recv.addr,
-                                        recv.data);
+                                        recv.request.x_src, recv.request.y_src,
+                                        recv.request.x_dst, recv.request.y_dst,
+                                        recv.request.addr,
+                                        recv.request.data);
                 }
         }
 
@@ -274,6 +740,45 @@ static int hb_mc_manycore_fifo_clear_isr(hb_mc_manycore_t *mc, hb_mc_direction_t
 // Init/Exit API //
 ///////////////////
 
+#if defined(EMULATION)
+/* initialize manycore MMIO by attaching to an emulated manycore */
+static int hb_mc_manycore_init_mmio(hb_mc_manycore_t *mc, hb_mc_manycore_id_t id)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        int err;
+
+        // each ID is a separate emulated manycore
+        if (id < 0 || id >= HB_MC_EMULATION_MAX_DEVICES) {
+                manycore_pr_err(mc, "Failed to init MMIO: invalid ID\n");
+                return HB_MC_INVALID;
+        }
+
+        if ((err = hb_mc_emulation_attach(id, &pdata->emul)) != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "Failed to init MMIO: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        mc->mmio = (uintptr_t)nullptr;
+        mc->id = id;
+        manycore_pr_dbg(mc, "%s: attached to emulated manycore %d\n", __func__, id);
+        return HB_MC_SUCCESS;
+}
+
+/* cleanup manycore MMIO */
+static void hb_mc_manycore_cleanup_mmio(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+
+        if (pdata->emul == nullptr)
+                return;
+
+        hb_mc_emulation_detach(pdata->emul);
+        pdata->emul = nullptr;
+        mc->mmio = (uintptr_t)nullptr;
+        mc->id = 0;
+        return;
+}
+#else
 /* initialize manycore MMIO */
 static int hb_mc_manycore_init_mmio(hb_mc_manycore_t *mc, hb_mc_manycore_id_t id)
 {
@@ -281,8 +786,13 @@ static int hb_mc_manycore_init_mmio(hb_mc_manycore_t *mc, hb_mc_manycore_id_t id
         int pf_id = FPGA_APP_PF, write_combine = 0, bar_id = APP_PF_BAR0;
         int r = HB_MC_FAIL, err;
 
-        // all IDs except 0 are unused at the moment
+#if defined(COSIM)
+        // cosimulation models a single manycore
         if (id != 0) {
+#else
+        // the ID selects an FPGA slot
+        if (id < 0 || id >= FPGA_SLOT_MAX) {
+#endif
                 manycore_pr_err(mc, "Failed to init MMIO: invalid ID\n");
                 return HB_MC_INVALID;
         }
@@ -332,6 +842,7 @@ static void hb_mc_manycore_cleanup_mmio(hb_mc_manycore_t *mc)
         mc->id = 0;
         return;
 }
+#endif
 
 /* initialize manycore private data */
 static int hb_mc_manycore_init_private_data(hb_mc_manycore_t *mc)
@@ -341,13 +852,23 @@ static int hb_mc_manycore_init_private_data(hb_mc_manycore_t *mc)
 
         mc->private_data = nullptr;
 
-        pdata = (hb_mc_manycore_private_t*)calloc(sizeof(*pdata), 1);
+        pdata = new (std::nothrow) hb_mc_manycore_private_t();
         if (!pdata) {
                 manycore_pr_err(mc, "%s failed: %m\n", __func__);
                 return HB_MC_NOMEM;
         }
 
+#if defined(EMULATION)
+        pdata->emul = nullptr;
+#else
         pdata->handle = PCI_BAR_HANDLE_INIT;
+#endif
+        pdata->backoff.spin_iterations  = HB_MC_BACKOFF_DEFAULT_SPIN_ITERATIONS;
+        pdata->backoff.yield_iterations = HB_MC_BACKOFF_DEFAULT_YIELD_ITERATIONS;
+        pdata->backoff.sleep_min_us     = HB_MC_BACKOFF_DEFAULT_SLEEP_MIN_US;
+        pdata->backoff.sleep_max_us     = HB_MC_BACKOFF_DEFAULT_SLEEP_MAX_US;
+        pdata->tx_injection = HB_MC_TX_INJECTION_BURST;
+        pdata->transfer_timeout = -1;
         mc->private_data = pdata;
 
         return HB_MC_SUCCESS;
@@ -356,7 +877,8 @@ static int hb_mc_manycore_init_private_data(hb_mc_manycore_t *mc)
 /* cleanup manycore private data */
 static void hb_mc_manycore_cleanup_private_data(hb_mc_manycore_t *mc)
 {
-        free(mc->private_data);
+        hb_mc_manycore_async_cleanup(mc);
+        delete (hb_mc_manycore_private_t*)mc->private_data;
 }
 
 /* initialize configuration */
@@ -412,54 +934,199 @@ static int hb_mc_fifo_enable(hb_mc_manycore_t *mc, hb_mc_direction_t fifo)
 /*
  * These might be rewritten to read from MMIO space: hence why error codes are returned.
  */
+static hb_mc_manycore_flow_control_t *hb_mc_manycore_get_flow_control(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        return &pdata->fc;
+}
+
 static int hb_mc_manycore_get_host_requests_cap(hb_mc_manycore_t *mc, unsigned *cap)
 {
-        *cap = 32;
+        *cap = hb_mc_manycore_get_flow_control(mc)->read_window;
         return HB_MC_SUCCESS;
 }
 
 static int hb_mc_manycore_get_host_requests(hb_mc_manycore_t *mc, unsigned *rqsts)
 {
-        *rqsts = mc->htod_requests;
+        *rqsts = __atomic_load_n(&mc->htod_requests, __ATOMIC_RELAXED);
         return HB_MC_SUCCESS;
 }
 
-static int hb_mc_manycore_incr_host_requests(hb_mc_manycore_t*mc, hb_mc_request_packet_t *request)
+/* account for #n more outstanding loads; fails with HB_MC_BUSY if that would exceed the cap */
+static int hb_mc_manycore_reserve_host_requests(hb_mc_manycore_t *mc, unsigned n)
 {
-        unsigned cap;
+        unsigned cap, rqsts;
         int err;
 
-        /* stores don't require an increment */
-        if (hb_mc_request_packet_get_op(request) == HB_MC_PACKET_OP_REMOTE_STORE)
-                return HB_MC_SUCCESS;
-
         err = hb_mc_manycore_get_host_requests_cap(mc, &cap);
         if (err != HB_MC_SUCCESS)
                 return err;
 
-        if (mc->htod_requests >= cap) {
-                manycore_pr_dbg(mc, "%s: Outstanding requests at cap of %u\n", __func__, cap);
-                return HB_MC_BUSY;
-        }
+        rqsts = __atomic_load_n(&mc->htod_requests, __ATOMIC_RELAXED);
+        do {
+                if (rqsts + n > cap) {
+                        manycore_pr_dbg(mc, "%s: %u loads would exceed outstanding request cap of %u\n",
+                                        __func__, n, cap);
+                        hb_mc_manycore_count(mc, load_id_stalls, 1);
+                        return HB_MC_BUSY;
+                }
+        } while (!__atomic_compare_exchange_n(&mc->htod_requests, &rqsts, rqsts + n, true,
+                                              __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+        return HB_MC_SUCCESS;
+}
+
+/* account for #n loads that have been answered */
+static int hb_mc_manycore_release_host_requests(hb_mc_manycore_t *mc, unsigned n)
+{
+        unsigned rqsts = __atomic_load_n(&mc->htod_requests, __ATOMIC_RELAXED);
+
+        do {
+                if (rqsts < n) {
+                        manycore_pr_err(mc, "%s: No outstanding requests!\n", __func__);
+                        return HB_MC_FAIL;
+                }
+        } while (!__atomic_compare_exchange_n(&mc->htod_requests, &rqsts, rqsts - n, true,
+                                              __ATOMIC_RELAXED, __ATOMIC_RELAXED));
 
-        mc->htod_requests++;
         return HB_MC_SUCCESS;
 }
 
+static int hb_mc_manycore_incr_host_requests(hb_mc_manycore_t*mc, hb_mc_request_packet_t *request)
+{
+        /* stores don't require an increment */
+        if (hb_mc_request_packet_get_op(request) == HB_MC_PACKET_OP_REMOTE_STORE)
+                return HB_MC_SUCCESS;
+
+        return hb_mc_manycore_reserve_host_requests(mc, 1);
+}
+
 static int hb_mc_manycore_decr_host_requests(hb_mc_manycore_t *mc)
 {
-        if (mc->htod_requests == 0) {
-                manycore_pr_err(mc, "%s: No outstanding requests!\n", __func__);
+        return hb_mc_manycore_release_host_requests(mc, 1);
+}
+
+static int hb_mc_manycore_host_requests_init(hb_mc_manycore_t *mc)
+{
+        mc->htod_requests = 0;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Initialize flow control from hardware. Must be called while the FIFOs are empty
+ * and no requests are in flight, so that vacancy and credits read as their maximums.
+ * @param[in] mc  A manycore instance
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_flow_control_init(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_flow_control_t *fc = hb_mc_manycore_get_flow_control(mc);
+        const uint32_t packet_words = sizeof(hb_mc_packet_t)/sizeof(uint32_t);
+        int credits, err;
+
+        for (int type = HB_MC_FIFO_TX_REQ; type <= HB_MC_FIFO_TX_RSP; type++) {
+                err = hb_mc_manycore_tx_fifo_get_vacancy(mc, (hb_mc_fifo_tx_t)type,
+                                                         &fc->tx_capacity[type]);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                if (fc->tx_capacity[type] < packet_words) {
+                        manycore_pr_err(mc, "%s: %s FIFO cannot hold a packet: vacancy = %" PRIu32 "\n",
+                                        __func__, hb_mc_fifo_tx_to_string((hb_mc_fifo_tx_t)type),
+                                        fc->tx_capacity[type]);
+                        return HB_MC_FAIL;
+                }
+
+                fc->tx_vacancy[type] = fc->tx_capacity[type];
+        }
+
+        credits = hb_mc_manycore_get_host_credits(mc);
+        if (credits < 0)
+                return credits;
+
+        if (credits == 0) {
+                manycore_pr_err(mc, "%s: No host credits available\n", __func__);
                 return HB_MC_FAIL;
         }
 
-        mc->htod_requests--;
+        fc->credits = credits;
+
+        /*
+         * Each outstanding load holds one of the host endpoint's credits
+         * until its response returns, and its response must fit in the
+         * host-side receive ring.
+         */
+        fc->read_window = std::min(fc->credits, (uint32_t)HB_MC_MANYCORE_RX_RING_PACKETS);
+
+        manycore_pr_dbg(mc, "%s: tx FIFO depths = %" PRIu32 "/%" PRIu32 " words, "
+                        "host credits = %" PRIu32 ", read window = %u\n",
+                        __func__, fc->tx_capacity[HB_MC_FIFO_TX_REQ],
+                        fc->tx_capacity[HB_MC_FIFO_TX_RSP], fc->credits, fc->read_window);
+
         return HB_MC_SUCCESS;
 }
 
-static int hb_mc_manycore_host_requests_init(hb_mc_manycore_t *mc)
+/**
+ * Get the estimated vacancy of a tx FIFO, reading it from hardware only if
+ * the estimate cannot cover the words the caller wants to send.
+ * @param[in]  mc       A manycore instance
+ * @param[in]  type     A tx FIFO
+ * @param[in]  want     Words the caller wants to send
+ * @param[out] vacancy  Set to the estimated vacancy in words
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_flow_control_get_vacancy(hb_mc_manycore_t *mc,
+                                                   hb_mc_fifo_tx_t type,
+                                                   uint32_t want,
+                                                   uint32_t *vacancy)
 {
-        mc->htod_requests = 0;
+        hb_mc_manycore_flow_control_t *fc = hb_mc_manycore_get_flow_control(mc);
+        int err;
+
+        if (fc->tx_vacancy[type] < want) {
+                err = hb_mc_manycore_tx_fifo_get_vacancy(mc, type, &fc->tx_vacancy[type]);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+
+        *vacancy = fc->tx_vacancy[type];
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get the estimated number of host credits, reading them from hardware only
+ * if the estimate cannot cover the requests the caller wants to send.
+ * Waits until at least one credit is available.
+ * @param[in]  mc       A manycore instance
+ * @param[in]  want     Requests the caller wants to send
+ * @param[out] credits  Set to the estimated number of available credits
+ * @param[in]  w        The polling loop to back off in while waiting for credits
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_flow_control_get_credits(hb_mc_manycore_t *mc, uint32_t want,
+                                                   uint32_t *credits, hb_mc_manycore_waiter_t *w)
+{
+        hb_mc_manycore_flow_control_t *fc = hb_mc_manycore_get_flow_control(mc);
+        int hw_credits, err;
+
+        if (fc->credits >= want)
+                goto done;
+
+        for (;;) {
+                hw_credits = hb_mc_manycore_get_host_credits(mc);
+                if (hw_credits < 0)
+                        return hw_credits;
+
+                fc->credits = hw_credits;
+                if (fc->credits != 0)
+                        break;
+
+                if ((err = hb_mc_manycore_waiter_backoff(w)) != HB_MC_SUCCESS)
+                        return err;
+        }
+
+done:
+        *credits = fc->credits;
         return HB_MC_SUCCESS;
 }
 
@@ -499,6 +1166,11 @@ static int hb_mc_manycore_init_fifos(hb_mc_manycore_t *mc)
         if (rc != HB_MC_SUCCESS)
                 return rc;
 
+        /* initialize flow control */
+        rc = hb_mc_manycore_flow_control_init(mc);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
         return HB_MC_SUCCESS;
 }
 
@@ -519,6 +1191,7 @@ static void hb_mc_manycore_cleanup_fifos(hb_mc_manycore_t *mc)
 int  hb_mc_manycore_init(hb_mc_manycore_t *mc, const char *name, hb_mc_manycore_id_t id)
 {
         int r = HB_MC_FAIL, err;
+        bool responders = false;
 
         // check if null
         if (!mc || !name)
@@ -548,11 +1221,19 @@ int  hb_mc_manycore_init(hb_mc_manycore_t *mc, const char *name, hb_mc_manycore_
         if ((err = hb_mc_manycore_init_config(mc)) != HB_MC_SUCCESS)
                 goto cleanup;
 
+        // precompute DRAM address translation
+        default_eva_dram_desc_init(mc);
+
         // initialize FIFOs
         if ((err = hb_mc_manycore_init_fifos(mc)) != HB_MC_SUCCESS)
                 goto cleanup;
 
-        // initialize responders
+        // initialize asynchronous transfers
+        if ((err = hb_mc_manycore_async_init(mc)) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        // initialize responders; this counts as a user of them even if it fails
+        responders = true;
         if ((err = hb_mc_responders_init(mc)))
                 goto cleanup;
 
@@ -565,6 +1246,9 @@ int  hb_mc_manycore_init(hb_mc_manycore_t *mc, const char *name, hb_mc_manycore_
 
  cleanup:
         r = err;
+        if (responders && hb_mc_responders_quit(mc) != HB_MC_SUCCESS)
+                bsg_pr_err("%s: failed to cleanup responders\n", __func__);
+        hb_mc_manycore_eva_tlb_exit(mc);
         hb_mc_manycore_cleanup_fifos(mc);
         hb_mc_manycore_cleanup_mmio(mc);
         hb_mc_manycore_cleanup_private_data(mc);
@@ -581,6 +1265,10 @@ int  hb_mc_manycore_init(hb_mc_manycore_t *mc, const char *name, hb_mc_manycore_
 int hb_mc_manycore_exit(hb_mc_manycore_t *mc)
 {
         int err;
+
+        /* never leave this manycore in the global TLB list, even if exit fails */
+        hb_mc_manycore_eva_tlb_exit(mc);
+
         err = hb_mc_responders_quit(mc);
         if (err != HB_MC_SUCCESS) {
                 bsg_pr_err("%s: failed to cleanup responders: %s\n",
@@ -594,6 +1282,38 @@ int hb_mc_manycore_exit(hb_mc_manycore_t *mc)
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Get the number of manycores present on this host.
+ * @param[out] count  Set to the number of manycores.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_manycore_get_device_count(int *count)
+{
+        if (!count)
+                return HB_MC_INVALID;
+
+#if defined(EMULATION)
+        *count = HB_MC_EMULATION_MAX_DEVICES;
+#elif defined(COSIM)
+        *count = 1;
+#else
+        struct fpga_slot_spec specs[FPGA_SLOT_MAX];
+        int err;
+
+        if ((err = fpga_pci_get_all_slot_specs(specs, FPGA_SLOT_MAX)) != 0) {
+                bsg_pr_err("%s: Failed to enumerate FPGA slots: %s\n",
+                           __func__, FPGA_ERR2STR(err));
+                return HB_MC_FAIL;
+        }
+
+        // slots are numbered densely from 0; empty entries have no vendor
+        *count = 0;
+        while (*count < FPGA_SLOT_MAX && specs[*count].map[FPGA_APP_PF].vendor_id != 0)
+                (*count)++;
+#endif
+        return HB_MC_SUCCESS;
+}
+
 /************/
 /* MMIO API */
 /************/
@@ -640,6 +1360,44 @@ static int  hb_mc_manycore_mmio_read_mmio(hb_mc_manycore_t *mc, uintptr_t offset
 
         return HB_MC_SUCCESS;
 }
+#if defined(EMULATION)
+/**
+ * Reads data for MMIO from an emulated manycore (used in EMULATION)
+ */
+static int  hb_mc_manycore_mmio_read_emulation(hb_mc_manycore_t *mc, uintptr_t offset,
+                                               void *vp, size_t sz)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        uint32_t val;
+        int err;
+
+        if (pdata->emul == nullptr) {
+                manycore_pr_err(mc, "%s: Failed: MMIO not initialized\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        if ((err = hb_mc_emulation_read32(pdata->emul, offset, &val)) != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed: %s\n", __func__, hb_mc_strerror(err));
+                return err;
+        }
+
+        switch (sz) {
+        case 4:
+                *(uint32_t*)vp = val;
+                break;
+        case 2:
+                *(uint16_t*)vp = val;
+                break;
+        case 1:
+                *(uint8_t *)vp = val;
+                break;
+        default:
+                manycore_pr_err(mc, "%s: Failed: invalid load size (%zu)\n", __func__, sz);
+                return HB_MC_INVALID;
+        }
+        return HB_MC_SUCCESS;
+}
+#else
 /**
  * Reads data for MMIO instead by using PCI ops (used in COSIM)
  */
@@ -671,6 +1429,7 @@ static int  hb_mc_manycore_mmio_read_pci(hb_mc_manycore_t *mc, uintptr_t offset,
         }
         return HB_MC_SUCCESS;
 }
+#endif
 
 /**
  * Read the number of remaining available host credits
@@ -695,7 +1454,10 @@ int hb_mc_manycore_get_host_credits(hb_mc_manycore_t *mc)
 static int hb_mc_manycore_mmio_read(hb_mc_manycore_t *mc, uintptr_t offset,
                                     void *vp, size_t sz)
 {
-#if !defined(COSIM)
+        hb_mc_manycore_count(mc, mmio_reads, 1);
+#if defined(EMULATION)
+        return hb_mc_manycore_mmio_read_emulation(mc, offset, vp, sz);
+#elif !defined(COSIM)
         return hb_mc_manycore_mmio_read_mmio(mc, offset, vp, sz);
 #else
         return hb_mc_manycore_mmio_read_pci(mc,  offset, vp, sz);
@@ -746,6 +1508,44 @@ static int hb_mc_manycore_mmio_write_mmio(hb_mc_manycore_t *mc, uintptr_t offset
         return HB_MC_SUCCESS;
 }
 
+#if defined(EMULATION)
+/**
+ * Writes data for MMIO to an emulated manycore (used in EMULATION)
+ */
+static int hb_mc_manycore_mmio_write_emulation(hb_mc_manycore_t *mc, uintptr_t offset,
+                                               void *vp, size_t sz)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        uint32_t val;
+        int err;
+
+        if (pdata->emul == nullptr) {
+                manycore_pr_err(mc, "%s: Failed: MMIO not initialized\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        switch (sz) {
+        case 4:
+                val = *(uint32_t*)vp;
+                break;
+        case 2:
+                val = *(uint16_t*)vp;
+                break;
+        case 1:
+                val = *(uint8_t*)vp;
+                break;
+        default:
+                manycore_pr_err(mc, "%s: Failed: invalid store size (%zu)\n", __func__, sz);
+                return HB_MC_INVALID;
+        }
+
+        if ((err = hb_mc_emulation_write32(pdata->emul, offset, val)) != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed: %s\n", __func__, hb_mc_strerror(err));
+                return err;
+        }
+        return HB_MC_SUCCESS;
+}
+#else
 /**
  * Writes data for MMIO instead by  PCI ops (used in COSIM)
  */
@@ -778,16 +1578,82 @@ static int hb_mc_manycore_mmio_write_pci(hb_mc_manycore_t *mc, uintptr_t offset,
         }
         return HB_MC_SUCCESS;
 }
+#endif
 
 static int hb_mc_manycore_mmio_write(hb_mc_manycore_t *mc, uintptr_t offset,
                                      void *vp, size_t sz)
 {
-#if !defined(COSIM)
+        hb_mc_manycore_count(mc, mmio_writes, 1);
+#if defined(EMULATION)
+        return hb_mc_manycore_mmio_write_emulation(mc, offset, vp, sz);
+#elif !defined(COSIM)
         return hb_mc_manycore_mmio_write_mmio(mc, offset, vp, sz);
 #else
         return hb_mc_manycore_mmio_write_pci(mc, offset, vp, sz);
 #endif
 }
+
+/**
+ * Write a burst of words to a tx FIFO data register.
+ * The register is checked once for the whole burst rather than once per word.
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] offset  The offset of a tx FIFO data register
+ * @param[in] words   Words to write
+ * @param[in] count   The number of words in #words
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_mmio_write_tx_data(hb_mc_manycore_t *mc, uintptr_t offset,
+                                             const uint32_t *words, size_t count)
+{
+        hb_mc_manycore_count(mc, mmio_writes, count);
+#if defined(EMULATION)
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        int err;
+
+        if (pdata->emul == nullptr) {
+                manycore_pr_err(mc, "%s: Failed: MMIO not initialized\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        if ((err = hb_mc_emulation_write_tx_data(pdata->emul, offset, words, count)) != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed: %s\n", __func__, hb_mc_strerror(err));
+                return err;
+        }
+#elif !defined(COSIM)
+        volatile uint32_t *addr;
+
+        if (mc->mmio == (uintptr_t)nullptr) {
+                manycore_pr_err(mc, "%s: Failed: MMIO not initialized", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        if (offset % 4) {
+                manycore_pr_err(mc, "%s: Failed: 0x%" PRIxPTR " "
+                                "is not aligned to 4 byte boundary\n",
+                                __func__, offset);
+                return HB_MC_UNALIGNED;
+        }
+
+        // the data register is 32 bits wide and TX_LENGTH sits directly above it,
+        // so each word must be its own 32-bit store
+        addr = (volatile uint32_t *)(mc->mmio + offset);
+        for (size_t i = 0; i < count; i++)
+                *addr = words[i];
+#else
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        int err;
+
+        for (size_t i = 0; i < count; i++) {
+                err = fpga_pci_poke(pdata->handle, offset, words[i]);
+                if (err != 0) {
+                        manycore_pr_err(mc, "%s: Failed: %s\n", __func__, FPGA_ERR2STR(err));
+                        return HB_MC_FAIL;
+                }
+        }
+#endif
+        return HB_MC_SUCCESS;
+}
+
 /**
  * Read one byte from manycore hardware at a given AXI Address
  * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
@@ -875,113 +1741,244 @@ int hb_mc_manycore_mmio_write32(hb_mc_manycore_t *mc, uintptr_t offset, uint32_t
 
 
 /**
- * Transmit a packet to manycore hardware
- * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
- * @param[in] packet  A packet to transmit to manycore hardware
- * @param[in] type    Is this packet a request or response packet?
- * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
- * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ * Select how a manycore instance writes packets into its tx FIFOs
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] mode  An injection mode
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
+int hb_mc_manycore_set_tx_injection(hb_mc_manycore_t *mc, hb_mc_tx_injection_t mode)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
 
-static int hb_mc_manycore_packet_tx_internal(hb_mc_manycore_t *mc,
-                                             hb_mc_packet_t *packet,
-                                             hb_mc_fifo_tx_t type,
-                                             long timeout) {
-        const char *typestr = hb_mc_fifo_tx_to_string(type);
-        uintptr_t data_addr, len_addr;
-        hb_mc_direction_t dir;
-        uint32_t vacancy, tx_complete;
-        int err;
-
-        if (timeout != -1) {
-                manycore_pr_err(mc, "%s: Only a timeout value of -1 is supported\n",
-                                __func__);
+        switch (mode) {
+        case HB_MC_TX_INJECTION_SCALAR:
+        case HB_MC_TX_INJECTION_BURST:
+                pdata->tx_injection = mode;
+                return HB_MC_SUCCESS;
+        default:
+                manycore_pr_err(mc, "%s: Invalid injection mode %d\n", __func__, mode);
                 return HB_MC_INVALID;
         }
+}
 
-        // get the address of the data and length registers
-        data_addr = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_TX_DATA_OFFSET);
-        len_addr  = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_TX_LENGTH_OFFSET);
+/* write packets into a tx FIFO that has room for all of them */
+static int hb_mc_manycore_tx_fifo_write_packets(hb_mc_manycore_t *mc,
+                                                hb_mc_fifo_tx_t type,
+                                                const hb_mc_packet_t *packets,
+                                                size_t count)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        uintptr_t data_addr = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_TX_DATA_OFFSET);
+        const size_t packet_words = array_size(packets->words);
+        int err;
 
-        // get the direction
-        dir = hb_mc_get_tx_direction(type);
+        if (pdata->tx_injection == HB_MC_TX_INJECTION_BURST)
+                return hb_mc_manycore_mmio_write_tx_data(mc, data_addr, packets[0].words,
+                                                         count * packet_words);
 
-        // get vacancy
-        err = hb_mc_manycore_tx_fifo_get_vacancy(mc, type, &vacancy);
-        if (err != HB_MC_SUCCESS) {
-                manycore_pr_err(mc, "%s: Failed to read %s FIFO vacancy: %s\n",
-                                __func__, typestr, hb_mc_strerror(err));
-                return err;
+        // scalar: write the data one word at a time
+        for (size_t p = 0; p < count; p++) {
+                for (unsigned i = 0; i < packet_words; i++) {
+                        err = hb_mc_manycore_mmio_write32(mc, data_addr, packets[p].words[i]);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+                }
         }
 
-        if (vacancy < array_size(packet->words)) {
-                manycore_pr_err(mc, "%s: FIFO %s has vacancy less than a unit packet size\n",
-                                __func__, typestr);
-                return HB_MC_FAIL;
-        }
+        return HB_MC_SUCCESS;
+}
 
-        // clear the Transmit Complete bit
-        err = hb_mc_manycore_fifo_clear_isr_bit(mc, dir, HB_MC_MMIO_FIFO_IXR_TC_BIT);
-        if (err != HB_MC_SUCCESS) {
-                manycore_pr_err(mc, "%s: Failed to clear TX-Complete bit for FIFO %s "
-                                "(direction = %s): %s\n",
-                                __func__,
-                                typestr,
-                                hb_mc_direction_to_string(dir), hb_mc_strerror(err));
+/**
+ * Transmit a burst of packets to manycore hardware
+ *
+ * The FIFO vacancy is read once per burst, as many packets as fit are
+ * written to the data register, and the whole burst is committed with a
+ * single write to the length register and a single wait on TX-Complete.
+ * Bursts repeat until all packets have been transmitted.
+ * A burst has left the host once its length is committed, even if the wait
+ * for it to complete then fails, so #sent may be nonzero on failure.
+ * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  packets An array of packets to transmit to manycore hardware
+ * @param[in]  count   The number of packets in #packets
+ * @param[in]  type    Are these request or response packets?
+ * @param[in]  timeout A timeout in microseconds. Set to -1 to wait forever.
+ * @param[out] sent    Set to the number of packets, from the start of #packets, that left the host
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+static int hb_mc_manycore_packets_tx_internal(hb_mc_manycore_t *mc,
+                                              const hb_mc_packet_t *packets,
+                                              size_t count,
+                                              hb_mc_fifo_tx_t type,
+                                              long timeout,
+                                              size_t *sent)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        const char *typestr = hb_mc_fifo_tx_to_string(type);
+        const size_t packet_words = array_size(packets->words);
+        hb_mc_manycore_flow_control_t *fc = hb_mc_manycore_get_flow_control(mc);
+        uintptr_t len_addr;
+        hb_mc_direction_t dir;
+        uint32_t vacancy, credits, tx_complete;
+        hb_mc_manycore_waiter_t w;
+        int err;
+
+        *sent = 0;
+        err = hb_mc_manycore_check_timeout(mc, __func__, timeout);
+        if (err != HB_MC_SUCCESS)
                 return err;
-        }
 
-        // transmit the data one word at a time
-        for (unsigned i = 0; i < array_size(packet->words); i++) {
-                err = hb_mc_manycore_mmio_write32(mc, data_addr, packet->words[i]);
-                if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to transmit word %d via %s FIFO: %s\n",
-                                        __func__, i, typestr, hb_mc_strerror(err));
-                        return err;
-                }
-        }
+        // bursts from different threads must not interleave in the FIFO
+        std::lock_guard<std::mutex> guard(pdata->tx_lock);
+
+        hb_mc_manycore_waiter_init(mc, &w, timeout);
+
+        // get the address of the length register
+        len_addr = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_TX_LENGTH_OFFSET);
 
-        do { // wait until transmit is complete: continuously write a packet length until done
-                err = hb_mc_manycore_mmio_write32(mc, len_addr, sizeof(*packet));
+        // get the direction
+        dir = hb_mc_get_tx_direction(type);
+
+        while (*sent < count) {
+                size_t burst;
+                // ask for enough room to send the rest, up to a full FIFO
+                uint32_t want = std::min(count - *sent, (size_t)(fc->tx_capacity[type] / packet_words));
+
+                // get vacancy
+                err = hb_mc_manycore_flow_control_get_vacancy(mc, type, want * packet_words, &vacancy);
                 if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to write length to FIFO %s: %s\n",
+                        manycore_pr_err(mc, "%s: Failed to read %s FIFO vacancy: %s\n",
                                         __func__, typestr, hb_mc_strerror(err));
                         return err;
                 }
 
-                err = hb_mc_manycore_fifo_get_isr_bit(mc, dir, HB_MC_MMIO_FIFO_IXR_TC_BIT, &tx_complete);
-                if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to read TX-Complete bit for FIFO %s "
-                                        "(direction = %s):"
-                                        "%s\n",
-                                        __func__,
-                                        typestr,
-                                        hb_mc_direction_to_string(dir), hb_mc_strerror(err));
+                if (vacancy < packet_words) {
+                        manycore_pr_err(mc, "%s: FIFO %s has vacancy less than a unit packet size\n",
+                                        __func__, typestr);
+                        return HB_MC_FAIL;
+                }
+
+                // send as many packets as the FIFO can hold
+                burst = std::min(count - *sent, (size_t)(vacancy / packet_words));
+
+                // requests are also limited by the credits available to inject them
+                if (type == HB_MC_FIFO_TX_REQ) {
+                        err = hb_mc_manycore_flow_control_get_credits(mc, want, &credits, &w);
+                        if (err == HB_MC_TIMEOUT)
+                                return err;
+
+                        if (err != HB_MC_SUCCESS) {
+                                manycore_pr_err(mc, "%s: Failed to read host credits: %s\n",
+                                                __func__, hb_mc_strerror(err));
+                                return err;
+                        }
+
+                        burst = std::min(burst, (size_t)credits);
+                }
+
+                // clear the Transmit Complete bit
+                err = hb_mc_manycore_fifo_clear_isr_bit(mc, dir, HB_MC_MMIO_FIFO_IXR_TC_BIT);
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to clear TX-Complete bit for FIFO %s "
+                                        "(direction = %s): %s\n",
+                                        __func__,
+                                        typestr,
+                                        hb_mc_direction_to_string(dir), hb_mc_strerror(err));
                         return err;
                 }
-        } while (!tx_complete);
 
-        // clear the Transmit Complete bit
-        err = hb_mc_manycore_fifo_clear_isr_bit(mc, dir, HB_MC_MMIO_FIFO_IXR_TC_BIT);
-        if (err != HB_MC_SUCCESS) {
-                manycore_pr_err(mc, "%s: Failed to clear TX-Complete bit for FIFO %s "
-                                "(direction = %s): %s\n",
-                                __func__,
-                                typestr,
-                                hb_mc_direction_to_string(dir), hb_mc_strerror(err));
-                return err;
-        }
+                // transmit the data
+                err = hb_mc_manycore_tx_fifo_write_packets(mc, type, &packets[*sent], burst);
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to transmit packets %zu-%zu via %s FIFO: %s\n",
+                                        __func__, *sent, *sent + burst - 1, typestr,
+                                        hb_mc_strerror(err));
+                        return err;
+                }
+
+                bool committed = false;
+                do { // wait until transmit is complete: continuously write the burst length until done
+                        err = hb_mc_manycore_mmio_write32(mc, len_addr, burst * sizeof(*packets));
+                        if (err != HB_MC_SUCCESS) {
+                                manycore_pr_err(mc, "%s: Failed to write length to FIFO %s: %s\n",
+                                                __func__, typestr, hb_mc_strerror(err));
+                                return err;
+                        }
+
+                        // the burst has left the host once its length is committed
+                        if (!committed) {
+                                committed = true;
+                                hb_mc_manycore_count(mc, tx_packets[type], burst);
+
+                                // spend the estimates; they are re-read when they cannot cover the next burst
+                                fc->tx_vacancy[type] -= burst * packet_words;
+                                if (type == HB_MC_FIFO_TX_REQ)
+                                        fc->credits -= burst;
+
+                                *sent += burst;
+                        }
 
+                        err = hb_mc_manycore_fifo_get_isr_bit(mc, dir, HB_MC_MMIO_FIFO_IXR_TC_BIT, &tx_complete);
+                        if (err != HB_MC_SUCCESS) {
+                                manycore_pr_err(mc, "%s: Failed to read TX-Complete bit for FIFO %s "
+                                                "(direction = %s):"
+                                                "%s\n",
+                                                __func__,
+                                                typestr,
+                                                hb_mc_direction_to_string(dir), hb_mc_strerror(err));
+                                return err;
+                        }
+
+                        if (!tx_complete) {
+                                hb_mc_manycore_count(mc, tc_spins, 1);
+                                if ((err = hb_mc_manycore_waiter_backoff(&w)) != HB_MC_SUCCESS) {
+                                        manycore_pr_dbg(mc, "%s: Timed out waiting for %s FIFO to transmit\n",
+                                                        __func__, typestr);
+                                        return err;
+                                }
+                        }
+                } while (!tx_complete);
+
+                // clear the Transmit Complete bit
+                err = hb_mc_manycore_fifo_clear_isr_bit(mc, dir, HB_MC_MMIO_FIFO_IXR_TC_BIT);
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to clear TX-Complete bit for FIFO %s "
+                                        "(direction = %s): %s\n",
+                                        __func__,
+                                        typestr,
+                                        hb_mc_direction_to_string(dir), hb_mc_strerror(err));
+                        return err;
+                }
+
+                hb_mc_manycore_waiter_reset(&w);
+        }
 
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Transmit a packet to manycore hardware
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] packet  A packet to transmit to manycore hardware
+ * @param[in] type    Is this packet a request or response packet?
+ * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
+ * @param[out] sent   Set to 1 if the packet left the host, even if the call then failed
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+static int hb_mc_manycore_packet_tx_internal(hb_mc_manycore_t *mc,
+                                             hb_mc_packet_t *packet,
+                                             hb_mc_fifo_tx_t type,
+                                             long timeout,
+                                             size_t *sent)
+{
+        return hb_mc_manycore_packets_tx_internal(mc, packet, 1, type, timeout, sent);
+}
+
 /**
  * Receive a packet from manycore hardware
  * @param[in] mc     A manycore instance initialized with hb_mc_manycore_init()
  * @param[out] packet A packet into which data should be read
  * @param[in] type   Is this packet a request or response packet?
- * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
 static int hb_mc_manycore_packet_rx_internal(hb_mc_manycore_t *mc,
@@ -989,73 +1986,56 @@ static int hb_mc_manycore_packet_rx_internal(hb_mc_manycore_t *mc,
                                              hb_mc_fifo_rx_t type,
                                              long timeout)
 {
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
         const char *typestr = hb_mc_fifo_rx_to_string(type);
-        uintptr_t length_addr, data_addr;
-        uint32_t occupancy, length;
+        hb_mc_manycore_rx_ring_t *ring = hb_mc_manycore_get_rx_ring(mc, type);
+        hb_mc_manycore_waiter_t w;
         int err;
 
-        if (timeout != -1) {
-                manycore_pr_err(mc, "%s: Only a timeout value of -1 is supported\n",
-                                __func__);
-                return HB_MC_INVALID;
-        }
-
-        length_addr = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_RX_LENGTH_OFFSET);
-        data_addr   = hb_mc_mmio_fifo_get_reg_addr(type, HB_MC_MMIO_FIFO_RX_DATA_OFFSET);
-
-        /* wait for a packet */
-        do {
-                err = hb_mc_manycore_rx_fifo_get_occupancy(mc, type, &occupancy);
-                if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to get %s FIFO occupancy while waiting for packet: %s\n",
-                                        __func__, typestr, hb_mc_strerror(err));
-                        return err;
-                }
-
-        } while (occupancy < 1);
-
-        /* get FIFO length */
-        err = hb_mc_manycore_mmio_read32(mc, length_addr, &length);
-        if (err != HB_MC_SUCCESS) {
-                manycore_pr_err(mc, "%s: Failed to read %s FIFO length register: %s\n",
-                                __func__, typestr, hb_mc_strerror(err));
+        err = hb_mc_manycore_check_timeout(mc, __func__, timeout);
+        if (err != HB_MC_SUCCESS)
                 return err;
-        }
 
-        if (length != sizeof(*packet)) {
-                manycore_pr_err(mc, "%s: Read bad length %" PRId32 " from %s FIFO length register\n",
-                                __func__, length, typestr);
-                return HB_MC_FAIL;
-        }
+        hb_mc_manycore_waiter_init(mc, &w, timeout);
 
-        manycore_pr_dbg(mc, "%s: From %s FIFO: Read the receive length register "
-                        "@ 0x%08" PRIxPTR " to be %" PRIu32 "\n",
-                        __func__, typestr, length_addr, length);
+        /* wait for a packet, without holding the FIFO while backing off */
+        for (;;) {
+                {
+                        std::lock_guard<std::mutex> guard(pdata->rx_lock[type]);
 
-        /* read in the packet one word at a time */
-        for (unsigned i = 0; i < array_size(packet->words); i++) {
-                err = hb_mc_manycore_mmio_read32(mc, data_addr, &packet->words[i]);
-                if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed read data from %s FIFO: %s\n",
-                                        __func__, typestr, hb_mc_strerror(err));
-                        return err;
+                        if (ring->count == 0) {
+                                err = hb_mc_manycore_rx_ring_fill(mc, type, nullptr);
+                                if (err != HB_MC_SUCCESS) {
+                                        manycore_pr_err(mc, "%s: Failed to read %s FIFO while waiting for packet: %s\n",
+                                                        __func__, typestr, hb_mc_strerror(err));
+                                        return err;
+                                }
+                        }
+
+                        if (ring->count > 0) {
+                                hb_mc_manycore_rx_ring_pop(ring, packet);
+                                return HB_MC_SUCCESS;
+                        }
                 }
-        }
 
-        return HB_MC_SUCCESS;
+                if ((err = hb_mc_manycore_waiter_backoff(&w)) != HB_MC_SUCCESS)
+                        return err; // timeouts are not errors: omit the error message
+        }
 }
 
 /**
  * Transmit a request packet to manycore hardware
  * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] request A request packet to transmit to manycore hardware
- * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_request_tx(hb_mc_manycore_t *mc,
                               hb_mc_request_packet_t *request,
                               long timeout)
 {
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_REQUEST_TX);
+        size_t sent;
         int err;
 
         /* do we have capacity for another request? */
@@ -1064,26 +2044,97 @@ int hb_mc_manycore_request_tx(hb_mc_manycore_t *mc,
                 return err;
 
         /* send the request packet */
-        err = hb_mc_manycore_packet_tx_internal(mc, (hb_mc_packet_t*)request, HB_MC_FIFO_TX_REQ, timeout);
+        err = hb_mc_manycore_packet_tx_internal(mc, (hb_mc_packet_t*)request, HB_MC_FIFO_TX_REQ, timeout, &sent);
+        if (err != HB_MC_SUCCESS) {
+                /* a request that left the host still holds its reservation until it is answered */
+                if (sent == 0)
+                        hb_mc_manycore_decr_host_requests(mc);
+                return err;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* count the loads among a batch of request packets */
+static unsigned hb_mc_manycore_count_loads(const hb_mc_packet_t *requests, size_t count)
+{
+        unsigned loads = 0;
+
+        for (size_t i = 0; i < count; i++)
+                if (hb_mc_request_packet_get_op(&requests[i].request) != HB_MC_PACKET_OP_REMOTE_STORE)
+                        loads++;
+
+        return loads;
+}
+
+/**
+ * Transmit a batch of request packets to manycore hardware, holding a host
+ * request for each load until its response is received.
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  requests An array of request packets to transmit to manycore hardware
+ * @param[in]  count    The number of packets in #requests
+ * @param[in]  timeout  A timeout in microseconds. Set to -1 to wait forever.
+ * @param[out] sent     Set to the number of packets, from the start of #requests, that left the host
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_requests_tx_internal(hb_mc_manycore_t *mc,
+                                               const hb_mc_packet_t *requests,
+                                               size_t count,
+                                               long timeout,
+                                               size_t *sent)
+{
+        unsigned loads = hb_mc_manycore_count_loads(requests, count);
+        int err;
+
+        *sent = 0;
+
+        /* do we have capacity for every load in the batch? */
+        err = hb_mc_manycore_reserve_host_requests(mc, loads);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* send the request packets */
+        err = hb_mc_manycore_packets_tx_internal(mc, requests, count, HB_MC_FIFO_TX_REQ, timeout, sent);
         if (err != HB_MC_SUCCESS) {
-                hb_mc_manycore_decr_host_requests(mc);
+                /* loads that left the host hold their reservations until they are answered */
+                hb_mc_manycore_release_host_requests(mc, loads - hb_mc_manycore_count_loads(requests, *sent));
                 return err;
         }
 
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Transmit a batch of request packets to manycore hardware
+ * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] requests An array of packets, each holding a request, to transmit to manycore hardware
+ * @param[in] count    The number of packets in #requests
+ * @param[in] timeout  A timeout in microseconds. Set to -1 to wait forever.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_requests_tx(hb_mc_manycore_t *mc,
+                               const hb_mc_packet_t *requests,
+                               size_t count,
+                               long timeout)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_REQUESTS_TX);
+        size_t sent;
+
+        return hb_mc_manycore_requests_tx_internal(mc, requests, count, timeout, &sent);
+}
+
 /**
  * Receive a response packet from manycore hardware
  * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] response A packet into which data should be read
- * @param[in] timeout  A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout  A timeout in microseconds. Set to -1 to wait forever.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_response_rx(hb_mc_manycore_t *mc,
                                hb_mc_response_packet_t *response,
                                long timeout)
 {
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_RESPONSE_RX);
         int err;
 
         /* receive the response packet */
@@ -1104,27 +2155,30 @@ int hb_mc_manycore_response_rx(hb_mc_manycore_t *mc,
  * Transmit a response packet to manycore hardware
  * @param[in] mc        A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] response  A response packet to transmit to manycore hardware
- * @param[in] timeout   A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout   A timeout in microseconds. Set to -1 to wait forever.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_response_tx(hb_mc_manycore_t *mc,
                                hb_mc_response_packet_t *response,
                                long timeout)
 {
-        return hb_mc_manycore_packet_tx_internal(mc, (hb_mc_packet_t*)response, HB_MC_FIFO_TX_RSP, timeout);
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_RESPONSE_TX);
+        size_t sent;
+        return hb_mc_manycore_packet_tx_internal(mc, (hb_mc_packet_t*)response, HB_MC_FIFO_TX_RSP, timeout, &sent);
 }
 
 /**
  * Receive a request packet from manycore hardware
  * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] request A packet into which data should be read
- * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_request_rx(hb_mc_manycore_t *mc,
                               hb_mc_request_packet_t *request,
                               long timeout)
 {
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_REQUEST_RX);
         int err;
         err = hb_mc_manycore_packet_rx_internal(mc, (hb_mc_packet_t*)request, HB_MC_FIFO_RX_REQ, timeout);
         if (err != HB_MC_SUCCESS)
@@ -1145,7 +2199,7 @@ int hb_mc_manycore_request_rx(hb_mc_manycore_t *mc,
  * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] packet  A packet to transmit to manycore hardware
  * @param[in] type    Is this packet a request or response packet?
- * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_packet_tx(hb_mc_manycore_t *mc,
@@ -1166,7 +2220,7 @@ int hb_mc_manycore_packet_tx(hb_mc_manycore_t *mc,
  * @param[in] mc     A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] packet A packet into which data should be read
  * @param[in] type   Is this packet a request or response packet?
- * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_packet_rx(hb_mc_manycore_t *mc,
@@ -1282,16 +2336,15 @@ static inline int hb_mc_manycore_epa_check_alignment(const hb_mc_epa_t *epa, siz
         return HB_MC_SUCCESS;
 }
 
-/* send a read request and don't wait for the return packet */
-static int hb_mc_manycore_send_read_rqst(hb_mc_manycore_t *mc,
-                                         const hb_mc_npa_t *npa, size_t sz,
-                                         uint32_t id = 0)
+/* format a read request to a memory address on the manycore */
+static int hb_mc_manycore_format_read_request_packet(hb_mc_manycore_t *mc, hb_mc_packet_t *rqst,
+                                                     const hb_mc_npa_t *npa, size_t sz,
+                                                     uint32_t id)
 {
-        hb_mc_packet_t rqst;
         int err;
 
         /* format the request packet */
-        err = hb_mc_manycore_format_load_request_packet(mc, &rqst.request, npa);
+        err = hb_mc_manycore_format_load_request_packet(mc, &rqst->request, npa);
         if (err != HB_MC_SUCCESS) {
                 manycore_pr_err(mc, "%s: Failed to format load request packet: %s\n",
                                 __func__, hb_mc_strerror(err));
@@ -1306,69 +2359,26 @@ static int hb_mc_manycore_send_read_rqst(hb_mc_manycore_t *mc,
                 return err;
 
         // mark request with id
-        hb_mc_request_packet_set_data(&rqst.request, id);
+        hb_mc_request_packet_set_data(&rqst->request, id);
         int shift = hb_mc_npa_get_epa(npa) & 0x3;
         /* set the byte mask */
         switch (sz) {
         case 4:
-                hb_mc_request_packet_set_mask(&rqst.request, HB_MC_PACKET_REQUEST_MASK_WORD);
+                hb_mc_request_packet_set_mask(&rqst->request, HB_MC_PACKET_REQUEST_MASK_WORD);
                 break;
         case 2:
-                hb_mc_request_packet_set_mask(&rqst.request,
+                hb_mc_request_packet_set_mask(&rqst->request,
                                               static_cast<hb_mc_packet_mask_t>(
                                                       HB_MC_PACKET_REQUEST_MASK_SHORT << shift));
                 break;
         case 1:
-                hb_mc_request_packet_set_mask(&rqst.request, static_cast<hb_mc_packet_mask_t>(
+                hb_mc_request_packet_set_mask(&rqst->request, static_cast<hb_mc_packet_mask_t>(
                                                       HB_MC_PACKET_REQUEST_MASK_BYTE << shift));
                 break;
         default:
                 return HB_MC_INVALID;
         }
 
-        /* transmit the request to the hardware */
-        manycore_pr_dbg(mc, "Sending %d-byte read request to NPA "
-                        "(x: %d, y: %d, 0x%08" PRIx32 ")\n",
-                        sz,
-                        hb_mc_npa_get_x(npa),
-                        hb_mc_npa_get_y(npa),
-                        hb_mc_npa_get_epa(npa));
-
-        err = hb_mc_manycore_request_tx(mc, &rqst.request, -1);
-        if (err == HB_MC_BUSY)
-                return err; // omit the error message if just busy
-
-        if (err != HB_MC_SUCCESS) {
-                manycore_pr_err(mc, "%s: Failed to send request packet: %s\n",
-                                __func__, hb_mc_strerror(err));
-                return err;
-        }
-
-        return HB_MC_SUCCESS;
-}
-
-/* read a response packet for a read request to an npa */
-static int hb_mc_manycore_recv_read_rsp(hb_mc_manycore_t *mc,
-                                        uint32_t *vp,
-                                        uint32_t *id = nullptr)
-{
-        hb_mc_packet_t rsp;
-        int err;
-
-        /* receive a packet from the hardware */
-        err = hb_mc_manycore_response_rx(mc, &rsp.response, -1);
-        if (err != HB_MC_SUCCESS) {
-                manycore_pr_err(mc, "%s: Failed to read response packet: %s\n",
-                                __func__, hb_mc_strerror(err));
-                return err;
-        }
-
-        /* read data from packet */
-        *vp = hb_mc_response_packet_get_data(&rsp.response);
-
-        if (id != nullptr)
-                *id = hb_mc_response_packet_get_load_id(&rsp.response);
-
         return HB_MC_SUCCESS;
 }
 
@@ -1399,36 +2409,14 @@ static UINT hb_mc_manycore_mask_load_data(const hb_mc_npa_t *npa, uint32_t load_
         return static_cast<UINT>(result);
 }
 
-/* read from a memory address on the manycore */
-template <typename UINT>
-static int hb_mc_manycore_read(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, UINT *vp)
-{
-        int err;
-
-        /* send load request */
-        err = hb_mc_manycore_send_read_rqst(mc, npa, sizeof(UINT));
-        if (err != HB_MC_SUCCESS)
-                return err;
-
-        /* read back response */
-        uint32_t load_data;
-        err = hb_mc_manycore_recv_read_rsp(mc, &load_data);
-        if (err != HB_MC_SUCCESS)
-                return err;
-
-        /* mask off unused bits */
-        *vp = hb_mc_manycore_mask_load_data<UINT>(npa, load_data);
-        return HB_MC_SUCCESS;
-}
-
-/* write to a memory address on the manycore */
-static int hb_mc_manycore_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, const void *vp, size_t sz)
+/* format a write request to a memory address on the manycore */
+static int hb_mc_manycore_format_write_request_packet(hb_mc_manycore_t *mc, hb_mc_packet_t *rqst,
+                                                      const hb_mc_npa_t *npa, const void *vp, size_t sz)
 {
         int err;
-        hb_mc_packet_t rqst;
 
         /* format the packet */
-        err = hb_mc_manycore_format_store_request_packet(mc, &rqst.request, npa);
+        err = hb_mc_manycore_format_store_request_packet(mc, &rqst->request, npa);
         if (err != HB_MC_SUCCESS)
                 return err;
 
@@ -1444,33 +2432,24 @@ static int hb_mc_manycore_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, co
         /* set data and size */
         switch (sz) {
         case 4:
-                hb_mc_request_packet_set_data(&rqst.request, *(const uint32_t*)vp);
-                hb_mc_request_packet_set_mask(&rqst.request, HB_MC_PACKET_REQUEST_MASK_WORD);
+                hb_mc_request_packet_set_data(&rqst->request, *(const uint32_t*)vp);
+                hb_mc_request_packet_set_mask(&rqst->request, HB_MC_PACKET_REQUEST_MASK_WORD);
                 break;
         case 2:
-                hb_mc_request_packet_set_data(&rqst.request, static_cast<uint32_t>(*(const uint16_t*)vp) << data_shift);
-                hb_mc_request_packet_set_mask(&rqst.request, static_cast<hb_mc_packet_mask_t>(
+                hb_mc_request_packet_set_data(&rqst->request, static_cast<uint32_t>(*(const uint16_t*)vp) << data_shift);
+                hb_mc_request_packet_set_mask(&rqst->request, static_cast<hb_mc_packet_mask_t>(
                                                       HB_MC_PACKET_REQUEST_MASK_SHORT << mask_shift));
                 break;
         case 1:
-                hb_mc_request_packet_set_data(&rqst.request, static_cast<uint32_t>(*(const  uint8_t*)vp) << data_shift);
-                hb_mc_request_packet_set_mask(&rqst.request, static_cast<hb_mc_packet_mask_t>(
+                hb_mc_request_packet_set_data(&rqst->request, static_cast<uint32_t>(*(const  uint8_t*)vp) << data_shift);
+                hb_mc_request_packet_set_mask(&rqst->request, static_cast<hb_mc_packet_mask_t>(
                                                       HB_MC_PACKET_REQUEST_MASK_BYTE << mask_shift));
                 break;
         default:
                 return HB_MC_INVALID;
         }
 
-        /* transmit the request */
-        manycore_pr_dbg(mc, "Sending %d-byte write request to NPA "
-                        "(x: %d, y: %d, 0x%08x) (data = 0x%08" PRIx32 ")\n",
-                        sz,
-                        hb_mc_npa_get_x(npa),
-                        hb_mc_npa_get_y(npa),
-                        hb_mc_npa_get_epa(npa),
-                        hb_mc_request_packet_get_data(&rqst.request));
-
-        return hb_mc_manycore_request_tx(mc, &rqst.request, -1);
+        return HB_MC_SUCCESS;
 }
 
 /* checks that the arguments of read/write_mem are supported */
@@ -1496,226 +2475,1294 @@ static int hb_mc_manycore_read_write_mem_check_args(hb_mc_manycore_t *mc,
         return HB_MC_SUCCESS;
 }
 
-/**
- * Write memory out to manycore hardware starting at a given NPA
- * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
- * @param[in]  npa    A valid hb_mc_npa_t
- * @param[in]  data   A buffer to be written out manycore hardware
- * @param[in]  sz     The number of bytes to write to manycore hardware
- * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
- */
-int hb_mc_manycore_write_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
-                             const void *data, size_t sz)
-{
-        int err;
+////////////////////////////
+// Asynchronous Transfers //
+////////////////////////////
 
-        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
-        if (err != HB_MC_SUCCESS)
-                return err;
+/*
+  Each host thread using a manycore instance submits transfers to its own
+  queue. Load ids come from a shared pool, a batch at a time, and belong to
+  the queue that sent the load until its response is consumed. Whichever
+  thread drains the response FIFO routes each response to the queue that
+  owns its load id, so a thread only ever completes its own transfers.
+  Stores need no load ids and only contend for the tx FIFO.
+*/
+
+typedef struct hb_mc_manycore_queue hb_mc_manycore_queue_t;
+
+/* an asynchronous transfer of words to or from manycore hardware */
+struct hb_mc_transfer {
+        bool               is_read;   //!< a load (true) or store (false) transfer
+        hb_mc_npa_t        base;      //!< NPA of the first word of a contiguous transfer
+        const hb_mc_npa_t *npas;      //!< NPA of each word of a scatter-gather transfer, or nullptr
+        hb_mc_npa_stream_next_t next; //!< produces the NPA segments of a streaming transfer, or nullptr
+        hb_mc_npa_lookup_t lookup;    //!< looks up the NPA of each word of an interleaved transfer, or nullptr
+        const hb_mc_npa_t *targets;   //!< base NPAs a fan-out transfer writes each word to, or nullptr
+        size_t             ntargets;  //!< number of #targets
+        void              *stream;    //!< passed to #next or #lookup
+        hb_mc_transfer_interleave_t order; //!< request order of an interleaved transfer
+        hb_mc_npa_t        seg;       //!< NPA of the current segment of a streaming transfer
+        size_t             seg_first; //!< index of the first word of the current segment
+        size_t             seg_end;   //!< index one past the last word of the current segment
+        uint32_t          *dst;       //!< destination of load data
+        const uint32_t    *src;       //!< source of store data, or nullptr to store #fill
+        uint32_t           fill;      //!< word stored when #src is nullptr
+        size_t             sz;        //!< bytes per request: 4, or 1 or 2 for a single sub-word access
+        size_t             count;     //!< number of words to transfer
+        size_t             issued;    //!< number of requests sent
+        size_t             completed; //!< number of words transferred
+        int                status;    //!< HB_MC_SUCCESS, or the first error encountered
+        bool               done;      //!< has the transfer completed?
+        bool               detached;  //!< release on completion (no handle was returned)
+        hb_mc_manycore_queue_t *queue; //!< the queue of the submitting thread
+        hb_mc_transfer_callback_t callback;
+        void              *context;
+
+        /* the NPA of the ith word */
+        hb_mc_npa_t npa(size_t i) const {
+                if (npas != nullptr)
+                        return npas[i];
+
+                /* a fan-out transfer sends each source word to every target in turn */
+                if (targets != nullptr) {
+                        const hb_mc_npa_t *t = &targets[i % ntargets];
+                        return hb_mc_npa_from_x_y(hb_mc_npa_get_x(t),
+                                                  hb_mc_npa_get_y(t),
+                                                  hb_mc_npa_get_epa(t) +
+                                                  (i / ntargets)*sizeof(uint32_t));
+                }
 
-        // This pair of matching function calls changes the clock period of the
-        // manycore during data transfer to accelerate simulation
-#ifdef COSIM
-        sv_set_virtual_dip_switch(0, 1);
-#endif
+                return hb_mc_npa_from_x_y(hb_mc_npa_get_x(&base),
+                                          hb_mc_npa_get_y(&base),
+                                          hb_mc_npa_get_epa(&base) +
+                                          i*sizeof(uint32_t));
+        }
 
-        const uint32_t *words = (const uint32_t*)data;
-        size_t n_words = sz >> 2;
-        hb_mc_npa_t addr = *npa;
+        /* the index of the word sent by the nth request */
+        size_t word_index(size_t n) const {
+                size_t block = order.lanes * order.lane_words;
 
-        /* send store requests one word at a time */
-        for (size_t i = 0; i < n_words; i++) {
+                if (block == 0 || n < order.head_words)
+                        return n;
 
-                err = hb_mc_manycore_write(mc, &addr, &words[i], 4);
-                if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to send write request: %s\n",
-                                        __func__, hb_mc_strerror(err));
-                        return err;
-                }
+                size_t m = n - order.head_words;
+                if (m / block >= (count - order.head_words) / block)
+                        return n;
 
-                // Increment EPA by 4:
-                hb_mc_npa_set_epa(&addr, hb_mc_npa_get_epa(&addr) + 4);
+                size_t r = m % block;
+                return n - r + (r % order.lanes) * order.lane_words + r / order.lanes;
         }
 
-#ifdef COSIM
-        sv_set_virtual_dip_switch(0, 0);
-#endif
-        return HB_MC_SUCCESS;
-}
+        /* the NPA of the ith word; streaming transfers must ask for words in order */
+        int next_npa(hb_mc_manycore_t *mc, size_t i, hb_mc_npa_t *npa_out) {
+                if (lookup != nullptr)
+                        return lookup(mc, stream, i * sizeof(uint32_t), npa_out);
 
-/**
- * Set memory to a given value starting at a given NPA
- * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
- * @param[in]  npa    A valid hb_mc_npa_t
- * @param[in]  val    Value to be written out
- * @param[in]  sz     The number of bytes to write to manycore hardware
- * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
- */
-int hb_mc_manycore_memset(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
-                          uint8_t val, size_t sz)
-{
-        int err;
+                if (next == nullptr) {
+                        *npa_out = npa(i);
+                        return HB_MC_SUCCESS;
+                }
 
-        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, NULL, sz);
-        if (err != HB_MC_SUCCESS)
-                return err;
+                if (i >= seg_end) {
+                        size_t seg_sz;
+                        int err = next(mc, stream, &seg, &seg_sz);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
 
-        const uint32_t word = (val << 24) | (val << 16) | (val << 8) | val;
-        size_t n_words = sz >> 2;
-        hb_mc_npa_t addr = *npa;
+                        if (seg_sz < sizeof(uint32_t))
+                                return HB_MC_INVALID;
 
-#ifdef COSIM
-        sv_set_virtual_dip_switch(0, 1);
-#endif
+                        seg_first = i;
+                        seg_end = i + seg_sz / sizeof(uint32_t);
+                }
 
-        /* send store requests one word at a time */
-        for (size_t i = 0; i < n_words; i++) {
+                *npa_out = hb_mc_npa_from_x_y(hb_mc_npa_get_x(&seg),
+                                              hb_mc_npa_get_y(&seg),
+                                              hb_mc_npa_get_epa(&seg) +
+                                              (i - seg_first)*sizeof(uint32_t));
+                return HB_MC_SUCCESS;
+        }
 
-                err = hb_mc_manycore_write(mc, &addr, &word, 4);
-                if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to send write request: %s\n",
-                                        __func__, hb_mc_strerror(err));
-                        return err;
-                }
+        /* the ith word to store */
+        uint32_t word(size_t i) const {
+                if (targets != nullptr)
+                        i /= ntargets;
 
-                // increment EPA by 1: (EPA's address words)
-                hb_mc_npa_set_epa(&addr, hb_mc_npa_get_epa(&addr) + sizeof(uint32_t));
+                return src != nullptr ? src[i] : fill;
         }
 
-#ifdef COSIM
-        sv_set_virtual_dip_switch(0, 0);
-#endif
+        /* does the ith word repeat the payload of the word before it (to another target)? */
+        bool repeats_payload(size_t i) const {
+                return targets != nullptr && i % ntargets != 0;
+        }
+};
+
+/* the transfers submitted by one host thread */
+struct hb_mc_manycore_queue {
+        std::deque<hb_mc_transfer_t*> pending;      //!< transfers with requests left to send, in submission order
+        std::unordered_set<hb_mc_transfer_t*> live; //!< transfers that have not been released
+        std::vector<hb_mc_packet_t> responses;      //!< responses routed to this queue; guarded by the async lock
+        std::vector<hb_mc_packet_t> consumed;       //!< responses being consumed by the owning thread
+        std::vector<uint32_t> freed;                //!< load ids being returned to the pool
+        size_t outstanding;                         //!< loads sent whose responses have not been consumed
+        uint64_t progress;                          //!< bursts sent plus responses consumed
+
+        ~hb_mc_manycore_queue() {
+                for (hb_mc_transfer_t *xfer : live)
+                        delete xfer;
+        }
+};
+
+/* the asynchronous transfers of a manycore instance */
+struct hb_mc_manycore_async {
+        std::mutex lock;                                                     //!< guards the members below and queue responses
+        std::unordered_map<std::thread::id, hb_mc_manycore_queue_t*> queues; //!< the queue of each host thread
+        std::vector<uint32_t> ids;                                           //!< free load ids
+        std::vector<hb_mc_manycore_queue_t*> id_to_queue;                    //!< queue that owns each load id
+        std::vector<hb_mc_transfer_t*> id_to_xfer;                           //!< transfer waiting on each load id; owner only
+        std::vector<size_t> id_to_word;                                      //!< word waiting on each load id; owner only
+
+        /* release all queues and transfers, complete or not */
+        ~hb_mc_manycore_async() {
+                for (auto &entry : queues)
+                        delete entry.second;
+        }
+};
 
-        return HB_MC_SUCCESS;
-}
+/* the queues a host thread has created; each is reclaimed when the thread exits */
+struct hb_mc_manycore_queue_owner {
+        typedef std::pair<std::weak_ptr<hb_mc_manycore_async_t>, hb_mc_manycore_queue_t*> entry_t;
+        std::vector<entry_t> queues;
 
-/**
- * Perform #cnt loads from a series of NPAs and return results in an associative container #data.
- * After returning success, #data[i] shall be the data read from the NPA given by #npa(i)
- * for i >= 0 and i < cnt.
- *
- * @tparam UINT               The unsigned integer type for data loads.
- * @tparam UINTV              An associative container of UNT words (indexed by i).
- * @tparam NPA_OF_I_FUNCTION  Returns an NPA given an index i.
- *
- * @param[in]  mc    A manycore instance.
- * @param[in]  npa   A function that takes an index i and returns an NPA.
- * @param[out] data  A mutable associative container by which load data is returned.
- * @param[in]  cnt   The number of loads to perform.
- *
- * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
- */
-template <typename UINT, typename UINTV, typename NPA_OF_I_FUNCTION>
-static int hb_mc_manycore_read_mem_internal(hb_mc_manycore_t *mc,
-                                            NPA_OF_I_FUNCTION npa,
-                                            UINTV & data, size_t cnt)
+        ~hb_mc_manycore_queue_owner() {
+                for (auto &entry : queues) {
+                        std::shared_ptr<hb_mc_manycore_async_t> async = entry.first.lock();
+                        hb_mc_manycore_queue_t *q = entry.second;
+
+                        /* the manycore has exited and freed the queue already */
+                        if (async == nullptr)
+                                continue;
+
+                        /* responses still on their way would be routed to it: leave it to hb_mc_manycore_exit() */
+                        std::lock_guard<std::mutex> guard(async->lock);
+                        if (q->outstanding != 0)
+                                continue;
+
+                        async->queues.erase(std::this_thread::get_id());
+                        delete q;
+                }
+        }
+};
+
+static thread_local hb_mc_manycore_queue_owner hb_mc_manycore_thread_queues;
+
+static hb_mc_manycore_async_t *hb_mc_manycore_get_async(hb_mc_manycore_t *mc)
 {
-        size_t rsp_i = 0, rqst_i = 0;
-        uint32_t occupancy;
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        return pdata != nullptr ? pdata->async.get() : nullptr;
+}
+
+/* get the calling thread's queue, creating it on first use; it lives until the thread or the manycore exits */
+static hb_mc_manycore_queue_t *hb_mc_manycore_get_queue(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        hb_mc_manycore_async_t *async = hb_mc_manycore_get_async(mc);
+
+        if (async == nullptr)
+                return nullptr;
+
+        std::lock_guard<std::mutex> guard(async->lock);
+        hb_mc_manycore_queue_t *&q = async->queues[std::this_thread::get_id()];
+        if (q == nullptr) {
+                auto &owned = hb_mc_manycore_thread_queues.queues;
+
+                /* forget the queues of manycores that have exited */
+                owned.erase(std::remove_if(owned.begin(), owned.end(),
+                                           [](const hb_mc_manycore_queue_owner::entry_t &entry) {
+                                                   return entry.first.expired();
+                                           }),
+                            owned.end());
+
+                q = new hb_mc_manycore_queue_t();
+                owned.emplace_back(pdata->async, q);
+        }
+
+        return q;
+}
+
+/**
+ * Initialize asynchronous transfers. Must be called after flow control is initialized.
+ * @param[in] mc  A manycore instance
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_async_init(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        std::shared_ptr<hb_mc_manycore_async_t> async;
         unsigned n_ids;
         int err;
 
-        /* cap the number of load ids to the maximum number of pending requests */
+        /* there is one load id per outstanding load */
         err = hb_mc_manycore_get_host_requests_cap(mc, &n_ids);
         if (err != HB_MC_SUCCESS)
                 return err;
 
-#ifdef COSIM
-        sv_set_virtual_dip_switch(0, 1);
-#endif
-
-        /* track requests and responses with ids and id_to_rsp_i */
-        std::stack <uint32_t, std::vector<uint32_t> > ids;
+        async = std::make_shared<hb_mc_manycore_async_t>();
         for (int i = n_ids - 1; i >= 0; i--)
-                ids.push(static_cast<uint32_t>(i));
+                async->ids.push_back(static_cast<uint32_t>(i));
 
-        int id_to_rsp_i [n_ids];
-        hb_mc_npa_t id_to_npa[n_ids];
+        async->id_to_queue.assign(n_ids, nullptr);
+        async->id_to_xfer.assign(n_ids, nullptr);
+        async->id_to_word.assign(n_ids, 0);
 
-        /* until we've received all responses... */
-        while (rsp_i < cnt) {
+        pdata->async = async;
+        return HB_MC_SUCCESS;
+}
 
-                /* try to request as many words as we have left */
-                while (rqst_i < cnt) {
-                        // get the NPA of the next load address
-                        hb_mc_npa_t rqst_addr = npa(rqst_i);
+/* release all queues and transfers, complete or not, once no exiting thread is reclaiming its queue */
+static void hb_mc_manycore_async_cleanup(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
 
-                        // if we're out of load ids, break to start reading requests
-                        if (ids.empty())
-                                break;
+        if (pdata == nullptr)
+                return;
+
+        pdata->async.reset();
+}
+
+static void hb_mc_manycore_transfer_release(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer)
+{
+        xfer->queue->live.erase(xfer);
+        delete xfer;
+}
+
+/* account for #n more words of a transfer and complete it if nothing is left */
+static void hb_mc_manycore_transfer_advance(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer, size_t n)
+{
+        xfer->completed += n;
+        if (xfer->completed < xfer->count)
+                return;
+
+        xfer->done = true;
+        if (xfer->callback != nullptr)
+                xfer->callback(mc, xfer, xfer->status, xfer->context);
+
+        if (xfer->detached)
+                hb_mc_manycore_transfer_release(mc, xfer);
+}
+
+/* stop issuing requests for a transfer; it completes once its outstanding loads return */
+static void hb_mc_manycore_transfer_fail(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer, int err)
+{
+        std::deque<hb_mc_transfer_t*> &pending = xfer->queue->pending;
+
+        if (xfer->status == HB_MC_SUCCESS)
+                xfer->status = err;
+
+        xfer->count = xfer->issued;
+        pending.erase(std::find(pending.begin(), pending.end(), xfer));
+        hb_mc_manycore_transfer_advance(mc, xfer, 0);
+}
+
+/* take up to #n free load ids for a queue; returns the number taken */
+static size_t hb_mc_manycore_async_take_ids(hb_mc_manycore_async_t *async,
+                                            hb_mc_manycore_queue_t *q,
+                                            uint32_t *ids, size_t n)
+{
+        std::lock_guard<std::mutex> guard(async->lock);
+
+        n = std::min(n, async->ids.size());
+        for (size_t j = 0; j < n; j++) {
+                ids[j] = async->ids.back();
+                async->ids.pop_back();
+                async->id_to_queue[ids[j]] = q;
+        }
+
+        return n;
+}
+
+/* return load ids to the free pool */
+static void hb_mc_manycore_async_give_ids(hb_mc_manycore_async_t *async,
+                                          const uint32_t *ids, size_t n)
+{
+        std::lock_guard<std::mutex> guard(async->lock);
+
+        for (size_t j = 0; j < n; j++) {
+                async->id_to_queue[ids[j]] = nullptr;
+                async->ids.push_back(ids[j]);
+        }
+}
 
-                        // get an available load id for this load request
-                        uint32_t rqst_load_id = ids.top();
-
-                        // save which request this is
-                        id_to_rsp_i[rqst_load_id] = rqst_i;
-                        id_to_npa[rqst_load_id] = rqst_addr;
-
-                        // send a load request
-                        err = hb_mc_manycore_send_read_rqst(mc, &rqst_addr, sizeof(UINT),
-                                                            rqst_load_id);
-                        if (err == HB_MC_SUCCESS) {
-                                // success; increment succesful requests and pop the load id
-                                rqst_i++;
-                                ids.pop();
-                        } else if (err == HB_MC_BUSY) {
-                                // if we're busy, break to start reading requests
+/**
+ * Send requests for a queue's pending transfers in submission order. Loads are sent
+ * as long as load ids are available. At most one burst of stores is sent per call.
+ * Requests that cannot be sent before the timeout stay pending.
+ * @param[in] mc       A manycore instance
+ * @param[in] q        The calling thread's queue
+ * @param[in] timeout  Microseconds to wait for credits and the tx FIFO, or -1 to wait forever
+ * @return HB_MC_SUCCESS on success, HB_MC_TIMEOUT if requests are still pending after the timeout.
+ *         Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_async_issue(hb_mc_manycore_t *mc, hb_mc_manycore_queue_t *q, long timeout)
+{
+        hb_mc_manycore_async_t *async = hb_mc_manycore_get_async(mc);
+        hb_mc_packet_t rqsts[HB_MC_MANYCORE_TX_BATCH_PACKETS];
+        uint32_t ids[HB_MC_MANYCORE_TX_BATCH_PACKETS];
+        bool stores_sent = false;
+        int err;
+
+        while (!q->pending.empty()) {
+                hb_mc_transfer_t *xfer = q->pending.front();
+                size_t batch = std::min(xfer->count - xfer->issued,
+                                        (size_t)HB_MC_MANYCORE_TX_BATCH_PACKETS);
+
+                if (xfer->is_read) {
+                        /* every load needs a load id */
+                        batch = hb_mc_manycore_async_take_ids(async, q, ids, batch);
+                        if (batch == 0) {
+                                hb_mc_manycore_count(mc, load_id_stalls, 1);
                                 break;
+                        }
+                } else if (stores_sent) {
+                        break;
+                }
+
+                /* format a batch of requests */
+                for (size_t j = 0; j < batch; j++) {
+                        size_t i = xfer->word_index(xfer->issued + j);
+                        hb_mc_npa_t npa;
+
+                        err = xfer->next_npa(mc, i, &npa);
+                        if (err != HB_MC_SUCCESS) {
+                                manycore_pr_err(mc, "%s: Failed to get the NPA of word %zu: %s\n",
+                                                __func__, i, hb_mc_strerror(err));
+                                if (xfer->is_read)
+                                        hb_mc_manycore_async_give_ids(async, ids, batch);
+
+                                hb_mc_manycore_transfer_fail(mc, xfer, err);
+                                return err;
+                        }
+
+                        if (xfer->is_read) {
+                                err = hb_mc_manycore_format_read_request_packet(mc, &rqsts[j], &npa,
+                                                                                xfer->sz, ids[j]);
+                        } else if (j > 0 && xfer->repeats_payload(i)) {
+                                /* same payload as the previous request; only the destination changes */
+                                rqsts[j] = rqsts[j-1];
+                                hb_mc_request_packet_set_x_dst(&rqsts[j].request, hb_mc_npa_get_x(&npa));
+                                hb_mc_request_packet_set_y_dst(&rqsts[j].request, hb_mc_npa_get_y(&npa));
+                                hb_mc_request_packet_set_addr(&rqsts[j].request, hb_mc_npa_get_epa(&npa) >> 2);
+                                err = HB_MC_SUCCESS;
                         } else {
-                                // we've hit some other error: abort with an error message
-                                manycore_pr_err(mc, "%s: Failed to send read request: %s\n",
+                                uint32_t data = xfer->word(i);
+                                err = hb_mc_manycore_format_write_request_packet(mc, &rqsts[j], &npa,
+                                                                                 &data, xfer->sz);
+                        }
+
+                        if (err != HB_MC_SUCCESS) {
+                                manycore_pr_err(mc, "%s: Failed to format request packet: %s\n",
                                                 __func__, hb_mc_strerror(err));
+                                if (xfer->is_read)
+                                        hb_mc_manycore_async_give_ids(async, ids, batch);
+
+                                hb_mc_manycore_transfer_fail(mc, xfer, err);
                                 return err;
                         }
                 }
-                // get occupancy
-                err = hb_mc_manycore_rx_fifo_get_occupancy(mc, HB_MC_FIFO_RX_RSP,
-                                                           &occupancy);
+
+                /* transmit them in as few bursts as the FIFO allows */
+                size_t sent;
+                err = hb_mc_manycore_requests_tx_internal(mc, rqsts, batch, timeout, &sent);
+
+                /* only loads that never left the host give up their ids */
+                if (xfer->is_read && sent < batch)
+                        hb_mc_manycore_async_give_ids(async, &ids[sent], batch - sent);
+
+                if (xfer->is_read) {
+                        /* remember where each load's data goes */
+                        for (size_t j = 0; j < sent; j++) {
+                                async->id_to_xfer[ids[j]] = xfer;
+                                async->id_to_word[ids[j]] = xfer->word_index(xfer->issued + j);
+                        }
+
+                        q->outstanding += sent;
+                }
+
+                xfer->issued += sent;
+                bool issued_all = xfer->issued == xfer->count;
+                if (sent > 0)
+                        q->progress++;
+
+                /* keep requests in submission order */
+                if (issued_all)
+                        q->pending.pop_front();
+
+                /* stores are complete once they are sent */
+                if (!xfer->is_read && sent > 0) {
+                        stores_sent = true;
+                        hb_mc_manycore_count(mc, bytes_written, sent * xfer->sz);
+                        hb_mc_manycore_transfer_advance(mc, xfer, sent);
+                }
+
+                if (err == HB_MC_BUSY)
+                        break;
+
+                /* backpressure is not an error: the rest is sent by a later call */
+                if (err == HB_MC_TIMEOUT)
+                        return err;
+
                 if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to get occupancy: %s\n",
+                        manycore_pr_err(mc, "%s: Failed to send request packets: %s\n",
                                         __func__, hb_mc_strerror(err));
+                        /* the transfer completes once the loads already sent are answered */
+                        if (!issued_all)
+                                hb_mc_manycore_transfer_fail(mc, xfer, err);
                         return err;
                 }
 
-                /* read all available response packets */
-                while (occupancy-- > 0 && rsp_i < cnt) {
-                        /* read a response and write it back to the location marked by load_id */
-                        uint32_t read_data, load_id;
-                        err = hb_mc_manycore_recv_read_rsp(mc, &read_data, &load_id);
-                        if (err != HB_MC_SUCCESS) {
-                                manycore_pr_err(mc, "%s: Failed to receive read response: %s\n",
-                                                __func__, hb_mc_strerror(err));
-                                return err;
-                        }
+                if (!issued_all)
+                        break;
+        }
 
-                        manycore_pr_dbg(mc, "%s: Received response for load_id = %" PRIu32 "\n",
-                                        __func__, load_id);
+        return HB_MC_SUCCESS;
+}
 
-                        // this should never happen unless something is messed up in hardware
-                        if (load_id >= n_ids) {
-                                manycore_pr_err(mc, "%s: Bad load id = %" PRIu32 "\n",
-                                                __func__, load_id);
-                                return HB_MC_FAIL;
-                        }
+/**
+ * Pull every load response available from hardware and hand each one to the queue
+ * that owns its load id. Returns immediately if another thread is already doing so.
+ * @param[in] mc  A manycore instance
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_async_route(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        hb_mc_manycore_async_t *async = hb_mc_manycore_get_async(mc);
+        hb_mc_manycore_rx_ring_t *ring = hb_mc_manycore_get_rx_ring(mc, HB_MC_FIFO_RX_RSP);
+        hb_mc_packet_t rsps[HB_MC_MANYCORE_RX_RING_PACKETS];
+        uint32_t available;
+        int err;
+
+        std::unique_lock<std::mutex> rx(pdata->rx_lock[HB_MC_FIFO_RX_RSP], std::try_to_lock);
+        if (!rx.owns_lock())
+                return HB_MC_SUCCESS;
+
+        /* pull all available responses into the host-side ring and take them */
+        err = hb_mc_manycore_rx_ring_fill(mc, HB_MC_FIFO_RX_RSP, &available);
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to receive responses: %s\n",
+                                __func__, hb_mc_strerror(err));
+                return err;
+        }
+
+        for (uint32_t i = 0; i < available; i++)
+                hb_mc_manycore_rx_ring_pop(ring, &rsps[i]);
+
+        rx.unlock();
+
+        if (available == 0)
+                return HB_MC_SUCCESS;
+
+        /* update the outstanding requests; the responses are routed regardless */
+        err = hb_mc_manycore_release_host_requests(mc, available);
+
+        /* the responses are off the ring: route every good one before reporting a bad one */
+        std::lock_guard<std::mutex> guard(async->lock);
+        for (uint32_t i = 0; i < available; i++) {
+                uint32_t load_id = hb_mc_response_packet_get_load_id(&rsps[i].response);
+
+                // this should never happen unless something is messed up in hardware
+                if (load_id >= async->id_to_queue.size() || async->id_to_queue[load_id] == nullptr) {
+                        char rsp_str[128];
+                        hb_mc_response_packet_to_string(&rsps[i].response, rsp_str, sizeof(rsp_str));
+                        manycore_pr_err(mc, "%s: Dropping response with bad load id = %" PRIu32 ": %s\n",
+                                        __func__, load_id, rsp_str);
+                        err = HB_MC_FAIL;
+                        continue;
+                }
+
+                async->id_to_queue[load_id]->responses.push_back(rsps[i]);
+        }
+
+        return err;
+}
+
+/**
+ * Consume the load responses that have been routed to a queue.
+ * @param[in] mc  A manycore instance
+ * @param[in] q   The calling thread's queue
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_async_receive(hb_mc_manycore_t *mc, hb_mc_manycore_queue_t *q)
+{
+        hb_mc_manycore_async_t *async = hb_mc_manycore_get_async(mc);
+        int err;
+
+        /* nothing to do if no loads are outstanding */
+        if (q->outstanding == 0)
+                return HB_MC_SUCCESS;
+
+        /* consume what was routed even if a bad response was dropped */
+        err = hb_mc_manycore_async_route(mc);
+
+        q->consumed.clear();
+        {
+                std::lock_guard<std::mutex> guard(async->lock);
+                std::swap(q->consumed, q->responses);
+        }
 
-                        // write 'read_data' back to the correct location
-                        data[id_to_rsp_i[load_id]] = hb_mc_manycore_mask_load_data<UINT>(&id_to_npa[load_id], read_data);
+        q->freed.clear();
+        for (const hb_mc_packet_t &rsp : q->consumed) {
+                uint32_t load_id = hb_mc_response_packet_get_load_id(&rsp.response);
+                hb_mc_transfer_t *xfer = async->id_to_xfer[load_id];
 
-                        // increment succesful responses
-                        rsp_i++;
+                manycore_pr_dbg(mc, "%s: Received response for load_id = %" PRIu32 "\n",
+                                __func__, load_id);
 
-                        // push the load id onto the stack so we can use it again
-                        ids.push(load_id);
+                // write the load data back to the correct location, unless its transfer was abandoned
+                if (xfer->dst != nullptr)
+                        xfer->dst[async->id_to_word[load_id]] = hb_mc_response_packet_get_data(&rsp.response);
+                async->id_to_xfer[load_id] = nullptr;
+                q->freed.push_back(load_id);
+                q->outstanding--;
+                q->progress++;
 
+                hb_mc_manycore_count(mc, bytes_read, xfer->sz);
+                hb_mc_manycore_transfer_advance(mc, xfer, 1);
+        }
+
+        // free the load ids so they can be used again
+        hb_mc_manycore_async_give_ids(async, q->freed.data(), q->freed.size());
+        return err;
+}
+
+/* make progress on a queue's transfers, waiting at most #timeout on backpressure */
+static int hb_mc_manycore_queue_poll(hb_mc_manycore_t *mc, hb_mc_manycore_queue_t *q, long timeout)
+{
+        int err, rx_err;
+
+        err = hb_mc_manycore_async_issue(mc, q, timeout);
+        if (err != HB_MC_SUCCESS && err != HB_MC_TIMEOUT)
+                return err;
+
+        /* loads already sent are received even if the rest timed out */
+        rx_err = hb_mc_manycore_async_receive(mc, q);
+        return rx_err != HB_MC_SUCCESS ? rx_err : err;
+}
+
+static long hb_mc_manycore_get_transfer_timeout_internal(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_private_t *pdata = (hb_mc_manycore_private_t*)mc->private_data;
+        return pdata->transfer_timeout;
+}
 
+/* queue a transfer on the calling thread's queue and start it */
+static int hb_mc_manycore_transfer_submit(hb_mc_manycore_t *mc, const hb_mc_transfer_t *proto,
+                                          hb_mc_transfer_callback_t callback, void *context,
+                                          hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_queue_t *q = hb_mc_manycore_get_queue(mc);
+        hb_mc_transfer_t *t;
 
+        if (q == nullptr) {
+                manycore_pr_err(mc, "%s: Asynchronous transfers are not initialized\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
 
+        t = new hb_mc_transfer_t(*proto);
+        if (t->sz == 0)
+                t->sz = sizeof(uint32_t);
+        t->issued = 0;
+        t->completed = 0;
+        t->status = HB_MC_SUCCESS;
+        t->done = false;
+        t->detached = (xfer == nullptr);
+        t->queue = q;
+        t->callback = callback;
+        t->context = context;
+
+        q->live.insert(t);
+        if (xfer != nullptr)
+                *xfer = t;
+
+        if (t->count == 0) {
+                hb_mc_manycore_transfer_advance(mc, t, 0);
+                return HB_MC_SUCCESS;
+        }
+
+        q->pending.push_back(t);
+
+        /* errors are reported through the status of the failing transfer */
+        (void)hb_mc_manycore_queue_poll(mc, q, hb_mc_manycore_get_transfer_timeout_internal(mc));
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Start reading memory from manycore hardware starting at a given NPA
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa      A valid hb_mc_npa_t
+ * @param[out] data     A buffer into which data will be read
+ * @param[in]  sz       The number of bytes to read from manycore hardware
+ * @param[in]  callback Called on completion. May be NULL.
+ * @param[in]  context  Passed to #callback
+ * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                      If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_read_mem_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                  void *data, size_t sz,
+                                  hb_mc_transfer_callback_t callback, void *context,
+                                  hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = true;
+        proto.base = *npa;
+        proto.dst = static_cast<uint32_t*>(data);
+        proto.count = sz >> 2;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Start reading memory from a vector of NPAs
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa      A vector of valid hb_mc_npa_t of length <= #words
+ * @param[out] data     A word vector into which data will be read
+ * @param[in]  words    The number of words to read from manycore hardware
+ * @param[in]  callback Called on completion. May be NULL.
+ * @param[in]  context  Passed to #callback
+ * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                      If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_read_mem_scatter_gather_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                                 uint32_t *data, size_t words,
+                                                 hb_mc_transfer_callback_t callback, void *context,
+                                                 hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+
+        proto.is_read = true;
+        proto.npas = npa;
+        proto.dst = data;
+        proto.count = words;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Start reading memory from a sequence of NPA segments produced by #next.
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  next     Produces the NPA segments to read, in order
+ * @param[in]  stream   Passed to #next; must stay valid until the transfer completes
+ * @param[out] data     A buffer into which data will be read
+ * @param[in]  sz       The number of bytes to read from manycore hardware
+ * @param[in]  callback Called on completion. May be NULL.
+ * @param[in]  context  Passed to #callback
+ * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                      If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_read_mem_stream_async(hb_mc_manycore_t *mc,
+                                         hb_mc_npa_stream_next_t next, void *stream,
+                                         void *data, size_t sz,
+                                         hb_mc_transfer_callback_t callback, void *context,
+                                         hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = true;
+        proto.next = next;
+        proto.stream = stream;
+        proto.dst = static_cast<uint32_t*>(data);
+        proto.count = sz >> 2;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Start reading memory with requests sent in an interleaved order.
+ * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  lookup_fn  Looks up the NPA of each word
+ * @param[in]  lookup     Passed to #lookup_fn; must stay valid until the transfer completes
+ * @param[in]  order      The request order
+ * @param[out] data       A buffer into which data will be read
+ * @param[in]  sz         The number of bytes to read from manycore hardware
+ * @param[in]  callback   Called on completion. May be NULL.
+ * @param[in]  context    Passed to #callback
+ * @param[out] xfer       Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                        If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_read_mem_interleaved_async(hb_mc_manycore_t *mc,
+                                              hb_mc_npa_lookup_t lookup_fn, void *lookup,
+                                              const hb_mc_transfer_interleave_t *order,
+                                              void *data, size_t sz,
+                                              hb_mc_transfer_callback_t callback, void *context,
+                                              hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = true;
+        proto.lookup = lookup_fn;
+        proto.stream = lookup;
+        proto.order = *order;
+        proto.dst = static_cast<uint32_t*>(data);
+        proto.count = sz >> 2;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Start writing memory with requests sent in an interleaved order.
+ * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  lookup_fn  Looks up the NPA of each word
+ * @param[in]  lookup     Passed to #lookup_fn; must stay valid until the transfer completes
+ * @param[in]  order      The request order
+ * @param[in]  data       A buffer to be written out manycore hardware
+ * @param[in]  sz         The number of bytes to write to manycore hardware
+ * @param[in]  callback   Called on completion. May be NULL.
+ * @param[in]  context    Passed to #callback
+ * @param[out] xfer       Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                        If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_write_mem_interleaved_async(hb_mc_manycore_t *mc,
+                                               hb_mc_npa_lookup_t lookup_fn, void *lookup,
+                                               const hb_mc_transfer_interleave_t *order,
+                                               const void *data, size_t sz,
+                                               hb_mc_transfer_callback_t callback, void *context,
+                                               hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = false;
+        proto.lookup = lookup_fn;
+        proto.stream = lookup;
+        proto.order = *order;
+        proto.src = static_cast<const uint32_t*>(data);
+        proto.count = sz >> 2;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Start writing memory out to manycore hardware starting at a given NPA
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa      A valid hb_mc_npa_t
+ * @param[in]  data     A buffer to be written out manycore hardware
+ * @param[in]  sz       The number of bytes to write to manycore hardware
+ * @param[in]  callback Called on completion. May be NULL.
+ * @param[in]  context  Passed to #callback
+ * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                      If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_write_mem_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                   const void *data, size_t sz,
+                                   hb_mc_transfer_callback_t callback, void *context,
+                                   hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = false;
+        proto.base = *npa;
+        proto.src = static_cast<const uint32_t*>(data);
+        proto.count = sz >> 2;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/* checks that the targets of a fan-out transfer are valid word-aligned destinations */
+static int hb_mc_manycore_fanout_check_targets(hb_mc_manycore_t *mc, const char *caller_name,
+                                               const hb_mc_npa_t *targets, size_t ntargets)
+{
+        if (targets == nullptr || ntargets == 0) {
+                manycore_pr_err(mc, "%s: No fan-out targets\n", caller_name);
+                return HB_MC_INVALID;
+        }
+
+        for (size_t t = 0; t < ntargets; t++) {
+                if (!hb_mc_manycore_dst_npa_is_valid(mc, &targets[t]))
+                        return HB_MC_INVALID;
+
+                if (hb_mc_npa_get_epa(&targets[t]) & 0x3) {
+                        manycore_pr_err(mc, "%s: Target %zu is not word aligned\n",
+                                        caller_name, t);
+                        return HB_MC_UNALIGNED;
                 }
         }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Start writing the same data to several NPAs.
+ * Requests go round-robin across the targets one word at a time.
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  targets  The NPAs to write #data to; must stay valid until the transfer completes
+ * @param[in]  ntargets The number of NPAs in #targets
+ * @param[in]  data     A buffer to be written out manycore hardware
+ * @param[in]  sz       The number of bytes to write to each target
+ * @param[in]  callback Called on completion. May be NULL.
+ * @param[in]  context  Passed to #callback
+ * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                      If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_write_mem_fanout_async(hb_mc_manycore_t *mc,
+                                          const hb_mc_npa_t *targets, size_t ntargets,
+                                          const void *data, size_t sz,
+                                          hb_mc_transfer_callback_t callback, void *context,
+                                          hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = hb_mc_manycore_fanout_check_targets(mc, __func__, targets, ntargets);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = false;
+        proto.targets = targets;
+        proto.ntargets = ntargets;
+        proto.src = static_cast<const uint32_t*>(data);
+        proto.count = (sz >> 2) * ntargets;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Start setting memory at several NPAs to a given value.
+ * Requests go round-robin across the targets one word at a time.
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  targets  The NPAs to set; must stay valid until the transfer completes
+ * @param[in]  ntargets The number of NPAs in #targets
+ * @param[in]  val      Value to be written out
+ * @param[in]  sz       The number of bytes to set at each target
+ * @param[in]  callback Called on completion. May be NULL.
+ * @param[in]  context  Passed to #callback
+ * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                      If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_memset_fanout_async(hb_mc_manycore_t *mc,
+                                       const hb_mc_npa_t *targets, size_t ntargets,
+                                       uint8_t val, size_t sz,
+                                       hb_mc_transfer_callback_t callback, void *context,
+                                       hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, NULL, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = hb_mc_manycore_fanout_check_targets(mc, __func__, targets, ntargets);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = false;
+        proto.targets = targets;
+        proto.ntargets = ntargets;
+        proto.src = nullptr;
+        proto.fill = (val << 24) | (val << 16) | (val << 8) | val;
+        proto.count = (sz >> 2) * ntargets;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Start setting memory to a given value starting at a given NPA
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa      A valid hb_mc_npa_t
+ * @param[in]  val      Value to be written out
+ * @param[in]  sz       The number of bytes to write to manycore hardware
+ * @param[in]  callback Called on completion. May be NULL.
+ * @param[in]  context  Passed to #callback
+ * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+ *                      If NULL, the transfer is released when it completes.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_memset_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                uint8_t val, size_t sz,
+                                hb_mc_transfer_callback_t callback, void *context,
+                                hb_mc_transfer_t **xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_SUBMIT);
+        hb_mc_transfer_t proto = {};
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, NULL, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        proto.is_read = false;
+        proto.base = *npa;
+        proto.src = nullptr;
+        proto.fill = (val << 24) | (val << 16) | (val << 8) | val;
+        proto.count = sz >> 2;
+
+        return hb_mc_manycore_transfer_submit(mc, &proto, callback, context, xfer);
+}
+
+/**
+ * Make progress on the calling thread's outstanding transfers without waiting for any of them.
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_transfer_poll(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_POLL);
+        hb_mc_manycore_queue_t *q = hb_mc_manycore_get_queue(mc);
+        int err;
+
+        if (q == nullptr)
+                return HB_MC_UNINITIALIZED;
+
+        /* requests held back by backpressure are still pending, which is not an error */
+        err = hb_mc_manycore_queue_poll(mc, q, hb_mc_manycore_get_transfer_timeout_internal(mc));
+        return err == HB_MC_TIMEOUT ? HB_MC_SUCCESS : err;
+}
+
+/* check if a transfer has completed, waiting at most #timeout on backpressure */
+static int hb_mc_manycore_transfer_test_internal(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer, long timeout)
+{
+        int err;
+
+        if (!xfer->done) {
+                err = hb_mc_manycore_queue_poll(mc, xfer->queue, timeout);
+                if (err != HB_MC_SUCCESS && !xfer->done)
+                        return err;
+        }
+
+        return xfer->done ? xfer->status : HB_MC_BUSY;
+}
+
+/**
+ * Make progress on outstanding transfers and check if a transfer has completed.
+ * The transfer is not released.
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  xfer   A transfer handle returned by a submit function on this thread
+ * @return HB_MC_BUSY if the transfer is in flight. Otherwise the status of the transfer.
+ */
+int hb_mc_manycore_transfer_test(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_POLL);
+        int err;
+
+        /* requests held back by backpressure are still pending, which is not an error */
+        err = hb_mc_manycore_transfer_test_internal(mc, xfer, hb_mc_manycore_get_transfer_timeout_internal(mc));
+        return err == HB_MC_TIMEOUT ? HB_MC_BUSY : err;
+}
+
+/* wait for a transfer to complete without releasing it */
+static int hb_mc_manycore_transfer_await(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer, long timeout)
+{
+        hb_mc_manycore_queue_t *q = xfer->queue;
+        hb_mc_manycore_waiter_t w;
+        uint64_t progress;
+        int err;
+
+        hb_mc_manycore_waiter_init(mc, &w, timeout);
+
+        for (;;) {
+                progress = q->progress;
+                err = hb_mc_manycore_transfer_test_internal(mc, xfer, hb_mc_manycore_waiter_remaining(&w));
+                if (err != HB_MC_BUSY)
+                        return err;
+
+                /* back off only while the hardware has nothing for us */
+                if (q->progress != progress)
+                        hb_mc_manycore_waiter_reset(&w);
+                else if ((err = hb_mc_manycore_waiter_backoff(&w)) != HB_MC_SUCCESS)
+                        return err;
+        }
+}
+
+/*
+ * give up on a transfer that did not complete: its unsent requests are dropped, its
+ * late load responses are discarded, and it is released once they arrive
+ */
+static void hb_mc_manycore_transfer_abandon(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer, int err)
+{
+        xfer->dst = nullptr;
+        xfer->callback = nullptr;
+        xfer->detached = true;
+
+        if (xfer->issued < xfer->count)
+                hb_mc_manycore_transfer_fail(mc, xfer, err);
+}
+
+/**
+ * Wait for a transfer to complete and release it.
+ * The wait is bounded by hb_mc_manycore_set_transfer_timeout(). A transfer that
+ * does not complete is abandoned: it is released, and no more of its data is read or written.
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  xfer   A transfer handle returned by a submit function on this thread
+ * @return The status of the transfer, HB_MC_TIMEOUT, or an error code if progress could not be made.
+ */
+int hb_mc_manycore_transfer_wait(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_WAIT);
+        int err;
+
+        err = hb_mc_manycore_transfer_await(mc, xfer, hb_mc_manycore_get_transfer_timeout_internal(mc));
+        if (xfer->done)
+                hb_mc_manycore_transfer_release(mc, xfer);
+        else
+                hb_mc_manycore_transfer_abandon(mc, xfer, err);
+
+        return err;
+}
+
+/**
+ * Wait a bounded time for a transfer to complete and release it.
+ * The transfer is not released if the wait times out.
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  xfer     A transfer handle returned by a submit function on this thread
+ * @param[in]  timeout  Microseconds without progress before giving up, or -1 to wait forever
+ * @return The status of the transfer, HB_MC_TIMEOUT, or an error code if progress could not be made.
+ */
+int hb_mc_manycore_transfer_wait_timeout(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer, long timeout)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_WAIT);
+        int err;
+
+        if ((err = hb_mc_manycore_check_timeout(mc, __func__, timeout)) != HB_MC_SUCCESS)
+                return err;
+
+        err = hb_mc_manycore_transfer_await(mc, xfer, timeout);
+        if (xfer->done)
+                hb_mc_manycore_transfer_release(mc, xfer);
+
+        return err;
+}
+
+/**
+ * Wait for every transfer submitted by the calling thread to complete.
+ * Handles returned by submit functions must still be released with hb_mc_manycore_transfer_wait().
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_transfer_wait_all(hb_mc_manycore_t *mc)
+{
+        return hb_mc_manycore_transfer_wait_all_timeout(mc, -1);
+}
+
+/**
+ * Wait a bounded time for every transfer submitted by the calling thread to complete.
+ * Handles returned by submit functions must still be released with hb_mc_manycore_transfer_wait().
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  timeout  Microseconds without progress before giving up, or -1 to wait forever
+ * @return HB_MC_SUCCESS on success, HB_MC_TIMEOUT if transfers are still in flight
+ *         after the timeout. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_transfer_wait_all_timeout(hb_mc_manycore_t *mc, long timeout)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_TRANSFER_WAIT);
+        hb_mc_manycore_queue_t *q;
+        hb_mc_manycore_waiter_t w;
+        uint64_t progress;
+        int err;
+
+        if ((err = hb_mc_manycore_check_timeout(mc, __func__, timeout)) != HB_MC_SUCCESS)
+                return err;
+
+        q = hb_mc_manycore_get_queue(mc);
+        if (q == nullptr)
+                return HB_MC_SUCCESS;
+
+        hb_mc_manycore_waiter_init(mc, &w, timeout);
+
+        while (!q->pending.empty() || q->outstanding != 0) {
+                progress = q->progress;
+                err = hb_mc_manycore_queue_poll(mc, q, hb_mc_manycore_waiter_remaining(&w));
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                /* back off only while the hardware has nothing for us */
+                if (q->progress != progress)
+                        hb_mc_manycore_waiter_reset(&w);
+                else if ((err = hb_mc_manycore_waiter_backoff(&w)) != HB_MC_SUCCESS)
+                        return err;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* read from a memory address on the manycore */
+template <typename UINT>
+static int hb_mc_manycore_read(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, UINT *vp)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_READ);
+        hb_mc_transfer_t proto = {}, *xfer;
+        uint32_t load_data;
+        int err;
+
+        /* a single-request transfer, so the response is routed back to this thread */
+        proto.is_read = true;
+        proto.base = *npa;
+        proto.dst = &load_data;
+        proto.sz = sizeof(UINT);
+        proto.count = 1;
+
+        err = hb_mc_manycore_transfer_submit(mc, &proto, nullptr, nullptr, &xfer);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
+
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* mask off unused bits */
+        *vp = hb_mc_manycore_mask_load_data<UINT>(npa, load_data);
+        return HB_MC_SUCCESS;
+}
+
+/* write to a memory address on the manycore */
+static int hb_mc_manycore_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, const void *vp, size_t sz)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_WRITE);
+        hb_mc_transfer_t proto = {}, *xfer;
+        uint32_t data = 0;
+        int err;
+
+        if (sz != 1 && sz != 2 && sz != 4)
+                return HB_MC_INVALID;
+
+        memcpy(&data, vp, sz);
+
+        manycore_pr_dbg(mc, "Sending %zu-byte write request to NPA "
+                        "(x: %d, y: %d, 0x%08x) (data = 0x%08" PRIx32 ")\n",
+                        sz,
+                        hb_mc_npa_get_x(npa),
+                        hb_mc_npa_get_y(npa),
+                        hb_mc_npa_get_epa(npa),
+                        data);
+
+        /* a single-request transfer, so it stays ordered with this thread's other stores */
+        proto.is_read = false;
+        proto.base = *npa;
+        proto.src = &data;
+        proto.sz = sz;
+        proto.count = 1;
+
+        err = hb_mc_manycore_transfer_submit(mc, &proto, nullptr, nullptr, &xfer);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
+
+        return err;
+}
+
+/**
+ * Write memory out to manycore hardware starting at a given NPA
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t
+ * @param[in]  data   A buffer to be written out manycore hardware
+ * @param[in]  sz     The number of bytes to write to manycore hardware
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_write_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                             const void *data, size_t sz)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_WRITE_MEM);
+        hb_mc_transfer_t *xfer;
+        int err;
+
+        // This pair of matching function calls changes the clock period of the
+        // manycore during data transfer to accelerate simulation
+#ifdef COSIM
+        sv_set_virtual_dip_switch(0, 1);
+#endif
+
+        err = hb_mc_manycore_write_mem_async(mc, npa, data, sz, nullptr, nullptr, &xfer);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
+
+#ifdef COSIM
+        sv_set_virtual_dip_switch(0, 0);
+#endif
+
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to send write requests: %s\n",
+                                __func__, hb_mc_strerror(err));
+                return err;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Set memory to a given value starting at a given NPA
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t
+ * @param[in]  val    Value to be written out
+ * @param[in]  sz     The number of bytes to write to manycore hardware
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_memset(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                          uint8_t val, size_t sz)
+{
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_MEMSET);
+        hb_mc_transfer_t *xfer;
+        int err;
+
+#ifdef COSIM
+        sv_set_virtual_dip_switch(0, 1);
+#endif
+
+        err = hb_mc_manycore_memset_async(mc, npa, val, sz, nullptr, nullptr, &xfer);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
+
 #ifdef COSIM
         sv_set_virtual_dip_switch(0, 0);
 #endif
 
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to send write requests: %s\n",
+                                __func__, hb_mc_strerror(err));
+                return err;
+        }
+
         return HB_MC_SUCCESS;
 }
 
@@ -1730,14 +3777,30 @@ static int hb_mc_manycore_read_mem_internal(hb_mc_manycore_t *mc,
 int hb_mc_manycore_read_mem_scatter_gather(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                                            uint32_t *data, size_t words)
 {
-        /* ith NPA => npa[i] */
-        struct npa_function {
-                const hb_mc_npa_t *npa;
-                npa_function(const hb_mc_npa_t *npa) : npa(npa) {}
-                hb_mc_npa_t operator()(size_t i) { return npa[i]; }
-        };
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_READ_MEM_SCATTER_GATHER);
+        hb_mc_transfer_t *xfer;
+        int err;
+
+#ifdef COSIM
+        sv_set_virtual_dip_switch(0, 1);
+#endif
+
+        err = hb_mc_manycore_read_mem_scatter_gather_async(mc, npa, data, words,
+                                                           nullptr, nullptr, &xfer);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
+
+#ifdef COSIM
+        sv_set_virtual_dip_switch(0, 0);
+#endif
+
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to read memory: %s\n",
+                                __func__, hb_mc_strerror(err));
+                return err;
+        }
 
-        return hb_mc_manycore_read_mem_internal<uint32_t>(mc, npa_function(npa), data, words);
+        return HB_MC_SUCCESS;
 }
 
 /**
@@ -1751,28 +3814,29 @@ int hb_mc_manycore_read_mem_scatter_gather(hb_mc_manycore_t *mc, const hb_mc_npa
 int hb_mc_manycore_read_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                             void *data, size_t sz)
 {
+        hb_mc_manycore_api_timer timer(mc, HB_MC_MANYCORE_API_READ_MEM);
+        hb_mc_transfer_t *xfer;
         int err;
 
-        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
-        if (err != HB_MC_SUCCESS)
-                return err;
+#ifdef COSIM
+        sv_set_virtual_dip_switch(0, 1);
+#endif
 
-        uint32_t *words = static_cast<uint32_t*>(data);
-        size_t n_words = sz >> 2;
-
-        /* ith NPA => first NPA + i words */
-        struct npa_function {
-                const hb_mc_npa_t *npa;
-                npa_function(const hb_mc_npa_t *npa) : npa(npa) {}
-                hb_mc_npa_t operator()(size_t i) {
-                        return hb_mc_npa_from_x_y(hb_mc_npa_get_x(npa),
-                                                  hb_mc_npa_get_y(npa),
-                                                  hb_mc_npa_get_epa(npa) +
-                                                  i*sizeof(uint32_t));
-                }
-        };
+        err = hb_mc_manycore_read_mem_async(mc, npa, data, sz, nullptr, nullptr, &xfer);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
 
-        return hb_mc_manycore_read_mem_internal<uint32_t>(mc, npa_function(npa), words, n_words);
+#ifdef COSIM
+        sv_set_virtual_dip_switch(0, 0);
+#endif
+
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to read memory: %s\n",
+                                __func__, hb_mc_strerror(err));
+                return err;
+        }
+
+        return HB_MC_SUCCESS;
 }
 
 /**
@@ -54,6 +54,36 @@ extern "C" {
         typedef int hb_mc_manycore_id_t;
 #define HB_MC_MANYCORE_ID_ANY -1
 
+        /**
+         * Constants of the default EVA map's DRAM translation, derived from
+         * the configuration once by hb_mc_manycore_init() so that
+         * translating a DRAM EVA takes only shifts and masks.
+         * See default_eva_dram_desc_init() in bsg_manycore_eva.h.
+         */
+        typedef struct hb_mc_dram_eva_desc {
+                int         valid;            //!< set once the fields below are filled in
+                uint32_t    stripe_log;       //!< log2 of the DRAM stripe size in bytes
+                uint32_t    stripe_mask;      //!< EVA bits of the offset within a stripe
+                uint32_t    x_dimlog;         //!< width of the X coordinate field
+                uint32_t    x_mask;           //!< X coordinate field, once shifted down by stripe_log
+                uint32_t    x_max;            //!< largest X coordinate accepted
+                uint32_t    epa_top_shift;    //!< position of the upper EPA bits in an EVA
+                hb_mc_idx_t y;                //!< Y coordinate of the DRAM banks
+                uint32_t    addrbits[2];      //!< width of a DRAM EPA, indexed by dram_enabled
+                uint64_t    max_size[2];      //!< 1 << addrbits[]
+        } hb_mc_dram_eva_desc_t;
+
+        typedef struct hb_mc_eva_tlb hb_mc_eva_tlb_t;
+
+        /*
+          Once initialized, a manycore may be used from several host threads
+          at once. Memory reads, writes, and asynchronous transfers issued by
+          different threads are interleaved on the network; each thread's own
+          operations keep their submission order. hb_mc_manycore_init() and
+          hb_mc_manycore_exit() must not race with any other call, and the
+          raw packet receive API (hb_mc_manycore_response_rx()) must not be
+          mixed with memory operations running on other threads.
+        */
         typedef struct hb_mc_manycore {
                 hb_mc_manycore_id_t id; //!< which manycore instance is this
                 const char    *name;     //!< the name of this manycore
@@ -62,6 +92,9 @@ extern "C" {
                 void    *private_data;   //!< implementation private data
                 unsigned htod_requests;  //!< outstanding host requests
                 int dram_enabled;        //!< operating in no-dram mode?
+                hb_mc_dram_eva_desc_t dram_eva; //!< cached DRAM EVA translation constants
+                int dram_interleave;     //!< spread DRAM EVA transfers across channels?
+                hb_mc_eva_tlb_t *eva_tlb; //!< software TLB in front of EVA maps, or NULL
         } hb_mc_manycore_t;
 
 #define HB_MC_MANYCORE_INIT {0}
@@ -94,15 +127,209 @@ extern "C" {
         __attribute__((warn_unused_result))
         int hb_mc_manycore_exit(hb_mc_manycore_t *mc);
 
+        /**
+         * Get the number of manycores present on this host.
+         * Valid IDs for hb_mc_manycore_init() are 0 to the count, exclusive.
+         * @param[out] count  Set to the number of manycores.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_get_device_count(int *count);
+
+        /////////////////
+        // Backoff API //
+        /////////////////
+
+        /*
+          Every loop that polls the hardware (waiting for a packet, for
+          TX-Complete, for host credits, or for a transfer) follows a
+          backoff policy after each poll that finds nothing: it busy-spins
+          for spin_iterations polls, then calls sched_yield() for
+          yield_iterations polls, then sleeps, doubling the sleep from
+          sleep_min_us up to sleep_max_us.
+
+          Timeouts passed to the packet API are in microseconds; -1 waits
+          forever and 0 polls once.
+        */
+
+#define HB_MC_BACKOFF_DEFAULT_SPIN_ITERATIONS  1000
+#define HB_MC_BACKOFF_DEFAULT_YIELD_ITERATIONS 1000
+#define HB_MC_BACKOFF_DEFAULT_SLEEP_MIN_US     1
+#define HB_MC_BACKOFF_DEFAULT_SLEEP_MAX_US     1000
+
+        typedef struct hb_mc_backoff_policy {
+                unsigned long spin_iterations;  //!< polls to busy-spin before yielding
+                unsigned long yield_iterations; //!< polls to yield the CPU before sleeping
+                unsigned long sleep_min_us;     //!< first sleep in microseconds
+                unsigned long sleep_max_us;     //!< longest sleep in microseconds
+        } hb_mc_backoff_policy_t;
+
+        typedef enum hb_mc_backoff_phase {
+                HB_MC_BACKOFF_SPIN  = 0,
+                HB_MC_BACKOFF_YIELD = 1,
+                HB_MC_BACKOFF_SLEEP = 2,
+                HB_MC_BACKOFF_PHASES,
+        } hb_mc_backoff_phase_t;
+
+        typedef struct hb_mc_backoff_stats {
+                uint64_t polls[HB_MC_BACKOFF_PHASES]; //!< unsuccessful polls in each phase
+                uint64_t ns[HB_MC_BACKOFF_PHASES];    //!< nanoseconds spent waiting in each phase
+                uint64_t timeouts;                    //!< waits that timed out
+        } hb_mc_backoff_stats_t;
+
+        /**
+         * Set the policy used by a manycore instance's polling loops
+         * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in] policy  A backoff policy. sleep_min_us must be non-zero and <= sleep_max_us.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_set_backoff_policy(hb_mc_manycore_t *mc, const hb_mc_backoff_policy_t *policy);
+
+        /**
+         * Get the policy used by a manycore instance's polling loops
+         * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+         * @param[out] policy  Set to the current backoff policy
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_get_backoff_policy(hb_mc_manycore_t *mc, hb_mc_backoff_policy_t *policy);
+
+        /**
+         * Get how much polling a manycore instance has done in each backoff phase
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[out] stats  Set to the statistics accumulated since init or the last reset
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_get_backoff_stats(hb_mc_manycore_t *mc, hb_mc_backoff_stats_t *stats);
+
+        /**
+         * Reset a manycore instance's backoff statistics
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_reset_backoff_stats(hb_mc_manycore_t *mc);
+
+        /**
+         * Bound how long a manycore instance's blocking transfers may wait on hardware.
+         * This covers the blocking memory API, hb_mc_manycore_transfer_wait(), and
+         * sending the requests of a newly submitted or polled transfer.
+         * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in] timeout  Microseconds, or -1 (the default) to wait forever
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_set_transfer_timeout(hb_mc_manycore_t *mc, long timeout);
+
+        /**
+         * Get how long a manycore instance's blocking transfers may wait on hardware
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[out] timeout  Set to the timeout in microseconds, or -1 if transfers wait forever
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_get_transfer_timeout(hb_mc_manycore_t *mc, long *timeout);
+
+        ////////////////////
+        // Statistics API //
+        ////////////////////
+
+        /*
+          Each manycore instance counts what its hot paths do. The counters
+          are always on and cost an increment each. Wall time is charged to
+          the outermost public API call only, so a hb_mc_manycore_read_mem()
+          is not also charged as a hb_mc_manycore_transfer_wait(), and the
+          sum of api_ns is the time spent inside the runtime.
+        */
+
+        typedef enum hb_mc_manycore_api {
+                HB_MC_MANYCORE_API_REQUEST_TX = 0,
+                HB_MC_MANYCORE_API_REQUESTS_TX,
+                HB_MC_MANYCORE_API_REQUEST_RX,
+                HB_MC_MANYCORE_API_RESPONSE_TX,
+                HB_MC_MANYCORE_API_RESPONSE_RX,
+                HB_MC_MANYCORE_API_READ,                    //!< hb_mc_manycore_read8/16/32
+                HB_MC_MANYCORE_API_WRITE,                   //!< hb_mc_manycore_write8/16/32
+                HB_MC_MANYCORE_API_READ_MEM,
+                HB_MC_MANYCORE_API_READ_MEM_SCATTER_GATHER,
+                HB_MC_MANYCORE_API_WRITE_MEM,
+                HB_MC_MANYCORE_API_MEMSET,
+                HB_MC_MANYCORE_API_TRANSFER_SUBMIT,         //!< the *_async calls
+                HB_MC_MANYCORE_API_TRANSFER_POLL,           //!< hb_mc_manycore_transfer_poll/test
+                HB_MC_MANYCORE_API_TRANSFER_WAIT,           //!< hb_mc_manycore_transfer_wait/wait_all
+                HB_MC_MANYCORE_API_COUNT,
+        } hb_mc_manycore_api_t;
+
+        typedef struct hb_mc_manycore_stats {
+                uint64_t mmio_reads;                          //!< MMIO loads
+                uint64_t mmio_writes;                         //!< MMIO stores
+                uint64_t tx_packets[2];                       //!< packets sent, indexed by hb_mc_fifo_tx_t
+                uint64_t rx_packets[2];                       //!< packets received, indexed by hb_mc_fifo_rx_t
+                uint64_t bytes_read;                          //!< memory data read from the manycore
+                uint64_t bytes_written;                       //!< memory data written to the manycore
+                uint64_t tc_spins;                            //!< TX-Complete polls that found the burst still in flight
+                uint64_t occupancy_polls;                     //!< rx FIFO occupancy reads
+                uint64_t vacancy_polls;                       //!< tx FIFO vacancy reads
+                uint64_t load_id_stalls;                      //!< loads held back for lack of a load id (HB_MC_BUSY)
+                uint64_t api_calls[HB_MC_MANYCORE_API_COUNT]; //!< outermost calls to each public API
+                uint64_t api_ns[HB_MC_MANYCORE_API_COUNT];    //!< nanoseconds of wall time in each public API
+        } hb_mc_manycore_stats_t;
+
+        /**
+         * Get the name of a public API counted in hb_mc_manycore_stats_t
+         * @param[in] api  A public API
+         * @return A string naming #api
+         */
+        const char *hb_mc_manycore_api_to_string(hb_mc_manycore_api_t api);
+
+        /**
+         * Get a manycore instance's hot path counters
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[out] stats  Set to the counters accumulated since init or the last reset
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_get_stats(hb_mc_manycore_t *mc, hb_mc_manycore_stats_t *stats);
+
+        /**
+         * Reset a manycore instance's hot path counters
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_reset_stats(hb_mc_manycore_t *mc);
+
         ////////////////
         // Packet API //
         ////////////////
 
+        /*
+          How packets are written into a tx FIFO. HB_MC_TX_INJECTION_SCALAR
+          performs one checked MMIO store per word. HB_MC_TX_INJECTION_BURST
+          (the default) checks the FIFO data register once per burst and
+          then stores every word of the burst back to back.
+        */
+        typedef enum hb_mc_tx_injection {
+                HB_MC_TX_INJECTION_SCALAR = 0,
+                HB_MC_TX_INJECTION_BURST  = 1,
+        } hb_mc_tx_injection_t;
+
+        /**
+         * Select how a manycore instance writes packets into its tx FIFOs
+         * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in] mode  An injection mode
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_set_tx_injection(hb_mc_manycore_t *mc, hb_mc_tx_injection_t mode);
+
         /**
          * Transmit a request packet to manycore hardware
          * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
          * @param[in] request A request packet to transmit to manycore hardware
-         * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+         * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */
         __attribute__((warn_unused_result))
@@ -110,11 +337,28 @@ extern "C" {
                                       hb_mc_request_packet_t *request,
                                       long timeout);
 
+        /**
+         * Transmit a batch of request packets to manycore hardware.
+         * Packets are streamed into the FIFO in bursts with one TX-complete handshake per burst.
+         * Fails with HB_MC_BUSY, without transmitting, if the loads in the batch would
+         * exceed the number of outstanding requests allowed.
+         * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in] requests An array of packets, each holding a request, to transmit to manycore hardware
+         * @param[in] count    The number of packets in #requests
+         * @param[in] timeout  A timeout in microseconds. Set to -1 to wait forever.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_requests_tx(hb_mc_manycore_t *mc,
+                                       const hb_mc_packet_t *requests,
+                                       size_t count,
+                                       long timeout);
+
         /**
          * Receive a response packet from manycore hardware
          * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
          * @param[in] response A packet into which data should be read
-         * @param[in] timeout  A timeout counter. Unused - set to -1 to wait forever.
+         * @param[in] timeout  A timeout in microseconds. Set to -1 to wait forever.
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */
         __attribute__((warn_unused_result))
@@ -126,7 +370,7 @@ extern "C" {
          * Transmit a response packet to manycore hardware
          * @param[in] mc        A manycore instance initialized with hb_mc_manycore_init()
          * @param[in] response  A response packet to transmit to manycore hardware
-         * @param[in] timeout   A timeout counter. Unused - set to -1 to wait forever.
+         * @param[in] timeout   A timeout in microseconds. Set to -1 to wait forever.
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */
         __attribute__((warn_unused_result))
@@ -138,7 +382,7 @@ extern "C" {
          * Receive a request packet from manycore hardware
          * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
          * @param[in] request A packet into which data should be read
-         * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+         * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */
         __attribute__((warn_unused_result))
@@ -151,7 +395,7 @@ extern "C" {
          * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
          * @param[in] packet  A packet to transmit to manycore hardware
          * @param[in] type    Is this packet a request or response packet?
-         * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+         * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */
         __attribute__((warn_unused_result, deprecated))
@@ -165,7 +409,7 @@ extern "C" {
          * @param[in] mc     A manycore instance initialized with hb_mc_manycore_init()
          * @param[in] packet A packet into which data should be read
          * @param[in] type   Is this packet a request or response packet?
-         * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+         * @param[in] timeout A timeout in microseconds. Set to -1 to wait forever.
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */
         __attribute__((warn_unused_result, deprecated))
@@ -285,6 +529,322 @@ extern "C" {
         __attribute__((warn_unused_result))
         int hb_mc_manycore_read_mem_scatter_gather(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                                                    uint32_t *data, size_t words);
+
+        /***************************/
+        /* Asynchronous Memory API */
+        /***************************/
+
+        /*
+          Asynchronous transfers are queued on a manycore and make progress
+          whenever the application calls hb_mc_manycore_transfer_poll(),
+          hb_mc_manycore_transfer_test(), or one of the wait functions. Requests
+          are issued in submission order. Buffers passed to a submit function
+          must stay valid until the transfer completes.
+
+          Each host thread has its own transfer queue. Polling and the wait
+          functions only advance the calling thread's transfers, and a
+          transfer must be tested and waited on by the thread that submitted
+          it.
+
+          Errors encountered while a transfer is in flight are recorded as the
+          transfer's status. The status is passed to its callback and returned
+          by hb_mc_manycore_transfer_test() and hb_mc_manycore_transfer_wait().
+
+          Callbacks run from inside the progress engine. They may submit new
+          transfers, but they must not poll, test, or wait.
+        */
+
+        typedef struct hb_mc_transfer hb_mc_transfer_t;
+
+        /**
+         * Called when an asynchronous transfer completes.
+         * @param[in] mc       The manycore the transfer was submitted to
+         * @param[in] xfer     The completed transfer
+         * @param[in] status   HB_MC_SUCCESS, or the error that ended the transfer
+         * @param[in] context  The context pointer passed at submission
+         */
+        typedef void (*hb_mc_transfer_callback_t)(hb_mc_manycore_t *mc,
+                                                  hb_mc_transfer_t *xfer,
+                                                  int status,
+                                                  void *context);
+
+        /**
+         * Start reading memory from manycore hardware starting at a given NPA
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa      A valid hb_mc_npa_t
+         * @param[out] data     A buffer into which data will be read
+         * @param[in]  sz       The number of bytes to read from manycore hardware
+         * @param[in]  callback Called on completion. May be NULL.
+         * @param[in]  context  Passed to #callback
+         * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                      If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_read_mem_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                          void *data, size_t sz,
+                                          hb_mc_transfer_callback_t callback, void *context,
+                                          hb_mc_transfer_t **xfer);
+
+        /**
+         * Start reading memory from a vector of NPAs
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa      A vector of valid hb_mc_npa_t of length <= #words
+         * @param[out] data     A word vector into which data will be read
+         * @param[in]  words    The number of words to read from manycore hardware
+         * @param[in]  callback Called on completion. May be NULL.
+         * @param[in]  context  Passed to #callback
+         * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                      If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_read_mem_scatter_gather_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                                         uint32_t *data, size_t words,
+                                                         hb_mc_transfer_callback_t callback, void *context,
+                                                         hb_mc_transfer_t **xfer);
+
+        /**
+         * Produce the next contiguous NPA segment of a streaming transfer.
+         * Segments are requested in order, only as the transfer reaches them.
+         * @param[in]  mc      The manycore the transfer was submitted to
+         * @param[in]  stream  The stream pointer passed at submission
+         * @param[out] npa     Set to the NPA of the next segment
+         * @param[out] sz      Set to the number of contiguous bytes at #npa; rounded down to whole words
+         * @return HB_MC_SUCCESS on success. Otherwise an error code that becomes the transfer's status.
+         */
+        typedef int (*hb_mc_npa_stream_next_t)(hb_mc_manycore_t *mc, void *stream,
+                                               hb_mc_npa_t *npa, size_t *sz);
+
+        /**
+         * Start reading memory from a sequence of NPA segments produced by #next.
+         * Requests for later segments are sent while responses for earlier ones are outstanding.
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  next     Produces the NPA segments to read, in order
+         * @param[in]  stream   Passed to #next; must stay valid until the transfer completes
+         * @param[out] data     A buffer into which data will be read
+         * @param[in]  sz       The number of bytes to read from manycore hardware
+         * @param[in]  callback Called on completion. May be NULL.
+         * @param[in]  context  Passed to #callback
+         * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                      If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_read_mem_stream_async(hb_mc_manycore_t *mc,
+                                                 hb_mc_npa_stream_next_t next, void *stream,
+                                                 void *data, size_t sz,
+                                                 hb_mc_transfer_callback_t callback, void *context,
+                                                 hb_mc_transfer_t **xfer);
+
+        /**
+         * Look up the NPA of a word of an interleaved transfer.
+         * @param[in]  mc      The manycore the transfer was submitted to
+         * @param[in]  lookup  The lookup pointer passed at submission
+         * @param[in]  offset  Byte offset of the word from the start of the transfer
+         * @param[out] npa     Set to the NPA of the word
+         * @return HB_MC_SUCCESS on success. Otherwise an error code that becomes the transfer's status.
+         */
+        typedef int (*hb_mc_npa_lookup_t)(hb_mc_manycore_t *mc, void *lookup,
+                                          size_t offset, hb_mc_npa_t *npa);
+
+        /*
+          The request order of an interleaved transfer. After the first
+          #head_words words, which are sent in order, the transfer is split
+          into blocks of #lanes x #lane_words words. Within a block, the
+          requests go round-robin across the lanes one word at a time, so
+          consecutive requests target different lanes (e.g. DRAM channels).
+          Words after the last whole block are sent in order.
+        */
+        typedef struct hb_mc_transfer_interleave {
+                size_t head_words; //!< words sent in order before the first block
+                size_t lanes;      //!< lanes per block
+                size_t lane_words; //!< consecutive words in the same lane
+        } hb_mc_transfer_interleave_t;
+
+        /**
+         * Start reading memory with requests sent in an interleaved order.
+         * Data lands in #data in address order regardless of the request order.
+         * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  lookup_fn  Looks up the NPA of each word
+         * @param[in]  lookup     Passed to #lookup_fn; must stay valid until the transfer completes
+         * @param[in]  order      The request order
+         * @param[out] data       A buffer into which data will be read
+         * @param[in]  sz         The number of bytes to read from manycore hardware
+         * @param[in]  callback   Called on completion. May be NULL.
+         * @param[in]  context    Passed to #callback
+         * @param[out] xfer       Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                        If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_read_mem_interleaved_async(hb_mc_manycore_t *mc,
+                                                      hb_mc_npa_lookup_t lookup_fn, void *lookup,
+                                                      const hb_mc_transfer_interleave_t *order,
+                                                      void *data, size_t sz,
+                                                      hb_mc_transfer_callback_t callback, void *context,
+                                                      hb_mc_transfer_t **xfer);
+
+        /**
+         * Start writing memory with requests sent in an interleaved order.
+         * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  lookup_fn  Looks up the NPA of each word
+         * @param[in]  lookup     Passed to #lookup_fn; must stay valid until the transfer completes
+         * @param[in]  order      The request order
+         * @param[in]  data       A buffer to be written out manycore hardware
+         * @param[in]  sz         The number of bytes to write to manycore hardware
+         * @param[in]  callback   Called on completion. May be NULL.
+         * @param[in]  context    Passed to #callback
+         * @param[out] xfer       Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                        If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_write_mem_interleaved_async(hb_mc_manycore_t *mc,
+                                                       hb_mc_npa_lookup_t lookup_fn, void *lookup,
+                                                       const hb_mc_transfer_interleave_t *order,
+                                                       const void *data, size_t sz,
+                                                       hb_mc_transfer_callback_t callback, void *context,
+                                                       hb_mc_transfer_t **xfer);
+
+        /**
+         * Start writing memory out to manycore hardware starting at a given NPA
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa      A valid hb_mc_npa_t
+         * @param[in]  data     A buffer to be written out manycore hardware
+         * @param[in]  sz       The number of bytes to write to manycore hardware
+         * @param[in]  callback Called on completion. May be NULL.
+         * @param[in]  context  Passed to #callback
+         * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                      If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_write_mem_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                           const void *data, size_t sz,
+                                           hb_mc_transfer_callback_t callback, void *context,
+                                           hb_mc_transfer_t **xfer);
+
+        /**
+         * Start writing the same data to several NPAs.
+         * Requests go round-robin across the targets one word at a time.
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  targets  The NPAs to write #data to; must stay valid until the transfer completes
+         * @param[in]  ntargets The number of NPAs in #targets
+         * @param[in]  data     A buffer to be written out manycore hardware
+         * @param[in]  sz       The number of bytes to write to each target
+         * @param[in]  callback Called on completion. May be NULL.
+         * @param[in]  context  Passed to #callback
+         * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                      If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_write_mem_fanout_async(hb_mc_manycore_t *mc,
+                                                  const hb_mc_npa_t *targets, size_t ntargets,
+                                                  const void *data, size_t sz,
+                                                  hb_mc_transfer_callback_t callback, void *context,
+                                                  hb_mc_transfer_t **xfer);
+
+        /**
+         * Start setting memory at several NPAs to a given value.
+         * Requests go round-robin across the targets one word at a time.
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  targets  The NPAs to set; must stay valid until the transfer completes
+         * @param[in]  ntargets The number of NPAs in #targets
+         * @param[in]  val      Value to be written out
+         * @param[in]  sz       The number of bytes to set at each target
+         * @param[in]  callback Called on completion. May be NULL.
+         * @param[in]  context  Passed to #callback
+         * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                      If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_memset_fanout_async(hb_mc_manycore_t *mc,
+                                               const hb_mc_npa_t *targets, size_t ntargets,
+                                               uint8_t val, size_t sz,
+                                               hb_mc_transfer_callback_t callback, void *context,
+                                               hb_mc_transfer_t **xfer);
+
+        /**
+         * Start setting memory to a given value starting at a given NPA
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa      A valid hb_mc_npa_t
+         * @param[in]  val      Value to be written out
+         * @param[in]  sz       The number of bytes to write to manycore hardware
+         * @param[in]  callback Called on completion. May be NULL.
+         * @param[in]  context  Passed to #callback
+         * @param[out] xfer     Set to a handle to be released with hb_mc_manycore_transfer_wait().
+         *                      If NULL, the transfer is released when it completes.
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_memset_async(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                        uint8_t val, size_t sz,
+                                        hb_mc_transfer_callback_t callback, void *context,
+                                        hb_mc_transfer_t **xfer);
+
+        /**
+         * Make progress on all outstanding transfers without waiting for any of them.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_transfer_poll(hb_mc_manycore_t *mc);
+
+        /**
+         * Make progress on outstanding transfers and check if a transfer has completed.
+         * The transfer is not released.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  xfer   A transfer handle returned by a submit function
+         * @return HB_MC_BUSY if the transfer is in flight. Otherwise the status of the transfer.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_transfer_test(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer);
+
+        /**
+         * Wait for a transfer to complete and release it.
+         * The wait is bounded by hb_mc_manycore_set_transfer_timeout(). A transfer that
+         * does not complete is abandoned: it is released, and no more of its data is read or written.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  xfer   A transfer handle returned by a submit function
+         * @return The status of the transfer, HB_MC_TIMEOUT, or an error code if progress could not be made.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_transfer_wait(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer);
+
+        /**
+         * Wait a bounded time for a transfer to complete and release it.
+         * The transfer is not released if the wait times out.
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  xfer     A transfer handle returned by a submit function
+         * @param[in]  timeout  Microseconds without progress before giving up, or -1 to wait forever
+         * @return The status of the transfer, HB_MC_TIMEOUT, or an error code if progress could not be made.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_transfer_wait_timeout(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer, long timeout);
+
+        /**
+         * Wait for every outstanding transfer to complete.
+         * Handles returned by submit functions must still be released with hb_mc_manycore_transfer_wait().
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_transfer_wait_all(hb_mc_manycore_t *mc);
+
+        /**
+         * Wait a bounded time for every outstanding transfer to complete.
+         * Handles returned by submit functions must still be released with hb_mc_manycore_transfer_wait().
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  timeout  Microseconds without progress before giving up, or -1 to wait forever
+         * @return HB_MC_SUCCESS on success, HB_MC_TIMEOUT if transfers are still in flight
+         *         after the timeout. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_transfer_wait_all_timeout(hb_mc_manycore_t *mc, long timeout);
+
         /************/
         /* MMIO API */
         /************/
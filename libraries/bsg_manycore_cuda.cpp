@@ -35,11 +35,18 @@
 #include <bsg_manycore_eva.h>
 #include <bsg_manycore_origin_eva_map.h>
 
+#ifdef EMULATION
+#include <bsg_manycore_emulation.h>
+#endif
+
 
 #ifdef __cplusplus
 #include <cstring>
+#include <ctime>
+#include <vector>
 #else
 #include <string.h>
+#include <time.h>
 #endif
 
 
@@ -99,6 +106,21 @@ __attribute__((warn_unused_result))
 static int hb_mc_tile_group_deallocate_tiles(hb_mc_device_t *device,
                                              hb_mc_tile_group_t *tg);
 
+__attribute__((warn_unused_result))
+static int hb_mc_tile_groups_upload_args (hb_mc_device_t *device,
+                                          hb_mc_tile_group_t **tgs,
+                                          uint32_t num_tgs);
+
+__attribute__((warn_unused_result))
+static int hb_mc_device_args_arena_reserve (hb_mc_device_t *device,
+                                            uint32_t size,
+                                            uint32_t *chunk,
+                                            hb_mc_eva_t *eva);
+
+__attribute__((warn_unused_result))
+static int hb_mc_device_args_arena_release (hb_mc_device_t *device,
+                                            hb_mc_tile_group_t *tg);
+
 __attribute__((warn_unused_result))
 static int hb_mc_tile_group_exit (hb_mc_tile_group_t *tg); 
 
@@ -111,6 +133,11 @@ static int hb_mc_device_program_load (hb_mc_device_t *device);
 __attribute__((warn_unused_result))
 static int hb_mc_device_manycore_exit (hb_mc_manycore_t *mc); 
 
+#ifdef EMULATION
+__attribute__((warn_unused_result))
+static int hb_mc_device_emulation_set_kernel_symbols (hb_mc_device_t *device);
+#endif
+
 __attribute__((warn_unused_result))
 static int hb_mc_device_program_exit (hb_mc_program_t *program); 
 
@@ -132,7 +159,7 @@ __attribute__((warn_unused_result))
 static int hb_mc_device_all_tile_groups_finished(hb_mc_device_t *device);
 
 __attribute__((warn_unused_result))
-static int hb_mc_device_wait_for_tile_group_finish_any(hb_mc_device_t *device);
+static int hb_mc_device_wait_for_tile_group_finish_any(hb_mc_device_t *device, long timeout);
 
 __attribute__((warn_unused_result))
 static hb_mc_epa_t hb_mc_tile_group_get_finish_signal_addr(hb_mc_tile_group_t *tg);  
@@ -154,8 +181,7 @@ static int hb_mc_device_tiles_unfreeze (hb_mc_device_t *device,
 __attribute__((warn_unused_result))
 static int hb_mc_tile_set_symbol_val (hb_mc_manycore_t *mc,
                                       const hb_mc_eva_map_t *map,
-                                      const unsigned char* bin,
-                                      size_t bin_size,
+                                      const hb_mc_loader_symbols_t *symbols,
                                       const hb_mc_coordinate_t *coord,
                                       const char* symbol,
                                       const uint32_t *val);
@@ -643,6 +669,8 @@ static int hb_mc_tile_group_enqueue (hb_mc_device_t* device,
         tg->grid_id = grid_id;
         tg->grid_dim = grid_dim;
         tg->status = HB_MC_TILE_GROUP_STATUS_INITIALIZED;
+        tg->args_eva = 0;
+        tg->args_chunk = HB_MC_CUDA_ARGS_CHUNK_NONE;
 
         tg->map = (hb_mc_eva_map_t *) malloc (sizeof(hb_mc_eva_map_t)); 
         if (tg->map == NULL) { 
@@ -726,6 +754,7 @@ static int hb_mc_tile_group_kernel_init (hb_mc_tile_group_t *tg,
 /**
  * Launches a tile group by sending packets to each tile in the
  * tile group setting the argc, argv, finish_addr and kernel pointer.
+ * The tile group's arguments must already be on the device (see hb_mc_tile_groups_upload_args()).
  * @param[in]  device        Pointer to device
  * @parma[in]  tg            Pointer to tile group
  * @return HB_MC_SUCCESS if tile group is launched successfully, otherwise an error code is returned.
@@ -736,32 +765,8 @@ static int hb_mc_tile_group_launch (hb_mc_device_t *device,
         int error;
         const hb_mc_config_t *cfg = hb_mc_manycore_get_config (device->mc); 
 
-        hb_mc_eva_t args_eva;
-
-        // allocate device memory for arguments
-        error = hb_mc_device_malloc (device, (tg->kernel->argc) * sizeof(uint32_t), &args_eva);
-        if (error != HB_MC_SUCCESS) {
-                bsg_pr_err("%s: failed to allocate space on device for grid %d tile group (%d,%d) arguments.\n",
-                           __func__,
-                           tg->grid_id,
-                           hb_mc_coordinate_get_x(tg->id), hb_mc_coordinate_get_y(tg->id));
-                return HB_MC_NOMEM;
-        }
-
-        // transfer the arguments to dram
-        error = hb_mc_device_memcpy(    device, reinterpret_cast<void *>(args_eva),
-                                        (void *) &(tg->kernel->argv[0]),
-                                        (tg->kernel->argc) * sizeof(uint32_t), HB_MC_MEMCPY_TO_DEVICE);
-        if (error != HB_MC_SUCCESS) {
-                bsg_pr_err("%s: failed to copy grid %d tile group (%d,%d) arguments to device.\n",
-                           __func__,
-                           tg->grid_id, hb_mc_coordinate_get_x(tg->id),
-                           hb_mc_coordinate_get_y(tg->id)); 
-                return error;
-        }
-        
         hb_mc_eva_t kernel_eva; 
-        error = hb_mc_loader_symbol_to_eva (device->program->bin, device->program->bin_size, tg->kernel->name, &kernel_eva); 
+        error = hb_mc_loader_symbols_lookup (device->program->symbols, tg->kernel->name, &kernel_eva, NULL);
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: invalid kernel name %s for grid %d tile group (%d,%d).\n",
                            __func__,
@@ -794,7 +799,7 @@ static int hb_mc_tile_group_launch (hb_mc_device_t *device,
         error = hb_mc_device_tiles_set_runtime_symbols(device,
                                                        tg->map,
                                                        tg->kernel->argc,
-                                                       args_eva,
+                                                       tg->args_eva,
                                                        finish_signal_npa, 
                                                        kernel_eva,
                                                        tile_list,
@@ -852,6 +857,15 @@ static int hb_mc_tile_group_deallocate_tiles(hb_mc_device_t *device,
                    hb_mc_dimension_get_x(tg->dim), hb_mc_dimension_get_y(tg->dim),
                    hb_mc_coordinate_get_x(tg->id), hb_mc_coordinate_get_y(tg->id),
                    hb_mc_coordinate_get_x(tg->origin), hb_mc_coordinate_get_y(tg->origin));
+
+        error = hb_mc_device_args_arena_release(device, tg);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to release grid %d tile group (%d,%d) arguments.\n",
+                           __func__,
+                           tg->grid_id,
+                           hb_mc_coordinate_get_x(tg->id), hb_mc_coordinate_get_y(tg->id));
+                return error;
+        }
         
         tg->status = HB_MC_TILE_GROUP_STATUS_FINISHED;
 
@@ -862,6 +876,200 @@ static int hb_mc_tile_group_deallocate_tiles(hb_mc_device_t *device,
 
 
 
+/**
+ * Copies the arguments of a wave of tile groups to the device in a single transfer.
+ * Space comes from the program's argument arena; tile groups with identical
+ * argument lists (e.g. those of one grid) share a single copy.
+ * @param[in]  device        Pointer to device
+ * @param[in]  tgs           Tile groups that are about to be launched
+ * @param[in]  num_tgs       Number of tile groups in #tgs
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+static int hb_mc_tile_groups_upload_args (hb_mc_device_t *device,
+                                          hb_mc_tile_group_t **tgs,
+                                          uint32_t num_tgs) {
+        int error;
+        std::vector<uint32_t> args;
+        std::vector<uint32_t> offset(num_tgs);
+
+        // Pack the argument lists into one host buffer
+        for (uint32_t i = 0; i < num_tgs; i ++) {
+                const hb_mc_kernel_t *kernel = tgs[i]->kernel;
+                uint32_t j;
+                for (j = 0; j < i; j ++) {
+                        const hb_mc_kernel_t *other = tgs[j]->kernel;
+                        if (other->argc == kernel->argc &&
+                            !memcmp(other->argv, kernel->argv, kernel->argc * sizeof(uint32_t)))
+                                break;
+                }
+
+                if (j < i) {
+                        offset[i] = offset[j];
+                } else {
+                        offset[i] = args.size();
+                        args.insert(args.end(), kernel->argv, kernel->argv + kernel->argc);
+                }
+        }
+
+        if (args.empty()) {
+                for (uint32_t i = 0; i < num_tgs; i ++) {
+                        tgs[i]->args_eva = 0;
+                        tgs[i]->args_chunk = HB_MC_CUDA_ARGS_CHUNK_NONE;
+                }
+                return HB_MC_SUCCESS;
+        }
+
+        uint32_t size = args.size() * sizeof(uint32_t);
+        uint32_t chunk;
+        hb_mc_eva_t args_eva;
+        error = hb_mc_device_args_arena_reserve(device, size, &chunk, &args_eva);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to reserve %" PRIu32 " bytes for tile group arguments.\n",
+                           __func__, size);
+                return error;
+        }
+
+        error = hb_mc_device_memcpy(device, reinterpret_cast<void *>(args_eva),
+                                    (void *) args.data(), size, HB_MC_MEMCPY_TO_DEVICE);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to copy tile group arguments to device.\n", __func__);
+                // hand the space back; it is still the last thing reserved from the chunk
+                device->program->allocator->args_arena.chunks[chunk].used -= size;
+                return error;
+        }
+
+        for (uint32_t i = 0; i < num_tgs; i ++) {
+                tgs[i]->args_eva = args_eva + offset[i] * sizeof(uint32_t);
+                tgs[i]->args_chunk = chunk;
+                device->program->allocator->args_arena.chunks[chunk].live ++;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+
+
+
+/**
+ * Bump-allocates space for kernel arguments from the program's argument arena.
+ * A new chunk of at least HB_MC_CUDA_ARGS_CHUNK_SIZE bytes is allocated if
+ * no existing chunk has room.
+ * @param[in]  device        Pointer to device
+ * @param[in]  size          Number of bytes to reserve
+ * @param[out] chunk         Set to the index of the chunk the space came from
+ * @param[out] eva           Set to the EVA of the reserved space
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+static int hb_mc_device_args_arena_reserve (hb_mc_device_t *device,
+                                            uint32_t size,
+                                            uint32_t *chunk,
+                                            hb_mc_eva_t *eva) {
+        int error;
+        hb_mc_args_arena_t *arena = &device->program->allocator->args_arena;
+        hb_mc_args_chunk_t *c;
+        uint32_t slot = arena->num_chunks;
+
+        for (uint32_t i = 0; i < arena->num_chunks; i ++) {
+                c = &arena->chunks[i];
+                if (c->size == 0) {
+                        if (slot == arena->num_chunks)
+                                slot = i;
+                        continue;
+                }
+
+                if (c->size - c->used >= size) {
+                        *chunk = i;
+                        *eva = c->eva + c->used;
+                        c->used += size;
+                        return HB_MC_SUCCESS;
+                }
+        }
+
+        if (slot == arena->num_chunks) {
+                c = (hb_mc_args_chunk_t *) realloc (arena->chunks, (arena->num_chunks + 1) * sizeof(hb_mc_args_chunk_t));
+                if (c == NULL) {
+                        bsg_pr_err("%s: failed to allocate space for argument arena chunk list.\n", __func__);
+                        return HB_MC_NOMEM;
+                }
+                arena->chunks = c;
+                arena->chunks[slot].size = 0;
+                arena->num_chunks ++;
+        }
+
+        c = &arena->chunks[slot];
+        uint32_t chunk_size = size > HB_MC_CUDA_ARGS_CHUNK_SIZE ? size : HB_MC_CUDA_ARGS_CHUNK_SIZE;
+        error = hb_mc_device_malloc_tagged(device, chunk_size, "kernel arguments", &c->eva);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to allocate %" PRIu32 " byte argument arena chunk.\n",
+                           __func__, chunk_size);
+                return error;
+        }
+        c->size = chunk_size;
+        c->used = size;
+        c->live = 0;
+
+        *chunk = slot;
+        *eva = c->eva;
+        return HB_MC_SUCCESS;
+}
+
+
+
+
+/**
+ * Releases a finished tile group's hold on its argument arena chunk.
+ * When the last tile group using a chunk finishes, the chunk is drained
+ * for reuse; any other drained chunk is returned to the device allocator.
+ * @param[in]  device        Pointer to device
+ * @param[in]  tg            Pointer to tile group
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+static int hb_mc_device_args_arena_release (hb_mc_device_t *device,
+                                            hb_mc_tile_group_t *tg) {
+        int error;
+        hb_mc_args_arena_t *arena = &device->program->allocator->args_arena;
+        uint32_t chunk = tg->args_chunk;
+
+        if (chunk == HB_MC_CUDA_ARGS_CHUNK_NONE)
+                return HB_MC_SUCCESS;
+
+        tg->args_chunk = HB_MC_CUDA_ARGS_CHUNK_NONE;
+        tg->args_eva = 0;
+
+        if (chunk >= arena->num_chunks || arena->chunks[chunk].live == 0) {
+                bsg_pr_err("%s: tile group holds no space in argument arena chunk %" PRIu32 ".\n",
+                           __func__, chunk);
+                return HB_MC_INVALID;
+        }
+
+        if (-- arena->chunks[chunk].live != 0)
+                return HB_MC_SUCCESS;
+
+        arena->chunks[chunk].used = 0;
+
+        // Keep only the most recently drained chunk around for the next wave
+        for (uint32_t i = 0; i < arena->num_chunks; i ++) {
+                hb_mc_args_chunk_t *c = &arena->chunks[i];
+                if (i == chunk || c->size == 0 || c->live != 0)
+                        continue;
+
+                error = hb_mc_device_free(device, c->eva);
+                if (error != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to free argument arena chunk %" PRIu32 ".\n",
+                                   __func__, i);
+                        return error;
+                }
+                c->size = 0;
+                c->used = 0;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+
+
+
+
 /**
  * Frees memroy and removes tile group object
  * @param[in]  tg        Pointer to tile group
@@ -940,6 +1148,30 @@ static int hb_mc_tile_group_kernel_exit (hb_mc_kernel_t *kernel) {
 
 
 
+/**
+ * Undoes a partially completed device initialization: frees the tile group
+ * list and mesh if they were set up, exits the manycore and frees it.
+ * @param[in]  device        Pointer to device with an initialized manycore
+ */
+static void hb_mc_device_init_cleanup (hb_mc_device_t *device) {
+        free(device->tile_groups);
+        device->tile_groups = NULL;
+
+        if (device->mesh) {
+                free(device->mesh->tiles);
+                free(device->mesh);
+                device->mesh = NULL;
+        }
+
+        if (hb_mc_manycore_exit(device->mc) != HB_MC_SUCCESS)
+                bsg_pr_err("%s: failed to exit manycore.\n", __func__);
+        free(device->mc);
+        device->mc = NULL;
+}
+
+
+
+
 /**
  * Initializes the manycore struct, and a mesh structure with default (maximum)
  * dimensions inside device struct with list of tiles and their coordinates 
@@ -952,6 +1184,11 @@ static int hb_mc_tile_group_kernel_exit (hb_mc_kernel_t *kernel) {
 int hb_mc_device_init (hb_mc_device_t *device,
                        const char *name,
                        hb_mc_manycore_id_t id){
+        device->program = NULL;
+        device->mesh = NULL;
+        device->tile_groups = NULL;
+        device->resident = NULL;
+
         device->mc = (hb_mc_manycore_t*) malloc (sizeof (hb_mc_manycore_t));
         if (device->mc == NULL) { 
                 bsg_pr_err("%s: failed to allocate space on host for hb_mc_manycore_t.\n", __func__);
@@ -962,6 +1199,8 @@ int hb_mc_device_init (hb_mc_device_t *device,
         int error = hb_mc_manycore_init(device->mc, name, id); 
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to initialize manycore.\n", __func__);
+                free(device->mc);
+                device->mc = NULL;
                 return HB_MC_UNINITIALIZED;
         } 
 
@@ -972,19 +1211,24 @@ int hb_mc_device_init (hb_mc_device_t *device,
         error = hb_mc_device_mesh_init(device, max_dim);
         if (error != HB_MC_SUCCESS) {
                 bsg_pr_err("%s: failed to initialize mesh.\n", __func__);
-                return HB_MC_UNINITIALIZED;
+                error = HB_MC_UNINITIALIZED;
+                goto cleanup;
         }
 
         error = hb_mc_device_tile_groups_init (device); 
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to initialize device's tile group structure.\n", __func__);
-                return error; 
+                goto cleanup;
         }
 
         device->num_grids = 0;
 
         return HB_MC_SUCCESS;
 
+cleanup:
+        hb_mc_device_init_cleanup(device);
+        return error;
+
 }
 
 
@@ -1003,6 +1247,11 @@ int hb_mc_device_init_custom_dimensions (hb_mc_device_t *device,
                                          hb_mc_manycore_id_t id,
                                          hb_mc_dimension_t dim) {
 
+        device->program = NULL;
+        device->mesh = NULL;
+        device->tile_groups = NULL;
+        device->resident = NULL;
+
         device->mc = (hb_mc_manycore_t*) malloc (sizeof (hb_mc_manycore_t));
         if (device->mc == NULL) { 
                 bsg_pr_err("%s: failed to allocate space on host for hb_mc_manycore_t.\n", __func__);
@@ -1013,6 +1262,8 @@ int hb_mc_device_init_custom_dimensions (hb_mc_device_t *device,
         int error = hb_mc_manycore_init(device->mc, name, id); 
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to initialize manycore.\n", __func__);
+                free(device->mc);
+                device->mc = NULL;
                 return HB_MC_UNINITIALIZED;
         } 
         
@@ -1020,18 +1271,105 @@ int hb_mc_device_init_custom_dimensions (hb_mc_device_t *device,
         error = hb_mc_device_mesh_init(device, dim);
         if (error != HB_MC_SUCCESS) {
                 bsg_pr_err("%s: failed to initialize mesh.\n", __func__);
-                return HB_MC_UNINITIALIZED;
+                error = HB_MC_UNINITIALIZED;
+                goto cleanup;
         }
 
         error = hb_mc_device_tile_groups_init (device); 
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to initialize device's tile group structure.\n", __func__);
-                return error; 
+                goto cleanup;
         }
 
         device->num_grids = 0;
 
         return HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_device_init_cleanup(device);
+        return error;
+}
+
+
+
+
+/**
+ * Writes the binary in a device's hb_mc_program_t struct to a list of tiles and DRAM.
+ * If HB_MC_LOADER_PLAN_CACHE names a directory, the load is replayed from
+ * a load plan cached there, and the plan is compiled and saved on a miss.
+ * If HB_MC_LOADER_INCREMENTAL is set to a value other than 0, only what
+ * differs from the previous program loaded onto the device is written.
+ * @param[in]  device        Pointer to device
+ * @param[in]  tiles         List of tiles to load
+ * @param[in]  num_tiles     Number of tiles in #tiles
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+static int hb_mc_device_program_load_binary (hb_mc_device_t *device,
+                                             const hb_mc_coordinate_t *tiles,
+                                             uint32_t num_tiles) {
+        const char *cache_dir = getenv("HB_MC_LOADER_PLAN_CACHE");
+        const char *incremental = getenv("HB_MC_LOADER_INCREMENTAL");
+        hb_mc_loader_plan_t *plan;
+        int error;
+
+        if (cache_dir != NULL && cache_dir[0] == '\0')
+                cache_dir = NULL;
+
+        if (incremental != NULL && (incremental[0] == '\0' || !strcmp(incremental, "0")))
+                incremental = NULL;
+
+        if (cache_dir == NULL && incremental == NULL) {
+                hb_mc_loader_resident_forget(device->resident);
+                return hb_mc_loader_load(device->program->bin,
+                                         device->program->bin_size,
+                                         device->mc, &default_map,
+                                         tiles, num_tiles);
+        }
+
+        error = hb_mc_loader_plan_cached(device->program->bin,
+                                         device->program->bin_size,
+                                         device->mc, &default_map,
+                                         tiles, num_tiles,
+                                         cache_dir, &plan);
+        if (error == HB_MC_NOIMPL) {
+                hb_mc_loader_resident_forget(device->resident);
+                return hb_mc_loader_load(device->program->bin,
+                                         device->program->bin_size,
+                                         device->mc, &default_map,
+                                         tiles, num_tiles);
+        }
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to get load plan.\n", __func__);
+                return error;
+        }
+
+        if (incremental != NULL && device->resident == NULL) {
+                error = hb_mc_loader_resident_init(&device->resident);
+                if (error != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to create resident image.\n", __func__);
+                        hb_mc_loader_plan_exit(plan);
+                        return error;
+                }
+        }
+
+        if (incremental != NULL) {
+                error = hb_mc_loader_plan_load_incremental(plan,
+                                                           device->program->bin,
+                                                           device->program->bin_size,
+                                                           device->mc, &default_map,
+                                                           tiles, num_tiles,
+                                                           device->resident);
+        } else {
+                hb_mc_loader_resident_forget(device->resident);
+                error = hb_mc_loader_plan_load(plan,
+                                               device->program->bin,
+                                               device->program->bin_size,
+                                               device->mc, &default_map,
+                                               tiles, num_tiles);
+        }
+
+        hb_mc_loader_plan_exit(plan);
+        return error;
 }
 
 
@@ -1062,18 +1400,23 @@ static int hb_mc_device_program_load (hb_mc_device_t *device) {
 
 
         // Load binary into all tiles 
-        error = hb_mc_loader_load (device->program->bin,
-                                   device->program->bin_size,
-                                   device->mc,
-                                   &default_map,
-                                   &tile_list[0],
-                                   num_tiles); 
+        error = hb_mc_device_program_load_binary(device, &tile_list[0], num_tiles);
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err ("%s: failed to load binary into tiles.\n", __func__); 
                 return error;
         }       
 
 
+#ifdef EMULATION
+        // Tell the emulated manycore where the CUDA-Lite runtime symbols live
+        error = hb_mc_device_emulation_set_kernel_symbols(device);
+        if (error != HB_MC_SUCCESS) { 
+                bsg_pr_err("%s: failed to register kernel symbols with emulator.\n", __func__);
+                return error;
+        }
+#endif
+
+
         // Set all tiles configuration symbols 
         hb_mc_coordinate_t tg_id = hb_mc_coordinate (0, 0);
         hb_mc_coordinate_t tg_dim = hb_mc_coordinate (1, 1); 
@@ -1107,6 +1450,45 @@ static int hb_mc_device_program_load (hb_mc_device_t *device) {
 
 
 
+#ifdef EMULATION
+/**
+ * Registers the DMEM addresses of the CUDA-Lite runtime symbols of the
+ * device's program with the emulated manycore, so that launched kernels
+ * signal completion. Programs without these symbols are not modeled.
+ * @param[in]  device        Pointer to device
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_device_emulation_set_kernel_symbols (hb_mc_device_t *device) {
+        hb_mc_emulation_kernel_symbols_t syms;
+        struct { const char *name; hb_mc_epa_t *epa; } table [] = {
+                { "cuda_kernel_ptr",         &syms.kernel_ptr },
+                { "cuda_finish_signal_addr", &syms.finish_signal_addr },
+                { "cuda_finish_signal_val",  &syms.finish_signal_val },
+                { "__bsg_id",                &syms.tile_id },
+        };
+
+        for (unsigned i = 0; i < sizeof(table)/sizeof(table[0]); i++) {
+                hb_mc_eva_t eva;
+                int error = hb_mc_loader_symbols_lookup(device->program->symbols,
+                                                        table[i].name,
+                                                        &eva, NULL);
+                if (error != HB_MC_SUCCESS) {
+                        bsg_pr_dbg("%s: %s not found: kernel completion is not emulated.\n",
+                                   __func__, table[i].name);
+                        return hb_mc_emulation_set_kernel_symbols(device->mc->id, NULL);
+                }
+                // DMEM EVAs are identical to DMEM EPAs
+                *table[i].epa = hb_mc_eva_addr(&eva);
+        }
+
+        syms.kernel_not_loaded_val = HB_MC_CUDA_KERNEL_NOT_LOADED_VAL;
+        return hb_mc_emulation_set_kernel_symbols(device->mc->id, &syms);
+}
+#endif
+
+
+
+
 
 /**
  * Takes in a buffer containing binary and its size,
@@ -1133,6 +1515,7 @@ int hb_mc_device_program_init_binary (hb_mc_device_t *device,
                 bsg_pr_err("%s: failed to allocate space on host for device hb_mc_program_t struct.\n", __func__);
                 return HB_MC_NOMEM;
         }
+        device->program->symbols = NULL;
 
         device->program->bin_name = strdup (bin_name);
         if (!device->program->bin_name) { 
@@ -1278,6 +1661,10 @@ static int hb_mc_device_program_exit (hb_mc_program_t *program) {
                 program->bin = NULL;
         }
 
+        // Free symbol index
+        hb_mc_loader_symbols_exit(program->symbols);
+        program->symbols = NULL;
+
         // Free allocator
         error = hb_mc_program_allocator_exit (program->allocator); 
         if (error != HB_MC_SUCCESS) { 
@@ -1320,6 +1707,14 @@ static int hb_mc_program_binary_copy (hb_mc_program_t *program,
         program->bin = copy; 
         program->bin_size = bin_size;
 
+        // Index the symbol tables once; every symbol lookup uses the index
+        int error = hb_mc_loader_symbols_init(program->bin, program->bin_size, &program->symbols);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to index program symbols: %s\n",
+                           __func__, hb_mc_strerror(error));
+                return error;
+        }
+
         return HB_MC_SUCCESS;   
 }
 
@@ -1353,16 +1748,19 @@ static int hb_mc_program_allocator_init (const hb_mc_config_t *cfg,
         program->allocator->id = id; 
 
         hb_mc_eva_t program_end_eva;
-        error = hb_mc_loader_symbol_to_eva(program->bin, program->bin_size, "_bsg_dram_end_addr", &program_end_eva); 
+        error = hb_mc_loader_symbols_lookup(program->symbols, "_bsg_dram_end_addr", &program_end_eva, NULL);
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to acquire _bsg_dram_end_addr eva from binary file.\n", __func__); 
                 return HB_MC_INVALID;
         }
 
-        uint32_t alignment = 32;
+        uint32_t alignment = HB_MC_DEVICE_MALLOC_ALIGNMENT;
         uint32_t start = program_end_eva + alignment - (program_end_eva % alignment); /* start at the next aligned block */
         size_t dram_size = hb_mc_config_get_dram_size(cfg); 
         program->allocator->memory_manager = (awsbwhal::MemoryManager *) new awsbwhal::MemoryManager(dram_size, start, alignment); 
+        program->allocator->stagger_channel = 0;
+        program->allocator->args_arena.chunks = NULL;
+        program->allocator->args_arena.num_chunks = 0;
 
         return HB_MC_SUCCESS;   
 }
@@ -1398,6 +1796,12 @@ static int hb_mc_program_allocator_exit (hb_mc_allocator_t *allocator) {
         }
 
 
+        // Free the argument arena's bookkeeping; its chunks go with the memory manager
+        free(allocator->args_arena.chunks);
+        allocator->args_arena.chunks = NULL;
+        allocator->args_arena.num_chunks = 0;
+
+
         // Free memory manager
         const awsbwhal::MemoryManager *memory_manager;
         memory_manager = (awsbwhal::MemoryManager *) allocator->memory_manager; 
@@ -1405,7 +1809,7 @@ static int hb_mc_program_allocator_exit (hb_mc_allocator_t *allocator) {
                 bsg_pr_err("%s: calling exit on allocator with null memory manager.\n", __func__);
                 return HB_MC_INVALID;
         } else {
-                free ((awsbwhal::MemoryManager *) memory_manager); 
+                delete memory_manager;
                 allocator->memory_manager = NULL;
         }
         free(allocator);
@@ -1441,19 +1845,40 @@ static int hb_mc_device_all_tile_groups_finished(hb_mc_device_t *device) {
 /**
  * Waits for a tile group to send a finish packet to device.
  * @param[in]  device        Pointer to device
- * return HB_MC_SUCCESS after a tile group is finished, gets stuck in infinite loop if no tile group finishes.
+ * @param[in]  timeout       Microseconds to wait for a finish packet, or -1 to wait forever
+ * Blocks in hb_mc_manycore_request_rx(), which backs off according to the
+ * manycore's backoff policy (see hb_mc_manycore_set_backoff_policy()).
+ * return HB_MC_SUCCESS after a tile group is finished, HB_MC_TIMEOUT if none finishes in time.
  */
-static int hb_mc_device_wait_for_tile_group_finish_any(hb_mc_device_t *device) {
+static int hb_mc_device_wait_for_tile_group_finish_any(hb_mc_device_t *device, long timeout) {
         int error; 
 
         int tile_group_finished = 0;
         hb_mc_request_packet_t recv, finish;
         hb_mc_coordinate_t host_coordinate = hb_mc_manycore_get_host_coordinate(device->mc); 
+        struct timespec now;
+        uint64_t deadline_us = 0;
+
+        if (timeout != -1) {
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                deadline_us = (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000 + timeout;
+        }
 
         while (!tile_group_finished) {
 
-                error = hb_mc_manycore_request_rx (device->mc, &recv, -1); 
-                if (error != HB_MC_SUCCESS) { 
+                /* packets that are not finish packets do not extend the wait */
+                long remaining = -1;
+                if (timeout != -1) {
+                        clock_gettime(CLOCK_MONOTONIC, &now);
+                        uint64_t now_us = (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+                        remaining = now_us < deadline_us ? (long)(deadline_us - now_us) : 0;
+                }
+
+                error = hb_mc_manycore_request_rx (device->mc, &recv, remaining); 
+                if (error == HB_MC_TIMEOUT) {
+                        bsg_pr_err("%s: no tile group finished within %ld us.\n", __func__, timeout);
+                        return error;
+                } else if (error != HB_MC_SUCCESS) { 
                         bsg_pr_err("%s: failed to read fifo for finish packet from device.\n", __func__);
                         return error;
                 }
@@ -1511,35 +1936,89 @@ static int hb_mc_device_wait_for_tile_group_finish_any(hb_mc_device_t *device) {
  * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
  */
 int hb_mc_device_tile_groups_execute (hb_mc_device_t *device) {
+        return hb_mc_device_tile_groups_execute_timeout(device, -1);
+}
+
+
+
 
-        int error ;
+/**
+ * Iterates over all tile groups inside device, allocates those that fit in mesh and launches them. 
+ * API remains in this function until all tile groups have finished execution,
+ * or until no launched tile group finishes within a timeout.
+ * @param[in]  device        Pointer to device
+ * @param[in]  timeout       Microseconds to wait for each tile group to finish and for each
+ *                           transfer that launches one, or -1 to wait forever
+ * @return HB_MC_SUCCESS if succesful, HB_MC_TIMEOUT if a wait timed out. Otherwise an error code is returned.
+ */
+int hb_mc_device_tile_groups_execute_timeout (hb_mc_device_t *device, long timeout) {
+
+        int error, restore_error ;
+        long transfer_timeout;
+
+        if (timeout < -1) {
+                bsg_pr_err("%s: invalid timeout %ld: must be -1 or a number of microseconds.\n",
+                           __func__, timeout);
+                return HB_MC_INVALID;
+        }
+
+        /* bound the argument uploads and launch packets by the timeout too */
+        error = hb_mc_manycore_get_transfer_timeout(device->mc, &transfer_timeout);
+        if (error != HB_MC_SUCCESS)
+                return error;
+
+        if (timeout != -1) {
+                error = hb_mc_manycore_set_transfer_timeout(device->mc, timeout);
+                if (error != HB_MC_SUCCESS)
+                        return error;
+        }
+
+        std::vector<hb_mc_tile_group_t *> wave;
         /* loop untill all tile groups have been allocated, launched and finished. */
         while(hb_mc_device_all_tile_groups_finished(device) != HB_MC_SUCCESS) {
-                /* loop over all tile groups and try to launch as many as possible */
+                /* loop over all tile groups and allocate tiles to as many as possible */
+                wave.clear();
                 hb_mc_tile_group_t *tg = device->tile_groups;
                 for (int tg_num = 0; tg_num < device->num_tile_groups; tg_num ++, tg ++) { 
                         if (tg->status == HB_MC_TILE_GROUP_STATUS_INITIALIZED) {
                                 error = hb_mc_tile_group_allocate_tiles(device, tg) ;
-                                if (error == HB_MC_SUCCESS) {
-                                        error = hb_mc_tile_group_launch(device, tg);
-                                        if (error != HB_MC_SUCCESS) {
-                                                bsg_pr_err("%s: failed to launch tile group %d.\n", __func__, tg_num);
-                                                return error;
-                                        }
-                                }
+                                if (error == HB_MC_SUCCESS)
+                                        wave.push_back(tg);
+                        }
+                }
+
+                /* upload the arguments of the whole wave at once, then launch it */
+                if (!wave.empty()) {
+                        error = hb_mc_tile_groups_upload_args(device, wave.data(), wave.size());
+                        if (error != HB_MC_SUCCESS) {
+                                bsg_pr_err("%s: failed to upload tile group arguments.\n", __func__);
+                                goto cleanup;
+                        }
+                }
+
+                for (hb_mc_tile_group_t *launch : wave) {
+                        error = hb_mc_tile_group_launch(device, launch);
+                        if (error != HB_MC_SUCCESS) {
+                                bsg_pr_err("%s: failed to launch tile group %d.\n",
+                                           __func__, (int) (launch - device->tile_groups));
+                                goto cleanup;
                         }
                 }
 
                 /* wait for a tile group to finish */
-                error = hb_mc_device_wait_for_tile_group_finish_any(device);
+                error = hb_mc_device_wait_for_tile_group_finish_any(device, timeout);
                 if (error != HB_MC_SUCCESS) { 
                         bsg_pr_err("%s: tile group not finished, something went wrong.\n", __func__); 
-                        return error;
+                        goto cleanup;
                 }
 
         }
 
-        return HB_MC_SUCCESS;
+        error = HB_MC_SUCCESS;
+
+cleanup:
+        restore_error = hb_mc_manycore_set_transfer_timeout(device->mc, transfer_timeout);
+        return error != HB_MC_SUCCESS ? error : restore_error;
 }
 
 
@@ -1575,12 +2054,17 @@ int hb_mc_device_finish (hb_mc_device_t *device) {
                 bsg_pr_err("%s: failed to destruct device's manycore struct.\n", __func__);
                 return error;
         }
+        device->mc = NULL;
 
 
-        error = hb_mc_device_program_exit (device->program); 
-        if (error != HB_MC_SUCCESS) { 
-                bsg_pr_err("%s: failed to destruct device's program struct.\n", __func__);
-                return error;
+        // a device may be finished without a program ever being loaded
+        if (device->program) {
+                error = hb_mc_device_program_exit (device->program); 
+                if (error != HB_MC_SUCCESS) { 
+                        bsg_pr_err("%s: failed to destruct device's program struct.\n", __func__);
+                        return error;
+                }
+                device->program = NULL;
         }
 
 
@@ -1589,6 +2073,7 @@ int hb_mc_device_finish (hb_mc_device_t *device) {
                 bsg_pr_err("%s: failed to destruct device's mesh struct.\n", __func__);
                 return error;
         }
+        device->mesh = NULL;
 
         
         error = hb_mc_device_tile_groups_exit(device); 
@@ -1597,6 +2082,9 @@ int hb_mc_device_finish (hb_mc_device_t *device) {
                 return error;
         }
 
+        hb_mc_loader_resident_exit(device->resident);
+        device->resident = NULL;
+
         return HB_MC_SUCCESS;
 }
 
@@ -1606,13 +2094,36 @@ int hb_mc_device_finish (hb_mc_device_t *device) {
 /**
  * Allocates memory on device DRAM
  * hb_mc_device_program_init() or hb_mc_device_program_init_binary() should
+ * have been called before calling this function to set up a memory allocator.
+ * Callers that include bsg_manycore_cuda.h reach hb_mc_device_malloc_tagged()
+ * through a macro that tags the buffer with their call site; this definition
+ * serves callers that take its address.
+ * @param[in]  device        Pointer to device
+ * @parma[in]  size          Size of requested memory
+ * @param[out] eva           Eva address of the allocated memory
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int (hb_mc_device_malloc) (hb_mc_device_t *device, uint32_t size, hb_mc_eva_t *eva) {
+        return hb_mc_device_malloc_tagged(device, size, __func__, eva);
+}
+
+
+
+
+/**
+ * Allocates memory on device DRAM and tags it with the name of its user.
+ * hb_mc_device_program_init() or hb_mc_device_program_init_binary() should
  * have been called before calling this function to set up a memory allocator
  * @param[in]  device        Pointer to device
  * @parma[in]  size          Size of requested memory
+ * @param[in]  tag           A string that outlives the buffer, e.g. a literal or __func__
  * @param[out] eva           Eva address of the allocated memory
  * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
  */
-int hb_mc_device_malloc (hb_mc_device_t *device, uint32_t size, hb_mc_eva_t *eva) {
+int hb_mc_device_malloc_tagged (hb_mc_device_t *device,
+                                uint32_t size,
+                                const char *tag,
+                                hb_mc_eva_t *eva) {
         *eva = 0;
 
         if (!device->program->allocator->memory_manager) {
@@ -1621,9 +2132,12 @@ int hb_mc_device_malloc (hb_mc_device_t *device, uint32_t size, hb_mc_eva_t *eva
         }
 
         awsbwhal::MemoryManager * mem_manager = (awsbwhal::MemoryManager *) device->program->allocator->memory_manager; 
-        hb_mc_eva_t result = mem_manager->alloc(size);
+        hb_mc_eva_t result = mem_manager->alloc(size, tag);
         if (result == awsbwhal::MemoryManager::mNull) {
-                bsg_pr_err("%s: failed to allocated memory.\n", __func__);      
+                awsbwhal::MemoryManager::Stats stats;
+                mem_manager->getStats(stats);
+                bsg_pr_err("%s: failed to allocate %" PRIu32 " bytes: %" PRIu64 " bytes free, largest free block %" PRIu64 " bytes.\n",
+                           __func__, size, stats.freeSize, stats.largestFree);
                 return HB_MC_NOMEM; 
         }
         *eva = result;
@@ -1633,6 +2147,151 @@ int hb_mc_device_malloc (hb_mc_device_t *device, uint32_t size, hb_mc_eva_t *eva
 
 
 
+/**
+ * Allocates memory on device DRAM starting on a chosen DRAM channel.
+ * Callers that include bsg_manycore_cuda.h reach hb_mc_device_malloc_placed_tagged()
+ * through a macro that tags the buffer with their call site; this definition
+ * serves callers that take its address.
+ * @param[in]  device        Pointer to device
+ * @parma[in]  size          Size of requested memory
+ * @param[in]  placement     How to pick the channel the buffer starts on
+ * @param[in]  channel       Starting channel for HB_MC_DEVICE_MALLOC_CHANNEL; ignored otherwise
+ * @param[out] eva           Eva address of the allocated memory
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int (hb_mc_device_malloc_placed) (hb_mc_device_t *device,
+                                  uint32_t size,
+                                  hb_mc_device_malloc_placement_t placement,
+                                  hb_mc_idx_t channel,
+                                  hb_mc_eva_t *eva) {
+        return hb_mc_device_malloc_placed_tagged(device, size, placement, channel, __func__, eva);
+}
+
+
+
+
+/**
+ * Allocates memory on device DRAM starting on a chosen DRAM channel and tags it with the name of its user.
+ * hb_mc_device_program_init() or hb_mc_device_program_init_binary() should
+ * have been called before calling this function to set up a memory allocator
+ * @param[in]  device        Pointer to device
+ * @parma[in]  size          Size of requested memory
+ * @param[in]  placement     How to pick the channel the buffer starts on
+ * @param[in]  channel       Starting channel for HB_MC_DEVICE_MALLOC_CHANNEL; ignored otherwise
+ * @param[in]  tag           A string that outlives the buffer, e.g. a literal or __func__
+ * @param[out] eva           Eva address of the allocated memory
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_malloc_placed_tagged (hb_mc_device_t *device,
+                                       uint32_t size,
+                                       hb_mc_device_malloc_placement_t placement,
+                                       hb_mc_idx_t channel,
+                                       const char *tag,
+                                       hb_mc_eva_t *eva) {
+        int error;
+        uint32_t stripe_size, stride, num_channels;
+        *eva = 0;
+
+        if (placement == HB_MC_DEVICE_MALLOC_ANYWHERE)
+                return hb_mc_device_malloc_tagged(device, size, tag, eva);
+
+        hb_mc_allocator_t *allocator = device->program->allocator;
+        if (!allocator->memory_manager) {
+                bsg_pr_err("%s: Memory manager not initialized.\n", __func__);
+                return HB_MC_FAIL;
+        }
+
+        error = default_eva_get_dram_interleave(device->mc, &stripe_size, &stride, &num_channels);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to get DRAM interleaving.\n", __func__);
+                return error;
+        }
+
+        // buffers start on allocator-aligned addresses, which cannot pick out a smaller stripe
+        if (stripe_size < HB_MC_DEVICE_MALLOC_ALIGNMENT) {
+                bsg_pr_err("%s: DRAM stripe of %" PRIu32 " bytes is smaller than the %d byte allocator alignment; "
+                           "buffers cannot be placed on a channel.\n",
+                           __func__, stripe_size, HB_MC_DEVICE_MALLOC_ALIGNMENT);
+                return HB_MC_INVALID;
+        }
+
+        if (placement == HB_MC_DEVICE_MALLOC_STAGGER) {
+                channel = allocator->stagger_channel;
+        } else if (placement != HB_MC_DEVICE_MALLOC_CHANNEL || channel >= num_channels) {
+                bsg_pr_err("%s: invalid placement %d on channel %d.\n", __func__, placement, channel);
+                return HB_MC_INVALID;
+        }
+
+        // the channel pattern repeats every stride bytes, holes included
+        awsbwhal::MemoryManager * mem_manager = (awsbwhal::MemoryManager *) allocator->memory_manager;
+        hb_mc_eva_t result = mem_manager->allocAligned(size,
+                                                       stride,
+                                                       (uint64_t)stripe_size * channel,
+                                                       tag);
+        if (result == awsbwhal::MemoryManager::mNull) {
+                bsg_pr_err("%s: failed to allocate memory on channel %d.\n", __func__, channel);
+                return HB_MC_NOMEM;
+        }
+
+        // the channels are 0 to num_channels - 1, so wrapping around skips the holes
+        if (placement == HB_MC_DEVICE_MALLOC_STAGGER)
+                allocator->stagger_channel = (channel + 1) % num_channels;
+
+        *eva = result;
+        return HB_MC_SUCCESS;
+}
+
+
+
+
+/**
+ * Gets the DRAM channels that a device buffer covers.
+ * @param[in]  device        Pointer to device
+ * @param[in]  eva           Eva address of the buffer
+ * @parma[in]  size          Size of the buffer in bytes
+ * @param[out] channels      Set to a mask with bit c set if the buffer touches channel c
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_get_dram_channels (hb_mc_device_t *device,
+                                    hb_mc_eva_t eva,
+                                    uint32_t size,
+                                    uint64_t *channels) {
+        int error;
+        uint32_t stripe_size, stride, num_channels;
+        *channels = 0;
+
+        error = default_eva_get_dram_interleave(device->mc, &stripe_size, &stride, &num_channels);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to get DRAM interleaving.\n", __func__);
+                return error;
+        }
+
+        if (num_channels > 64) {
+                bsg_pr_err("%s: %u channels do not fit in a 64-bit mask.\n", __func__, num_channels);
+                return HB_MC_NOIMPL;
+        }
+
+        // visit one address per stripe; after stride bytes the pattern repeats
+        uint64_t end = (uint64_t)eva + (size ? size : 1);
+        uint64_t addr = eva;
+        for (uint32_t i = 0; i < stride / stripe_size && addr < end; i++) {
+                hb_mc_eva_t stripe_eva = addr;
+                hb_mc_idx_t channel;
+                error = default_eva_get_dram_channel(device->mc, &stripe_eva, &channel);
+                if (error != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to get channel of eva 0x%08x.\n", __func__, stripe_eva);
+                        return error;
+                }
+                *channels |= 1ull << channel;
+                addr = (addr / stripe_size + 1) * stripe_size;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+
+
+
 /**
  * Frees memory on device DRAM
  * hb_mc_device_program_init() or hb_mc_device_program_init_binary() should
@@ -1657,6 +2316,78 @@ int hb_mc_device_free (hb_mc_device_t *device, eva_t eva) {
 
 
 
+/**
+ * Gets usage and fragmentation statistics of the device DRAM allocator.
+ * @param[in]  device        Pointer to device
+ * @param[out] stats         Set to the allocator's statistics
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_get_memory_stats (hb_mc_device_t *device,
+                                   hb_mc_device_memory_stats_t *stats) {
+
+        if (!device->program->allocator->memory_manager) {
+                bsg_pr_err("%s: memory manager not initialized.\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        awsbwhal::MemoryManager * mem_manager = (awsbwhal::MemoryManager *) device->program->allocator->memory_manager;
+        awsbwhal::MemoryManager::Stats mm;
+        static_assert(HB_MC_DEVICE_MEMORY_HISTOGRAM_BINS == awsbwhal::MemoryManager::mHistogramBins,
+                      "histogram bins of hb_mc_device_memory_stats_t and MemoryManager::Stats differ");
+        mem_manager->getStats(mm);
+
+        stats->size = mm.size;
+        stats->free_size = mm.freeSize;
+        stats->peak_used = mm.peakUsed;
+        stats->largest_free_block = mm.largestFree;
+        stats->num_free_blocks = mm.freeBlocks;
+        for (int bin = 0; bin < HB_MC_DEVICE_MEMORY_HISTOGRAM_BINS; bin++)
+                stats->free_block_histogram[bin] = mm.freeHistogram[bin];
+        stats->num_live_buffers = mm.liveBuffers;
+        stats->num_allocs = mm.allocs;
+        stats->num_failed_allocs = mm.failedAllocs;
+        stats->num_frees = mm.frees;
+        stats->alloc_ns = mm.allocNanos;
+        stats->free_ns = mm.freeNanos;
+        return HB_MC_SUCCESS;
+}
+
+
+
+
+/**
+ * Prints a summary of the device DRAM allocator followed by every
+ * allocated buffer, in address order, with its size and tag.
+ * @param[in]  device        Pointer to device
+ * @param[in]  fp            Stream to print to
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_memory_dump (hb_mc_device_t *device, FILE *fp) {
+        int error;
+        hb_mc_device_memory_stats_t stats;
+
+        error = hb_mc_device_get_memory_stats(device, &stats);
+        if (error != HB_MC_SUCCESS)
+                return error;
+
+        fprintf(fp, "device DRAM: %" PRIu64 " of %" PRIu64 " bytes in use (peak %" PRIu64 ") in %" PRIu64 " buffers\n",
+                stats.size - stats.free_size, stats.size, stats.peak_used, stats.num_live_buffers);
+        fprintf(fp, "device DRAM: %" PRIu64 " bytes free in %" PRIu64 " blocks, largest %" PRIu64 "\n",
+                stats.free_size, stats.num_free_blocks, stats.largest_free_block);
+        fprintf(fp, "device DRAM: %" PRIu64 " allocs (%" PRIu64 " failed), %" PRIu64 " frees\n",
+                stats.num_allocs, stats.num_failed_allocs, stats.num_frees);
+
+        awsbwhal::MemoryManager * mem_manager = (awsbwhal::MemoryManager *) device->program->allocator->memory_manager;
+        for (const awsbwhal::MemoryManager::Buffer &b : mem_manager->liveBuffers()) {
+                fprintf(fp, "  0x%08" PRIx64 " %10" PRIu64 "  %s\n",
+                        b.base, b.size, b.tag ? b.tag : "(untagged)");
+        }
+        return HB_MC_SUCCESS;
+}
+
+
+
+
 
 /**
  * Copies a buffer from src on the host/device DRAM to dst on device DRAM/host.
@@ -1827,8 +2558,7 @@ static int hb_mc_device_tiles_unfreeze (hb_mc_device_t *device,
                 // Set the tile's cuda_kernel_ptr_eva symbol to HB_MC_CUDA_KERNEL_NOT_LOADED_VAL
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "cuda_kernel_ptr",
                                                   &kernel_eva);
@@ -1861,8 +2591,7 @@ static int hb_mc_device_tiles_unfreeze (hb_mc_device_t *device,
  * Behavior is undefined if #mc is not initialized with hb_mc_manycore_init().
  * @param[in] mc         A manycore instance initialized with hb_mc_manycore_init().
  * @param[in] map        Eva to npa mapping. 
- * @param[in] bin        Binary elf file. 
- * @param[in] bin_size   Size of binary file. 
+ * @param[in] symbols    Symbol index of the program's binary.
  * @param[in] coord      Tile coordinates to set the tile group id of.
  * @param[in] symbol     Symbol to be set in tile's binary
  * @param[in] val        Val to set the symbol 
@@ -1870,8 +2599,7 @@ static int hb_mc_device_tiles_unfreeze (hb_mc_device_t *device,
  */
 static int hb_mc_tile_set_symbol_val (hb_mc_manycore_t *mc,
                                       const hb_mc_eva_map_t *map,
-                                      const unsigned char* bin,
-                                      size_t bin_size,
+                                      const hb_mc_loader_symbols_t *symbols,
                                       const hb_mc_coordinate_t *coord,
                                       const char* symbol,
                                       const uint32_t *val) {
@@ -1879,7 +2607,7 @@ static int hb_mc_tile_set_symbol_val (hb_mc_manycore_t *mc,
         int error;
 
         hb_mc_eva_t symbol_eva;
-        error = hb_mc_loader_symbol_to_eva(bin, bin_size, symbol, &symbol_eva); 
+        error = hb_mc_loader_symbols_lookup(symbols, symbol, &symbol_eva, NULL);
         if (error != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to acquire %s symbol's eva.\n",
                            __func__,
@@ -1941,6 +2669,9 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
 
         int error;
 
+        // The loader no longer knows these tiles' origin registers
+        hb_mc_loader_resident_forget_origin(device->resident);
+
         for (hb_mc_idx_t tile_id = 0; tile_id < num_tiles; tile_id ++) { 
                 
                 hb_mc_coordinate_t coord = hb_mc_coordinate_get_relative (origin, tiles[tile_id]); 
@@ -1963,8 +2694,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
                 hb_mc_idx_t origin_y = hb_mc_coordinate_get_y (origin); 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_grp_org_x",
                                                   &origin_x);
@@ -1979,8 +2709,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_grp_org_y",
                                                   &origin_y);
@@ -2002,8 +2731,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
                 hb_mc_idx_t coord_y = hb_mc_coordinate_get_y (coord); 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_x",
                                                   &coord_x);
@@ -2018,8 +2746,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_y",
                                                   &coord_y);
@@ -2044,8 +2771,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
                 hb_mc_idx_t id = hb_mc_coordinate_get_y(coord) * hb_mc_dimension_get_x(tg_dim) + hb_mc_coordinate_get_x(coord); 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_id",
                                                   &id);
@@ -2073,8 +2799,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
                 hb_mc_idx_t tg_id = tg_id_y * hb_mc_dimension_get_x(grid_dim) + tg_id_x;
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_tile_group_id_x",
                                                   &tg_id_x);
@@ -2089,8 +2814,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_tile_group_id_y",
                                                   &tg_id_y);
@@ -2105,8 +2829,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_tile_group_id",
                                                   &tg_id);
@@ -2125,8 +2848,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
                 hb_mc_idx_t grid_dim_y = hb_mc_dimension_get_y (grid_dim);
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_grid_dim_x",
                                                   &grid_dim_x);
@@ -2141,8 +2863,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "__bsg_grid_dim_y",
                                                   &grid_dim_y);
@@ -2160,8 +2881,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
                 uint32_t finish_signal_val = HB_MC_CUDA_FINISH_SIGNAL_VAL;
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "cuda_finish_signal_val",
                                                   &finish_signal_val);
@@ -2180,8 +2900,7 @@ static int hb_mc_device_tiles_set_config_symbols (hb_mc_device_t *device,
                 uint32_t kernel_not_loaded_val = HB_MC_CUDA_KERNEL_NOT_LOADED_VAL;
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "cuda_kernel_not_loaded_val",
                                                   &kernel_not_loaded_val);
@@ -2232,8 +2951,7 @@ static int hb_mc_device_tiles_set_runtime_symbols (     hb_mc_device_t *device,
                 // Set tile's argument count cuda_argc symbol.
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "cuda_argc",
                                                   &argc);
@@ -2251,8 +2969,7 @@ static int hb_mc_device_tiles_set_runtime_symbols (     hb_mc_device_t *device,
                 // Set tile's pointer to argument list cuda_argv_ptr symbol.
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "cuda_argv_ptr",
                                                   &args_eva);
@@ -2279,8 +2996,7 @@ static int hb_mc_device_tiles_set_runtime_symbols (     hb_mc_device_t *device,
 
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "cuda_finish_signal_addr",
                                                   &finish_signal_eva);
@@ -2298,8 +3014,7 @@ static int hb_mc_device_tiles_set_runtime_symbols (     hb_mc_device_t *device,
                 // Finally, set tile's pointer to kernel cuda_kernel_ptr symbol.
                 error = hb_mc_tile_set_symbol_val(device->mc,
                                                   map,
-                                                  device->program->bin,
-                                                  device->program->bin_size,
+                                                  device->program->symbols,
                                                   &(tiles[tile_id]),
                                                   "cuda_kernel_ptr",
                                                   &kernel_eva);
@@ -29,11 +29,14 @@
 #define BSG_MANYCORE_CUDA_H
 #include <bsg_manycore_features.h>
 #include <bsg_manycore_eva.h>
+#include <bsg_manycore_loader.h>
 
 #ifdef __cplusplus
 #include <cstdint>
+#include <cstdio>
 #else
 #include <stdint.h>
+#include <stdio.h>
 #endif
 
 #ifdef __cplusplus
@@ -47,6 +50,14 @@ extern "C" {
 #define HB_MC_CUDA_FINISH_SIGNAL_VAL            0x0001  
         // The begining of section in host memory intended for tile groups to write finish signals into.
 #define HB_MC_CUDA_HOST_FINISH_SIGNAL_BASE_ADDR 0xF000  
+        // Minimum size in bytes of a chunk of the kernel argument arena.
+#define HB_MC_CUDA_ARGS_CHUNK_SIZE              4096
+        // Value of args_chunk for a tile group that holds no space in the argument arena.
+#define HB_MC_CUDA_ARGS_CHUNK_NONE              0xFFFFFFFF
+        // Number of power-of-two bins in the free block histogram of hb_mc_device_memory_stats_t.
+#define HB_MC_DEVICE_MEMORY_HISTOGRAM_BINS      64
+        // Alignment in bytes of every buffer from the device DRAM allocator.
+#define HB_MC_DEVICE_MALLOC_ALIGNMENT           32
 
 
 
@@ -92,6 +103,8 @@ extern "C" {
                 hb_mc_dimension_t dim;
                 hb_mc_eva_map_t *map;
                 hb_mc_kernel_t *kernel;
+                hb_mc_eva_t args_eva;     //!< device copy of kernel->argv while launched
+                uint32_t args_chunk;      //!< argument arena chunk that holds args_eva
         } hb_mc_tile_group_t;
 
 
@@ -102,10 +115,49 @@ extern "C" {
         } hb_mc_mesh_t;
 
 
+        typedef struct {
+                uint64_t size;                  //!< bytes managed by the allocator
+                uint64_t free_size;             //!< bytes not allocated
+                uint64_t peak_used;             //!< most bytes ever allocated at once
+                uint64_t largest_free_block;    //!< largest allocation that can currently succeed
+                uint64_t num_free_blocks;       //!< number of free blocks
+                uint64_t free_block_histogram[HB_MC_DEVICE_MEMORY_HISTOGRAM_BINS]; //!< bin i counts free blocks of [2^i, 2^(i+1)) bytes
+                uint64_t num_live_buffers;      //!< number of allocated buffers
+                uint64_t num_allocs;            //!< successful allocations
+                uint64_t num_failed_allocs;     //!< allocations that failed for lack of a large enough free block
+                uint64_t num_frees;             //!< buffers freed
+                uint64_t alloc_ns;              //!< total time spent allocating, in nanoseconds
+                uint64_t free_ns;               //!< total time spent freeing, in nanoseconds
+        } hb_mc_device_memory_stats_t;
+
+
+        typedef struct {
+                hb_mc_eva_t eva;          //!< base of the chunk in device DRAM
+                uint32_t size;            //!< size of the chunk in bytes, 0 if the slot is unused
+                uint32_t used;            //!< bytes handed out since the chunk was last drained
+                uint32_t live;            //!< launched tile groups with arguments in the chunk
+        } hb_mc_args_chunk_t;
+
+
+        /*
+          Kernel arguments are bump-allocated out of device-side chunks,
+          one chunk per wave of launches. A chunk is drained once every
+          tile group that took arguments from it has finished, and is
+          then reused by the next wave (or freed if another drained chunk
+          is already being kept).
+        */
+        typedef struct {
+                hb_mc_args_chunk_t *chunks;
+                uint32_t num_chunks;
+        } hb_mc_args_arena_t;
+
+
         typedef struct {
                 hb_mc_allocator_id_t id;
                 const char *name; 
                 void *memory_manager;
+                uint32_t stagger_channel; //!< DRAM channel the next staggered buffer starts on
+                hb_mc_args_arena_t args_arena; //!< device memory for kernel arguments
         } hb_mc_allocator_t;
 
 
@@ -113,6 +165,7 @@ extern "C" {
                 const char* bin_name;
                 const unsigned char* bin;
                 size_t bin_size;
+                hb_mc_loader_symbols_t *symbols; //!< symbol index of bin, built once at load
                 hb_mc_allocator_t *allocator;
         } hb_mc_program_t;
 
@@ -125,9 +178,23 @@ extern "C" {
                 uint32_t num_tile_groups;
                 uint32_t tile_group_capacity;
                 uint8_t num_grids;
+                hb_mc_loader_resident_t *resident; //!< image left by the last incremental program load
         } hb_mc_device_t; 
 
 
+        /*
+          DRAM is interleaved across victim cache columns (channels) every
+          vcache stripe. Placement lets buffers that are used together start
+          on different channels instead of all starting wherever the
+          allocator puts them.
+        */
+        typedef enum {
+                HB_MC_DEVICE_MALLOC_ANYWHERE = 0, //!< no constraint; same as hb_mc_device_malloc()
+                HB_MC_DEVICE_MALLOC_CHANNEL  = 1, //!< start on the given channel
+                HB_MC_DEVICE_MALLOC_STAGGER  = 2, //!< start one channel after the previous staggered buffer
+        } hb_mc_device_malloc_placement_t;
+
+
         enum hb_mc_memcpy_kind {
                 HB_MC_MEMCPY_TO_DEVICE = 0,
                 HB_MC_MEMCPY_TO_HOST = 1,
@@ -229,6 +296,100 @@ extern "C" {
 
 
 
+        /**
+         * Allocates memory on device DRAM and tags it with the name of its user.
+         * The tag shows up in hb_mc_device_memory_dump(); hb_mc_device_malloc()
+         * tags buffers with the file and line it was called from.
+         * @param[in]  device        Pointer to device
+         * @parma[in]  size          Size of requested memory
+         * @param[in]  tag           A string that outlives the buffer, e.g. a literal or __func__
+         * @param[out] eva           Eva address of the allocated memory
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_malloc_tagged (hb_mc_device_t *device,
+                                        uint32_t size,
+                                        const char *tag,
+                                        hb_mc_eva_t *eva);
+
+#define HB_MC_DEVICE_CALL_SITE_LINE(line) #line
+#define HB_MC_DEVICE_CALL_SITE(line) __FILE__ ":" HB_MC_DEVICE_CALL_SITE_LINE(line)
+
+        /* tag every hb_mc_device_malloc() buffer with its call site */
+#define hb_mc_device_malloc(device, size, eva)                          \
+        hb_mc_device_malloc_tagged(device, size, HB_MC_DEVICE_CALL_SITE(__LINE__), eva)
+
+
+
+
+
+        /**
+         * Allocates memory on device DRAM starting on a chosen DRAM channel.
+         * hb_mc_device_program_init() or hb_mc_device_program_init_binary() should
+         * have been called before calling this function to set up a memory allocator.
+         * Channel placements fail with HB_MC_INVALID if the DRAM stripe is smaller
+         * than HB_MC_DEVICE_MALLOC_ALIGNMENT.
+         * @param[in]  device        Pointer to device
+         * @parma[in]  size          Size of requested memory
+         * @param[in]  placement     How to pick the channel the buffer starts on
+         * @param[in]  channel       Starting channel for HB_MC_DEVICE_MALLOC_CHANNEL; ignored otherwise
+         * @param[out] eva           Eva address of the allocated memory
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_malloc_placed (hb_mc_device_t *device,
+                                        uint32_t size,
+                                        hb_mc_device_malloc_placement_t placement,
+                                        hb_mc_idx_t channel,
+                                        hb_mc_eva_t *eva);
+
+        /**
+         * Allocates memory on device DRAM starting on a chosen DRAM channel and
+         * tags it with the name of its user, like hb_mc_device_malloc_tagged().
+         * hb_mc_device_malloc_placed() tags buffers with the file and line it was called from.
+         * @param[in]  device        Pointer to device
+         * @parma[in]  size          Size of requested memory
+         * @param[in]  placement     How to pick the channel the buffer starts on
+         * @param[in]  channel       Starting channel for HB_MC_DEVICE_MALLOC_CHANNEL; ignored otherwise
+         * @param[in]  tag           A string that outlives the buffer, e.g. a literal or __func__
+         * @param[out] eva           Eva address of the allocated memory
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_malloc_placed_tagged (hb_mc_device_t *device,
+                                               uint32_t size,
+                                               hb_mc_device_malloc_placement_t placement,
+                                               hb_mc_idx_t channel,
+                                               const char *tag,
+                                               hb_mc_eva_t *eva);
+
+        /* tag every hb_mc_device_malloc_placed() buffer with its call site */
+#define hb_mc_device_malloc_placed(device, size, placement, channel, eva) \
+        hb_mc_device_malloc_placed_tagged(device, size, placement, channel, \
+                                          HB_MC_DEVICE_CALL_SITE(__LINE__), eva)
+
+
+
+
+
+        /**
+         * Gets the DRAM channels that a device buffer covers.
+         * @param[in]  device        Pointer to device
+         * @param[in]  eva           Eva address of the buffer
+         * @parma[in]  size          Size of the buffer in bytes
+         * @param[out] channels      Set to a mask with bit c set if the buffer touches channel c
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_get_dram_channels (hb_mc_device_t *device,
+                                            hb_mc_eva_t eva,
+                                            uint32_t size,
+                                            uint64_t *channels);
+
+
+
+
+
         /**
          * Copies a buffer from src on the host/device DRAM to dst on device DRAM/host.
          * @param[in]  device        Pointer to device
@@ -282,6 +443,36 @@ extern "C" {
 
 
 
+        /**
+         * Gets usage and fragmentation statistics of the device DRAM allocator.
+         * An allocation of up to largest_free_block bytes will succeed;
+         * when that is much smaller than free_size, DRAM is fragmented.
+         * @param[in]  device        Pointer to device
+         * @param[out] stats         Set to the allocator's statistics
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_get_memory_stats (hb_mc_device_t *device,
+                                           hb_mc_device_memory_stats_t *stats);
+
+
+
+
+
+        /**
+         * Prints a summary of the device DRAM allocator followed by every
+         * allocated buffer, in address order, with its size and tag.
+         * @param[in]  device        Pointer to device
+         * @param[in]  fp            Stream to print to
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_memory_dump (hb_mc_device_t *device, FILE *fp);
+
+
+
+
+
         /**
          * Enqueues and schedules a kernel to be run on device
          * Takes the grid size, tile group dimensions, kernel name, argc,
@@ -317,6 +508,17 @@ extern "C" {
         __attribute__((warn_unused_result))
         int hb_mc_device_tile_groups_execute (hb_mc_device_t *device);
 
+        /**
+         * Like hb_mc_device_tile_groups_execute(), but gives up if no
+         * launched tile group finishes within a timeout.
+         * @param[in]  device        Pointer to device
+         * @param[in]  timeout       Microseconds to wait for each tile group to finish and for each
+         *                           transfer that launches one, or -1 to wait forever
+         * @return HB_MC_SUCCESS if succesful, HB_MC_TIMEOUT if a wait timed out. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_tile_groups_execute_timeout (hb_mc_device_t *device, long timeout);
+
 
 
 
@@ -0,0 +1,510 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore_device_set.h>
+#include <bsg_manycore_cuda.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_errno.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+
+/*
+  Each device in a set is confined to one worker thread: every call into
+  the CUDA-Lite API for device d, and so every transfer on its manycore,
+  runs on worker d. A set operation posts one job per device, then waits
+  until all of them have run.
+*/
+
+typedef struct hb_mc_device_set_worker {
+        std::thread thread;
+        std::function<int(void)> job;
+        bool busy;
+        int result;
+} hb_mc_device_set_worker_t;
+
+typedef struct hb_mc_device_set_private {
+        std::mutex lock;
+        std::condition_variable post; //!< signalled when jobs are posted or workers should exit
+        std::condition_variable done; //!< signalled when the last pending job finishes
+        hb_mc_device_set_worker_t workers[HB_MC_DEVICE_SET_MAX_DEVICES];
+        uint32_t num_workers;
+        uint32_t pending;
+        bool exit;
+} hb_mc_device_set_private_t;
+
+typedef std::function<int(hb_mc_device_t *device, uint32_t d)> hb_mc_device_set_job_t;
+
+static void hb_mc_device_set_worker_main(hb_mc_device_set_private_t *pdata, uint32_t d)
+{
+        hb_mc_device_set_worker_t *worker = &pdata->workers[d];
+        std::unique_lock<std::mutex> lk(pdata->lock);
+
+        while (true) {
+                pdata->post.wait(lk, [=] { return worker->busy || pdata->exit; });
+                if (!worker->busy)
+                        return;
+
+                std::function<int(void)> job = std::move(worker->job);
+                lk.unlock();
+                int result = job();
+                lk.lock();
+
+                worker->result = result;
+                worker->busy = false;
+                if (--pdata->pending == 0)
+                        pdata->done.notify_all();
+        }
+}
+
+/* stop and join all worker threads and free the private data */
+static void hb_mc_device_set_stop_workers(hb_mc_device_set_t *set)
+{
+        hb_mc_device_set_private_t *pdata = (hb_mc_device_set_private_t*)set->private_data;
+
+        if (!pdata)
+                return;
+
+        {
+                std::lock_guard<std::mutex> guard(pdata->lock);
+                pdata->exit = true;
+        }
+        pdata->post.notify_all();
+
+        for (uint32_t d = 0; d < pdata->num_workers; d++)
+                pdata->workers[d].thread.join();
+
+        delete pdata;
+        set->private_data = nullptr;
+}
+
+/* start one worker thread per device */
+static int hb_mc_device_set_start_workers(hb_mc_device_set_t *set)
+{
+        hb_mc_device_set_private_t *pdata = new (std::nothrow) hb_mc_device_set_private_t();
+        if (!pdata) {
+                bsg_pr_err("%s: failed to allocate device set private data.\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        set->private_data = pdata;
+        for (uint32_t d = 0; d < set->num_devices; d++) {
+                try {
+                        pdata->workers[d].thread = std::thread(hb_mc_device_set_worker_main, pdata, d);
+                } catch (const std::system_error &e) {
+                        bsg_pr_err("%s: failed to start worker for device %u: %s\n",
+                                   __func__, d, e.what());
+                        hb_mc_device_set_stop_workers(set);
+                        return HB_MC_FAIL;
+                }
+                pdata->num_workers++;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Run a job for every device in a set, each on the device's own worker thread.
+ * @param[in]  set   An initialized device set
+ * @param[in]  job   Called once per device with the device and its index
+ * @param[in]  what  Description of the job, for error messages
+ * @return HB_MC_SUCCESS if every job succeeded. Otherwise the first error is returned.
+ */
+static int hb_mc_device_set_run(hb_mc_device_set_t *set,
+                                const hb_mc_device_set_job_t &job,
+                                const char *what)
+{
+        hb_mc_device_set_private_t *pdata = (hb_mc_device_set_private_t*)set->private_data;
+        int r = HB_MC_SUCCESS;
+
+        if (!pdata) {
+                bsg_pr_err("%s: device set not initialized.\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        std::unique_lock<std::mutex> lk(pdata->lock);
+        for (uint32_t d = 0; d < set->num_devices; d++) {
+                hb_mc_device_t *device = &set->devices[d];
+                pdata->workers[d].job = [=, &job] { return job(device, d); };
+                pdata->workers[d].busy = true;
+        }
+        pdata->pending = set->num_devices;
+        pdata->post.notify_all();
+        pdata->done.wait(lk, [=] { return pdata->pending == 0; });
+
+        for (uint32_t d = 0; d < set->num_devices; d++) {
+                int err = pdata->workers[d].result;
+                if (err == HB_MC_SUCCESS)
+                        continue;
+
+                bsg_pr_err("%s: device %u failed to %s: %s\n",
+                           __func__, d, what, hb_mc_strerror(err));
+                if (r == HB_MC_SUCCESS)
+                        r = err;
+        }
+
+        return r;
+}
+
+/**
+ * Initialize a device set with one manycore per ID.
+ * @param[in]  set          A device set to initialize
+ * @param[in]  name         Device set name; device d is named name.d
+ * @param[in]  ids          Manycore IDs, one per device
+ * @param[in]  num_devices  Number of entries in #ids, at most HB_MC_DEVICE_SET_MAX_DEVICES
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_init(hb_mc_device_set_t *set,
+                          const char *name,
+                          const hb_mc_manycore_id_t *ids,
+                          uint32_t num_devices)
+{
+        int err;
+
+        if (!set || !name || !ids ||
+            num_devices == 0 || num_devices > HB_MC_DEVICE_SET_MAX_DEVICES) {
+                bsg_pr_err("%s: invalid arguments.\n", __func__);
+                return HB_MC_INVALID;
+        }
+
+        memset(set->devices, 0, sizeof(set->devices));
+        set->num_devices = num_devices;
+        set->private_data = nullptr;
+
+        err = hb_mc_device_set_start_workers(set);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = hb_mc_device_set_run(set, [=](hb_mc_device_t *device, uint32_t d) {
+                        char device_name[256];
+                        snprintf(device_name, sizeof(device_name), "%s.%u", name, d);
+                        return hb_mc_device_init(device, device_name, ids[d]);
+                }, "initialize");
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        return HB_MC_SUCCESS;
+
+cleanup:
+        // finish the devices that did come up, each on its own worker;
+        // a device that failed to initialize has already cleaned up after itself
+        hb_mc_device_set_run(set, [](hb_mc_device_t *device, uint32_t d) {
+                        int r = HB_MC_SUCCESS;
+                        if (device->mc)
+                                r = hb_mc_device_finish(device);
+                        // finish leaves the manycore behind if it fails early
+                        free(device->mc);
+                        device->mc = nullptr;
+                        return r;
+                }, "clean up");
+        hb_mc_device_set_stop_workers(set);
+        return err;
+}
+
+/**
+ * Load a program binary from a buffer onto every device in a set.
+ * @param[in]  set           An initialized device set
+ * @param[in]  bin_name      Name of binary elf file
+ * @param[in]  bin_data      Buffer containing binary
+ * @param[in]  bin_size      Size of the binary
+ * @param[in]  alloc_name    Unique name of program's memory allocator
+ * @param[in]  id            Id of program's memory allocator
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_program_init_binary(hb_mc_device_set_t *set,
+                                         const char *bin_name,
+                                         const unsigned char *bin_data,
+                                         size_t bin_size,
+                                         const char *alloc_name,
+                                         hb_mc_allocator_id_t id)
+{
+        return hb_mc_device_set_run(set, [=](hb_mc_device_t *device, uint32_t d) {
+                        return hb_mc_device_program_init_binary(device, bin_name,
+                                                                bin_data, bin_size,
+                                                                alloc_name, id);
+                }, "load program");
+}
+
+/**
+ * Load a program binary from a file onto every device in a set.
+ * @param[in]  set           An initialized device set
+ * @param[in]  bin_name      Name of binary elf file
+ * @param[in]  alloc_name    Unique name of program's memory allocator
+ * @param[in]  id            Id of program's memory allocator
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_program_init(hb_mc_device_set_t *set,
+                                  const char *bin_name,
+                                  const char *alloc_name,
+                                  hb_mc_allocator_id_t id)
+{
+        unsigned char *bin_data;
+        size_t bin_size;
+        int err;
+
+        // read the file once and share it between devices
+        err = hb_mc_loader_read_program_file(bin_name, &bin_data, &bin_size);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read binary file.\n", __func__);
+                return err;
+        }
+
+        err = hb_mc_device_set_program_init_binary(set, bin_name, bin_data, bin_size,
+                                                   alloc_name, id);
+        free(bin_data);
+        return err;
+}
+
+/**
+ * Allocate a buffer sharded across the DRAM of every device in a set.
+ * @param[in]  set     A device set with a program loaded
+ * @param[in]  size    Size of the buffer in bytes
+ * @param[out] buffer  Set to the shards of the buffer
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_malloc(hb_mc_device_set_t *set,
+                            uint32_t size,
+                            hb_mc_device_set_buffer_t *buffer)
+{
+        int err;
+
+        if (!set || !buffer || set->num_devices == 0)
+                return HB_MC_INVALID;
+
+        // split the buffer into word-aligned slices, the last one may be short;
+        // work in 64 bits so that sizes close to 4GB do not wrap
+        uint64_t words = ((uint64_t)size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+        uint64_t shard = ((words + set->num_devices - 1) / set->num_devices) * sizeof(uint32_t);
+
+        memset(buffer, 0, sizeof(*buffer));
+        buffer->total_size = size;
+        for (uint32_t d = 0; d < set->num_devices; d++) {
+                uint32_t offset = std::min<uint64_t>(d * shard, size);
+                buffer->offset[d] = offset;
+                buffer->size[d] = std::min<uint64_t>(shard, size - offset);
+        }
+
+        err = hb_mc_device_set_run(set, [=](hb_mc_device_t *device, uint32_t d) {
+                        if (buffer->size[d] == 0)
+                                return HB_MC_SUCCESS;
+
+                        int r = hb_mc_device_malloc_tagged(device, buffer->size[d], "device set buffer",
+                                                           &buffer->eva[d]);
+                        if (r != HB_MC_SUCCESS)
+                                buffer->size[d] = 0; // nothing to free on this device
+                        return r;
+                }, "allocate buffer");
+        if (err != HB_MC_SUCCESS) {
+                // free the shards that were allocated
+                if (hb_mc_device_set_free(set, buffer) != HB_MC_SUCCESS)
+                        bsg_pr_err("%s: failed to free partial buffer.\n", __func__);
+                return err;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Free a buffer allocated with hb_mc_device_set_malloc().
+ * @param[in]  set     A device set with a program loaded
+ * @param[in]  buffer  A sharded buffer
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_free(hb_mc_device_set_t *set,
+                          const hb_mc_device_set_buffer_t *buffer)
+{
+        if (!set || !buffer)
+                return HB_MC_INVALID;
+
+        return hb_mc_device_set_run(set, [=](hb_mc_device_t *device, uint32_t d) {
+                        if (buffer->size[d] == 0)
+                                return HB_MC_SUCCESS;
+
+                        return hb_mc_device_free(device, buffer->eva[d]);
+                }, "free buffer");
+}
+
+/**
+ * Copy a whole sharded buffer to or from host memory.
+ * @param[in]  set     A device set with a program loaded
+ * @param[in]  buffer  A sharded buffer
+ * @param[in]  host    Host memory of buffer->total_size bytes
+ * @param[in]  kind    HB_MC_MEMCPY_TO_DEVICE or HB_MC_MEMCPY_TO_HOST
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_memcpy(hb_mc_device_set_t *set,
+                            const hb_mc_device_set_buffer_t *buffer,
+                            void *host,
+                            enum hb_mc_memcpy_kind kind)
+{
+        if (!set || !buffer || !host)
+                return HB_MC_INVALID;
+
+        if (kind != HB_MC_MEMCPY_TO_DEVICE && kind != HB_MC_MEMCPY_TO_HOST) {
+                bsg_pr_err("%s: invalid copy type.\n", __func__);
+                return HB_MC_INVALID;
+        }
+
+        return hb_mc_device_set_run(set, [=](hb_mc_device_t *device, uint32_t d) {
+                        if (buffer->size[d] == 0)
+                                return HB_MC_SUCCESS;
+
+                        unsigned char *h = (unsigned char*)host + buffer->offset[d];
+                        void *eva = reinterpret_cast<void*>((uintptr_t)buffer->eva[d]);
+                        if (kind == HB_MC_MEMCPY_TO_DEVICE)
+                                return hb_mc_device_memcpy(device, eva, h, buffer->size[d], kind);
+                        else
+                                return hb_mc_device_memcpy(device, h, eva, buffer->size[d], kind);
+                }, "copy buffer");
+}
+
+/**
+ * Set every byte of a sharded buffer to a value.
+ * @param[in]  set     A device set with a program loaded
+ * @param[in]  buffer  A sharded buffer
+ * @param[in]  val     Value to write
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_memset(hb_mc_device_set_t *set,
+                            const hb_mc_device_set_buffer_t *buffer,
+                            uint8_t val)
+{
+        if (!set || !buffer)
+                return HB_MC_INVALID;
+
+        return hb_mc_device_set_run(set, [=](hb_mc_device_t *device, uint32_t d) {
+                        if (buffer->size[d] == 0)
+                                return HB_MC_SUCCESS;
+
+                        return hb_mc_device_memset(device, &buffer->eva[d], val, buffer->size[d]);
+                }, "set buffer");
+}
+
+/**
+ * Get the part of a grid that runs on one device of a set.
+ * @param[in]  set       An initialized device set
+ * @param[in]  grid_dim  Dimensions of the whole grid
+ * @param[in]  device    Index of a device in the set
+ * @param[out] shard     Set to the device's shard of the grid
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_get_grid_shard(const hb_mc_device_set_t *set,
+                                    hb_mc_dimension_t grid_dim,
+                                    uint32_t device,
+                                    hb_mc_device_set_grid_shard_t *shard)
+{
+        if (!set || !shard || device >= set->num_devices)
+                return HB_MC_INVALID;
+
+        // the first (columns % devices) devices take one extra column
+        uint32_t columns = hb_mc_dimension_get_x(grid_dim);
+        uint32_t base = columns / set->num_devices;
+        uint32_t extra = columns % set->num_devices;
+        uint32_t x = device * base + std::min(device, extra);
+        uint32_t w = base + (device < extra ? 1 : 0);
+
+        shard->origin = hb_mc_coordinate(x, 0);
+        shard->dim = hb_mc_dimension(w, w ? hb_mc_dimension_get_y(grid_dim) : 0);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Enqueue a grid sharded across every device in a set.
+ * @param[in]  set       A device set with a program loaded
+ * @param[in]  grid_dim  X/Y dimensions of the whole grid
+ * @param[in]  tg_dim    X/Y dimensions of tile groups in grid
+ * @param[in]  name      Kernel name to be executed on tile groups in grid
+ * @param[in]  argc      Number of input arguments to kernel
+ * @param[in]  argv      One list of #argc arguments per device
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_kernel_enqueue(hb_mc_device_set_t *set,
+                                    hb_mc_dimension_t grid_dim,
+                                    hb_mc_dimension_t tg_dim,
+                                    const char *name,
+                                    uint32_t argc,
+                                    const uint32_t *const *argv)
+{
+        if (!set || !name || !argv)
+                return HB_MC_INVALID;
+
+        return hb_mc_device_set_run(set, [=](hb_mc_device_t *device, uint32_t d) {
+                        hb_mc_device_set_grid_shard_t shard;
+                        int err = hb_mc_device_set_get_grid_shard(set, grid_dim, d, &shard);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+
+                        if (hb_mc_dimension_get_x(shard.dim) == 0)
+                                return HB_MC_SUCCESS;
+
+                        return hb_mc_kernel_enqueue(device, shard.dim, tg_dim, name, argc, argv[d]);
+                }, "enqueue kernel");
+}
+
+/**
+ * Run all enqueued tile groups on every device in a set.
+ * @param[in]  set  A device set with a program loaded
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_tile_groups_execute(hb_mc_device_set_t *set)
+{
+        if (!set)
+                return HB_MC_INVALID;
+
+        return hb_mc_device_set_run(set, [](hb_mc_device_t *device, uint32_t d) {
+                        return hb_mc_device_tile_groups_execute(device);
+                }, "execute tile groups");
+}
+
+/**
+ * Finish every device in a set and stop its host threads.
+ * @param[in]  set  A device set with a program loaded
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_finish(hb_mc_device_set_t *set)
+{
+        int err;
+
+        if (!set)
+                return HB_MC_INVALID;
+
+        err = hb_mc_device_set_run(set, [](hb_mc_device_t *device, uint32_t d) {
+                        return hb_mc_device_finish(device);
+                }, "finish");
+
+        hb_mc_device_set_stop_workers(set);
+        return err;
+}
@@ -0,0 +1,230 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BSG_MANYCORE_DEVICE_SET_H
+#define BSG_MANYCORE_DEVICE_SET_H
+
+#include <bsg_manycore_features.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_cuda.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_coordinate.h>
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+        /*
+          A device set drives several manycores (one per FPGA) as one
+          CUDA-Lite device. Each manycore in the set is an hb_mc_device_t
+          owned by a host thread of its own; every operation on the set is
+          handed to all of those threads and returns once all of them have
+          finished, with the first error any of them reported.
+
+          Buffers allocated on a set are sharded: device d holds a
+          contiguous, word-aligned slice of the buffer. Grids enqueued on a
+          set are split into contiguous ranges of grid columns, one per
+          device. Tile groups see only their device's slice of the grid, so
+          kernels that need global indices should be passed the shard
+          origin from hb_mc_device_set_get_grid_shard().
+        */
+
+#define HB_MC_DEVICE_SET_MAX_DEVICES 8
+
+        typedef struct {
+                hb_mc_device_t devices[HB_MC_DEVICE_SET_MAX_DEVICES]; //!< one CUDA-Lite device per manycore
+                uint32_t num_devices;                                 //!< devices in use
+                void *private_data;                                   //!< implementation private data
+        } hb_mc_device_set_t;
+
+        typedef struct {
+                hb_mc_eva_t eva[HB_MC_DEVICE_SET_MAX_DEVICES];  //!< base of each device's shard
+                uint32_t offset[HB_MC_DEVICE_SET_MAX_DEVICES];  //!< byte offset of each shard in the buffer
+                uint32_t size[HB_MC_DEVICE_SET_MAX_DEVICES];    //!< bytes in each shard; 0 if the device holds none
+                uint32_t total_size;                            //!< size of the whole buffer in bytes
+        } hb_mc_device_set_buffer_t;
+
+        typedef struct {
+                hb_mc_coordinate_t origin;  //!< first tile group of the shard in the full grid
+                hb_mc_dimension_t dim;      //!< tile groups in the shard; 0 wide if the device runs none
+        } hb_mc_device_set_grid_shard_t;
+
+        /**
+         * Initialize a device set with one manycore per ID.
+         * @param[in]  set          A device set to initialize
+         * @param[in]  name         Device set name; device d is named name.d
+         * @param[in]  ids          Manycore IDs, one per device
+         * @param[in]  num_devices  Number of entries in #ids, at most HB_MC_DEVICE_SET_MAX_DEVICES
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_init(hb_mc_device_set_t *set,
+                                  const char *name,
+                                  const hb_mc_manycore_id_t *ids,
+                                  uint32_t num_devices);
+
+        /**
+         * Load a program binary from a buffer onto every device in a set.
+         * @param[in]  set           An initialized device set
+         * @param[in]  bin_name      Name of binary elf file
+         * @param[in]  bin_data      Buffer containing binary
+         * @param[in]  bin_size      Size of the binary
+         * @param[in]  alloc_name    Unique name of program's memory allocator
+         * @param[in]  id            Id of program's memory allocator
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_program_init_binary(hb_mc_device_set_t *set,
+                                                 const char *bin_name,
+                                                 const unsigned char *bin_data,
+                                                 size_t bin_size,
+                                                 const char *alloc_name,
+                                                 hb_mc_allocator_id_t id);
+
+        /**
+         * Load a program binary from a file onto every device in a set.
+         * @param[in]  set           An initialized device set
+         * @param[in]  bin_name      Name of binary elf file
+         * @param[in]  alloc_name    Unique name of program's memory allocator
+         * @param[in]  id            Id of program's memory allocator
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_program_init(hb_mc_device_set_t *set,
+                                          const char *bin_name,
+                                          const char *alloc_name,
+                                          hb_mc_allocator_id_t id);
+
+        /**
+         * Allocate a buffer sharded across the DRAM of every device in a set.
+         * @param[in]  set     A device set with a program loaded
+         * @param[in]  size    Size of the buffer in bytes
+         * @param[out] buffer  Set to the shards of the buffer
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_malloc(hb_mc_device_set_t *set,
+                                    uint32_t size,
+                                    hb_mc_device_set_buffer_t *buffer);
+
+        /**
+         * Free a buffer allocated with hb_mc_device_set_malloc().
+         * @param[in]  set     A device set with a program loaded
+         * @param[in]  buffer  A sharded buffer
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_free(hb_mc_device_set_t *set,
+                                  const hb_mc_device_set_buffer_t *buffer);
+
+        /**
+         * Copy a whole sharded buffer to or from host memory.
+         * All devices copy their shards concurrently. As with hb_mc_device_memcpy(),
+         * #host must be 32-bit aligned and the buffer size a multiple of 4 bytes.
+         * @param[in]  set     A device set with a program loaded
+         * @param[in]  buffer  A sharded buffer
+         * @param[in]  host    Host memory of buffer->total_size bytes
+         * @param[in]  kind    HB_MC_MEMCPY_TO_DEVICE or HB_MC_MEMCPY_TO_HOST
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_memcpy(hb_mc_device_set_t *set,
+                                    const hb_mc_device_set_buffer_t *buffer,
+                                    void *host,
+                                    enum hb_mc_memcpy_kind kind);
+
+        /**
+         * Set every byte of a sharded buffer to a value.
+         * @param[in]  set     A device set with a program loaded
+         * @param[in]  buffer  A sharded buffer
+         * @param[in]  val     Value to write
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_memset(hb_mc_device_set_t *set,
+                                    const hb_mc_device_set_buffer_t *buffer,
+                                    uint8_t val);
+
+        /**
+         * Get the part of a grid that runs on one device of a set.
+         * @param[in]  set       An initialized device set
+         * @param[in]  grid_dim  Dimensions of the whole grid
+         * @param[in]  device    Index of a device in the set
+         * @param[out] shard     Set to the device's shard of the grid
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_get_grid_shard(const hb_mc_device_set_t *set,
+                                            hb_mc_dimension_t grid_dim,
+                                            uint32_t device,
+                                            hb_mc_device_set_grid_shard_t *shard);
+
+        /**
+         * Enqueue a grid sharded across every device in a set.
+         * @param[in]  set       A device set with a program loaded
+         * @param[in]  grid_dim  X/Y dimensions of the whole grid
+         * @param[in]  tg_dim    X/Y dimensions of tile groups in grid
+         * @param[in]  name      Kernel name to be executed on tile groups in grid
+         * @param[in]  argc      Number of input arguments to kernel
+         * @param[in]  argv      One list of #argc arguments per device
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_kernel_enqueue(hb_mc_device_set_t *set,
+                                            hb_mc_dimension_t grid_dim,
+                                            hb_mc_dimension_t tg_dim,
+                                            const char *name,
+                                            uint32_t argc,
+                                            const uint32_t *const *argv);
+
+        /**
+         * Run all enqueued tile groups on every device in a set.
+         * Returns once every device has finished all of its tile groups.
+         * @param[in]  set  A device set with a program loaded
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_tile_groups_execute(hb_mc_device_set_t *set);
+
+        /**
+         * Finish every device in a set and stop its host threads.
+         * @param[in]  set  A device set with a program loaded
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_finish(hb_mc_device_set_t *set);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
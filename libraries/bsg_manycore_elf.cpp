@@ -47,139 +47,142 @@
 #endif
 
 #include <unistd.h>
-#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
 
-#include <map>
+#include <bsg_manycore_loader.h>
+
+#include <mutex>
 #include <string>
-#include <memory>
-
-using std::string;
-using std::map;
-using std::unique_ptr;
-
-struct SymbolInfo {        
-        char * name;
-        Elf32_Addr   value;
-        Elf32_Word   size;
-        SymbolInfo(const char*name, Elf32_Addr value, Elf32_Word size):
-                name(strdup(name)),
-                value(value),
-                size(size) {}
-        virtual ~SymbolInfo() { free(name); }
+#include <unordered_map>
+#include <new>
+
+/*
+  symbol_to_eva() is called with the same binary over and over, so each
+  binary's symbols are indexed once and cached for the life of the
+  process. An entry is rebuilt when the file at its path is replaced or
+  modified, as detected by its device, inode, size, and mtime.
+*/
+struct object_symbol_cache_entry {
+        dev_t dev;
+        ino_t ino;
+        off_t size;
+        struct timespec mtime;
+        hb_mc_loader_symbols_t *symbols;
+
+        object_symbol_cache_entry() : symbols(nullptr) {}
+        ~object_symbol_cache_entry() { hb_mc_loader_symbols_exit(symbols); }
+        object_symbol_cache_entry(const object_symbol_cache_entry &) = delete;
+        object_symbol_cache_entry & operator=(const object_symbol_cache_entry &) = delete;
 };
 
-typedef unique_ptr<SymbolInfo> SymbolInfoPtr;
-typedef map<string, SymbolInfoPtr> symbol_table;
-
+static std::mutex object_symbol_cache_lock;
+static std::unordered_map<std::string, object_symbol_cache_entry> object_symbol_cache;
 
-
-static int object_symbol_table_import_symbols(symbol_table& symbols, unsigned char *object_data, Elf32_Shdr *symtab_shdr, Elf32_Shdr *strtab_shdr)
+static bool object_symbol_cache_entry_is_stale(const object_symbol_cache_entry &entry,
+                                               const struct stat &st)
 {
-        Elf32_Word sym_n = symtab_shdr->sh_size/symtab_shdr->sh_entsize;
-        Elf32_Word sym_i;
-        Elf32_Sym *sym, *sym_base = (Elf32_Sym *)&object_data[symtab_shdr->sh_offset];
-        char *strtab_base = (char*) &object_data[strtab_shdr->sh_offset];
-        
-        const char *sym_name;
-        
-        for (sym_i = 0; sym_i < sym_n; sym_i++) {
-                sym = &sym_base[sym_i];
-
-                /* skip symbols with no name */
-                if (sym->st_name == 0)
-                        continue;
-                
-                sym_name = &strtab_base[sym->st_name];
-                
-                SymbolInfo *sym_info = new SymbolInfo(sym_name, sym->st_value, sym->st_size);
-                
-                symbols[string(sym_name)] = SymbolInfoPtr(sym_info);
-        }
-        return 0;
+        return entry.symbols == nullptr
+                || entry.dev != st.st_dev
+                || entry.ino != st.st_ino
+                || entry.size != st.st_size
+                || entry.mtime.tv_sec != st.st_mtim.tv_sec
+                || entry.mtime.tv_nsec != st.st_mtim.tv_nsec;
 }
 
-static void object_symbol_table_init(const char *fname, symbol_table& symbols)
+static int object_symbol_cache_entry_init(const char *fname, object_symbol_cache_entry &entry)
 {
-        FILE *f = fopen(fname, "rb");
-        long size;
-        unsigned char *object_data;
-        Elf32_Ehdr *ehdr;
-        Elf32_Shdr *shdr, *symtab_shdr, *strtab_shdr;
-        Elf32_Sym  *sym;
-        int section_i, r;
-        
-        if (!f) {
+        struct stat st;
+        void *object_data;
+        hb_mc_loader_symbols_t *symbols;
+        int fd, rc;
+
+        fd = open(fname, O_RDONLY);
+        if (fd < 0) {
                 bsg_pr_err("%s: failed to open '%s': %s\n", __func__, fname, strerror(errno));
-                goto fail_return;
+                return HB_MC_FAIL;
         }
 
-        fseek(f, 0, SEEK_END);
-        size = ftell(f);
-        if (size < 0) {
+        /* stat the open file so that the entry describes what was indexed */
+        if (fstat(fd, &st) != 0) {
                 bsg_pr_err("%s: failed to stat '%s': %s\n", __func__, fname, strerror(errno));
-                goto fail_close_f;
+                rc = HB_MC_FAIL;
+                goto close_fd;
         }
 
-        object_data = (unsigned char*)malloc(size);
-        if (!object_data) {
-                bsg_pr_err("%s: failed to read '%s': %s\n", __func__, fname, strerror(errno));
-                goto fail_close_f;
+        if (st.st_size == 0) {
+                bsg_pr_err("%s: '%s' is empty\n", __func__, fname);
+                rc = HB_MC_INVALID;
+                goto close_fd;
         }
 
-        fseek(f, 0, SEEK_SET);
-        if ((r = fread(object_data, size, 1, f)) != 1) {
-                bsg_pr_err("%s: failed to read '%s' (fread returned %d): %s\n", __func__, fname, r, strerror(errno));
-                goto fail_free_object_data;
+        object_data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (object_data == MAP_FAILED) {
+                bsg_pr_err("%s: failed to map '%s': %s\n", __func__, fname, strerror(errno));
+                rc = HB_MC_FAIL;
+                goto close_fd;
         }
 
-        /* check that this is indeed an ELF file */
-        if (memcmp(object_data, ELFMAG, SELFMAG) != 0) {
-                bsg_pr_err("%s: '%s' is not a valid ELF file\n", __func__, fname);
-                goto fail_free_object_data;
-        }
-        /* check that this is 32-bit little endian */
-        if (!(object_data[EI_CLASS] == ELFCLASS32  &&
-              object_data[EI_DATA]  == ELFDATA2LSB)) {
-                bsg_pr_err("%s: '%s' is not a 32-bit little endian object file\n", __func__, fname);
-                goto fail_free_object_data;
-        }
-        /* check here for RISC-V? */
-        /* find each section that is a symbol table */
-        ehdr = (Elf32_Ehdr*)object_data;
-        shdr = (Elf32_Shdr*)&object_data[ehdr->e_shoff];
-        for (section_i = 0; section_i < ehdr->e_shnum; section_i++) {
-                // only looking for symbol tables
-                if (shdr[section_i].sh_type != SHT_SYMTAB)
-                        continue;
-                
-                symtab_shdr = &shdr[section_i];
-                strtab_shdr = &shdr[symtab_shdr->sh_link];
-                /* add all symbols to the symbol table */
-                if (object_symbol_table_import_symbols(symbols, object_data, symtab_shdr, strtab_shdr) < 0)
-                        goto fail_free_object_data;
+        /* the index copies symbol names, so the mapping is not kept */
+        rc = hb_mc_loader_symbols_init(object_data, st.st_size, &symbols);
+        munmap(object_data, st.st_size);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: '%s' is not a valid manycore binary: %s\n",
+                           __func__, fname, hb_mc_strerror(rc));
+                goto close_fd;
         }
 
-        free(object_data);
-        fclose(f);
-        return;
-        
- fail_free_object_data:
-        free(object_data);
- fail_close_f:
-        fclose(f);
- fail_return:
-        exit(1);
+        hb_mc_loader_symbols_exit(entry.symbols);
+        entry.symbols = symbols;
+        entry.dev = st.st_dev;
+        entry.ino = st.st_ino;
+        entry.size = st.st_size;
+        entry.mtime = st.st_mtim;
+        rc = HB_MC_SUCCESS;
+
+close_fd:
+        close(fd);
+        return rc;
 }
 
+/**
+ * Get the EVA of a symbol in a binary file.
+ * @param[in]  fname     Path to a manycore binary.
+ * @param[in]  sym_name  A program symbol.
+ * @param[out] eva       An EVA that addresses #sym_name.
+ * @return HB_MC_NOTFOUND if #sym_name is not in the binary. HB_MC_SUCCESS on success.
+ * Otherwise an error code is returned.
+ */
 int symbol_to_eva(const char *fname, const char *sym_name, eva_t* eva)
 {
-        static symbol_table symbols;
-        object_symbol_table_init(fname, symbols);
-        symbol_table::iterator it = symbols.find(string(sym_name));
-        if (it != symbols.end()) {
-                *eva = (it->second->value);
-                return HB_MC_SUCCESS;
-        } else {
+        struct stat st;
+        int rc;
+
+        if (!fname || !sym_name || !eva)
+                return HB_MC_INVALID;
+
+        if (stat(fname, &st) != 0) {
+                bsg_pr_err("%s: failed to stat '%s': %s\n", __func__, fname, strerror(errno));
                 return HB_MC_FAIL;
         }
+
+        std::lock_guard<std::mutex> guard(object_symbol_cache_lock);
+        object_symbol_cache_entry *entry;
+        try {
+                entry = &object_symbol_cache[fname];
+        } catch (const std::bad_alloc &) {
+                return HB_MC_NOMEM;
+        }
+
+        if (object_symbol_cache_entry_is_stale(*entry, st)) {
+                rc = object_symbol_cache_entry_init(fname, *entry);
+                if (rc != HB_MC_SUCCESS) {
+                        object_symbol_cache.erase(fname);
+                        return rc;
+                }
+        }
+
+        return hb_mc_loader_symbols_lookup(entry->symbols, sym_name, eva, NULL);
 }
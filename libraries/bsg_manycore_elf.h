@@ -33,6 +33,18 @@
 extern "C" {
 #endif
 
+        /**
+         * Get the EVA of a symbol in a binary file.
+         * Each binary is indexed once per process; the index is rebuilt if the file changes.
+         * The binary must be a RISC-V executable that hb_mc_loader_symbols_init() accepts.
+         * If a name is defined more than once, the first definition in the symbol table is used.
+         * @param[in]  fname     Path to a manycore binary.
+         * @param[in]  sym_name  A program symbol.
+         * @param[out] eva       An EVA that addresses #sym_name.
+         * @return HB_MC_NOTFOUND if #sym_name is not in the binary. HB_MC_SUCCESS on success.
+         * Otherwise an error code is returned: HB_MC_FAIL if #fname cannot be read,
+         * HB_MC_INVALID if it is not a manycore binary.
+         */
         __attribute__((deprecated))
         int symbol_to_eva(const char *fname, const char *sym_name, eva_t *eva);
 
@@ -0,0 +1,791 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore_emulation.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_fifo.h>
+#include <bsg_manycore_mmio.h>
+#include <bsg_manycore_packet.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_vcache.h>
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#define array_size(x)                           \
+        (sizeof(x)/sizeof(x[0]))
+
+/* Default ROM contents that do not come from hb_mc_emulation_params_t */
+#define EMUL_ROM_VERSION        0x00030000 /* 3.0.0 */
+#define EMUL_ROM_TIMESTAMP      0x01012020 /* month, day, year as BCD nibbles */
+#define EMUL_ROM_GITHASH        0x0000e3e1
+#define EMUL_NETWORK_DATA_WIDTH 32
+
+/* Return packet type of a load response (e_return_int_wb) */
+#define EMUL_RETURN_INT_WB      1
+
+/* Tile memories: 4KB of DMEM and 4KB of ICACHE */
+#define EMUL_TILE_MEM_SIZE      (1 << 12)
+#define EMUL_TILE_CSR_WORDS     5
+
+/* DRAM is allocated on first touch in pages of this size */
+#define EMUL_DRAM_PAGE_LOGSZ    12
+#define EMUL_DRAM_PAGE_SIZE     (1 << EMUL_DRAM_PAGE_LOGSZ)
+
+/* Layout of a global EVA as produced by the default EVA map */
+#define EMUL_GLOBAL_X_BITIDX    HB_MC_EPA_LOGSZ
+#define EMUL_GLOBAL_Y_BITIDX    (EMUL_GLOBAL_X_BITIDX + 6)
+#define EMUL_GLOBAL_BITIDX      (EMUL_GLOBAL_Y_BITIDX + 6)
+#define EMUL_GLOBAL_COORD_MASK  0x3F
+
+#define EMUL_PACKET_WORDS       (sizeof(hb_mc_packet_t)/sizeof(uint32_t))
+
+typedef struct hb_mc_emulation_tile {
+        uint8_t  dmem[EMUL_TILE_MEM_SIZE];
+        uint8_t  icache[EMUL_TILE_MEM_SIZE];
+        uint32_t csr[EMUL_TILE_CSR_WORDS];
+} hb_mc_emulation_tile_t;
+
+typedef struct hb_mc_emulation_inflight {
+        hb_mc_request_packet_t request;
+        uint32_t load_data;
+        uint64_t done_ns;
+} hb_mc_emulation_inflight_t;
+
+/*
+ * State of one AXI FIFO block. The TX side holds words written to TX_DATA
+ * that have not been committed by TX_LENGTH and committed packets that have
+ * not yet been injected into the network. The RX side holds packets for the
+ * host and the number of words of the head packet already read.
+ */
+typedef struct hb_mc_emulation_fifo {
+        std::vector<uint32_t> tx_words;
+        std::deque<hb_mc_packet_t> tx_pending;
+        std::deque<hb_mc_packet_t> rx;
+        uint32_t rx_head_words;
+        uint32_t isr;
+        uint32_t ier;
+} hb_mc_emulation_fifo_t;
+
+struct hb_mc_emulation {
+        hb_mc_manycore_id_t id;
+        hb_mc_emulation_params_t params;
+        unsigned attached; //!< number of manycore handles attached
+        std::mutex lock;
+
+        hb_mc_emulation_fifo_t fifo[HB_MC_MMIO_FIFO_MAX + 1];
+        std::deque<hb_mc_emulation_inflight_t> inflight;
+
+        std::vector<hb_mc_emulation_tile_t> tiles;
+        std::unordered_map<uint64_t, std::vector<uint8_t> > dram;
+        std::unordered_map<uint64_t, uint32_t> tags;
+
+        bool model_kernels;
+        hb_mc_emulation_kernel_symbols_t syms;
+};
+
+static std::mutex emulation_registry_lock;
+static hb_mc_emulation_t *emulation_registry[HB_MC_EMULATION_MAX_DEVICES];
+
+static uint64_t hb_mc_emulation_now_ns(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t hb_mc_emulation_getenv(const char *name, uint32_t dflt)
+{
+        const char *v = getenv(name);
+        if (!v || !*v)
+                return dflt;
+        return (uint32_t)strtoul(v, nullptr, 0);
+}
+
+void hb_mc_emulation_get_default_params(hb_mc_emulation_params_t *params)
+{
+        params->dim_x = hb_mc_emulation_getenv("HB_MC_EMULATION_DIM_X", 4);
+        params->dim_y = hb_mc_emulation_getenv("HB_MC_EMULATION_DIM_Y", 4);
+        params->network_bitwidth_addr = 28;
+        params->vcache_ways = 8;
+        params->vcache_sets = 64;
+        params->vcache_block_words = 16;
+        params->vcache_stripe_words = 16;
+        params->host_credits = HB_MC_MMIO_MAX_CREDITS;
+        params->fifo_words = 256;
+        params->latency_ns = hb_mc_emulation_getenv("HB_MC_EMULATION_LATENCY_NS", 0);
+}
+
+static int hb_mc_emulation_check_params(const hb_mc_emulation_params_t *p)
+{
+        if (p->dim_x < 1 || p->dim_x > EMUL_GLOBAL_COORD_MASK + 1 ||
+            p->dim_y < 1 || p->dim_y + 2 > EMUL_GLOBAL_COORD_MASK + 1) {
+                bsg_pr_err("%s: Invalid dimensions %" PRIu32 "x%" PRIu32 "\n",
+                           __func__, p->dim_x, p->dim_y);
+                return HB_MC_INVALID;
+        }
+
+        if (p->network_bitwidth_addr < 13 ||
+            p->network_bitwidth_addr > HB_MC_CONFIG_MAX_BITWIDTH_ADDR) {
+                bsg_pr_err("%s: Invalid network address width %" PRIu32 "\n",
+                           __func__, p->network_bitwidth_addr);
+                return HB_MC_INVALID;
+        }
+
+        if (p->vcache_block_words == 0 ||
+            p->vcache_stripe_words < p->vcache_block_words) {
+                bsg_pr_err("%s: Invalid victim cache stripe (%" PRIu32 ") "
+                           "or block (%" PRIu32 ") size\n",
+                           __func__, p->vcache_stripe_words, p->vcache_block_words);
+                return HB_MC_INVALID;
+        }
+
+        if (p->host_credits == 0 || p->fifo_words < 2 * EMUL_PACKET_WORDS) {
+                bsg_pr_err("%s: Invalid credits (%" PRIu32 ") or FIFO depth (%" PRIu32 ")\n",
+                           __func__, p->host_credits, p->fifo_words);
+                return HB_MC_INVALID;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* get (or create) the emulated manycore with ID #id; registry lock must be held */
+static int hb_mc_emulation_get(hb_mc_manycore_id_t id, hb_mc_emulation_t **emul)
+{
+        if (id < 0 || id >= HB_MC_EMULATION_MAX_DEVICES) {
+                bsg_pr_err("%s: Invalid manycore ID %d\n", __func__, id);
+                return HB_MC_INVALID;
+        }
+
+        if (emulation_registry[id] == nullptr) {
+                hb_mc_emulation_t *e = new (std::nothrow) hb_mc_emulation_t;
+                if (!e)
+                        return HB_MC_NOMEM;
+
+                e->id = id;
+                e->attached = 0;
+                e->model_kernels = false;
+                hb_mc_emulation_get_default_params(&e->params);
+                emulation_registry[id] = e;
+        }
+
+        *emul = emulation_registry[id];
+        return HB_MC_SUCCESS;
+}
+
+int hb_mc_emulation_set_params(hb_mc_manycore_id_t id,
+                               const hb_mc_emulation_params_t *params)
+{
+        std::lock_guard<std::mutex> guard(emulation_registry_lock);
+        hb_mc_emulation_t *emul;
+        int err;
+
+        if ((err = hb_mc_emulation_check_params(params)) != HB_MC_SUCCESS)
+                return err;
+
+        if ((err = hb_mc_emulation_get(id, &emul)) != HB_MC_SUCCESS)
+                return err;
+
+        if (emul->attached) {
+                bsg_pr_err("%s: Manycore %d is in use\n", __func__, id);
+                return HB_MC_BUSY;
+        }
+
+        // memory from the old geometry is meaningless
+        emul->params = *params;
+        emul->tiles.clear();
+        emul->dram.clear();
+        emul->tags.clear();
+        return HB_MC_SUCCESS;
+}
+
+int hb_mc_emulation_set_kernel_symbols(hb_mc_manycore_id_t id,
+                                       const hb_mc_emulation_kernel_symbols_t *syms)
+{
+        std::lock_guard<std::mutex> guard(emulation_registry_lock);
+        hb_mc_emulation_t *emul;
+        int err;
+
+        if ((err = hb_mc_emulation_get(id, &emul)) != HB_MC_SUCCESS)
+                return err;
+
+        std::lock_guard<std::mutex> emul_guard(emul->lock);
+        if (syms == nullptr) {
+                emul->model_kernels = false;
+                return HB_MC_SUCCESS;
+        }
+
+        const hb_mc_epa_t epas [] = { syms->kernel_ptr, syms->finish_signal_addr,
+                                      syms->finish_signal_val, syms->tile_id };
+        for (unsigned i = 0; i < array_size(epas); i++) {
+                if (epas[i] < HB_MC_TILE_EPA_DMEM_BASE ||
+                    epas[i] + sizeof(uint32_t) > HB_MC_TILE_EPA_DMEM_BASE + EMUL_TILE_MEM_SIZE ||
+                    (epas[i] & 0x3)) {
+                        bsg_pr_err("%s: Symbol EPA 0x%08" PRIx32 " is not a DMEM word\n",
+                                   __func__, epas[i]);
+                        return HB_MC_INVALID;
+                }
+        }
+
+        emul->syms = *syms;
+        emul->model_kernels = true;
+        return HB_MC_SUCCESS;
+}
+
+static void hb_mc_emulation_reset_fifos(hb_mc_emulation_t *emul)
+{
+        for (unsigned dir = HB_MC_MMIO_FIFO_MIN; dir <= HB_MC_MMIO_FIFO_MAX; dir++) {
+                hb_mc_emulation_fifo_t *fifo = &emul->fifo[dir];
+                fifo->tx_words.clear();
+                fifo->tx_pending.clear();
+                fifo->rx.clear();
+                fifo->rx_head_words = 0;
+                fifo->isr = 0;
+                fifo->ier = 0;
+        }
+        emul->inflight.clear();
+}
+
+static void hb_mc_emulation_reset_tiles(hb_mc_emulation_t *emul)
+{
+        size_t n = emul->params.dim_x * emul->params.dim_y;
+        if (emul->tiles.size() == n)
+                return;
+
+        emul->tiles.assign(n, hb_mc_emulation_tile_t());
+        for (auto & tile : emul->tiles) {
+                memset(&tile, 0, sizeof(tile));
+                tile.csr[HB_MC_TILE_EPA_CSR_FREEZE_OFFSET >> 2] = 1;
+        }
+}
+
+int hb_mc_emulation_attach(hb_mc_manycore_id_t id, hb_mc_emulation_t **emul)
+{
+        std::lock_guard<std::mutex> guard(emulation_registry_lock);
+        hb_mc_emulation_t *e;
+        int err;
+
+        if ((err = hb_mc_emulation_get(id, &e)) != HB_MC_SUCCESS)
+                return err;
+
+        // like a PCIe BAR, a device may be attached more than once; all
+        // handles share its state
+        std::lock_guard<std::mutex> emul_guard(e->lock);
+        if (e->attached++ == 0) {
+                hb_mc_emulation_reset_fifos(e);
+                hb_mc_emulation_reset_tiles(e);
+        }
+
+        bsg_pr_dbg("%s: emulating a %" PRIu32 "x%" PRIu32 " manycore as ID %d "
+                   "(latency = %" PRIu64 " ns)\n",
+                   __func__, e->params.dim_x, e->params.dim_y, id, e->params.latency_ns);
+
+        *emul = e;
+        return HB_MC_SUCCESS;
+}
+
+void hb_mc_emulation_detach(hb_mc_emulation_t *emul)
+{
+        std::lock_guard<std::mutex> guard(emulation_registry_lock);
+        std::lock_guard<std::mutex> emul_guard(emul->lock);
+        if (--emul->attached == 0)
+                hb_mc_emulation_reset_fifos(emul);
+}
+
+//////////////////////
+// Network Endpoints //
+//////////////////////
+
+static hb_mc_emulation_tile_t *hb_mc_emulation_get_tile(hb_mc_emulation_t *emul,
+                                                        hb_mc_idx_t x, hb_mc_idx_t y)
+{
+        if (x >= emul->params.dim_x ||
+            y <  HB_MC_CONFIG_VCORE_BASE_Y ||
+            y >= HB_MC_CONFIG_VCORE_BASE_Y + emul->params.dim_y)
+                return nullptr;
+
+        return &emul->tiles[(y - HB_MC_CONFIG_VCORE_BASE_Y) * emul->params.dim_x + x];
+}
+
+static hb_mc_idx_t hb_mc_emulation_get_dram_y(hb_mc_emulation_t *emul)
+{
+        return emul->params.dim_y + 1;
+}
+
+/* returns a pointer to the word at #epa in the endpoint at (#x, #y), or nullptr if unmapped */
+static uint8_t *hb_mc_emulation_get_word(hb_mc_emulation_t *emul,
+                                         hb_mc_idx_t x, hb_mc_idx_t y,
+                                         hb_mc_epa_t epa, bool allocate)
+{
+        static uint8_t zero[sizeof(uint32_t)];
+
+        if (y == hb_mc_emulation_get_dram_y(emul) && x < emul->params.dim_x) {
+                uint64_t dram_size = 1ull << (emul->params.network_bitwidth_addr
+                                              - HB_MC_VCACHE_EPA_RESERVED_BITS
+                                              + 2);
+
+                if (epa & HB_MC_VCACHE_EPA_OFFSET_TAG) {
+                        uint64_t key = ((uint64_t)x << 32) | epa;
+                        return (uint8_t*)&emul->tags[key];
+                }
+
+                if (epa >= dram_size)
+                        return nullptr;
+
+                uint64_t key = ((uint64_t)x << 32) | (epa >> EMUL_DRAM_PAGE_LOGSZ);
+                auto it = emul->dram.find(key);
+                if (it == emul->dram.end()) {
+                        // untouched DRAM reads as zero
+                        if (!allocate) {
+                                memset(zero, 0, sizeof(zero));
+                                return zero;
+                        }
+                        it = emul->dram.emplace(key, std::vector<uint8_t>(EMUL_DRAM_PAGE_SIZE, 0)).first;
+                }
+                return &it->second[epa & (EMUL_DRAM_PAGE_SIZE - 1)];
+        }
+
+        hb_mc_emulation_tile_t *tile = hb_mc_emulation_get_tile(emul, x, y);
+        if (!tile)
+                return nullptr;
+
+        if (epa >= HB_MC_TILE_EPA_DMEM_BASE &&
+            epa <  HB_MC_TILE_EPA_DMEM_BASE + EMUL_TILE_MEM_SIZE)
+                return &tile->dmem[epa - HB_MC_TILE_EPA_DMEM_BASE];
+
+        if (epa >= HB_MC_TILE_EPA_ICACHE_BASE &&
+            epa <  HB_MC_TILE_EPA_ICACHE_BASE + EMUL_TILE_MEM_SIZE)
+                return &tile->icache[epa - HB_MC_TILE_EPA_ICACHE_BASE];
+
+        if (epa >= HB_MC_TILE_EPA_CSR_BASE &&
+            epa <  HB_MC_TILE_EPA_CSR_BASE + sizeof(tile->csr))
+                return (uint8_t*)&tile->csr[(epa - HB_MC_TILE_EPA_CSR_BASE) >> 2];
+
+        return nullptr;
+}
+
+static void hb_mc_emulation_kernel_finish(hb_mc_emulation_t *emul,
+                                          hb_mc_idx_t x, hb_mc_idx_t y,
+                                          hb_mc_emulation_tile_t *tile);
+
+/* perform the memory side effects of a request packet; returns load data */
+static uint32_t hb_mc_emulation_execute(hb_mc_emulation_t *emul, const hb_mc_request_packet_t *rqst)
+{
+        hb_mc_idx_t x = hb_mc_request_packet_get_x_dst(rqst);
+        hb_mc_idx_t y = hb_mc_request_packet_get_y_dst(rqst);
+        hb_mc_epa_t epa = hb_mc_request_packet_get_addr(rqst) << 2;
+        bool store = hb_mc_request_packet_get_op(rqst) == HB_MC_PACKET_OP_REMOTE_STORE;
+        uint8_t *word;
+        uint32_t data;
+
+        word = hb_mc_emulation_get_word(emul, x, y, epa, store);
+        if (!word) {
+                bsg_pr_warn("%s: %s to unmapped address (%" PRIu32 ", %" PRIu32 ") "
+                            "EPA 0x%08" PRIx32 "\n",
+                            __func__, store ? "store" : "load", x, y, epa);
+                return 0;
+        }
+
+        if (!store) {
+                memcpy(&data, word, sizeof(data));
+                return data;
+        }
+
+        data = hb_mc_request_packet_get_data(rqst);
+        uint8_t mask = hb_mc_request_packet_get_mask(rqst);
+        for (unsigned i = 0; i < sizeof(data); i++)
+                if (mask & (1 << i))
+                        word[i] = (data >> (8 * i)) & 0xFF;
+
+        // writing the kernel pointer of an unfrozen tile group origin "runs" the kernel
+        hb_mc_emulation_tile_t *tile = hb_mc_emulation_get_tile(emul, x, y);
+        if (tile && emul->model_kernels && epa == emul->syms.kernel_ptr)
+                hb_mc_emulation_kernel_finish(emul, x, y, tile);
+
+        return 0;
+}
+
+static uint32_t hb_mc_emulation_dmem_read(hb_mc_emulation_tile_t *tile, hb_mc_epa_t epa)
+{
+        uint32_t v;
+        memcpy(&v, &tile->dmem[epa - HB_MC_TILE_EPA_DMEM_BASE], sizeof(v));
+        return v;
+}
+
+static void hb_mc_emulation_dmem_write(hb_mc_emulation_tile_t *tile, hb_mc_epa_t epa, uint32_t v)
+{
+        memcpy(&tile->dmem[epa - HB_MC_TILE_EPA_DMEM_BASE], &v, sizeof(v));
+}
+
+/*
+ * Vanilla cores are not modeled, so a launched kernel finishes as soon as it
+ * starts: the tile group origin sends its finish signal and the tile returns
+ * to waiting for a kernel.
+ */
+static void hb_mc_emulation_kernel_finish(hb_mc_emulation_t *emul,
+                                          hb_mc_idx_t x, hb_mc_idx_t y,
+                                          hb_mc_emulation_tile_t *tile)
+{
+        const hb_mc_emulation_kernel_symbols_t *syms = &emul->syms;
+        uint32_t kernel = hb_mc_emulation_dmem_read(tile, syms->kernel_ptr);
+
+        if (kernel == syms->kernel_not_loaded_val)
+                return;
+
+        if (tile->csr[HB_MC_TILE_EPA_CSR_FREEZE_OFFSET >> 2] != 0)
+                return;
+
+        hb_mc_emulation_dmem_write(tile, syms->kernel_ptr, syms->kernel_not_loaded_val);
+
+        // only the tile group origin reports completion
+        if (hb_mc_emulation_dmem_read(tile, syms->tile_id) != 0)
+                return;
+
+        uint32_t eva = hb_mc_emulation_dmem_read(tile, syms->finish_signal_addr);
+        if (!(eva & (1u << EMUL_GLOBAL_BITIDX))) {
+                bsg_pr_warn("%s: tile (%" PRIu32 ", %" PRIu32 ") has a non-global "
+                            "finish signal address 0x%08" PRIx32 "\n",
+                            __func__, x, y, eva);
+                return;
+        }
+
+        hb_mc_packet_t finish;
+        memset(&finish, 0, sizeof(finish));
+        hb_mc_request_packet_set_x_dst(&finish.request, (eva >> EMUL_GLOBAL_X_BITIDX) & EMUL_GLOBAL_COORD_MASK);
+        hb_mc_request_packet_set_y_dst(&finish.request, (eva >> EMUL_GLOBAL_Y_BITIDX) & EMUL_GLOBAL_COORD_MASK);
+        hb_mc_request_packet_set_x_src(&finish.request, x);
+        hb_mc_request_packet_set_y_src(&finish.request, y);
+        hb_mc_request_packet_set_data(&finish.request, hb_mc_emulation_dmem_read(tile, syms->finish_signal_val));
+        hb_mc_request_packet_set_mask(&finish.request, HB_MC_PACKET_REQUEST_MASK_WORD);
+        hb_mc_request_packet_set_op(&finish.request, HB_MC_PACKET_OP_REMOTE_STORE);
+        hb_mc_request_packet_set_addr(&finish.request, (eva & ((1u << HB_MC_EPA_LOGSZ) - 1)) >> 2);
+
+        if (hb_mc_request_packet_get_x_dst(&finish.request) == 0 &&
+            hb_mc_request_packet_get_y_dst(&finish.request) == 0)
+                emul->fifo[HB_MC_FIFO_RX_REQ].rx.push_back(finish);
+        else
+                hb_mc_emulation_execute(emul, &finish.request);
+}
+
+////////////////////
+// FIFO Transport //
+////////////////////
+
+static uint32_t hb_mc_emulation_tx_vacancy(hb_mc_emulation_t *emul, hb_mc_fifo_tx_t type)
+{
+        hb_mc_emulation_fifo_t *fifo = &emul->fifo[type];
+        size_t used = fifo->tx_words.size() + fifo->tx_pending.size() * EMUL_PACKET_WORDS;
+        return used >= emul->params.fifo_words ? 0 : emul->params.fifo_words - used;
+}
+
+static uint32_t hb_mc_emulation_rx_occupancy(hb_mc_emulation_t *emul, hb_mc_fifo_rx_t type)
+{
+        hb_mc_emulation_fifo_t *fifo = &emul->fifo[type];
+        return fifo->rx.size() * EMUL_PACKET_WORDS - fifo->rx_head_words;
+}
+
+/*
+ * Advance the model to the current time: retire requests whose latency has
+ * elapsed, returning their credits and any load responses, then inject
+ * pending host requests while credits are available.
+ */
+static void hb_mc_emulation_advance(hb_mc_emulation_t *emul)
+{
+        hb_mc_emulation_fifo_t *tx = &emul->fifo[HB_MC_FIFO_TX_REQ];
+        hb_mc_emulation_fifo_t *rsp = &emul->fifo[HB_MC_FIFO_RX_RSP];
+        uint64_t now = hb_mc_emulation_now_ns();
+
+        while (!emul->inflight.empty() && emul->inflight.front().done_ns <= now) {
+                hb_mc_emulation_inflight_t &head = emul->inflight.front();
+                const hb_mc_request_packet_t *rqst = &head.request;
+
+                if (hb_mc_request_packet_get_op(rqst) == HB_MC_PACKET_OP_REMOTE_LOAD) {
+                        // back-pressure: a response needs room in the response FIFO
+                        if (hb_mc_emulation_rx_occupancy(emul, HB_MC_FIFO_RX_RSP)
+                            + EMUL_PACKET_WORDS > emul->params.fifo_words)
+                                break;
+
+                        hb_mc_packet_t response;
+                        memset(&response, 0, sizeof(response));
+                        response.response.x_dst   = hb_mc_request_packet_get_x_src(rqst);
+                        response.response.y_dst   = hb_mc_request_packet_get_y_src(rqst);
+                        response.response.load_id = hb_mc_request_packet_get_data(rqst);
+                        response.response.data    = head.load_data;
+                        response.response.op      = EMUL_RETURN_INT_WB;
+                        rsp->rx.push_back(response);
+                }
+                emul->inflight.pop_front();
+        }
+
+        bool had_pending = !tx->tx_pending.empty();
+        while (!tx->tx_pending.empty() && emul->inflight.size() < emul->params.host_credits) {
+                hb_mc_emulation_inflight_t flight;
+                flight.request = tx->tx_pending.front().request;
+                flight.done_ns = now + emul->params.latency_ns;
+                tx->tx_pending.pop_front();
+
+                // memory effects happen at injection, responses after the latency
+                flight.load_data = hb_mc_emulation_execute(emul, &flight.request);
+                emul->inflight.push_back(flight);
+        }
+
+        // TX-Complete is raised when the last committed packet leaves the FIFO
+        if (had_pending && tx->tx_pending.empty())
+                tx->isr |= (1 << HB_MC_MMIO_FIFO_IXR_TC_BIT);
+}
+
+static int hb_mc_emulation_tx_commit(hb_mc_emulation_t *emul, hb_mc_fifo_tx_t type, uint32_t length)
+{
+        hb_mc_emulation_fifo_t *fifo = &emul->fifo[type];
+
+        if (length % sizeof(hb_mc_packet_t) != 0) {
+                bsg_pr_err("%s: Transmit length %" PRIu32 " is not a multiple of the packet size\n",
+                           __func__, length);
+                return HB_MC_INVALID;
+        }
+
+        // the driver rewrites the length until TX-Complete is set:
+        // only words written since the last commit form new packets
+        size_t words = std::min<size_t>(length / sizeof(uint32_t), fifo->tx_words.size());
+        words -= words % EMUL_PACKET_WORDS;
+
+        for (size_t i = 0; i < words; i += EMUL_PACKET_WORDS) {
+                hb_mc_packet_t packet;
+                memcpy(packet.words, &fifo->tx_words[i], sizeof(packet.words));
+                // host responses to device requests are not modeled
+                if (type == HB_MC_FIFO_TX_REQ)
+                        fifo->tx_pending.push_back(packet);
+        }
+        fifo->tx_words.erase(fifo->tx_words.begin(), fifo->tx_words.begin() + words);
+
+        if (type == HB_MC_FIFO_TX_RSP && fifo->tx_words.empty())
+                fifo->isr |= (1 << HB_MC_MMIO_FIFO_IXR_TC_BIT);
+
+        return HB_MC_SUCCESS;
+}
+
+static int hb_mc_emulation_rx_data(hb_mc_emulation_t *emul, hb_mc_fifo_rx_t type, uint32_t *vp)
+{
+        hb_mc_emulation_fifo_t *fifo = &emul->fifo[type];
+
+        if (fifo->rx.empty()) {
+                bsg_pr_err("%s: Read from empty %s FIFO\n",
+                           __func__, hb_mc_fifo_rx_to_string(type));
+                return HB_MC_FAIL;
+        }
+
+        *vp = fifo->rx.front().words[fifo->rx_head_words++];
+        if (fifo->rx_head_words == EMUL_PACKET_WORDS) {
+                fifo->rx.pop_front();
+                fifo->rx_head_words = 0;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static uint32_t hb_mc_emulation_rom_read(hb_mc_emulation_t *emul, unsigned idx)
+{
+        const hb_mc_emulation_params_t *p = &emul->params;
+
+        switch (idx) {
+        case HB_MC_CONFIG_VERSION:                 return EMUL_ROM_VERSION;
+        case HB_MC_CONFIG_TIMESTAMP:               return EMUL_ROM_TIMESTAMP;
+        case HB_MC_CONFIG_NETWORK_ADDR_WIDTH:      return p->network_bitwidth_addr;
+        case HB_MC_CONFIG_NETWORK_DATA_WIDTH:      return EMUL_NETWORK_DATA_WIDTH;
+        case HB_MC_CONFIG_DEVICE_DIM_X:            return p->dim_x;
+        case HB_MC_CONFIG_DEVICE_DIM_Y:            return p->dim_y;
+        case HB_MC_CONFIG_DEVICE_HOST_INTF_COORD_X: return 0;
+        case HB_MC_CONFIG_DEVICE_HOST_INTF_COORD_Y: return 0;
+        case HB_MC_CONFIG_REPO_BASEJUMP_HASH:
+        case HB_MC_CONFIG_REPO_MANYCORE_HASH:
+        case HB_MC_CONFIG_REPO_F1_HASH:            return EMUL_ROM_GITHASH;
+        case HB_MC_CONFIG_VCACHE_WAYS:             return p->vcache_ways;
+        case HB_MC_CONFIG_VCACHE_SETS:             return p->vcache_sets;
+        case HB_MC_CONFIG_VCACHE_BLOCK_WORDS:      return p->vcache_block_words;
+        case HB_MC_CONFIG_VCACHE_STRIPE_WORDS:     return p->vcache_stripe_words;
+        default:                                   return 0;
+        }
+}
+
+int hb_mc_emulation_read32(hb_mc_emulation_t *emul, uintptr_t offset, uint32_t *vp)
+{
+        std::lock_guard<std::mutex> guard(emul->lock);
+
+        if (offset % 4) {
+                bsg_pr_err("%s: 0x%" PRIxPTR " is not aligned to a 4 byte boundary\n",
+                           __func__, offset);
+                return HB_MC_UNALIGNED;
+        }
+
+        hb_mc_emulation_advance(emul);
+
+        if (offset >= HB_MC_MMIO_ROM_BASE &&
+            offset <  HB_MC_MMIO_ROM_BASE + HB_MC_CONFIG_MAX * sizeof(uint32_t)) {
+                *vp = hb_mc_emulation_rom_read(emul, (offset - HB_MC_MMIO_ROM_BASE) >> 2);
+                return HB_MC_SUCCESS;
+        }
+
+        switch (offset) {
+        case hb_mc_mmio_credits_get_reg_addr(HB_MC_MMIO_CREDITS_FIFO_HOST_VACANCY_OFFSET):
+                *vp = hb_mc_emulation_tx_vacancy(emul, HB_MC_FIFO_TX_REQ);
+                return HB_MC_SUCCESS;
+        case hb_mc_mmio_credits_get_reg_addr(HB_MC_MMIO_CREDITS_FIFO_DEVICE_VACANCY_OFFSET):
+                *vp = emul->params.fifo_words - hb_mc_emulation_rx_occupancy(emul, HB_MC_FIFO_RX_REQ);
+                return HB_MC_SUCCESS;
+        case hb_mc_mmio_credits_get_reg_addr(HB_MC_MMIO_CREDITS_HOST_OFFSET):
+                *vp = emul->params.host_credits - emul->inflight.size();
+                return HB_MC_SUCCESS;
+        default:
+                break;
+        }
+
+        for (unsigned dir = HB_MC_MMIO_FIFO_MIN; dir <= HB_MC_MMIO_FIFO_MAX; dir++) {
+                hb_mc_emulation_fifo_t *fifo = &emul->fifo[dir];
+                hb_mc_fifo_rx_t rx = (hb_mc_fifo_rx_t)dir;
+                hb_mc_fifo_tx_t tx = (hb_mc_fifo_tx_t)dir;
+
+                if (offset < hb_mc_mmio_fifo_get_direction_offset(dir) ||
+                    offset >= hb_mc_mmio_fifo_get_direction_offset(dir) + HB_MC_MMIO_FIFO_NUM_BYTES)
+                        continue;
+
+                switch (offset - hb_mc_mmio_fifo_get_direction_offset(dir)) {
+                case HB_MC_MMIO_FIFO_ISR_OFFSET:
+                        *vp = fifo->isr;
+                        return HB_MC_SUCCESS;
+                case HB_MC_MMIO_FIFO_IER_OFFSET:
+                        *vp = fifo->ier;
+                        return HB_MC_SUCCESS;
+                case HB_MC_MMIO_FIFO_TX_VACANCY_OFFSET:
+                        *vp = hb_mc_emulation_tx_vacancy(emul, tx);
+                        return HB_MC_SUCCESS;
+                case HB_MC_MMIO_FIFO_RX_OCCUPANCY_OFFSET:
+                        *vp = hb_mc_emulation_rx_occupancy(emul, rx);
+                        return HB_MC_SUCCESS;
+                case HB_MC_MMIO_FIFO_RX_LENGTH_OFFSET:
+                        *vp = fifo->rx.empty() ? 0 : sizeof(hb_mc_packet_t);
+                        return HB_MC_SUCCESS;
+                case HB_MC_MMIO_FIFO_RX_DATA_OFFSET:
+                        return hb_mc_emulation_rx_data(emul, rx, vp);
+                default:
+                        break;
+                }
+        }
+
+        bsg_pr_err("%s: Read from unmapped MMIO offset 0x%" PRIxPTR "\n", __func__, offset);
+        return HB_MC_INVALID;
+}
+
+int hb_mc_emulation_write32(hb_mc_emulation_t *emul, uintptr_t offset, uint32_t v)
+{
+        std::lock_guard<std::mutex> guard(emul->lock);
+        int err = HB_MC_SUCCESS;
+
+        if (offset % 4) {
+                bsg_pr_err("%s: 0x%" PRIxPTR " is not aligned to a 4 byte boundary\n",
+                           __func__, offset);
+                return HB_MC_UNALIGNED;
+        }
+
+        for (unsigned dir = HB_MC_MMIO_FIFO_MIN; dir <= HB_MC_MMIO_FIFO_MAX; dir++) {
+                hb_mc_emulation_fifo_t *fifo = &emul->fifo[dir];
+                hb_mc_fifo_tx_t tx = (hb_mc_fifo_tx_t)dir;
+
+                if (offset < hb_mc_mmio_fifo_get_direction_offset(dir) ||
+                    offset >= hb_mc_mmio_fifo_get_direction_offset(dir) + HB_MC_MMIO_FIFO_NUM_BYTES)
+                        continue;
+
+                switch (offset - hb_mc_mmio_fifo_get_direction_offset(dir)) {
+                case HB_MC_MMIO_FIFO_ISR_OFFSET:
+                        // write one to clear
+                        fifo->isr &= ~v;
+                        break;
+                case HB_MC_MMIO_FIFO_IER_OFFSET:
+                        fifo->ier = v;
+                        break;
+                case HB_MC_MMIO_FIFO_TX_DATA_OFFSET:
+                        if (hb_mc_emulation_tx_vacancy(emul, tx) == 0) {
+                                bsg_pr_err("%s: %s FIFO overflow\n",
+                                           __func__, hb_mc_fifo_tx_to_string(tx));
+                                return HB_MC_FAIL;
+                        }
+                        fifo->tx_words.push_back(v);
+                        break;
+                case HB_MC_MMIO_FIFO_TX_LENGTH_OFFSET:
+                        err = hb_mc_emulation_tx_commit(emul, tx, v);
+                        break;
+                default:
+                        bsg_pr_err("%s: Write to read-only or unmapped MMIO offset 0x%" PRIxPTR "\n",
+                                   __func__, offset);
+                        return HB_MC_INVALID;
+                }
+
+                hb_mc_emulation_advance(emul);
+                return err;
+        }
+
+        bsg_pr_err("%s: Write to read-only or unmapped MMIO offset 0x%" PRIxPTR "\n",
+                   __func__, offset);
+        return HB_MC_INVALID;
+}
+
+int hb_mc_emulation_write_tx_data(hb_mc_emulation_t *emul, uintptr_t offset,
+                                  const uint32_t *words, size_t count)
+{
+        std::lock_guard<std::mutex> guard(emul->lock);
+
+        for (unsigned dir = HB_MC_MMIO_FIFO_MIN; dir <= HB_MC_MMIO_FIFO_MAX; dir++) {
+                hb_mc_emulation_fifo_t *fifo = &emul->fifo[dir];
+                hb_mc_fifo_tx_t tx = (hb_mc_fifo_tx_t)dir;
+
+                if (offset != hb_mc_mmio_fifo_get_reg_addr(dir, HB_MC_MMIO_FIFO_TX_DATA_OFFSET))
+                        continue;
+
+                if (hb_mc_emulation_tx_vacancy(emul, tx) < count) {
+                        bsg_pr_err("%s: %s FIFO overflow\n",
+                                   __func__, hb_mc_fifo_tx_to_string(tx));
+                        return HB_MC_FAIL;
+                }
+
+                fifo->tx_words.insert(fifo->tx_words.end(), words, words + count);
+                hb_mc_emulation_advance(emul);
+                return HB_MC_SUCCESS;
+        }
+
+        bsg_pr_err("%s: 0x%" PRIxPTR " is not a TX data register\n", __func__, offset);
+        return HB_MC_INVALID;
+}
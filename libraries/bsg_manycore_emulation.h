@@ -0,0 +1,167 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BSG_MANYCORE_EMULATION_H
+#define BSG_MANYCORE_EMULATION_H
+
+#include <bsg_manycore_features.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_epa.h>
+#include <bsg_manycore_coordinate.h>
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+        /*
+          The emulation backend is a software model of the manycore as seen
+          from the host's MMIO window: the AXI FIFO register set, the
+          host-credit register, the configuration ROM, tile DMEM/ICACHE/CSR
+          endpoints, and DRAM behind the victim caches. It is selected by
+          building the runtime with -DEMULATION (make EMULATION=1), in which
+          case every hb_mc_manycore_mmio_* access is serviced in-process.
+
+          Vanilla cores do not execute code. If kernel symbols are
+          registered with hb_mc_emulation_set_kernel_symbols(), a tile
+          group origin that is handed a kernel pointer immediately posts
+          its CUDA-Lite finish signal, so host launch flows run end to end.
+        */
+
+#define HB_MC_EMULATION_MAX_DEVICES 8
+
+        typedef struct hb_mc_emulation_params {
+                hb_mc_idx_t dim_x;              //!< columns of vanilla cores
+                hb_mc_idx_t dim_y;              //!< rows of vanilla cores
+                uint32_t network_bitwidth_addr; //!< network (word) address width
+                uint32_t vcache_ways;           //!< victim cache associativity
+                uint32_t vcache_sets;           //!< victim cache sets
+                uint32_t vcache_block_words;    //!< victim cache line size in words
+                uint32_t vcache_stripe_words;   //!< DRAM stripe size in words
+                uint32_t host_credits;          //!< maximum requests in flight from the host
+                uint32_t fifo_words;            //!< capacity of each AXI FIFO in 32-bit words
+                uint64_t latency_ns;            //!< time from injection until a request completes
+        } hb_mc_emulation_params_t;
+
+        /**
+         * DMEM EPAs of the CUDA-Lite runtime symbols used to model kernel completion.
+         */
+        typedef struct hb_mc_emulation_kernel_symbols {
+                hb_mc_epa_t kernel_ptr;         //!< cuda_kernel_ptr
+                hb_mc_epa_t finish_signal_addr; //!< cuda_finish_signal_addr
+                hb_mc_epa_t finish_signal_val;  //!< cuda_finish_signal_val
+                hb_mc_epa_t tile_id;            //!< __bsg_id
+                uint32_t kernel_not_loaded_val; //!< value of cuda_kernel_ptr when idle
+        } hb_mc_emulation_kernel_symbols_t;
+
+        typedef struct hb_mc_emulation hb_mc_emulation_t;
+
+        /**
+         * Get the default emulation parameters (a 4x4 F1 machine).
+         * The HB_MC_EMULATION_DIM_X, HB_MC_EMULATION_DIM_Y, and
+         * HB_MC_EMULATION_LATENCY_NS environment variables override the defaults.
+         * @param[out] params  Set to the default parameters.
+         */
+        void hb_mc_emulation_get_default_params(hb_mc_emulation_params_t *params);
+
+        /**
+         * Set the parameters of an emulated manycore.
+         * Must be called before the manycore with ID #id is initialized.
+         * @param[in] id      A manycore ID.
+         * @param[in] params  Parameters for the emulated manycore.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_emulation_set_params(hb_mc_manycore_id_t id,
+                                       const hb_mc_emulation_params_t *params);
+
+        /**
+         * Register the DMEM locations of CUDA-Lite runtime symbols with an emulated manycore.
+         * @param[in] id    A manycore ID.
+         * @param[in] syms  Symbol EPAs, or NULL to stop modeling kernel completion.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_emulation_set_kernel_symbols(hb_mc_manycore_id_t id,
+                                               const hb_mc_emulation_kernel_symbols_t *syms);
+
+        /**
+         * Attach to an emulated manycore, creating it if it does not exist.
+         * A manycore may be attached more than once; attachments share its state.
+         * Device memory persists across attach/detach for the life of the process.
+         * @param[in]  id     A manycore ID.
+         * @param[out] emul   Set to the emulated manycore.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_emulation_attach(hb_mc_manycore_id_t id, hb_mc_emulation_t **emul);
+
+        /**
+         * Detach from an emulated manycore.
+         * @param[in] emul  An emulated manycore attached with hb_mc_emulation_attach().
+         */
+        void hb_mc_emulation_detach(hb_mc_emulation_t *emul);
+
+        /**
+         * Read a 32-bit register from an emulated manycore's MMIO space.
+         * @param[in]  emul    An emulated manycore.
+         * @param[in]  offset  A 4-byte aligned offset into the MMIO space.
+         * @param[out] vp      Set to the register value.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        int hb_mc_emulation_read32(hb_mc_emulation_t *emul, uintptr_t offset, uint32_t *vp);
+
+        /**
+         * Write a 32-bit register in an emulated manycore's MMIO space.
+         * @param[in] emul    An emulated manycore.
+         * @param[in] offset  A 4-byte aligned offset into the MMIO space.
+         * @param[in] v       A value to write.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        int hb_mc_emulation_write32(hb_mc_emulation_t *emul, uintptr_t offset, uint32_t v);
+
+        /**
+         * Write a sequence of words to a TX data register of an emulated manycore.
+         * Equivalent to #count calls to hb_mc_emulation_write32() at #offset.
+         * @param[in] emul    An emulated manycore.
+         * @param[in] offset  The offset of a TX_DATA register in the MMIO space.
+         * @param[in] words   Words to push into the FIFO.
+         * @param[in] count   The number of words in #words.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        int hb_mc_emulation_write_tx_data(hb_mc_emulation_t *emul, uintptr_t offset,
+                                          const uint32_t *words, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -33,6 +33,10 @@
 
 #ifdef __cplusplus
 #include <cmath>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <new>
 #else
 #include <math.h>
 #endif
@@ -297,92 +301,95 @@ static uint32_t default_get_x_dimlog(const hb_mc_config_t *cfg)
         return ceil(log2(hb_mc_dimension_get_x(dim)));
 }
 
-static uint32_t default_get_dram_x_bitidx(const hb_mc_config_t *cfg)
+static uint32_t default_get_dram_stripe_size_log(const hb_mc_config_t *cfg)
 {
-        uint32_t xdimlog;
-        // The number of bits used for the x index is determined by clog2 of the
-        // x dimension (or the number of bits needed to represent the maximum x
-        // dimension).
-        xdimlog = default_get_x_dimlog(cfg);
-        return MAKE_MASK(xdimlog);
-}
-
-static uint32_t default_get_dram_stripe_size_log(const hb_mc_manycore_t *mc)
-{
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
         return ceil(log2(hb_mc_config_get_vcache_stripe_size(cfg)));
 }
 
-static uint32_t default_get_dram_bitwidth(const hb_mc_manycore_t *mc)
+static uint32_t default_get_dram_bitwidth(const hb_mc_config_t *cfg, int dram_enabled)
 {
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        if (hb_mc_manycore_dram_is_enabled(mc)) {
+        if (dram_enabled) {
                 return hb_mc_config_get_vcache_bitwidth_data_addr(cfg);
         } else {
                 return ceil(log2(hb_mc_config_get_vcache_size(cfg))); // clog2(victim cache size)
         }
 }
 
-static uint32_t default_get_dram_x_shift_dep(const hb_mc_manycore_t *mc)
+static void default_dram_desc_compute(const hb_mc_config_t *cfg, hb_mc_dram_eva_desc_t *desc)
 {
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        if (hb_mc_manycore_dram_is_enabled(mc)) {
-                return hb_mc_config_get_vcache_bitwidth_data_addr(cfg);
-        } else {
-                return ceil(log2(hb_mc_config_get_vcache_size(cfg))); // clog2(victim cache size)
+        // The number of bits used for the x index is determined by clog2 of the
+        // x dimension (or the number of bits needed to represent the maximum x
+        // dimension).
+        desc->stripe_log    = default_get_dram_stripe_size_log(cfg);
+        desc->stripe_mask   = MAKE_MASK(desc->stripe_log);
+        desc->x_dimlog      = default_get_x_dimlog(cfg);
+        desc->x_mask        = MAKE_MASK(desc->x_dimlog);
+        desc->x_max         = default_get_dram_max_x_coord(cfg);
+        desc->epa_top_shift = desc->stripe_log + desc->x_dimlog;
+        desc->y             = hb_mc_config_get_dram_y(cfg);
+        for (int enabled = 0; enabled < 2; enabled++) {
+                desc->addrbits[enabled] = default_get_dram_bitwidth(cfg, enabled);
+                desc->max_size[enabled] = 1ull << desc->addrbits[enabled];
         }
+        desc->valid = 1;
+}
+
+/**
+ * Precompute the default map's DRAM translation constants for a manycore.
+ * @param[in]  mc       A manycore whose configuration is initialized
+ */
+void default_eva_dram_desc_init(hb_mc_manycore_t *mc)
+{
+        default_dram_desc_compute(hb_mc_manycore_get_config(mc), &mc->dram_eva);
+}
+
+/*
+ * Get the DRAM translation constants of a manycore. They are computed at
+ * init; a manycore whose struct was filled in some other way gets them
+ * computed into #scratch.
+ */
+static inline const hb_mc_dram_eva_desc_t *
+default_get_dram_desc(const hb_mc_manycore_t *mc, hb_mc_dram_eva_desc_t *scratch)
+{
+        if (__builtin_expect(mc->dram_eva.valid, 1))
+                return &mc->dram_eva;
+
+        default_dram_desc_compute(hb_mc_manycore_get_config(mc), scratch);
+        return scratch;
 }
 
 // See comments on default_eva_to_npa_dram 
-static int default_eva_get_x_coord_dram(const hb_mc_manycore_t *mc,
-                                        const hb_mc_config_t *cfg,
+static int default_eva_get_x_coord_dram(const hb_mc_dram_eva_desc_t *desc,
                                         const hb_mc_eva_t *eva,
                                         hb_mc_idx_t *x) { 
-        uint32_t stripe_log = default_get_dram_stripe_size_log(mc);
-        uint32_t xmask = default_get_dram_x_bitidx(cfg);
-        uint32_t dram_max_x_coord = default_get_dram_max_x_coord(cfg);
-
-        *x = (hb_mc_eva_addr(eva) >> stripe_log) & xmask;
-        if ( *x > dram_max_x_coord) { 
+        *x = (hb_mc_eva_addr(eva) >> desc->stripe_log) & desc->x_mask;
+        if ( *x > desc->x_max) { 
                 bsg_pr_err("%s: Translation of EVA 0x%08" PRIx32 " failed. The X coordinate "
                            "of the DRAM bank for the requested EPA %d is larger than max %d\n.",
                            __func__, hb_mc_eva_addr(eva),
-                           *x, dram_max_x_coord);
+                           *x, desc->x_max);
                 return HB_MC_INVALID;
         }
         return HB_MC_SUCCESS;
 }
 
 // See comments on default_eva_to_npa_dram 
-static int default_eva_get_y_coord_dram(const hb_mc_manycore_t *mc,
-                                        const hb_mc_config_t *cfg,
-                                        const hb_mc_eva_t *eva,
-                                        hb_mc_idx_t *y) { 
-        // Y dimension is fixed at the bottom column
-        *y = hb_mc_config_get_dram_y(cfg);
-        return HB_MC_SUCCESS;
-}
-
-// See comments on default_eva_to_npa_dram 
-static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
-                                     const hb_mc_config_t *cfg,
+static int default_eva_get_epa_dram (const hb_mc_dram_eva_desc_t *desc,
+                                     int dram_enabled,
                                      const hb_mc_eva_t *eva,
                                      hb_mc_epa_t *epa,
                                      size_t *sz) { 
- 
-        uint32_t xdimlog    = default_get_x_dimlog(cfg);
-        uint32_t stripe_log = default_get_dram_stripe_size_log(mc);
-        uint32_t shift      = stripe_log + xdimlog;
+        uint32_t addr = hb_mc_eva_addr(eva);
 
         // Refer to comments on default_eva_to_npa_dram for more clarification
         // DRAM EPA  =  EPA_top + block_offset + word_addressible  
         // Construct (block_offset + word_addressible) portion of EPA
         // i.e. the <stripe_log> lower bits of the EVA 
-        *epa = (hb_mc_eva_addr(eva) & MAKE_MASK(stripe_log));
+        *epa = addr & desc->stripe_mask;
         // Construct the EPA_top portion of EPA and append to lower bits  
         // Shift right by (stripe_log + x_dimlog) and shift left by stripe_log
         // to remove the X_coord porition of EVA 
-        *epa |= (((hb_mc_eva_addr(eva) & MAKE_MASK(DEFAULT_DRAM_BITIDX)) >> shift ) << stripe_log);
+        *epa |= (((addr & MAKE_MASK(DEFAULT_DRAM_BITIDX)) >> desc->epa_top_shift) << desc->stripe_log);
 
 
         // The EPA portion of an EVA is technically determined by EPA_top + 
@@ -391,16 +398,14 @@ static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
         // xdimlog) != DEFAULT_DRAM_BITIDX, since there are unused bits between
         // the x index and EPA.  To avoid really awful debugging, we check this
         // situation.
-        uint32_t addrbits = default_get_dram_bitwidth(mc);
-        uint32_t errmask = MAKE_MASK(addrbits);
-        size_t max_dram_sz = 1 << addrbits;
+        uint64_t max_dram_sz = desc->max_size[dram_enabled ? 1 : 0];
 
         if (*epa >= max_dram_sz){
                 bsg_pr_err("%s: Translation of EVA 0x%08" PRIx32 " failed. "
                            "Requested EPA 0x%08" PRIx32 " is outside of "
                            "DRAM's addressable range 0x%08" PRIx32 ".\n",
                            __func__,
-                           hb_mc_eva_addr(eva),
+                           addr,
                            *epa,
                            uint32_t(max_dram_sz));
                 return HB_MC_INVALID;
@@ -409,8 +414,7 @@ static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
 
         // Maximum permitted size to write starting from this epa is from 
         // the block offset until the end of the striped block.
-        uint32_t max_striped_block_size = 1 << stripe_log;
-        *sz = max_striped_block_size - (hb_mc_eva_addr(eva) & MAKE_MASK(stripe_log));
+        *sz = desc->stripe_mask + 1 - (addr & desc->stripe_mask);
 
         return HB_MC_SUCCESS;
 }
@@ -446,12 +450,13 @@ static int default_eva_to_npa_dram(const hb_mc_manycore_t *mc,
                                    size_t *sz)
 {
         int rc;
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
         hb_mc_idx_t x,y;
         hb_mc_epa_t epa;
 
         // Calculate X coordinate of NPA from EVA
-        rc = default_eva_get_x_coord_dram (mc, cfg, eva, &x); 
+        rc = default_eva_get_x_coord_dram (desc, eva, &x); 
         if (rc != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to generate x coordinate from eva 0x%08" PRIx32 ".\n",
                            __func__,
@@ -459,18 +464,12 @@ static int default_eva_to_npa_dram(const hb_mc_manycore_t *mc,
                 return rc;
         }
 
-        // Calculate Y coordinate of NPA from EVA
-        rc = default_eva_get_y_coord_dram (mc, cfg, eva, &y);
-        if (rc != HB_MC_SUCCESS) { 
-                bsg_pr_err("%s: failed to generate y coordinate from eva 0x%08" PRIx32 ".\n",
-                           __func__,
-                           hb_mc_eva_addr(eva));
-                return rc;
-        }
+        // Y dimension is fixed at the bottom column
+        y = desc->y;
 
 
         // Calculate EPA Portion of NPA from EVA
-        rc = default_eva_get_epa_dram (mc, cfg, eva, &epa, sz);
+        rc = default_eva_get_epa_dram (desc, hb_mc_manycore_dram_is_enabled(mc), eva, &epa, sz);
         if (rc != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to generate npa from eva 0x%08" PRIx32 ".\n",
                            __func__,
@@ -511,20 +510,18 @@ static int default_eva_to_npa_dram_dep(const hb_mc_manycore_t *mc,
                                        const hb_mc_eva_t *eva,
                                        hb_mc_npa_t *npa, size_t *sz)
 {
-        uint32_t xmask, xdimlog, addrbits, shift, errmask;
+        uint32_t xmask, addrbits, shift, errmask;
         size_t maxsz;
         hb_mc_idx_t x, y;
         hb_mc_epa_t epa;
-        hb_mc_dimension_t dim;
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        dim = hb_mc_config_get_dimension_network(cfg);
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
 
-        xdimlog = default_get_x_dimlog(cfg);
-        xmask   = default_get_dram_x_bitidx(cfg);
-        shift   = default_get_dram_x_shift_dep(mc);
+        xmask   = desc->x_mask;
+        shift   = desc->addrbits[hb_mc_manycore_dram_is_enabled(mc) ? 1 : 0];
 
         x = (hb_mc_eva_addr(eva) >> shift) & xmask;
-        y = hb_mc_config_get_dram_y(cfg);
+        y = desc->y;
 
         addrbits = shift;
         maxsz = 1 << addrbits;
@@ -741,11 +738,12 @@ static int default_npa_to_eva_dram(hb_mc_manycore_t *mc,
 {
         // build the eva
         hb_mc_eva_t addr = 0;
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
         uint32_t stripe_log, xdimlog;
 
-        stripe_log = default_get_dram_stripe_size_log(mc); 
-        xdimlog    = default_get_x_dimlog(cfg);
+        stripe_log = desc->stripe_log;
+        xdimlog    = desc->x_dimlog;
 
         // See comments on default_eva_to_npa_dram for clarification
         addr |= (hb_mc_npa_get_epa(npa) & MAKE_MASK(stripe_log)); // Set byte address and cache block offset
@@ -781,7 +779,9 @@ static int default_npa_to_eva_dram_dep(hb_mc_manycore_t *mc,
 {
         // build the eva
         hb_mc_eva_t addr = 0;
-        hb_mc_eva_t xshift = default_get_dram_x_shift_dep(mc);
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
+        hb_mc_eva_t xshift = desc->addrbits[hb_mc_manycore_dram_is_enabled(mc) ? 1 : 0];
 
         addr |= hb_mc_npa_get_epa(npa); // set the byte address
         addr |= hb_mc_npa_get_x(npa) << xshift; // set the x coordinate
@@ -964,6 +964,53 @@ int default_eva_size(
 
 }
 
+/**
+ * Get how the default EVA map interleaves DRAM across victim caches.
+ * @param[in]  mc            An initialized manycore
+ * @param[out] stripe_size   Set to the number of contiguous bytes on one channel
+ * @param[out] stride        Set to the number of bytes after which the pattern repeats
+ * @param[out] num_channels  Set to the number of channels DRAM is interleaved across
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int default_eva_get_dram_interleave(const hb_mc_manycore_t *mc,
+                                    uint32_t *stripe_size,
+                                    uint32_t *stride,
+                                    uint32_t *num_channels)
+{
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
+
+        // the X coordinate sits just above the stripe offset (see default_eva_to_npa_dram),
+        // but X coordinates past x_max are holes that the translation rejects
+        *stripe_size = 1 << desc->stripe_log;
+        *stride = *stripe_size << desc->x_dimlog;
+        *num_channels = std::min(1u << desc->x_dimlog, desc->x_max + 1);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get the DRAM channel (victim cache column) that a DRAM EVA maps to.
+ * @param[in]  mc       An initialized manycore
+ * @param[in]  eva      A DRAM eva
+ * @param[out] channel  Set to the channel of #eva
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int default_eva_get_dram_channel(const hb_mc_manycore_t *mc,
+                                 const hb_mc_eva_t *eva,
+                                 hb_mc_idx_t *channel)
+{
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
+
+        if (!default_eva_is_dram(eva)) {
+                bsg_pr_err("%s: EVA 0x%08" PRIx32 " is not a DRAM address\n",
+                           __func__, hb_mc_eva_addr(eva));
+                return HB_MC_INVALID;
+        }
+
+        return default_eva_get_x_coord_dram(desc, eva, channel);
+}
+
 const hb_mc_coordinate_t default_origin = {.x = HB_MC_CONFIG_VCORE_BASE_X,
                                            .y = HB_MC_CONFIG_VCORE_BASE_Y};
 hb_mc_eva_map_t default_map = {
@@ -1000,6 +1047,194 @@ int hb_mc_npa_to_eva(hb_mc_manycore_t *mc,
         return HB_MC_SUCCESS;
 }
 
+/* one translated NPA segment */
+typedef struct hb_mc_eva_tlb_entry {
+        const hb_mc_eva_map_t *map; //!< the map that made the translation, or nullptr if empty
+        hb_mc_coordinate_t src;     //!< the tile that issued the EVA
+        hb_mc_eva_t eva;            //!< the EVA that was translated
+        hb_mc_npa_t npa;            //!< its NPA
+        size_t sz;                  //!< bytes in the NPA segment starting at #npa
+} hb_mc_eva_tlb_entry_t;
+
+#define HB_MC_EVA_TLB_SETS (HB_MC_EVA_TLB_ENTRIES / HB_MC_EVA_TLB_WAYS)
+
+struct hb_mc_eva_tlb {
+        std::mutex lock;   //!< guards the members below
+        int dram_enabled;  //!< the manycore's dram_enabled when the entries were made
+        hb_mc_eva_tlb_entry_t entries[HB_MC_EVA_TLB_ENTRIES]; //!< HB_MC_EVA_TLB_WAYS entries per set
+        uint8_t victim[HB_MC_EVA_TLB_SETS];                   //!< next way of each set to replace
+        hb_mc_eva_tlb_stats_t stats;
+};
+
+/* every TLB in the process, so that a map can be invalidated everywhere */
+static std::mutex eva_tlbs_lock;
+static std::vector<hb_mc_eva_tlb_t*> eva_tlbs;
+
+/* the index of the first entry of the set that caches a page */
+static size_t hb_mc_eva_tlb_set(const hb_mc_eva_map_t *map,
+                                const hb_mc_coordinate_t *src,
+                                hb_mc_eva_t eva)
+{
+        uint64_t h = (hb_mc_eva_addr(&eva) >> HB_MC_EVA_TLB_PAGE_LOG);
+        h ^= ((uint64_t)hb_mc_coordinate_get_x(*src) << 7) ^
+                ((uint64_t)hb_mc_coordinate_get_y(*src) << 13) ^
+                ((uintptr_t)map >> 4);
+        h ^= h >> 17;
+        return (h & (HB_MC_EVA_TLB_SETS - 1)) * HB_MC_EVA_TLB_WAYS;
+}
+
+static void hb_mc_eva_tlb_flush(hb_mc_eva_tlb_t *tlb)
+{
+        for (hb_mc_eva_tlb_entry_t &e : tlb->entries)
+                e.map = nullptr;
+}
+
+/**
+ * Turn a manycore's EVA TLB on or off
+ * @param[in]  mc      An initialized manycore struct
+ * @param[in]  enable  Nonzero to cache EVA translations
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_set_eva_tlb(hb_mc_manycore_t *mc, int enable)
+{
+        hb_mc_eva_tlb_t *tlb = nullptr;
+
+        if (!enable) {
+                hb_mc_manycore_eva_tlb_exit(mc);
+                return HB_MC_SUCCESS;
+        }
+
+        if (mc->eva_tlb != nullptr)
+                return HB_MC_SUCCESS;
+
+        std::lock_guard<std::mutex> guard(eva_tlbs_lock);
+        try {
+                tlb = new hb_mc_eva_tlb_t();
+                eva_tlbs.push_back(tlb);
+        } catch (const std::bad_alloc &) {
+                delete tlb;
+                return HB_MC_NOMEM;
+        }
+
+        tlb->dram_enabled = mc->dram_enabled;
+        mc->eva_tlb = tlb;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Turn off a manycore's EVA TLB and free it
+ * @param[in]  mc      A manycore struct
+ */
+void hb_mc_manycore_eva_tlb_exit(hb_mc_manycore_t *mc)
+{
+        hb_mc_eva_tlb_t *tlb = mc->eva_tlb;
+
+        if (tlb == nullptr)
+                return;
+
+        std::lock_guard<std::mutex> guard(eva_tlbs_lock);
+        eva_tlbs.erase(std::find(eva_tlbs.begin(), eva_tlbs.end(), tlb));
+        mc->eva_tlb = nullptr;
+        delete tlb;
+}
+
+/**
+ * Get the hit and miss counters of a manycore's EVA TLB
+ * @param[in]  mc     An initialized manycore struct with its EVA TLB on
+ * @param[out] stats  Set to the counters accumulated since the TLB was turned on
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_get_eva_tlb_stats(hb_mc_manycore_t *mc, hb_mc_eva_tlb_stats_t *stats)
+{
+        hb_mc_eva_tlb_t *tlb = mc->eva_tlb;
+
+        if (tlb == nullptr) {
+                bsg_pr_err("%s: EVA TLB is not enabled\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        std::lock_guard<std::mutex> guard(tlb->lock);
+        *stats = tlb->stats;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Drop every cached translation made through an EVA map, on every manycore
+ * @param[in]  map  An EVA map
+ */
+void hb_mc_eva_map_invalidate(const hb_mc_eva_map_t *map)
+{
+        std::lock_guard<std::mutex> guard(eva_tlbs_lock);
+
+        for (hb_mc_eva_tlb_t *tlb : eva_tlbs) {
+                std::lock_guard<std::mutex> tlb_guard(tlb->lock);
+                for (hb_mc_eva_tlb_entry_t &e : tlb->entries) {
+                        if (e.map == map) {
+                                e.map = nullptr;
+                                tlb->stats.invalidations++;
+                        }
+                }
+        }
+}
+
+/* translate an EVA through a manycore's TLB, filling it from #map on a miss */
+static int hb_mc_eva_tlb_translate(hb_mc_manycore_t *mc,
+                                   hb_mc_eva_tlb_t *tlb,
+                                   const hb_mc_eva_map_t *map,
+                                   const hb_mc_coordinate_t *src,
+                                   const hb_mc_eva_t *eva,
+                                   hb_mc_npa_t *npa, size_t *sz)
+{
+        size_t set = hb_mc_eva_tlb_set(map, src, *eva);
+        int err;
+
+        {
+                std::lock_guard<std::mutex> guard(tlb->lock);
+
+                /* translations depend on whether DRAM is enabled */
+                if (tlb->dram_enabled != mc->dram_enabled) {
+                        hb_mc_eva_tlb_flush(tlb);
+                        tlb->dram_enabled = mc->dram_enabled;
+                }
+
+                for (size_t way = 0; way < HB_MC_EVA_TLB_WAYS; way++) {
+                        const hb_mc_eva_tlb_entry_t &e = tlb->entries[set + way];
+                        hb_mc_eva_t offset = hb_mc_eva_addr(eva) - hb_mc_eva_addr(&e.eva);
+
+                        if (e.map == map &&
+                            hb_mc_coordinate_get_x(e.src) == hb_mc_coordinate_get_x(*src) &&
+                            hb_mc_coordinate_get_y(e.src) == hb_mc_coordinate_get_y(*src) &&
+                            hb_mc_eva_addr(eva) >= hb_mc_eva_addr(&e.eva) &&
+                            offset < e.sz) {
+                                *npa = hb_mc_npa_from_x_y(hb_mc_npa_get_x(&e.npa),
+                                                          hb_mc_npa_get_y(&e.npa),
+                                                          hb_mc_npa_get_epa(&e.npa) + offset);
+                                *sz = e.sz - offset;
+                                tlb->stats.hits++;
+                                return HB_MC_SUCCESS;
+                        }
+                }
+
+                tlb->stats.misses++;
+        }
+
+        err = map->eva_to_npa(mc, map->priv, src, eva, npa, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        std::lock_guard<std::mutex> guard(tlb->lock);
+        uint8_t &victim = tlb->victim[set / HB_MC_EVA_TLB_WAYS];
+        hb_mc_eva_tlb_entry_t &e = tlb->entries[set + victim];
+        victim = (victim + 1) % HB_MC_EVA_TLB_WAYS;
+        e.map = map;
+        e.src = *src;
+        e.eva = *eva;
+        e.npa = *npa;
+        e.sz = *sz;
+
+        return HB_MC_SUCCESS;
+}
+
 /**
  * Translate an Endpoint Virtual Address in a source tile's address space
  * to a Network Physical Address
@@ -1019,6 +1254,10 @@ int hb_mc_eva_to_npa(hb_mc_manycore_t *mc,
 {
         int err;
 
+        /* the default map's DRAM translation is cheaper than a TLB lookup */
+        if (mc->eva_tlb != nullptr && map != &default_map)
+                return hb_mc_eva_tlb_translate(mc, mc->eva_tlb, map, src, eva, npa, sz);
+
         err = map->eva_to_npa(mc, map->priv, src, eva, npa, sz);
         if (err != HB_MC_SUCCESS)
                 return err;
@@ -1026,6 +1265,150 @@ int hb_mc_eva_to_npa(hb_mc_manycore_t *mc,
         return HB_MC_SUCCESS;
 }
 
+/*
+ * Translate DRAM EVAs with the default map's precomputed constants. There
+ * are no branches in the loop so the compiler can vectorize it; EVAs that
+ * are not in DRAM, or fall outside it, are only flagged.
+ * Returns nonzero if any EVA needs the scalar path.
+ */
+template <typename EvaAt>
+static uint32_t default_eva_to_npa_dram_batch(const hb_mc_dram_eva_desc_t *desc,
+                                              uint64_t max_size,
+                                              EvaAt eva_at,
+                                              hb_mc_npa_t *npas, size_t *szs,
+                                              size_t count)
+{
+        const uint32_t stripe_log = desc->stripe_log;
+        const uint32_t stripe_mask = desc->stripe_mask;
+        const uint32_t x_mask = desc->x_mask;
+        const uint32_t x_max = desc->x_max;
+        const uint32_t epa_top_shift = desc->epa_top_shift;
+        const hb_mc_idx_t y = desc->y;
+        uint32_t slow = 0;
+
+        for (size_t i = 0; i < count; i++) {
+                uint32_t addr = eva_at(i);
+                uint32_t x = (addr >> stripe_log) & x_mask;
+                uint32_t epa = (addr & stripe_mask) |
+                        (((addr & MAKE_MASK(DEFAULT_DRAM_BITIDX)) >> epa_top_shift) << stripe_log);
+
+                npas[i].x = x;
+                npas[i].y = y;
+                npas[i].epa = epa;
+                szs[i] = stripe_mask + 1 - (addr & stripe_mask);
+                slow |= ((addr >> DEFAULT_DRAM_BITIDX) ^ 1) | (x > x_max) | (epa >= max_size);
+        }
+
+        return slow;
+}
+
+/*
+ * Batch translation for maps that use default_eva_to_npa(). DRAM EVAs take
+ * the vectorized path; anything else goes through default_eva_to_npa().
+ */
+template <typename EvaAt>
+static int default_eva_to_npa_batch(hb_mc_manycore_t *mc,
+                                    const void *priv,
+                                    const hb_mc_coordinate_t *src,
+                                    EvaAt eva_at,
+                                    hb_mc_npa_t *npas, size_t *szs,
+                                    size_t count)
+{
+        int err;
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
+        uint64_t max_size = desc->max_size[hb_mc_manycore_dram_is_enabled(mc) ? 1 : 0];
+
+        if (!default_eva_to_npa_dram_batch(desc, max_size, eva_at, npas, szs, count))
+                return HB_MC_SUCCESS;
+
+        for (size_t i = 0; i < count; i++) {
+                hb_mc_eva_t eva = eva_at(i);
+                if (default_eva_is_dram(&eva) &&
+                    hb_mc_npa_get_x(&npas[i]) <= desc->x_max &&
+                    hb_mc_npa_get_epa(&npas[i]) < max_size)
+                        continue;
+
+                err = default_eva_to_npa(mc, priv, src, &eva, &npas[i], &szs[i]);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+template <typename EvaAt>
+static int hb_mc_eva_to_npa_batch_at(hb_mc_manycore_t *mc,
+                                     const hb_mc_eva_map_t *map,
+                                     const hb_mc_coordinate_t *src,
+                                     EvaAt eva_at,
+                                     hb_mc_npa_t *npas, size_t *szs,
+                                     size_t count)
+{
+        int err;
+
+        if (map->eva_to_npa == default_eva_to_npa)
+                return default_eva_to_npa_batch(mc, map->priv, src, eva_at, npas, szs, count);
+
+        for (size_t i = 0; i < count; i++) {
+                hb_mc_eva_t eva = eva_at(i);
+                err = hb_mc_eva_to_npa(mc, map, src, &eva, &npas[i], &szs[i]);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Translate an array of Endpoint Virtual Addresses in a source tile's address
+ * space to Network Physical Addresses
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa translation
+ * @param[in]  src    Coordinate of the tile issuing the #evas
+ * @param[in]  evas   EVAs to translate
+ * @param[out] npas   Set to the NPA of each EVA
+ * @param[out] szs    Set to the size in bytes of the NPA segment of each EVA
+ * @param[in]  count  Number of EVAs
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_eva_to_npa_batch(hb_mc_manycore_t *mc,
+                           const hb_mc_eva_map_t *map,
+                           const hb_mc_coordinate_t *src,
+                           const hb_mc_eva_t *evas,
+                           hb_mc_npa_t *npas, size_t *szs,
+                           size_t count)
+{
+        return hb_mc_eva_to_npa_batch_at(mc, map, src,
+                                         [evas](size_t i) { return evas[i]; },
+                                         npas, szs, count);
+}
+
+/**
+ * Translate the EVAs base, base + stride, ... in a source tile's address
+ * space to Network Physical Addresses
+ * @param[in]  mc      An initialized manycore struct
+ * @param[in]  map     An eva map for computing the eva to npa translation
+ * @param[in]  src     Coordinate of the tile issuing the EVAs
+ * @param[in]  base    The first EVA to translate
+ * @param[in]  stride  Distance in bytes between consecutive EVAs
+ * @param[out] npas    Set to the NPA of each EVA
+ * @param[out] szs     Set to the size in bytes of the NPA segment of each EVA
+ * @param[in]  count   Number of EVAs
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_eva_to_npa_strided(hb_mc_manycore_t *mc,
+                             const hb_mc_eva_map_t *map,
+                             const hb_mc_coordinate_t *src,
+                             hb_mc_eva_t base, uint32_t stride,
+                             hb_mc_npa_t *npas, size_t *szs,
+                             size_t count)
+{
+        return hb_mc_eva_to_npa_batch_at(mc, map, src,
+                                         [base, stride](size_t i) { return (hb_mc_eva_t)(base + i * stride); },
+                                         npas, szs, count);
+}
+
 /**
  * Translate an Endpoint Virtual Address in a source tile's address space
  * to a Network Physical Address
@@ -1053,6 +1436,154 @@ static size_t min_size_t(size_t x, size_t y)
         return x < y ? x : y;
 }
 
+/**
+ * Choose whether large DRAM transfers are sent round-robin across DRAM channels
+ * @param[in]  mc      An initialized manycore struct
+ * @param[in]  enable  Nonzero to interleave requests across channels
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_set_dram_interleave(hb_mc_manycore_t *mc, int enable)
+{
+        mc->dram_interleave = enable ? 1 : 0;
+        return HB_MC_SUCCESS;
+}
+
+/* the EVAs of an interleaved transfer, looked up one word at a time */
+typedef struct hb_mc_eva_lookup {
+        const hb_mc_eva_map_t *map;
+        const hb_mc_coordinate_t *tgt;
+        hb_mc_eva_t eva; //!< the first EVA of the transfer
+} hb_mc_eva_lookup_t;
+
+static int hb_mc_eva_lookup_npa(hb_mc_manycore_t *mc, void *lookup,
+                                size_t offset, hb_mc_npa_t *npa)
+{
+        hb_mc_eva_lookup_t *l = (hb_mc_eva_lookup_t *)lookup;
+        hb_mc_eva_t eva = l->eva + offset;
+        hb_mc_dram_eva_desc_t scratch;
+        const hb_mc_dram_eva_desc_t *desc = default_get_dram_desc(mc, &scratch);
+        uint64_t max_size = desc->max_size[hb_mc_manycore_dram_is_enabled(mc) ? 1 : 0];
+        size_t sz;
+
+        if (!default_eva_to_npa_dram_batch(desc, max_size,
+                                           [eva](size_t) { return eva; },
+                                           npa, &sz, 1))
+                return HB_MC_SUCCESS;
+
+        return default_eva_to_npa(mc, l->map->priv, l->tgt, &eva, npa, &sz);
+}
+
+/*
+ * Decide whether a transfer of #sz bytes at #eva is sent round-robin across
+ * DRAM channels, and if so, in what order. Only DRAM transfers through the
+ * default map that span at least one stripe on every channel qualify.
+ */
+static bool hb_mc_eva_get_interleave(hb_mc_manycore_t *mc,
+                                     const hb_mc_eva_map_t *map,
+                                     const hb_mc_eva_t *eva, size_t sz,
+                                     hb_mc_transfer_interleave_t *order)
+{
+        uint32_t stripe_size, stride, num_channels;
+
+        if (!mc->dram_interleave || map->eva_to_npa != default_eva_to_npa)
+                return false;
+
+        if (!default_eva_is_dram(eva) || (hb_mc_eva_addr(eva) & 0x3) ||
+            (uint64_t)hb_mc_eva_addr(eva) + sz > ((uint64_t)1 << 32))
+                return false;
+
+        if (default_eva_get_dram_interleave(mc, &stripe_size, &stride, &num_channels) != HB_MC_SUCCESS)
+                return false;
+
+        // a transfer this long would cross the holes of a DRAM with missing channels
+        if (num_channels < 2 || stride != stripe_size * num_channels || sz < stride)
+                return false;
+
+        order->head_words = ((stripe_size - (hb_mc_eva_addr(eva) & (stripe_size - 1))) &
+                             (stripe_size - 1)) / sizeof(uint32_t);
+        order->lanes = num_channels;
+        order->lane_words = stripe_size / sizeof(uint32_t);
+        return true;
+}
+
+/*
+ * Walks the EVAs of a transfer in maximal runs of contiguous NPAs. Chunks
+ * that a map translates separately (e.g. pages of the deprecated DRAM map)
+ * are merged whenever one starts on the same endpoint where the last ended.
+ */
+typedef struct hb_mc_eva_runs {
+        const hb_mc_eva_map_t *map;
+        const hb_mc_coordinate_t *tgt;
+        hb_mc_eva_t eva;      //!< the first EVA of the next run
+        size_t remaining;     //!< bytes left to walk
+        bool peeked;          //!< has the chunk at #eva been translated already?
+        hb_mc_npa_t peek_npa; //!< NPA of the chunk at #eva, if #peeked
+        size_t peek_sz;       //!< size of the chunk at #eva, if #peeked
+} hb_mc_eva_runs_t;
+
+/**
+ * Get the next run of contiguous NPAs of a transfer.
+ * @param[in]  mc    An initialized manycore struct
+ * @param[in]  runs  The transfer's EVAs; must have bytes remaining
+ * @param[out] npa   Set to the NPA of the run
+ * @param[out] sz    Set to the size of the run in bytes
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+static int hb_mc_eva_runs_next(hb_mc_manycore_t *mc, hb_mc_eva_runs_t *runs,
+                               hb_mc_npa_t *npa, size_t *sz)
+{
+        int err;
+        size_t run, chunk_sz;
+        hb_mc_npa_t chunk_npa;
+
+        if(runs->peeked){
+                *npa = runs->peek_npa;
+                chunk_sz = runs->peek_sz;
+                runs->peeked = false;
+        } else {
+                err = hb_mc_eva_to_npa(mc, runs->map, runs->tgt, &runs->eva, npa, &chunk_sz);
+                if(err != HB_MC_SUCCESS){
+                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
+                                   __func__);
+                        return err;
+                }
+        }
+
+        run = min_size_t(runs->remaining, chunk_sz);
+        while(run < runs->remaining){
+                hb_mc_eva_t next_eva = runs->eva + run;
+                err = hb_mc_eva_to_npa(mc, runs->map, runs->tgt, &next_eva, &chunk_npa, &chunk_sz);
+                if(err != HB_MC_SUCCESS){
+                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
+                                   __func__);
+                        return err;
+                }
+
+                if(hb_mc_npa_get_x(&chunk_npa) != hb_mc_npa_get_x(npa) ||
+                   hb_mc_npa_get_y(&chunk_npa) != hb_mc_npa_get_y(npa) ||
+                   hb_mc_npa_get_epa(&chunk_npa) != hb_mc_npa_get_epa(npa) + run){
+                        /* keep the translation for the next run */
+                        runs->peeked = true;
+                        runs->peek_npa = chunk_npa;
+                        runs->peek_sz = chunk_sz;
+                        break;
+                }
+
+                run += min_size_t(runs->remaining - run, chunk_sz);
+        }
+
+        char npa_str[256];
+        bsg_pr_dbg("%zd byte run at eva %08x (%s)\n",
+                   run,
+                   runs->eva,
+                   hb_mc_npa_to_string(npa, npa_str, sizeof(npa_str)));
+
+        runs->eva += run;
+        runs->remaining -= run;
+        *sz = run;
+        return HB_MC_SUCCESS;
+}
+
 /**
  * Write memory out to manycore hardware starting at a given EVA
  * @param[in]  mc     An initialized manycore struct
@@ -1070,26 +1601,36 @@ int hb_mc_manycore_eva_write(hb_mc_manycore_t *mc,
                              const void *data, size_t sz)
 {
         int err;
-        size_t dest_sz, xfer_sz;
+        size_t xfer_sz;
         hb_mc_npa_t dest_npa;
         char *destp;
-        hb_mc_eva_t curr_eva = *eva;
+        hb_mc_eva_runs_t runs = { map, tgt, *eva, sz };
+        hb_mc_transfer_interleave_t order;
+
+        if(hb_mc_eva_get_interleave(mc, map, eva, sz, &order)){
+                hb_mc_transfer_t *xfer;
+                hb_mc_eva_lookup_t lookup = { map, tgt, *eva };
+
+                err = hb_mc_manycore_write_mem_interleaved_async(mc, hb_mc_eva_lookup_npa, &lookup,
+                                                                 &order, data, sz,
+                                                                 nullptr, nullptr, &xfer);
+                if(err == HB_MC_SUCCESS)
+                        err = hb_mc_manycore_transfer_wait(mc, xfer);
 
-        destp = (char *)data;
-        while(sz > 0){
-                err = hb_mc_eva_to_npa(mc, map, tgt, &curr_eva, &dest_npa, &dest_sz);
                 if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
+                        bsg_pr_err("%s: Failed to copy data from host to NPA\n",
                                    __func__);
                         return err;
                 }
-                xfer_sz = min_size_t(sz, dest_sz);
 
-                char npa_str[256];
-                bsg_pr_dbg("writing %zd bytes to eva %08x (%s)\n",
-                           xfer_sz,
-                           curr_eva,
-                           hb_mc_npa_to_string(&dest_npa, npa_str, sizeof(npa_str)));
+                return HB_MC_SUCCESS;
+        }
+
+        destp = (char *)data;
+        while(runs.remaining > 0){
+                err = hb_mc_eva_runs_next(mc, &runs, &dest_npa, &xfer_sz);
+                if(err != HB_MC_SUCCESS)
+                        return err;
 
                 err = hb_mc_manycore_write_mem(mc, &dest_npa, destp, xfer_sz);
                 if(err != HB_MC_SUCCESS){
@@ -1099,13 +1640,18 @@ int hb_mc_manycore_eva_write(hb_mc_manycore_t *mc,
                 }
 
                 destp += xfer_sz;
-                sz -= xfer_sz;
-                curr_eva += xfer_sz;
         }
 
         return HB_MC_SUCCESS;
 }
 
+/* the segments of a streaming read are the runs of its EVAs */
+static int hb_mc_eva_stream_next(hb_mc_manycore_t *mc, void *stream,
+                                 hb_mc_npa_t *npa, size_t *sz)
+{
+        return hb_mc_eva_runs_next(mc, (hb_mc_eva_runs_t *)stream, npa, sz);
+}
+
 /**
  * Read memory from manycore hardware starting at a given EVA
  * @param[in]  mc     An initialized manycore struct
@@ -1123,39 +1669,31 @@ int hb_mc_manycore_eva_read(hb_mc_manycore_t *mc,
                             void *data, size_t sz)
 {
         int err;
-        size_t src_sz, xfer_sz;
-        hb_mc_npa_t src_npa;
-        char *srcp;
-        hb_mc_eva_t curr_eva = *eva;
-
-        srcp = (char *)data;
-        while(sz > 0){
-                err = hb_mc_eva_to_npa(mc, map, tgt, &curr_eva, &src_npa, &src_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
-                                   __func__);
-                        return err;
-                }
-
-                xfer_sz = min_size_t(sz, src_sz);
-
-                char npa_str[256];
-                bsg_pr_dbg("read %zd bytes from eva %08x (%s)\n",
-                           xfer_sz,
-                           curr_eva,
-                           hb_mc_npa_to_string(&src_npa, npa_str, sizeof(npa_str)));
+        hb_mc_transfer_t *xfer;
+        hb_mc_eva_runs_t runs = { map, tgt, *eva, sz };
+        hb_mc_eva_lookup_t lookup = { map, tgt, *eva };
+        hb_mc_transfer_interleave_t order;
+
+        if(hb_mc_eva_get_interleave(mc, map, eva, sz, &order)){
+                err = hb_mc_manycore_read_mem_interleaved_async(mc, hb_mc_eva_lookup_npa, &lookup,
+                                                                &order, data, sz,
+                                                                nullptr, nullptr, &xfer);
+        } else {
+                /* segments are translated as the transfer reaches them, so
+                   requests for later stripes go out while earlier ones are in flight */
+                err = hb_mc_manycore_read_mem_stream_async(mc, hb_mc_eva_stream_next, &runs,
+                                                           data, sz, nullptr, nullptr, &xfer);
+        }
 
-                err = hb_mc_manycore_read_mem(mc, &src_npa, srcp, xfer_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to copy data from host to NPA\n",
-                                   __func__);
-                        return err;
-                }
+        if(err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
 
-                srcp += xfer_sz;
-                sz -= xfer_sz;
-                curr_eva += xfer_sz;
+        if(err != HB_MC_SUCCESS){
+                bsg_pr_err("%s: Failed to copy data from NPA to host\n",
+                           __func__);
+                return err;
         }
+
         return HB_MC_SUCCESS;
 }
 
@@ -1176,25 +1714,14 @@ int hb_mc_manycore_eva_memset(hb_mc_manycore_t *mc,
                               uint8_t val, size_t sz)
 {
         int err;
-        size_t dest_sz, xfer_sz;
+        size_t xfer_sz;
         hb_mc_npa_t dest_npa;
-        hb_mc_eva_t curr_eva = *eva;
+        hb_mc_eva_runs_t runs = { map, tgt, *eva, sz };
 
-        while(sz > 0){
-                err = hb_mc_eva_to_npa(mc, map, tgt, &curr_eva, &dest_npa, &dest_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
-                                   __func__);
+        while(runs.remaining > 0){
+                err = hb_mc_eva_runs_next(mc, &runs, &dest_npa, &xfer_sz);
+                if(err != HB_MC_SUCCESS)
                         return err;
-                }
-                xfer_sz = min_size_t(sz, dest_sz);
-
-
-                char npa_str[256];
-                bsg_pr_dbg("read %zd bytes from eva %08x (%s)\n",
-                           xfer_sz,
-                           curr_eva,
-                           hb_mc_npa_to_string(&dest_npa, npa_str, sizeof(npa_str)));
 
                 err = hb_mc_manycore_memset(mc, &dest_npa, val, xfer_sz);
                 if(err != HB_MC_SUCCESS){
@@ -1202,9 +1729,6 @@ int hb_mc_manycore_eva_memset(hb_mc_manycore_t *mc,
                                    __func__);
                         return err;
                 }
-
-                sz -= xfer_sz;
-                curr_eva += xfer_sz;
         }
 
         return HB_MC_SUCCESS;
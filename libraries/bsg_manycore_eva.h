@@ -152,6 +152,42 @@ extern "C" {
                              size_t *sz);
 
 
+        /**
+         * Get how the default EVA map interleaves DRAM across victim caches.
+         * Consecutive #stripe_size byte blocks of DRAM EVA space map to
+         * channels (victim cache columns) 0, 1, 2, ... in turn, and the pattern
+         * repeats every #stride bytes. When there are fewer than
+         * #stride / #stripe_size channels, the blocks past the last channel
+         * are holes that do not map to DRAM.
+         * @param[in]  mc            An initialized manycore
+         * @param[out] stripe_size   Set to the number of contiguous bytes on one channel
+         * @param[out] stride        Set to the number of bytes after which the pattern repeats
+         * @param[out] num_channels  Set to the number of channels DRAM is interleaved across
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        int default_eva_get_dram_interleave(const hb_mc_manycore_t *mc,
+                                            uint32_t *stripe_size,
+                                            uint32_t *stride,
+                                            uint32_t *num_channels);
+
+        /**
+         * Get the DRAM channel (victim cache column) that a DRAM EVA maps to.
+         * @param[in]  mc       An initialized manycore
+         * @param[in]  eva      A DRAM eva
+         * @param[out] channel  Set to the channel of #eva
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        int default_eva_get_dram_channel(const hb_mc_manycore_t *mc,
+                                         const hb_mc_eva_t *eva,
+                                         hb_mc_idx_t *channel);
+
+        /**
+         * Precompute the default map's DRAM translation constants for a manycore.
+         * Called by hb_mc_manycore_init() once the configuration has been read.
+         * @param[in]  mc       A manycore whose configuration is initialized
+         */
+        void default_eva_dram_desc_init(hb_mc_manycore_t *mc);
+
         extern const hb_mc_coordinate_t default_origin;
         extern hb_mc_eva_map_t default_map;
 
@@ -201,6 +237,117 @@ extern "C" {
                              const hb_mc_eva_t *eva,
                              hb_mc_npa_t *npa, size_t *sz);
 
+        /**
+         * Translate an array of Endpoint Virtual Addresses in a source tile's
+         * address space to Network Physical Addresses.
+         * Maps built on default_eva_to_npa() translate DRAM EVAs in a vectorized
+         * loop; other maps fall back to one eva_to_npa() call per EVA.
+         * @param[in]  mc     An initialized manycore struct
+         * @param[in]  map    An eva map for computing the eva to npa translation
+         * @param[in]  src    Coordinate of the tile issuing the #evas
+         * @param[in]  evas   EVAs to translate
+         * @param[out] npas   Set to the NPA of each EVA
+         * @param[out] szs    Set to the size in bytes of the NPA segment of each EVA
+         * @param[in]  count  Number of EVAs
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_eva_to_npa_batch(hb_mc_manycore_t *mc,
+                                   const hb_mc_eva_map_t *map,
+                                   const hb_mc_coordinate_t *src,
+                                   const hb_mc_eva_t *evas,
+                                   hb_mc_npa_t *npas, size_t *szs,
+                                   size_t count);
+
+        /**
+         * Translate the EVAs base, base + stride, ..., base + (count - 1) * stride
+         * in a source tile's address space to Network Physical Addresses.
+         * See hb_mc_eva_to_npa_batch().
+         * @param[in]  mc      An initialized manycore struct
+         * @param[in]  map     An eva map for computing the eva to npa translation
+         * @param[in]  src     Coordinate of the tile issuing the EVAs
+         * @param[in]  base    The first EVA to translate
+         * @param[in]  stride  Distance in bytes between consecutive EVAs
+         * @param[out] npas    Set to the NPA of each EVA
+         * @param[out] szs     Set to the size in bytes of the NPA segment of each EVA
+         * @param[in]  count   Number of EVAs
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_eva_to_npa_strided(hb_mc_manycore_t *mc,
+                                     const hb_mc_eva_map_t *map,
+                                     const hb_mc_coordinate_t *src,
+                                     hb_mc_eva_t base, uint32_t stride,
+                                     hb_mc_npa_t *npas, size_t *szs,
+                                     size_t count);
+
+        /*
+          The EVA TLB caches translations made through EVA maps other than
+          default_map, keyed by map, source tile, and EVA page. Each entry
+          holds one translated NPA segment, so any EVA inside a cached
+          segment is translated without calling the map. A page has
+          HB_MC_EVA_TLB_WAYS entries, enough for every DRAM stripe in it
+          down to 32 byte stripes. A map's entries
+          must be dropped with hb_mc_eva_map_invalidate() before the map is
+          changed or destroyed; hb_mc_origin_eva_map_exit() does so.
+        */
+#define HB_MC_EVA_TLB_ENTRIES  1024
+#define HB_MC_EVA_TLB_WAYS     4
+#define HB_MC_EVA_TLB_PAGE_LOG 7
+
+        typedef struct hb_mc_eva_tlb_stats {
+                uint64_t hits;          //!< translations served from the TLB
+                uint64_t misses;        //!< translations that called the map
+                uint64_t invalidations; //!< entries dropped by hb_mc_eva_map_invalidate()
+        } hb_mc_eva_tlb_stats_t;
+
+        /**
+         * Turn a manycore's EVA TLB on or off. The TLB is off by default.
+         * Turning it off drops its entries and counters.
+         * @param[in]  mc      An initialized manycore struct
+         * @param[in]  enable  Nonzero to cache EVA translations
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_set_eva_tlb(hb_mc_manycore_t *mc, int enable);
+
+        /**
+         * Turn off a manycore's EVA TLB and free it. Cannot fail.
+         * Called by hb_mc_manycore_exit() and when hb_mc_manycore_init() fails.
+         * @param[in]  mc      A manycore struct
+         */
+        void hb_mc_manycore_eva_tlb_exit(hb_mc_manycore_t *mc);
+
+        /**
+         * Get the hit and miss counters of a manycore's EVA TLB.
+         * @param[in]  mc     An initialized manycore struct with its EVA TLB on
+         * @param[out] stats  Set to the counters accumulated since the TLB was turned on
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_get_eva_tlb_stats(hb_mc_manycore_t *mc, hb_mc_eva_tlb_stats_t *stats);
+
+        /**
+         * Drop every cached translation made through an EVA map, on every manycore.
+         * Must be called before #map is changed or destroyed.
+         * @param[in]  map  An EVA map
+         */
+        void hb_mc_eva_map_invalidate(const hb_mc_eva_map_t *map);
+
+        /**
+         * Choose whether large DRAM transfers through the default map are
+         * sent round-robin across DRAM channels instead of in address order.
+         * With interleaving on, hb_mc_manycore_eva_read() and
+         * hb_mc_manycore_eva_write() spread requests so that every victim
+         * cache has requests outstanding at once; data still lands in
+         * address order. Interleaving is off by default.
+         * @param[in]  mc      An initialized manycore struct
+         * @param[in]  enable  Nonzero to interleave requests across channels
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_set_dram_interleave(hb_mc_manycore_t *mc, int enable);
+
         /**
          * Write memory out to manycore hardware starting at a given EVA
          * @param[in]  mc     An initialized manycore struct
@@ -40,6 +40,12 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <list>
+#include <new>
+
 #ifdef __cplusplus
 #include <cassert>
 #include <cstdlib>
@@ -242,43 +248,91 @@ static int hb_mc_loader_eva_memset(const Elf32_Phdr *phdr,
 }
 
 /**
- * Load a program segment.
+ * Check that a tile has the capacity for a program segment.
  * @param[in] mc       A manycore instance.
  * @param[in] map      A EVA to NPA map.
  * @param[in] phdr     A program header for the data to be loaded.
- * @param[in] segdata  Program data to be loaded.
  * @param[in] tile     A manycore coordinate.
- * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ * @return HB_MC_SUCCESS if the segment fits. Otherwise an error code is returned.
  */
-static int hb_mc_loader_load_tile_segment(hb_mc_manycore_t *mc,
-                                          const hb_mc_eva_map_t *map,
-                                          const Elf32_Phdr *phdr,
-                                          const unsigned char *segdata,
-                                          hb_mc_coordinate_t tile)
+static int hb_mc_loader_check_tile_segment_capacity(hb_mc_manycore_t *mc,
+                                                    const hb_mc_eva_map_t *map,
+                                                    const Elf32_Phdr *phdr,
+                                                    hb_mc_coordinate_t tile)
 {
-        int rc;
         size_t cap, seg_sz;
         char segname[64];
 
-        hb_mc_loader_segment_to_string(phdr, segname, sizeof(segname));
-
         /* get hardware capacity of the segment */
         cap = hb_mc_loader_get_tile_segment_capacity(mc, map, phdr, tile);
         seg_sz = RV32_Word_to_host(phdr->p_memsz);
 
-        bsg_pr_dbg("%s: writing program data: %s\n", __func__, segname);
-
         /* return error if the hardware lacks the capacity */
         if (cap < seg_sz) {
                 bsg_pr_err("%s: '%s' (%zu bytes) exceeds "
                            "maximum (%zu bytes)\n",
                            __func__,
-                           segname,
+                           hb_mc_loader_segment_to_string(phdr, segname, sizeof(segname)),
                            seg_sz,
                            cap);
                 return HB_MC_FAIL;
         }
 
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Wait for the transfers of a fan-out load.
+ * @param[in] mc       A manycore instance.
+ * @param[in] xfers    Transfer handles; NULL entries are skipped.
+ * @param[in] n        The number of entries in #xfers.
+ * @return HB_MC_SUCCESS if every transfer succeeded. Otherwise the first error.
+ */
+static int hb_mc_loader_fanout_wait(hb_mc_manycore_t *mc, hb_mc_transfer_t **xfers, size_t n)
+{
+        int rc = HB_MC_SUCCESS;
+
+        /* wait for all of them, so that no handle is leaked */
+        for (size_t i = 0; i < n; i++) {
+                if (xfers[i] == nullptr)
+                        continue;
+
+                int err = hb_mc_manycore_transfer_wait(mc, xfers[i]);
+                if (rc == HB_MC_SUCCESS)
+                        rc = err;
+        }
+
+        return rc;
+}
+
+/**
+ * Load a program segment.
+ * @param[in] mc       A manycore instance.
+ * @param[in] map      A EVA to NPA map.
+ * @param[in] phdr     A program header for the data to be loaded.
+ * @param[in] segdata  Program data to be loaded.
+ * @param[in] tile     A manycore coordinate.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_load_tile_segment(hb_mc_manycore_t *mc,
+                                          const hb_mc_eva_map_t *map,
+                                          const Elf32_Phdr *phdr,
+                                          const unsigned char *segdata,
+                                          hb_mc_coordinate_t tile)
+{
+        int rc;
+        size_t seg_sz;
+        char segname[64];
+
+        hb_mc_loader_segment_to_string(phdr, segname, sizeof(segname));
+        seg_sz = RV32_Word_to_host(phdr->p_memsz);
+
+        bsg_pr_dbg("%s: writing program data: %s\n", __func__, segname);
+
+        rc = hb_mc_loader_check_tile_segment_capacity(mc, map, phdr, tile);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
         /* load initialized data */
         hb_mc_eva_t eva = RV32_Addr_to_host(phdr->p_paddr); /* get the load eva */
         size_t file_sz = RV32_Word_to_host(phdr->p_filesz); /* get the size of segdata */
@@ -309,12 +363,88 @@ static int hb_mc_loader_load_tile_segment(hb_mc_manycore_t *mc,
 }
 
 /**
- * Load a program segment.
+ * Load a program segment into several tiles with one stream of requests.
+ * Every tile gets identical bytes, so the requests go round-robin across
+ * the tiles and each payload is built once, instead of each tile's copy
+ * completing before the next one starts.
  * @param[in] mc       A manycore instance.
  * @param[in] map      A EVA to NPA map.
  * @param[in] phdr     A program header for the data to be loaded.
  * @param[in] segdata  Program data to be loaded.
- * @param[in] tile     A manycore coordinate.
+ * @param[in] tiles    Tiles to load.
+ * @param[in] ntiles   Number of tiles.
+ * @return HB_MC_NOIMPL if the segment cannot be fanned out and must be loaded
+ *         one tile at a time. HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_load_tiles_segment_fanout(hb_mc_manycore_t *mc,
+                                                  const hb_mc_eva_map_t *map,
+                                                  const Elf32_Phdr *phdr,
+                                                  const unsigned char *segdata,
+                                                  const hb_mc_coordinate_t *tiles,
+                                                  uint32_t ntiles)
+{
+        hb_mc_eva_t eva = RV32_Addr_to_host(phdr->p_paddr);
+        size_t seg_sz = RV32_Word_to_host(phdr->p_memsz);
+        size_t file_sz = RV32_Word_to_host(phdr->p_filesz);
+        size_t zeros_sz = seg_sz - file_sz;
+        hb_mc_transfer_t *xfers[2] = {nullptr, nullptr};
+        int rc;
+
+        /* fan-out transfers move whole words */
+        if (((uintptr_t)segdata & 0x3) || (file_sz & 0x3) || (zeros_sz & 0x3))
+                return HB_MC_NOIMPL;
+
+        std::vector<hb_mc_npa_t> data_npas(ntiles), zeros_npas(ntiles);
+        for (uint32_t i = 0; i < ntiles; i++) {
+                size_t contiguous;
+
+                rc = hb_mc_loader_check_tile_segment_capacity(mc, map, phdr, tiles[i]);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+
+                rc = hb_mc_eva_to_npa(mc, map, &tiles[i], &eva, &data_npas[i], &contiguous);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+
+                /* each tile's copy must be one run of NPAs */
+                if (contiguous < seg_sz)
+                        return HB_MC_NOIMPL;
+
+                zeros_npas[i] = hb_mc_npa_from_x_y(hb_mc_npa_get_x(&data_npas[i]),
+                                                   hb_mc_npa_get_y(&data_npas[i]),
+                                                   hb_mc_npa_get_epa(&data_npas[i]) + file_sz);
+        }
+
+        /* load initialized data and zeroed data back to back */
+        if (file_sz > 0) {
+                rc = hb_mc_manycore_write_mem_fanout_async(mc, data_npas.data(), ntiles,
+                                                           segdata, file_sz,
+                                                           nullptr, nullptr, &xfers[0]);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+        if (zeros_sz > 0) {
+                rc = hb_mc_manycore_memset_fanout_async(mc, zeros_npas.data(), ntiles,
+                                                        0, zeros_sz,
+                                                        nullptr, nullptr, &xfers[1]);
+                if (rc != HB_MC_SUCCESS) {
+                        (void)hb_mc_loader_fanout_wait(mc, xfers, 1);
+                        return rc;
+                }
+        }
+
+        return hb_mc_loader_fanout_wait(mc, xfers, 2);
+}
+
+/**
+ * Load a program segment into several tiles.
+ * @param[in] mc       A manycore instance.
+ * @param[in] map      A EVA to NPA map.
+ * @param[in] phdr     A program header for the data to be loaded.
+ * @param[in] segdata  Program data to be loaded.
+ * @param[in] tiles    Tiles to load.
+ * @param[in] ntiles   Number of tiles.
  * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
  */
 static int hb_mc_loader_load_tiles_segment(hb_mc_manycore_t *mc,
@@ -326,6 +456,10 @@ static int hb_mc_loader_load_tiles_segment(hb_mc_manycore_t *mc,
 {
         int rc;
 
+        rc = hb_mc_loader_load_tiles_segment_fanout(mc, map, phdr, segdata, tiles, ntiles);
+        if (rc != HB_MC_NOIMPL)
+                return rc;
+
         for (uint32_t i = 0; i < ntiles; i++) {
                 rc = hb_mc_loader_load_tile_segment(mc, map, phdr, segdata, tiles[i]);
                 if (rc != HB_MC_SUCCESS)
@@ -389,6 +523,56 @@ static int hb_mc_loader_load_tile_icache(hb_mc_manycore_t *mc,
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Load several tiles' ICACHEs with one stream of requests.
+ * @param[in] mc       A manycore instance.
+ * @param[in] phdr     The program header to be loaded.
+ * @param[in] segdata  The program data to be loaded.
+ * @param[in] tiles    Tiles whose ICACHE needs to be initialized.
+ * @param[in] ntiles   Number of tiles.
+ * @return HB_MC_NOIMPL if the ICACHEs must be loaded one tile at a time.
+ *         HB_MC_SUCCESS if succseful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_load_tiles_icache_fanout(hb_mc_manycore_t *mc,
+                                                 const Elf32_Phdr *phdr,
+                                                 const unsigned char *segdata,
+                                                 const hb_mc_coordinate_t *tiles,
+                                                 uint32_t ntiles)
+{
+        hb_mc_transfer_t *xfer = nullptr;
+        size_t sz;
+        int rc;
+
+        /* write min(icache size, segment size) bytes; every tile must agree */
+        sz = min_size_t(RV32_Word_to_host(phdr->p_filesz),
+                        hb_mc_tile_get_size_icache(mc, &tiles[0]));
+        for (uint32_t i = 1; i < ntiles; i++) {
+                if (min_size_t(RV32_Word_to_host(phdr->p_filesz),
+                               hb_mc_tile_get_size_icache(mc, &tiles[i])) != sz)
+                        return HB_MC_NOIMPL;
+        }
+
+        /* see hb_mc_loader_load_tile_icache() */
+        if ((HB_MC_TILE_EPA_ICACHE + sz - 1) & 0x00FFF000)
+                return HB_MC_NOIMPL;
+
+        if (((uintptr_t)segdata & 0x3) || (sz & 0x3))
+                return HB_MC_NOIMPL;
+
+        std::vector<hb_mc_npa_t> icache_npas(ntiles);
+        for (uint32_t i = 0; i < ntiles; i++)
+                icache_npas[i] = hb_mc_npa(tiles[i], HB_MC_TILE_EPA_ICACHE);
+
+        bsg_pr_dbg("%s: writing %zu bytes to %" PRIu32 " icaches\n", __func__, sz, ntiles);
+
+        rc = hb_mc_manycore_write_mem_fanout_async(mc, icache_npas.data(), ntiles,
+                                                   segdata, sz, nullptr, nullptr, &xfer);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        return hb_mc_loader_fanout_wait(mc, &xfer, 1);
+}
+
 /**
  * Load tiles' ICACHE.
  * @param[in] mc       A manycore instance.
@@ -406,6 +590,10 @@ static int hb_mc_loader_load_tiles_icache(hb_mc_manycore_t *mc,
                                           uint32_t ntiles)
 {       int rc;
 
+        rc = hb_mc_loader_load_tiles_icache_fanout(mc, phdr, segdata, tiles, ntiles);
+        if (rc != HB_MC_NOIMPL)
+                return rc;
+
         for (uint32_t i = 0; i < ntiles; i++) {
                 rc = hb_mc_loader_load_tile_icache(mc, map, phdr, segdata, tiles[i]);
                 if (rc != HB_MC_SUCCESS)
@@ -681,6 +869,11 @@ static int hb_mc_loader_load_segments(const void *bin, size_t sz,
         return HB_MC_SUCCESS;
 }
 
+/* tile registers the loader sets; tiles are always frozen */
+#define HB_MC_LOADER_REG_ORIGIN       0x1 //!< the tile group origin
+#define HB_MC_LOADER_REG_DRAM_ENABLED 0x2 //!< DRAM-enabled, and victim cache tags in no-DRAM mode
+#define HB_MC_LOADER_REG_ALL          (HB_MC_LOADER_REG_ORIGIN | HB_MC_LOADER_REG_DRAM_ENABLED)
+
 /**
  * Perform register setup for a tile.
  * @param[in] mc         A manycore instance.
@@ -688,13 +881,15 @@ static int hb_mc_loader_load_segments(const void *bin, size_t sz,
  * @param[in] tile       A tile to setup.
  * @param[in] all_tiles  All tiles being loaded.
  * @param[in] ntiles     Number of tiles being loaded.
+ * @param[in] regs       HB_MC_LOADER_REG_* flags of the registers to set.
  * @return
  */
 static int hb_mc_loader_tile_set_registers(hb_mc_manycore_t *mc,
                                            const hb_mc_eva_map_t *map,
                                            hb_mc_coordinate_t tile,
                                            const hb_mc_coordinate_t *all_tiles,
-                                           uint32_t ntiles)
+                                           uint32_t ntiles,
+                                           unsigned regs)
 {
         int rc;
 
@@ -709,7 +904,8 @@ static int hb_mc_loader_tile_set_registers(hb_mc_manycore_t *mc,
         }
 
         /* set the origin tile */
-        rc = hb_mc_tile_set_origin(mc, &tile, &all_tiles[0]); // we assume 0 is the origin
+        if (regs & HB_MC_LOADER_REG_ORIGIN)
+                rc = hb_mc_tile_set_origin(mc, &tile, &all_tiles[0]); // we assume 0 is the origin
 
         if (rc != HB_MC_SUCCESS) {
                 bsg_pr_dbg("%s: failed to write (%d,%d)'s origin registers: %s\n",
@@ -721,7 +917,9 @@ static int hb_mc_loader_tile_set_registers(hb_mc_manycore_t *mc,
         }
 
         /* set/clear DRAM enabled */
-        if (hb_mc_manycore_dram_is_enabled(mc)) {
+        if (!(regs & HB_MC_LOADER_REG_DRAM_ENABLED)) {
+                rc = HB_MC_SUCCESS;
+        } else if (hb_mc_manycore_dram_is_enabled(mc)) {
                 rc = hb_mc_tile_set_dram_enabled(mc, &tile);
         } else {
                 rc = hb_mc_tile_clear_dram_enabled(mc, &tile);
@@ -746,17 +944,19 @@ static int hb_mc_loader_tile_set_registers(hb_mc_manycore_t *mc,
  * @param[in] tile    A tile to initialize
  * @param[in] tiles   The list of tiles being initialized.
  * @param[in] ntiles  The number of tiles being initialized.
+ * @param[in] regs    HB_MC_LOADER_REG_* flags of the registers to set.
  * @return HB_MC_SUCCESS if an error occured. Otherwise an error code is returned.
  */
 static int hb_mc_loader_tile_initialize(hb_mc_manycore_t *mc,
                                         const hb_mc_eva_map_t *map,
                                         hb_mc_coordinate_t tile,
                                         const hb_mc_coordinate_t *all_tiles,
-                                        uint32_t ntiles)
+                                        uint32_t ntiles,
+                                        unsigned regs)
 {
         int rc;
 
-        rc = hb_mc_loader_tile_set_registers(mc, map, tile, all_tiles, ntiles);
+        rc = hb_mc_loader_tile_set_registers(mc, map, tile, all_tiles, ntiles, regs);
         if (rc != HB_MC_SUCCESS)
                 return rc;
 
@@ -842,12 +1042,14 @@ static int hb_mc_loader_columns_validate_victim_cache(hb_mc_manycore_t *mc,
  * @param[in] map     An EVA<->NPA map.
  * @param[in] tiles   The list of tiles to initialize.
  * @param[in] ntiles  The number of tiles to initialize.
+ * @param[in] regs    HB_MC_LOADER_REG_* flags of the registers to set.
  * @return HB_MC_SUCCESS if an error occured. Otherwise an error code is returned.
  */
 static int hb_mc_loader_tiles_initialize(hb_mc_manycore_t *mc,
                                          const hb_mc_eva_map_t *map,
                                          const hb_mc_coordinate_t *tiles,
-                                         uint32_t ntiles)
+                                         uint32_t ntiles,
+                                         unsigned regs)
 {
         int rc;
 
@@ -855,13 +1057,13 @@ static int hb_mc_loader_tiles_initialize(hb_mc_manycore_t *mc,
                 return HB_MC_INVALID;
 
         for (uint32_t i = 0; i < ntiles; i++) {
-                rc = hb_mc_loader_tile_initialize(mc, map, tiles[i], tiles, ntiles);
+                rc = hb_mc_loader_tile_initialize(mc, map, tiles[i], tiles, ntiles, regs);
                 if (rc != HB_MC_SUCCESS)
                         return rc;
         }
 
         /* validate all vcache tags if we're in no-DRAM mode */
-        if (!hb_mc_manycore_dram_is_enabled(mc)) {
+        if (!hb_mc_manycore_dram_is_enabled(mc) && (regs & HB_MC_LOADER_REG_DRAM_ENABLED)) {
                 rc = hb_mc_loader_columns_validate_victim_cache(mc, map);
                 if (rc != HB_MC_SUCCESS)
                         return rc;
@@ -897,7 +1099,7 @@ int hb_mc_loader_load(const void *bin, size_t sz, hb_mc_manycore_t *mc,
         }
 
         // Set CSRs
-        rc = hb_mc_loader_tiles_initialize(mc, map, tiles, ntiles);
+        rc = hb_mc_loader_tiles_initialize(mc, map, tiles, ntiles, HB_MC_LOADER_REG_ALL);
         if (rc != HB_MC_SUCCESS) {
                 bsg_pr_dbg("%s: failed to initialize tiles\n", __func__);
                 return rc;
@@ -1036,6 +1238,183 @@ static int hb_mc_loader_symbol_search_symbol_tables(const void *bin, size_t sz,
         return HB_MC_NOTFOUND;
 }
 
+struct hb_mc_loader_symbol {
+        hb_mc_eva_t eva;
+        size_t size;
+};
+
+struct hb_mc_loader_symbols {
+        std::unordered_map<std::string, hb_mc_loader_symbol> index; //!< symbol name -> eva and size
+};
+
+static int hb_mc_loader_symbols_index_symbol_table(const void *bin, size_t sz,
+                                                   const Elf32_Shdr *symtab_shdr,
+                                                   const unsigned char *symtab_data,
+                                                   hb_mc_loader_symbols_t *syms)
+{
+        int rc;
+        unsigned strtab_idx = RV32_Word_to_host(symtab_shdr->sh_link);
+        const Elf32_Shdr *strtab_shdr;
+        const unsigned char *strtab_data;
+        const Elf32_Sym *symbol_table = (const Elf32_Sym*)symtab_data;
+
+        /* get the string table for this section */
+        rc = hb_mc_loader_get_section(bin, sz, strtab_idx,
+                                      &strtab_shdr, &strtab_data);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to get section %u: %s\n",
+                           __func__, strtab_idx, hb_mc_strerror(rc));
+                return rc;
+        }
+
+        Elf32_Word strtab_sz = RV32_Word_to_host(strtab_shdr->sh_size);
+        Elf32_Word entsize = RV32_Word_to_host(symtab_shdr->sh_entsize);
+        if (entsize < sizeof(Elf32_Sym))
+                return HB_MC_INVALID;
+
+        /* total number of symbols in symtab */
+        Elf32_Word sym_n = RV32_Word_to_host(symtab_shdr->sh_size)/entsize;
+
+        for (Elf32_Word sym_i = 0; sym_i < sym_n; sym_i++) {
+                const Elf32_Sym *sym = &symbol_table[sym_i];
+                Elf32_Word sym_name_off = RV32_Word_to_host(sym->st_name);
+
+                /* skip symbols with no name */
+                if (sym_name_off == 0)
+                        continue;
+
+                /* symbol's name is in bounds? */
+                if (sym_name_off >= strtab_sz)
+                        return HB_MC_INVALID;
+
+                const char *sym_name = (const char *)&strtab_data[sym_name_off];
+                size_t sym_name_len = strnlen(sym_name, strtab_sz - sym_name_off);
+
+                /* the first definition wins, as with a linear search */
+                hb_mc_loader_symbol entry;
+                entry.eva = RV32_Addr_to_host(sym->st_value);
+                entry.size = RV32_Word_to_host(sym->st_size);
+                syms->index.emplace(std::string(sym_name, sym_name_len), entry);
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Add a program's symbols to a symbol index.
+ * @param[in]  bin     A memory buffer containing a valid manycore binary.
+ * @param[in]  sz      Size of #bin in bytes.
+ * @param[out] syms    A symbol index to which symbols are added.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_symbols_index(const void *bin, size_t sz, hb_mc_loader_symbols_t *syms)
+{
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr*) bin;
+        const Elf32_Shdr *shdr;
+        const unsigned char *section_data;
+        int rc;
+
+        for (unsigned idx = 0; idx < RV32_Half_to_host(ehdr->e_shnum); idx++) {
+                rc = hb_mc_loader_get_section(bin, sz, idx, &shdr, &section_data);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_dbg("%s: failed to get section %u: %s\n",
+                                   __func__, idx, hb_mc_strerror(rc));
+                        return rc;
+                }
+
+                if (!hb_mc_loader_section_is_symbol_table(shdr))
+                        continue;
+
+                try {
+                        rc = hb_mc_loader_symbols_index_symbol_table(bin, sz, shdr,
+                                                                     section_data,
+                                                                     syms);
+                } catch (const std::bad_alloc &) {
+                        rc = HB_MC_NOMEM;
+                }
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_dbg("%s: failed to index symbols in section %u: %s\n",
+                                   __func__, idx, hb_mc_strerror(rc));
+                        return rc;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Build a symbol index for a program.
+ * @param[in]  bin     A memory buffer containing a valid manycore binary.
+ * @param[in]  sz      Size of #bin in bytes.
+ * @param[out] syms    Set to a symbol index. Free with hb_mc_loader_symbols_exit().
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_loader_symbols_init(const void *bin, size_t sz, hb_mc_loader_symbols_t **syms)
+{
+        hb_mc_loader_symbols_t *index;
+        int rc;
+
+        if (!syms)
+                return HB_MC_INVALID;
+
+        rc = hb_mc_loader_elf_validate(bin, sz);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to validate binary\n", __func__);
+                return rc;
+        }
+
+        try {
+                index = new hb_mc_loader_symbols;
+        } catch (const std::bad_alloc &) {
+                return HB_MC_NOMEM;
+        }
+
+        rc = hb_mc_loader_symbols_index(bin, sz, index);
+        if (rc != HB_MC_SUCCESS) {
+                delete index;
+                return rc;
+        }
+
+        *syms = index;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Free a symbol index.
+ * @param[in]  syms    A symbol index built with hb_mc_loader_symbols_init(), or NULL.
+ */
+void hb_mc_loader_symbols_exit(hb_mc_loader_symbols_t *syms)
+{
+        delete syms;
+}
+
+/**
+ * Look up a symbol in a symbol index.
+ * @param[in]  syms    A symbol index built with hb_mc_loader_symbols_init().
+ * @param[in]  symbol  A program symbol.
+ * @param[out] eva     An EVA that addresses #symbol.
+ * @param[out] size    Set to the size of #symbol in bytes. May be NULL.
+ * @return HB_MC_NOTFOUND if #symbol is not in the program. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_loader_symbols_lookup(const hb_mc_loader_symbols_t *syms, const char *symbol,
+                                hb_mc_eva_t *eva, size_t *size)
+{
+        if (!syms || !symbol || !eva)
+                return HB_MC_INVALID;
+
+        auto it = syms->index.find(symbol);
+        if (it == syms->index.end()) {
+                bsg_pr_dbg("%s: failed to find symbol '%s'\n", __func__, symbol);
+                return HB_MC_NOTFOUND;
+        }
+
+        *eva = it->second.eva;
+        if (size)
+                *size = it->second.size;
+
+        return HB_MC_SUCCESS;
+}
+
 /**
  * Get an EVA for a symbol from a program data.
  * @param[in]  bin     A memory buffer containing a valid manycore binary.
@@ -1071,8 +1450,1246 @@ int hb_mc_loader_symbol_to_eva(const void *bin, size_t sz, const char *symbol,
 }
 
 
+////////////////
+// Load plans //
+////////////////
+
+/*
+  A load plan records what hb_mc_loader_load() works out before it sends
+  a packet: which bytes of the binary go to which NPAs. Each run is one
+  contiguous range of NPAs and is either a slice of the binary or zeros.
+  Replaying a plan skips ELF parsing, segment classification, capacity
+  checks, and EVA translation.
+
+  Plans are keyed by a hash of the binary and a hash of everything that
+  goes into translation (machine configuration, EVA map, and tiles), so
+  a plan saved to a cache directory can be replayed by a later process.
+  Plan files are in host byte order; they are a cache, not an interchange
+  format.
+*/
+
+#define HB_MC_LOADER_PLAN_MAGIC     0x504c4248 /* "HBLP" */
+#define HB_MC_LOADER_PLAN_VERSION   2
+#define HB_MC_LOADER_PLAN_ZERO_FILL 0xFFFFFFFF
+#define HB_MC_LOADER_PLAN_WRITABLE  0x1
+
+#define HB_MC_LOADER_FNV_OFFSET 0xcbf29ce484222325ULL
+#define HB_MC_LOADER_FNV_PRIME  0x100000001b3ULL
+
+typedef enum {
+        HB_MC_LOADER_PLAN_ONCE   = 0, //!< a run of absolute NPAs (e.g. DRAM)
+        HB_MC_LOADER_PLAN_EACH   = 1, //!< a run of EPAs in every tile (e.g. DMEM)
+        HB_MC_LOADER_PLAN_ICACHE = 2, //!< a run of EPAs in every tile's ICACHE
+} hb_mc_loader_plan_class_t;
+
+/* one run of a load plan; saved to plan files as-is */
+struct hb_mc_loader_plan_run {
+        uint32_t cls;    //!< a hb_mc_loader_plan_class_t
+        uint32_t x;      //!< destination X of a HB_MC_LOADER_PLAN_ONCE run
+        uint32_t y;      //!< destination Y of a HB_MC_LOADER_PLAN_ONCE run
+        uint32_t epa;    //!< first EPA of the run
+        uint32_t size;   //!< bytes in the run
+        uint32_t offset; //!< offset of the data in the binary, or HB_MC_LOADER_PLAN_ZERO_FILL
+        uint32_t flags;  //!< HB_MC_LOADER_PLAN_WRITABLE if the program may write the run
+};
+
+/* the header of a plan file; followed by runs, then symbols */
+struct hb_mc_loader_plan_header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t bin_hash;
+        uint64_t config_hash;
+        uint64_t bin_size;
+        uint32_t nruns;
+        uint32_t nsymbols;
+};
+
+/* a symbol in a plan file; followed by #name_len bytes of name */
+struct hb_mc_loader_plan_symbol {
+        uint32_t eva;
+        uint32_t size;
+        uint32_t name_len;
+};
+
+struct hb_mc_loader_plan {
+        uint64_t bin_hash;                        //!< hash of the binary
+        uint64_t config_hash;                     //!< hash of the machine, map, and tiles
+        uint64_t bin_size;                        //!< size of the binary
+        std::vector<hb_mc_loader_plan_run> runs;  //!< runs in load order
+        hb_mc_loader_symbols_t symbols;           //!< the program's symbols
+};
+
+static uint64_t hb_mc_loader_fnv1a(uint64_t hash, const void *data, size_t sz)
+{
+        const unsigned char *p = (const unsigned char *)data;
+
+        for (size_t i = 0; i < sz; i++) {
+                hash ^= p[i];
+                hash *= HB_MC_LOADER_FNV_PRIME;
+        }
+
+        return hash;
+}
+
+/**
+ * Hash everything a load plan's translation depends on.
+ * @param[in] mc       A manycore instance.
+ * @param[in] map      An EVA<->NPA map.
+ * @param[in] tiles    Tiles to load.
+ * @param[in] ntiles   The number of tiles to load.
+ * @return A hash of #mc's configuration, #map, and #tiles.
+ */
+static uint64_t hb_mc_loader_plan_config_hash(hb_mc_manycore_t *mc,
+                                              const hb_mc_eva_map_t *map,
+                                              const hb_mc_coordinate_t *tiles,
+                                              uint32_t ntiles)
+{
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        const char *name = hb_mc_eva_map_get_name(map);
+        uint64_t hash = HB_MC_LOADER_FNV_OFFSET;
+
+        uint32_t fields[] = {
+                HB_MC_LOADER_PLAN_VERSION,
+                cfg->design_version.major,
+                cfg->design_version.minor,
+                cfg->design_version.revision,
+                cfg->network_bitwidth_addr,
+                cfg->network_bitwidth_data,
+                hb_mc_dimension_get_x(cfg->vcore_dimensions),
+                hb_mc_dimension_get_y(cfg->vcore_dimensions),
+                hb_mc_coordinate_get_x(cfg->host_interface),
+                hb_mc_coordinate_get_y(cfg->host_interface),
+                cfg->basejump,
+                cfg->manycore,
+                cfg->f1,
+                cfg->vcache_ways,
+                cfg->vcache_sets,
+                cfg->vcache_block_words,
+                cfg->vcache_stripe_words,
+                (uint32_t)hb_mc_manycore_dram_is_enabled(mc),
+                ntiles,
+        };
+
+        hash = hb_mc_loader_fnv1a(hash, fields, sizeof(fields));
+        if (name != NULL)
+                hash = hb_mc_loader_fnv1a(hash, name, strlen(name));
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                uint32_t xy[] = {
+                        hb_mc_coordinate_get_x(tiles[i]),
+                        hb_mc_coordinate_get_y(tiles[i]),
+                };
+                hash = hb_mc_loader_fnv1a(hash, xy, sizeof(xy));
+        }
+
+        return hash;
+}
 
+/**
+ * Append a run to a load plan, extending the last run if they are contiguous.
+ * @param[in] plan     A load plan.
+ * @param[in] run      A run to append.
+ */
+static void hb_mc_loader_plan_add_run(hb_mc_loader_plan_t *plan,
+                                      const hb_mc_loader_plan_run &run)
+{
+        if (!plan->runs.empty()) {
+                hb_mc_loader_plan_run &last = plan->runs.back();
+                bool zeros = run.offset == HB_MC_LOADER_PLAN_ZERO_FILL;
+                bool last_zeros = last.offset == HB_MC_LOADER_PLAN_ZERO_FILL;
+
+                if (last.cls == run.cls && last.x == run.x && last.y == run.y
+                    && last.flags == run.flags
+                    && last.epa + last.size == run.epa
+                    && zeros == last_zeros
+                    && (zeros || last.offset + last.size == run.offset)) {
+                        last.size += run.size;
+                        return;
+                }
+        }
 
+        plan->runs.push_back(run);
+}
+
+/**
+ * Get the run flags of a program segment.
+ * @param[in] phdr     A program header for the segment.
+ * @return HB_MC_LOADER_PLAN_* flags for runs of the segment.
+ */
+static uint32_t hb_mc_loader_plan_segment_flags(const Elf32_Phdr *phdr)
+{
+        return (RV32_Word_to_host(phdr->p_flags) & PF_W) ? HB_MC_LOADER_PLAN_WRITABLE : 0;
+}
+
+/**
+ * Plan a program segment that is loaded once (e.g. to DRAM).
+ * @param[in] plan     A load plan.
+ * @param[in] mc       A manycore instance.
+ * @param[in] map      An EVA<->NPA map.
+ * @param[in] phdr     A program header for the segment.
+ * @param[in] tile     The tile relative to which the segment is translated.
+ * @return HB_MC_NOIMPL if the segment cannot be planned.
+ *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_segment_once(hb_mc_loader_plan_t *plan,
+                                          hb_mc_manycore_t *mc,
+                                          const hb_mc_eva_map_t *map,
+                                          const Elf32_Phdr *phdr,
+                                          hb_mc_coordinate_t tile)
+{
+        hb_mc_eva_t eva = RV32_Addr_to_host(phdr->p_paddr);
+        size_t segoff = RV32_Off_to_host(phdr->p_offset);
+        size_t seg_sz = RV32_Word_to_host(phdr->p_memsz);
+        size_t file_sz = RV32_Word_to_host(phdr->p_filesz);
+        int rc;
+
+        rc = hb_mc_loader_check_tile_segment_capacity(mc, map, phdr, tile);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        /* runs move whole words */
+        if ((eva & 0x3) || (segoff & 0x3) || (file_sz & 0x3) || (seg_sz & 0x3))
+                return HB_MC_NOIMPL;
+
+        for (size_t pos = 0; pos < seg_sz; ) {
+                hb_mc_eva_t run_eva = eva + pos;
+                hb_mc_npa_t npa;
+                size_t contiguous;
+
+                rc = hb_mc_eva_to_npa(mc, map, &tile, &run_eva, &npa, &contiguous);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+
+                /* a run is all initialized data or all zeros */
+                size_t end = pos < file_sz ? file_sz : seg_sz;
+                size_t len = min_size_t(contiguous, end - pos);
+                if (len == 0 || (len & 0x3))
+                        return HB_MC_NOIMPL;
+
+                hb_mc_loader_plan_run run;
+                run.cls = HB_MC_LOADER_PLAN_ONCE;
+                run.x = hb_mc_npa_get_x(&npa);
+                run.y = hb_mc_npa_get_y(&npa);
+                run.epa = hb_mc_npa_get_epa(&npa);
+                run.size = len;
+                run.offset = pos < file_sz ? segoff + pos : HB_MC_LOADER_PLAN_ZERO_FILL;
+                run.flags = hb_mc_loader_plan_segment_flags(phdr);
+                hb_mc_loader_plan_add_run(plan, run);
+
+                pos += len;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Plan a program segment that is loaded into each tile (e.g. to DMEM).
+ * @param[in] plan     A load plan.
+ * @param[in] mc       A manycore instance.
+ * @param[in] map      An EVA<->NPA map.
+ * @param[in] phdr     A program header for the segment.
+ * @param[in] tiles    Tiles to load.
+ * @param[in] ntiles   The number of tiles to load.
+ * @return HB_MC_NOIMPL if the segment cannot be planned.
+ *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_segment_each(hb_mc_loader_plan_t *plan,
+                                          hb_mc_manycore_t *mc,
+                                          const hb_mc_eva_map_t *map,
+                                          const Elf32_Phdr *phdr,
+                                          const hb_mc_coordinate_t *tiles,
+                                          uint32_t ntiles)
+{
+        hb_mc_eva_t eva = RV32_Addr_to_host(phdr->p_paddr);
+        size_t segoff = RV32_Off_to_host(phdr->p_offset);
+        size_t seg_sz = RV32_Word_to_host(phdr->p_memsz);
+        size_t file_sz = RV32_Word_to_host(phdr->p_filesz);
+        hb_mc_epa_t epa = 0;
+        int rc;
+
+        if ((eva & 0x3) || (segoff & 0x3) || (file_sz & 0x3) || (seg_sz & 0x3))
+                return HB_MC_NOIMPL;
+
+        /*
+          The plan stores one EPA for all tiles, so the segment must land
+          at the same EPA inside each tile, in one run.
+        */
+        for (uint32_t i = 0; i < ntiles; i++) {
+                hb_mc_npa_t npa;
+                size_t contiguous;
+
+                rc = hb_mc_loader_check_tile_segment_capacity(mc, map, phdr, tiles[i]);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+
+                if (seg_sz == 0)
+                        continue;
+
+                rc = hb_mc_eva_to_npa(mc, map, &tiles[i], &eva, &npa, &contiguous);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+
+                if (contiguous < seg_sz
+                    || hb_mc_npa_get_x(&npa) != hb_mc_coordinate_get_x(tiles[i])
+                    || hb_mc_npa_get_y(&npa) != hb_mc_coordinate_get_y(tiles[i])
+                    || (i > 0 && hb_mc_npa_get_epa(&npa) != epa))
+                        return HB_MC_NOIMPL;
+
+                epa = hb_mc_npa_get_epa(&npa);
+        }
+
+        hb_mc_loader_plan_run run;
+        run.cls = HB_MC_LOADER_PLAN_EACH;
+        run.x = 0;
+        run.y = 0;
+        run.flags = hb_mc_loader_plan_segment_flags(phdr);
+
+        if (file_sz > 0) {
+                run.epa = epa;
+                run.size = file_sz;
+                run.offset = segoff;
+                hb_mc_loader_plan_add_run(plan, run);
+        }
+
+        if (seg_sz > file_sz) {
+                run.epa = epa + file_sz;
+                run.size = seg_sz - file_sz;
+                run.offset = HB_MC_LOADER_PLAN_ZERO_FILL;
+                hb_mc_loader_plan_add_run(plan, run);
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Plan the ICACHE image of each tile.
+ * @param[in] plan     A load plan.
+ * @param[in] mc       A manycore instance.
+ * @param[in] phdr     The program header of the ICACHE segment.
+ * @param[in] tiles    Tiles to load.
+ * @param[in] ntiles   The number of tiles to load.
+ * @return HB_MC_NOIMPL if the ICACHEs cannot be planned.
+ *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_icache(hb_mc_loader_plan_t *plan,
+                                    hb_mc_manycore_t *mc,
+                                    const Elf32_Phdr *phdr,
+                                    const hb_mc_coordinate_t *tiles,
+                                    uint32_t ntiles)
+{
+        size_t segoff = RV32_Off_to_host(phdr->p_offset);
+        size_t file_sz = RV32_Word_to_host(phdr->p_filesz);
+        size_t sz;
+
+        /* every tile gets min(icache size, segment size) bytes */
+        sz = min_size_t(file_sz, hb_mc_tile_get_size_icache(mc, &tiles[0]));
+        for (uint32_t i = 1; i < ntiles; i++) {
+                if (min_size_t(file_sz, hb_mc_tile_get_size_icache(mc, &tiles[i])) != sz)
+                        return HB_MC_NOIMPL;
+        }
+
+        /* see hb_mc_loader_load_tile_icache() */
+        if ((HB_MC_TILE_EPA_ICACHE + sz - 1) & 0x00FFF000) {
+                bsg_pr_dbg("%s: Oops: ICACHE EPA 0x%08" PRIx32 " sets tag bits\n",
+                           __func__, (uint32_t)HB_MC_TILE_EPA_ICACHE);
+                return HB_MC_FAIL;
+        }
+
+        if ((segoff & 0x3) || (sz & 0x3) || sz == 0)
+                return HB_MC_NOIMPL;
+
+        hb_mc_loader_plan_run run;
+        run.cls = HB_MC_LOADER_PLAN_ICACHE;
+        run.x = 0;
+        run.y = 0;
+        run.flags = 0;
+        run.epa = HB_MC_TILE_EPA_ICACHE;
+        run.size = sz;
+        run.offset = segoff;
+        hb_mc_loader_plan_add_run(plan, run);
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Compile a load plan for a binary.
+ * @param[in]  bin          A memory buffer containing a valid manycore binary.
+ * @param[in]  sz           Size of #bin in bytes.
+ * @param[in]  mc           A manycore instance.
+ * @param[in]  map          An EVA<->NPA map.
+ * @param[in]  tiles        Tiles to load.
+ * @param[in]  ntiles       The number of tiles to load.
+ * @param[in]  bin_hash     The hash of #bin.
+ * @param[in]  config_hash  The hash of #mc, #map, and #tiles.
+ * @param[out] plan         Set to a load plan.
+ * @return HB_MC_NOIMPL if #bin cannot be planned.
+ *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_compile(const void *bin, size_t sz,
+                                     hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                     const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                                     uint64_t bin_hash, uint64_t config_hash,
+                                     hb_mc_loader_plan_t **plan)
+{
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)bin;
+        const Elf32_Phdr *phdr, *icache_phdr = nullptr;
+        const unsigned char *segdata;
+        hb_mc_loader_plan_t *p;
+        int rc;
+
+        /* the plan stores offsets into the binary as 32-bit values */
+        if (sz >= HB_MC_LOADER_PLAN_ZERO_FILL)
+                return HB_MC_NOIMPL;
+
+        try {
+                p = new hb_mc_loader_plan;
+        } catch (const std::bad_alloc &) {
+                return HB_MC_NOMEM;
+        }
+
+        p->bin_hash = bin_hash;
+        p->config_hash = config_hash;
+        p->bin_size = sz;
+
+        try {
+                for (int segidx = 0; segidx < RV32_Half_to_host(ehdr->e_phnum); segidx++) {
+                        rc = hb_mc_loader_get_segment(bin, sz, segidx, &phdr, &segdata);
+                        if (rc != HB_MC_SUCCESS)
+                                goto cleanup;
+
+                        /* classify segments the way hb_mc_loader_load_segments() does */
+                        if (hb_mc_loader_segment_is_load_never(mc, phdr, map, tiles, ntiles)) {
+                                continue;
+                        } else if (hb_mc_loader_segment_is_load_once(mc, phdr, map, tiles, ntiles)) {
+                                rc = hb_mc_loader_plan_segment_once(p, mc, map, phdr, tiles[0]);
+                        } else {
+                                rc = hb_mc_loader_plan_segment_each(p, mc, map, phdr, tiles, ntiles);
+                        }
+                        if (rc != HB_MC_SUCCESS)
+                                goto cleanup;
+
+                        if (hb_mc_loader_segment_is_load_icache(mc, phdr, map, tiles, ntiles))
+                                icache_phdr = phdr;
+                }
+
+                if (icache_phdr == nullptr) {
+                        bsg_pr_dbg("%s: no ICACHE segment\n", __func__);
+                        rc = HB_MC_INVALID;
+                        goto cleanup;
+                }
+
+                rc = hb_mc_loader_plan_icache(p, mc, icache_phdr, tiles, ntiles);
+                if (rc != HB_MC_SUCCESS)
+                        goto cleanup;
+        } catch (const std::bad_alloc &) {
+                rc = HB_MC_NOMEM;
+                goto cleanup;
+        }
+
+        rc = hb_mc_loader_symbols_index(bin, sz, &p->symbols);
+        if (rc != HB_MC_SUCCESS)
+                goto cleanup;
+
+        *plan = p;
+        return HB_MC_SUCCESS;
+
+cleanup:
+        delete p;
+        return rc;
+}
+
+/**
+ * Check the arguments common to the load plan API.
+ * @return HB_MC_SUCCESS if the arguments are valid. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_check_args(const void *bin, size_t sz,
+                                        hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                        const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+{
+        if (!bin || !mc || !map || !tiles || ntiles < 1)
+                return HB_MC_INVALID;
+
+        return hb_mc_loader_elf_validate(bin, sz);
+}
+
+/**
+ * Compile a load plan for a binary.
+ * @param[in]  bin     A memory buffer containing a valid manycore binary.
+ * @param[in]  sz      Size of #bin in bytes.
+ * @param[in]  mc      A manycore instance.
+ * @param[in]  map     An EVA<->NPA map.
+ * @param[in]  tiles   Tiles to load.
+ * @param[in]  ntiles  The number of tiles to load.
+ * @param[out] plan    Set to a load plan. Free with hb_mc_loader_plan_exit().
+ * @return HB_MC_NOIMPL if #bin cannot be planned and must be loaded with hb_mc_loader_load().
+ *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_loader_plan_init(const void *bin, size_t sz,
+                           hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                           const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                           hb_mc_loader_plan_t **plan)
+{
+        int rc;
+
+        if (!plan)
+                return HB_MC_INVALID;
+
+        rc = hb_mc_loader_plan_check_args(bin, sz, mc, map, tiles, ntiles);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        return hb_mc_loader_plan_compile(bin, sz, mc, map, tiles, ntiles,
+                                         hb_mc_loader_fnv1a(HB_MC_LOADER_FNV_OFFSET, bin, sz),
+                                         hb_mc_loader_plan_config_hash(mc, map, tiles, ntiles),
+                                         plan);
+}
+
+/**
+ * Free a load plan.
+ * @param[in]  plan    A load plan, or NULL.
+ */
+void hb_mc_loader_plan_exit(hb_mc_loader_plan_t *plan)
+{
+        delete plan;
+}
+
+/**
+ * Write a load plan to a file.
+ * The plan is written to a uniquely named temporary file in the same
+ * directory which is renamed to #path, so that concurrent readers never
+ * see a partial plan and concurrent writers never share a file.
+ * @param[in]  plan    A load plan.
+ * @param[in]  path    The path of the plan file.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_save(const hb_mc_loader_plan_t *plan, const std::string &path)
+{
+        std::string tmp = path + ".XXXXXX";
+        hb_mc_loader_plan_header hdr;
+        bool ok;
+        FILE *f;
+        int fd;
+
+        if ((fd = mkstemp(&tmp[0])) < 0) {
+                bsg_pr_dbg("%s: failed to create '%s': %m\n", __func__, tmp.c_str());
+                return HB_MC_FAIL;
+        }
+
+        /* mkstemp() creates the file 0600; plans are shared like the directory */
+        if (fchmod(fd, 0644) != 0 || !(f = fdopen(fd, "wb"))) {
+                bsg_pr_dbg("%s: failed to open '%s': %m\n", __func__, tmp.c_str());
+                close(fd);
+                unlink(tmp.c_str());
+                return HB_MC_FAIL;
+        }
+
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.magic = HB_MC_LOADER_PLAN_MAGIC;
+        hdr.version = HB_MC_LOADER_PLAN_VERSION;
+        hdr.bin_hash = plan->bin_hash;
+        hdr.config_hash = plan->config_hash;
+        hdr.bin_size = plan->bin_size;
+        hdr.nruns = plan->runs.size();
+        hdr.nsymbols = plan->symbols.index.size();
+
+        ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+        if (ok && !plan->runs.empty())
+                ok = fwrite(plan->runs.data(), sizeof(plan->runs[0]), plan->runs.size(), f)
+                        == plan->runs.size();
+
+        for (const auto &sym : plan->symbols.index) {
+                if (!ok)
+                        break;
+
+                hb_mc_loader_plan_symbol rec;
+                rec.eva = sym.second.eva;
+                rec.size = sym.second.size;
+                rec.name_len = sym.first.size();
+                ok = fwrite(&rec, sizeof(rec), 1, f) == 1
+                        && fwrite(sym.first.data(), 1, rec.name_len, f) == rec.name_len;
+        }
+
+        if (fclose(f) != 0)
+                ok = false;
+
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+                bsg_pr_dbg("%s: failed to write '%s': %m\n", __func__, path.c_str());
+                unlink(tmp.c_str());
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Check that a run read from a plan file stays inside the binary and the machine.
+ * @param[in]  run       A run read from a plan file.
+ * @param[in]  cfg       The configuration of the machine the plan is for.
+ * @param[in]  bin_size  The size of the binary the plan is for.
+ * @return true if the run can be replayed safely.
+ */
+static bool hb_mc_loader_plan_run_is_valid(const hb_mc_loader_plan_run &run,
+                                           const hb_mc_config_t *cfg, uint64_t bin_size)
+{
+        hb_mc_dimension_t net = hb_mc_config_get_dimension_network(cfg);
+        uint64_t epa_limit = 1ull << (hb_mc_config_get_network_bitwidth_addr(cfg) + 2);
+
+        if (run.cls > HB_MC_LOADER_PLAN_ICACHE || run.size == 0 || (run.size & 0x3)
+            || (run.flags & ~HB_MC_LOADER_PLAN_WRITABLE))
+                return false;
+
+        /* never replay a run that reads outside the binary */
+        if (run.offset != HB_MC_LOADER_PLAN_ZERO_FILL
+            && (uint64_t)run.offset + run.size > bin_size)
+                return false;
+
+        if ((uint64_t)run.epa + run.size > epa_limit)
+                return false;
+
+        /* runs to absolute NPAs must target a node on the network */
+        if (run.cls == HB_MC_LOADER_PLAN_ONCE
+            && (run.x >= hb_mc_dimension_get_x(net) || run.y >= hb_mc_dimension_get_y(net)))
+                return false;
+
+        return true;
+}
+
+/**
+ * Read a load plan from a file.
+ * @param[in]  path         The path of the plan file.
+ * @param[in]  cfg          The configuration of the machine the plan is for.
+ * @param[in]  bin_hash     The expected hash of the binary.
+ * @param[in]  config_hash  The expected hash of the machine, map, and tiles.
+ * @param[in]  bin_size     The expected size of the binary.
+ * @param[out] plan         Set to a load plan.
+ * @return HB_MC_NOTFOUND if there is no plan file for this key.
+ *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_read(const std::string &path, const hb_mc_config_t *cfg,
+                                  uint64_t bin_hash, uint64_t config_hash, uint64_t bin_size,
+                                  hb_mc_loader_plan_t **plan)
+{
+        hb_mc_loader_plan_header hdr;
+        hb_mc_loader_plan_t *p = nullptr;
+        int rc = HB_MC_INVALID;
+        struct stat st;
+        uint64_t left;
+        FILE *f;
+
+        if (!(f = fopen(path.c_str(), "rb")))
+                return HB_MC_NOTFOUND;
+
+        if (fstat(fileno(f), &st) != 0 || (uint64_t)st.st_size < sizeof(hdr)
+            || fread(&hdr, sizeof(hdr), 1, f) != 1
+            || hdr.magic != HB_MC_LOADER_PLAN_MAGIC
+            || hdr.version != HB_MC_LOADER_PLAN_VERSION)
+                goto cleanup;
+
+        if (hdr.bin_hash != bin_hash || hdr.config_hash != config_hash
+            || hdr.bin_size != bin_size) {
+                rc = HB_MC_NOTFOUND;
+                goto cleanup;
+        }
+
+        /* the counts must fit in the file before anything is allocated for them */
+        left = st.st_size - sizeof(hdr);
+        if ((uint64_t)hdr.nruns * sizeof(hb_mc_loader_plan_run) > left)
+                goto cleanup;
+        left -= (uint64_t)hdr.nruns * sizeof(hb_mc_loader_plan_run);
+        if ((uint64_t)hdr.nsymbols * sizeof(hb_mc_loader_plan_symbol) > left)
+                goto cleanup;
+
+        try {
+                p = new hb_mc_loader_plan;
+                p->bin_hash = hdr.bin_hash;
+                p->config_hash = hdr.config_hash;
+                p->bin_size = hdr.bin_size;
+
+                p->runs.resize(hdr.nruns);
+                if (hdr.nruns > 0
+                    && fread(p->runs.data(), sizeof(p->runs[0]), hdr.nruns, f) != hdr.nruns)
+                        goto cleanup;
+
+                for (const auto &run : p->runs) {
+                        if (!hb_mc_loader_plan_run_is_valid(run, cfg, bin_size))
+                                goto cleanup;
+                }
+
+                for (uint32_t i = 0; i < hdr.nsymbols; i++) {
+                        hb_mc_loader_plan_symbol rec;
+                        hb_mc_loader_symbol sym;
+
+                        if (fread(&rec, sizeof(rec), 1, f) != 1 || left < sizeof(rec)
+                            || rec.name_len > left - sizeof(rec))
+                                goto cleanup;
+                        left -= sizeof(rec) + rec.name_len;
+
+                        std::string name(rec.name_len, '\0');
+                        if (rec.name_len > 0 && fread(&name[0], 1, rec.name_len, f) != rec.name_len)
+                                goto cleanup;
+
+                        sym.eva = rec.eva;
+                        sym.size = rec.size;
+                        p->symbols.index.emplace(std::move(name), sym);
+                }
+        } catch (const std::bad_alloc &) {
+                rc = HB_MC_NOMEM;
+                goto cleanup;
+        }
+
+        fclose(f);
+        *plan = p;
+        return HB_MC_SUCCESS;
+
+cleanup:
+        if (rc == HB_MC_INVALID)
+                bsg_pr_dbg("%s: ignoring malformed plan file '%s'\n", __func__, path.c_str());
+        delete p;
+        fclose(f);
+        return rc;
+}
+
+/**
+ * Get a load plan for a binary from a cache directory, compiling and saving it on a miss.
+ * @param[in]  bin        A memory buffer containing a valid manycore binary.
+ * @param[in]  sz         Size of #bin in bytes.
+ * @param[in]  mc         A manycore instance.
+ * @param[in]  map        An EVA<->NPA map.
+ * @param[in]  tiles      Tiles to load.
+ * @param[in]  ntiles     The number of tiles to load.
+ * @param[in]  cache_dir  A directory of plan files, or NULL to compile without caching.
+ * @param[out] plan       Set to a load plan. Free with hb_mc_loader_plan_exit().
+ * @return HB_MC_NOIMPL if #bin cannot be planned and must be loaded with hb_mc_loader_load().
+ *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_loader_plan_cached(const void *bin, size_t sz,
+                             hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                             const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                             const char *cache_dir, hb_mc_loader_plan_t **plan)
+{
+        uint64_t bin_hash, config_hash;
+        char key[64];
+        int rc;
+
+        if (cache_dir == NULL)
+                return hb_mc_loader_plan_init(bin, sz, mc, map, tiles, ntiles, plan);
+
+        if (!plan)
+                return HB_MC_INVALID;
+
+        rc = hb_mc_loader_plan_check_args(bin, sz, mc, map, tiles, ntiles);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        bin_hash = hb_mc_loader_fnv1a(HB_MC_LOADER_FNV_OFFSET, bin, sz);
+        config_hash = hb_mc_loader_plan_config_hash(mc, map, tiles, ntiles);
+        snprintf(key, sizeof(key), "/%016" PRIx64 "-%016" PRIx64 ".hbplan",
+                 bin_hash, config_hash);
+
+        try {
+                std::string path = std::string(cache_dir) + key;
+
+                /* anything short of a good plan, even a corrupt one, is a cache miss */
+                rc = hb_mc_loader_plan_read(path, hb_mc_manycore_get_config(mc),
+                                            bin_hash, config_hash, sz, plan);
+                if (rc == HB_MC_SUCCESS)
+                        return rc;
+
+                rc = hb_mc_loader_plan_compile(bin, sz, mc, map, tiles, ntiles,
+                                               bin_hash, config_hash, plan);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+
+                /* failing to save only costs the next process a compile */
+                mkdir(cache_dir, 0755);
+                if (hb_mc_loader_plan_save(*plan, path) != HB_MC_SUCCESS)
+                        bsg_pr_dbg("%s: failed to save plan to '%s'\n", __func__, path.c_str());
+        } catch (const std::bad_alloc &) {
+                return HB_MC_NOMEM;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Submit a run of a load plan.
+ * @param[in]  mc       A manycore instance.
+ * @param[in]  run      A run to write.
+ * @param[in]  data     The binary from which the run's plan was compiled.
+ * @param[in]  tiles    Tiles to load.
+ * @param[in]  ntiles   The number of tiles to load.
+ * @param[in]  targets  Space for #ntiles NPAs that outlives the transfer.
+ * @param[out] xfer     Set to the transfer handle.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_submit_run(hb_mc_manycore_t *mc,
+                                        const hb_mc_loader_plan_run &run,
+                                        const unsigned char *data,
+                                        const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                                        hb_mc_npa_t *targets, hb_mc_transfer_t **xfer)
+{
+        bool zeros = run.offset == HB_MC_LOADER_PLAN_ZERO_FILL;
+
+        if (run.cls == HB_MC_LOADER_PLAN_ONCE) {
+                hb_mc_npa_t npa = hb_mc_npa_from_x_y(run.x, run.y, run.epa);
+
+                if (zeros)
+                        return hb_mc_manycore_memset_async(mc, &npa, 0, run.size,
+                                                           nullptr, nullptr, xfer);
+                return hb_mc_manycore_write_mem_async(mc, &npa, &data[run.offset], run.size,
+                                                      nullptr, nullptr, xfer);
+        }
+
+        for (uint32_t i = 0; i < ntiles; i++)
+                targets[i] = hb_mc_npa(tiles[i], run.epa);
+
+        if (zeros)
+                return hb_mc_manycore_memset_fanout_async(mc, targets, ntiles, 0, run.size,
+                                                          nullptr, nullptr, xfer);
+        return hb_mc_manycore_write_mem_fanout_async(mc, targets, ntiles,
+                                                     &data[run.offset], run.size,
+                                                     nullptr, nullptr, xfer);
+}
+
+/**
+ * Check that a load plan can be replayed with a binary, machine, and tiles.
+ * @return HB_MC_SUCCESS if the plan matches. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_plan_check_load_args(const hb_mc_loader_plan_t *plan,
+                                             const void *bin, size_t sz,
+                                             hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                             const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+{
+        if (!plan || !bin || !mc || !map || !tiles || ntiles < 1)
+                return HB_MC_INVALID;
+
+        /* a plan is only good for the binary, machine, and tiles it was compiled for */
+        if (sz != plan->bin_size
+            || hb_mc_loader_fnv1a(HB_MC_LOADER_FNV_OFFSET, bin, sz) != plan->bin_hash
+            || hb_mc_loader_plan_config_hash(mc, map, tiles, ntiles) != plan->config_hash) {
+                bsg_pr_err("%s: plan does not match this binary and machine\n", __func__);
+                return HB_MC_INVALID;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Load a binary into a list of tiles and DRAM by replaying a load plan.
+ * @param[in]  plan    A load plan compiled for #bin, #mc, #map, and #tiles.
+ * @param[in]  bin     The binary from which #plan was compiled.
+ * @param[in]  sz      Size of #bin in bytes.
+ * @param[in]  mc      A manycore instance.
+ * @param[in]  map     An EVA<->NPA map.
+ * @param[in]  tiles   Tiles to load.
+ * @param[in]  ntiles  The number of tiles to load.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_loader_plan_load(const hb_mc_loader_plan_t *plan, const void *bin, size_t sz,
+                           hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                           const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+{
+        std::vector<hb_mc_transfer_t*> xfers;
+        std::vector<hb_mc_npa_t> targets;
+        hb_mc_npa_t *run_targets;
+        size_t ntile_runs = 0;
+        int rc, err;
+
+        rc = hb_mc_loader_plan_check_load_args(plan, bin, sz, mc, map, tiles, ntiles);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        rc = hb_mc_loader_tiles_initialize(mc, map, tiles, ntiles, HB_MC_LOADER_REG_ALL);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to initialize tiles\n", __func__);
+                return rc;
+        }
+
+        /* fan-out targets must outlive their transfers */
+        for (const auto &run : plan->runs) {
+                if (run.cls != HB_MC_LOADER_PLAN_ONCE)
+                        ntile_runs++;
+        }
+
+        try {
+                targets.resize(ntile_runs * ntiles);
+                xfers.reserve(plan->runs.size());
+        } catch (const std::bad_alloc &) {
+                return HB_MC_NOMEM;
+        }
+
+        run_targets = targets.data();
+        for (const auto &run : plan->runs) {
+                hb_mc_transfer_t *xfer = nullptr;
+
+                rc = hb_mc_loader_plan_submit_run(mc, run, (const unsigned char *)bin,
+                                                  tiles, ntiles, run_targets, &xfer);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_dbg("%s: failed to submit run: %s\n", __func__, hb_mc_strerror(rc));
+                        break;
+                }
+
+                if (run.cls != HB_MC_LOADER_PLAN_ONCE)
+                        run_targets += ntiles;
+                xfers.push_back(xfer);
+        }
+
+        err = hb_mc_loader_fanout_wait(mc, xfers.data(), xfers.size());
+        return rc != HB_MC_SUCCESS ? rc : err;
+}
+
+/**
+ * Get a copy of the symbol index stored in a load plan.
+ * @param[in]  plan    A load plan.
+ * @param[out] syms    Set to a symbol index. Free with hb_mc_loader_symbols_exit().
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_loader_plan_get_symbols(const hb_mc_loader_plan_t *plan, hb_mc_loader_symbols_t **syms)
+{
+        if (!plan || !syms)
+                return HB_MC_INVALID;
+
+        try {
+                *syms = new hb_mc_loader_symbols(plan->symbols);
+        } catch (const std::bad_alloc &) {
+                return HB_MC_NOMEM;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get the number of runs in a load plan.
+ * @param[in]  plan    A load plan.
+ * @return The number of contiguous NPA runs #plan replays.
+ */
+size_t hb_mc_loader_plan_get_num_runs(const hb_mc_loader_plan_t *plan)
+{
+        return plan->runs.size();
+}
+
+/////////////////////
+// Resident images //
+/////////////////////
+
+/*
+  A resident image remembers what the last incremental load left in
+  memory, so that the next load of the same or another binary only
+  sends what differs. It remembers only runs that nothing else writes:
+  writable segments are changed by the program and by the host (e.g.
+  CUDA-Lite's DMEM symbols), and ICACHE lines are refilled by the
+  hardware, so those runs are always rewritten. Read-only runs (e.g.
+  .text in DRAM) are kept in pages of HB_MC_LOADER_RESIDENT_PAGE_SIZE
+  bytes, and a page is skipped if its bytes are already resident.
+*/
+
+#define HB_MC_LOADER_RESIDENT_PAGE_SIZE  256
+#define HB_MC_LOADER_RESIDENT_PAGE_WORDS (HB_MC_LOADER_RESIDENT_PAGE_SIZE / sizeof(uint32_t))
+
+/* the X/Y of pages of HB_MC_LOADER_PLAN_EACH runs, which are the same in every tile */
+#define HB_MC_LOADER_RESIDENT_EACH_XY    0xFFFF
+
+struct hb_mc_loader_resident_page {
+        uint64_t known;                                       //!< bit i is set if word i is resident
+        unsigned char data[HB_MC_LOADER_RESIDENT_PAGE_SIZE];  //!< resident bytes
+};
+
+static_assert(HB_MC_LOADER_RESIDENT_PAGE_WORDS <= 64,
+              "resident page words must fit in hb_mc_loader_resident_page::known");
+
+typedef std::unordered_map<uint64_t, hb_mc_loader_resident_page> hb_mc_loader_resident_pages_t;
+
+struct hb_mc_loader_resident {
+        uint64_t config_hash;                 //!< the machine, map, and tiles of the image
+        unsigned regs;                        //!< HB_MC_LOADER_REG_* flags of registers that are set
+        hb_mc_loader_resident_pages_t pages;  //!< read-only pages of the image
+        size_t bytes_written;                 //!< bytes written by the last load
+        size_t bytes_skipped;                 //!< bytes skipped by the last load
+};
+
+/**
+ * Get the key of a resident page.
+ * @param[in] run       A run that covers the page.
+ * @param[in] page_epa  The EPA of the page.
+ * @return A key for the page in hb_mc_loader_resident::pages.
+ */
+static uint64_t hb_mc_loader_resident_page_key(const hb_mc_loader_plan_run &run,
+                                               hb_mc_epa_t page_epa)
+{
+        uint64_t x = HB_MC_LOADER_RESIDENT_EACH_XY, y = HB_MC_LOADER_RESIDENT_EACH_XY;
+
+        if (run.cls == HB_MC_LOADER_PLAN_ONCE) {
+                x = run.x & 0xFFFF;
+                y = run.y & 0xFFFF;
+        }
+
+        return (x << 48) | (y << 32) | page_epa;
+}
+
+/**
+ * Get the mask of the words in a range of a resident page.
+ * @param[in] off  A word-aligned offset into the page.
+ * @param[in] len  A multiple of 4 bytes.
+ * @return A mask with a bit set for each word in [#off, #off + #len).
+ */
+static uint64_t hb_mc_loader_resident_word_mask(size_t off, size_t len)
+{
+        size_t words = len / sizeof(uint32_t);
+        uint64_t mask = words >= 64 ? ~0ULL : ((1ULL << words) - 1);
+
+        return mask << (off / sizeof(uint32_t));
+}
+
+/**
+ * Submit a run of a load plan, keeping its fan-out targets alive until the transfers are waited on.
+ * @param[in]  mc       A manycore instance.
+ * @param[in]  run      A run to write.
+ * @param[in]  data     The binary from which the run's plan was compiled.
+ * @param[in]  tiles    Tiles to load.
+ * @param[in]  ntiles   The number of tiles to load.
+ * @param[in]  targets  Fan-out targets of submitted runs.
+ * @param[in]  xfers    Transfer handles of submitted runs.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_resident_submit_run(hb_mc_manycore_t *mc,
+                                            const hb_mc_loader_plan_run &run,
+                                            const unsigned char *data,
+                                            const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                                            std::list<std::vector<hb_mc_npa_t>> &targets,
+                                            std::vector<hb_mc_transfer_t*> &xfers)
+{
+        hb_mc_npa_t *run_targets = nullptr;
+
+        if (run.cls != HB_MC_LOADER_PLAN_ONCE) {
+                targets.emplace_back(ntiles);
+                run_targets = targets.back().data();
+        }
+
+        /* make room for the handle first, so that it is never dropped */
+        xfers.push_back(nullptr);
+        return hb_mc_loader_plan_submit_run(mc, run, data, tiles, ntiles,
+                                            run_targets, &xfers.back());
+}
+
+/**
+ * Create an empty resident image.
+ * @param[out] res     Set to a resident image. Free with hb_mc_loader_resident_exit().
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_loader_resident_init(hb_mc_loader_resident_t **res)
+{
+        hb_mc_loader_resident_t *r;
+
+        if (!res)
+                return HB_MC_INVALID;
+
+        try {
+                r = new hb_mc_loader_resident;
+        } catch (const std::bad_alloc &) {
+                return HB_MC_NOMEM;
+        }
+
+        r->config_hash = 0;
+        r->regs = 0;
+        r->bytes_written = 0;
+        r->bytes_skipped = 0;
+
+        *res = r;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Free a resident image.
+ * @param[in]  res     A resident image, or NULL.
+ */
+void hb_mc_loader_resident_exit(hb_mc_loader_resident_t *res)
+{
+        delete res;
+}
+
+/**
+ * Forget everything in a resident image, so that the next incremental load writes everything.
+ * @param[in]  res     A resident image, or NULL.
+ */
+void hb_mc_loader_resident_forget(hb_mc_loader_resident_t *res)
+{
+        if (!res)
+                return;
+
+        res->regs = 0;
+        res->pages.clear();
+}
+
+/**
+ * Forget the tile group origin registers in a resident image.
+ * @param[in]  res     A resident image, or NULL.
+ */
+void hb_mc_loader_resident_forget_origin(hb_mc_loader_resident_t *res)
+{
+        if (!res)
+                return;
+
+        res->regs &= ~HB_MC_LOADER_REG_ORIGIN;
+}
+
+/**
+ * Get the bytes written and skipped by the last incremental load.
+ * @param[in]  res      A resident image.
+ * @param[out] written  Set to the bytes written. May be NULL.
+ * @param[out] skipped  Set to the bytes that were already resident. May be NULL.
+ */
+void hb_mc_loader_resident_get_stats(const hb_mc_loader_resident_t *res,
+                                     size_t *written, size_t *skipped)
+{
+        if (written)
+                *written = res->bytes_written;
+        if (skipped)
+                *skipped = res->bytes_skipped;
+}
+
+/**
+ * Load a binary by replaying a load plan, writing only what is not already resident.
+ * @param[in]  plan    A load plan compiled for #bin, #mc, #map, and #tiles.
+ * @param[in]  bin     The binary from which #plan was compiled.
+ * @param[in]  sz      Size of #bin in bytes.
+ * @param[in]  mc      A manycore instance.
+ * @param[in]  map     An EVA<->NPA map.
+ * @param[in]  tiles   Tiles to load.
+ * @param[in]  ntiles  The number of tiles to load.
+ * @param[in]  res     The resident image of the previous incremental load; updated to #bin.
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+ */
+int hb_mc_loader_plan_load_incremental(const hb_mc_loader_plan_t *plan,
+                                       const void *bin, size_t sz,
+                                       hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                       const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                                       hb_mc_loader_resident_t *res)
+{
+        static const unsigned char zeros[HB_MC_LOADER_RESIDENT_PAGE_SIZE] = {0};
+        const unsigned char *data = (const unsigned char *)bin;
+        std::list<std::vector<hb_mc_npa_t>> targets;
+        std::vector<hb_mc_transfer_t*> xfers;
+        hb_mc_loader_resident_pages_t pages;
+        int rc, err;
+
+        if (!res)
+                return HB_MC_INVALID;
+
+        rc = hb_mc_loader_plan_check_load_args(plan, bin, sz, mc, map, tiles, ntiles);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        /* another machine, map, or tile list has nothing in common with the image */
+        if (res->config_hash != plan->config_hash) {
+                hb_mc_loader_resident_forget(res);
+                res->config_hash = plan->config_hash;
+        }
+
+        res->bytes_written = 0;
+        res->bytes_skipped = 0;
+
+        rc = hb_mc_loader_tiles_initialize(mc, map, tiles, ntiles,
+                                           HB_MC_LOADER_REG_ALL & ~res->regs);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to initialize tiles\n", __func__);
+                hb_mc_loader_resident_forget(res);
+                return rc;
+        }
+        res->regs = HB_MC_LOADER_REG_ALL;
+
+        try {
+                for (const auto &run : plan->runs) {
+                        size_t copies = run.cls == HB_MC_LOADER_PLAN_ONCE ? 1 : ntiles;
+                        bool zero_fill = run.offset == HB_MC_LOADER_PLAN_ZERO_FILL;
+
+                        if (run.cls == HB_MC_LOADER_PLAN_ICACHE
+                            || (run.flags & HB_MC_LOADER_PLAN_WRITABLE)) {
+                                rc = hb_mc_loader_resident_submit_run(mc, run, data, tiles, ntiles,
+                                                                      targets, xfers);
+                                if (rc != HB_MC_SUCCESS)
+                                        break;
+
+                                res->bytes_written += run.size * copies;
+                                continue;
+                        }
+
+                        /* compare the run page by page, and write runs of pages that differ */
+                        hb_mc_loader_plan_run dirty = run;
+                        dirty.size = 0;
+
+                        for (size_t pos = 0; pos < run.size; ) {
+                                hb_mc_epa_t epa = run.epa + pos;
+                                hb_mc_epa_t page_epa = epa & ~(HB_MC_LOADER_RESIDENT_PAGE_SIZE - 1);
+                                size_t off = epa - page_epa;
+                                size_t len = min_size_t(HB_MC_LOADER_RESIDENT_PAGE_SIZE - off,
+                                                        run.size - pos);
+                                const unsigned char *src = zero_fill ? zeros : &data[run.offset + pos];
+                                uint64_t key = hb_mc_loader_resident_page_key(run, page_epa);
+                                uint64_t mask = hb_mc_loader_resident_word_mask(off, len);
+                                bool resident = false;
+
+                                auto old = res->pages.find(key);
+                                if (old != res->pages.end())
+                                        resident = (old->second.known & mask) == mask
+                                                && !memcmp(&old->second.data[off], src, len);
+
+                                hb_mc_loader_resident_page &page = pages[key];
+                                memcpy(&page.data[off], src, len);
+                                page.known |= mask;
+                                pos += len;
+
+                                if (!resident) {
+                                        if (dirty.size == 0) {
+                                                dirty.epa = epa;
+                                                dirty.offset = zero_fill ? HB_MC_LOADER_PLAN_ZERO_FILL
+                                                        : run.offset + pos - len;
+                                        }
+                                        dirty.size += len;
+                                        continue;
+                                }
+
+                                res->bytes_skipped += len * copies;
+                                if (dirty.size == 0)
+                                        continue;
+
+                                rc = hb_mc_loader_resident_submit_run(mc, dirty, data, tiles, ntiles,
+                                                                      targets, xfers);
+                                if (rc != HB_MC_SUCCESS)
+                                        break;
+
+                                res->bytes_written += dirty.size * copies;
+                                dirty.size = 0;
+                        }
+
+                        if (rc == HB_MC_SUCCESS && dirty.size > 0) {
+                                rc = hb_mc_loader_resident_submit_run(mc, dirty, data, tiles, ntiles,
+                                                                      targets, xfers);
+                                res->bytes_written += dirty.size * copies;
+                        }
+
+                        if (rc != HB_MC_SUCCESS)
+                                break;
+                }
+        } catch (const std::bad_alloc &) {
+                rc = HB_MC_NOMEM;
+        }
+
+        if (rc != HB_MC_SUCCESS)
+                bsg_pr_dbg("%s: failed to submit run: %s\n", __func__, hb_mc_strerror(rc));
+
+        err = hb_mc_loader_fanout_wait(mc, xfers.data(), xfers.size());
+        if (rc == HB_MC_SUCCESS)
+                rc = err;
+
+        /* after a failed load, nothing is known to be resident */
+        if (rc != HB_MC_SUCCESS) {
+                hb_mc_loader_resident_forget(res);
+                return rc;
+        }
+
+        res->pages.swap(pages);
+        return HB_MC_SUCCESS;
+}
 
 /**
  * Takes in the path to a binary and loads the binary into a buffer and set the binary size.
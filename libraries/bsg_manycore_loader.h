@@ -66,6 +66,194 @@ extern "C" {
 
 
 
+        /**
+         * An index of a program's symbols, built once so that repeated
+         * lookups do not re-validate and re-scan the ELF symbol tables.
+         */
+        typedef struct hb_mc_loader_symbols hb_mc_loader_symbols_t;
+
+        /**
+         * Build a symbol index for a program.
+         * @param[in]  bin     A memory buffer containing a valid manycore binary.
+         * @param[in]  sz      Size of #bin in bytes.
+         * @param[out] syms    Set to a symbol index. Free with hb_mc_loader_symbols_exit().
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_symbols_init(const void *bin, size_t sz, hb_mc_loader_symbols_t **syms);
+
+        /**
+         * Free a symbol index.
+         * @param[in]  syms    A symbol index built with hb_mc_loader_symbols_init(), or NULL.
+         */
+        void hb_mc_loader_symbols_exit(hb_mc_loader_symbols_t *syms);
+
+        /**
+         * Look up a symbol in a symbol index.
+         * The index does not reference #bin, which may be freed after hb_mc_loader_symbols_init().
+         * @param[in]  syms    A symbol index built with hb_mc_loader_symbols_init().
+         * @param[in]  symbol  A program symbol.
+         * @param[out] eva     An EVA that addresses #symbol.
+         * @param[out] size    Set to the size of #symbol in bytes. May be NULL.
+         * @return HB_MC_NOTFOUND if #symbol is not in the program. HB_MC_SUCCESS otherwise.
+         */
+        int hb_mc_loader_symbols_lookup(const hb_mc_loader_symbols_t *syms, const char *symbol,
+                                        hb_mc_eva_t *eva, size_t *size);
+
+        /**
+         * A precompiled load of a binary: the runs of contiguous NPAs that
+         * hb_mc_loader_load() would write, each a slice of the binary or zeros,
+         * plus the program's symbols. Replaying a plan skips ELF parsing and
+         * EVA translation, and plans can be cached on disk across processes.
+         */
+        typedef struct hb_mc_loader_plan hb_mc_loader_plan_t;
+
+        /**
+         * Compile a load plan for a binary.
+         * @param[in]  bin     A memory buffer containing a valid manycore binary.
+         * @param[in]  sz      Size of #bin in bytes.
+         * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init().
+         * @param[in]  map     An eva map for computing the eva to npa translation.
+         * @param[in]  tiles   A list of manycore to load with #bin, with the origin at 0.
+         * @param[in]  ntiles  The number of tiles in #tiles.
+         * @param[out] plan    Set to a load plan. Free with hb_mc_loader_plan_exit().
+         * @return HB_MC_NOIMPL if #bin cannot be planned and must be loaded with hb_mc_loader_load().
+         *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_plan_init(const void *bin, size_t sz,
+                                   hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                   const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                                   hb_mc_loader_plan_t **plan);
+
+        /**
+         * Get a load plan for a binary from a cache directory, compiling and saving it on a miss.
+         * Plan files are named by a hash of #bin and a hash of #mc's configuration, #map, and #tiles.
+         * @param[in]  bin        A memory buffer containing a valid manycore binary.
+         * @param[in]  sz         Size of #bin in bytes.
+         * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init().
+         * @param[in]  map        An eva map for computing the eva to npa translation.
+         * @param[in]  tiles      A list of manycore to load with #bin, with the origin at 0.
+         * @param[in]  ntiles     The number of tiles in #tiles.
+         * @param[in]  cache_dir  A directory of plan files, or NULL to compile without caching.
+         * @param[out] plan       Set to a load plan. Free with hb_mc_loader_plan_exit().
+         * @return HB_MC_NOIMPL if #bin cannot be planned and must be loaded with hb_mc_loader_load().
+         *         HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_plan_cached(const void *bin, size_t sz,
+                                     hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                     const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                                     const char *cache_dir, hb_mc_loader_plan_t **plan);
+
+        /**
+         * Free a load plan.
+         * @param[in]  plan    A load plan, or NULL.
+         */
+        void hb_mc_loader_plan_exit(hb_mc_loader_plan_t *plan);
+
+        /**
+         * Load a binary into a list of tiles and DRAM by replaying a load plan.
+         * Equivalent to hb_mc_loader_load() with the arguments #plan was compiled with.
+         * @param[in]  plan    A load plan compiled for #bin, #mc, #map, and #tiles.
+         * @param[in]  bin     The binary from which #plan was compiled.
+         * @param[in]  sz      Size of #bin in bytes.
+         * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init().
+         * @param[in]  map     An eva map for computing the eva to npa translation.
+         * @param[in]  tiles   A list of manycore to load with #bin, with the origin at 0.
+         * @param[in]  ntiles  The number of tiles in #tiles.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_plan_load(const hb_mc_loader_plan_t *plan, const void *bin, size_t sz,
+                                   hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                   const hb_mc_coordinate_t *tiles, uint32_t ntiles);
+
+        /**
+         * Get a copy of the symbol index stored in a load plan.
+         * @param[in]  plan    A load plan.
+         * @param[out] syms    Set to a symbol index. Free with hb_mc_loader_symbols_exit().
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_plan_get_symbols(const hb_mc_loader_plan_t *plan,
+                                          hb_mc_loader_symbols_t **syms);
+
+        /**
+         * Get the number of runs in a load plan.
+         * @param[in]  plan    A load plan. Behavior is undefined if #plan is NULL.
+         * @return The number of contiguous NPA runs #plan replays.
+         */
+        size_t hb_mc_loader_plan_get_num_runs(const hb_mc_loader_plan_t *plan);
+
+        /**
+         * What the last incremental load left in memory. Incremental loads
+         * write only the read-only pages (e.g. .text in DRAM) that differ from
+         * the resident image, and skip tile registers that are already set.
+         * Writable segments and ICACHEs are always rewritten, because the
+         * program, the host, and the hardware change them after a load.
+         */
+        typedef struct hb_mc_loader_resident hb_mc_loader_resident_t;
+
+        /**
+         * Create an empty resident image.
+         * @param[out] res     Set to a resident image. Free with hb_mc_loader_resident_exit().
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_resident_init(hb_mc_loader_resident_t **res);
+
+        /**
+         * Free a resident image.
+         * @param[in]  res     A resident image, or NULL.
+         */
+        void hb_mc_loader_resident_exit(hb_mc_loader_resident_t *res);
+
+        /**
+         * Forget everything in a resident image, so that the next incremental load writes everything.
+         * Call this after writing to a loaded program's read-only segments other than with the loader.
+         * @param[in]  res     A resident image, or NULL.
+         */
+        void hb_mc_loader_resident_forget(hb_mc_loader_resident_t *res);
+
+        /**
+         * Forget the tile group origin registers in a resident image.
+         * Call this after setting the origin registers of loaded tiles other than with the loader.
+         * @param[in]  res     A resident image, or NULL.
+         */
+        void hb_mc_loader_resident_forget_origin(hb_mc_loader_resident_t *res);
+
+        /**
+         * Get the bytes written and skipped by the last incremental load.
+         * Bytes written to several tiles are counted once per tile.
+         * @param[in]  res      A resident image. Behavior is undefined if #res is NULL.
+         * @param[out] written  Set to the bytes written. May be NULL.
+         * @param[out] skipped  Set to the bytes that were already resident. May be NULL.
+         */
+        void hb_mc_loader_resident_get_stats(const hb_mc_loader_resident_t *res,
+                                             size_t *written, size_t *skipped);
+
+        /**
+         * Load a binary by replaying a load plan, writing only what is not already resident.
+         * The first load with a resident image, or with a different machine or tile list, writes everything.
+         * @param[in]  plan    A load plan compiled for #bin, #mc, #map, and #tiles.
+         * @param[in]  bin     The binary from which #plan was compiled.
+         * @param[in]  sz      Size of #bin in bytes.
+         * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init().
+         * @param[in]  map     An eva map for computing the eva to npa translation.
+         * @param[in]  tiles   A list of manycore to load with #bin, with the origin at 0.
+         * @param[in]  ntiles  The number of tiles in #tiles.
+         * @param[in]  res     The resident image of the previous incremental load; updated to #bin.
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_plan_load_incremental(const hb_mc_loader_plan_t *plan,
+                                               const void *bin, size_t sz,
+                                               hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                               const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                                               hb_mc_loader_resident_t *res);
+
+
         /**
          * Takes in the path to a binary and loads it into a buffer and sets the binary size. 
          * @param[in]  file_name A memory buffer containing a valid manycore binary.
@@ -23,141 +23,195 @@
 #endif
 
 #include <bsg_manycore_memory_manager.h>
+#include <iterator>
+#include <chrono>
+#include <algorithm>
 
 awsbwhal::MemoryManager::MemoryManager(uint64_t size, uint64_t start,
                                        unsigned alignment) : mSize(size), mStart(start), mAlignment(alignment),
-                                                             mCoalesceThreshold(4), mFreeSize(0)
+                                                             mFreeSize(0), mPeakUsed(0), mAllocs(0), mFailedAllocs(0),
+                                                             mFrees(0), mAllocNanos(0), mFreeNanos(0)
 {
         assert(start % alignment == 0);
-        mFreeBufferList.push_back(std::make_pair(mStart, mSize));
+        insertFree(mStart, mSize);
         mFreeSize = mSize;
 }
 
 awsbwhal::MemoryManager::~MemoryManager()
 {
-
-
 }
 
+// Round a request up to the alignment; zero-sized requests take one unit
 uint64_t
-awsbwhal::MemoryManager::alloc(size_t size)
+awsbwhal::MemoryManager::padSize(size_t size) const
 {
         if (size == 0)
                 size = mAlignment;
 
-        uint64_t result = mNull;
         const size_t mod_size = size % mAlignment;
         const size_t pad = (mod_size > 0) ? (mAlignment - mod_size) : 0;
-        size += pad;
+        return size + pad;
+}
 
-        std::lock_guard<std::mutex> lock(mMemManagerMutex);
-        for (PairList::iterator i = mFreeBufferList.begin(), e = mFreeBufferList.end(); i != e; ++i) {
-                if (i->second < size)
-                        continue;
-                result = i->first;
-                if (i->second > size) {
-                        // Resize the existing entry in freelist
-                        i->first += size;
-                        i->second -= size;
-                }
-                else {
-                        // remove the exact match found
-                        mFreeBufferList.erase(i);
-                }
-                mBusyBufferList.push_back(std::make_pair(result, size));
-                mFreeSize -= size;
-                break;
-        }
-        return result;
+void
+awsbwhal::MemoryManager::insertFree(uint64_t base, uint64_t size)
+{
+        mFreeByAddr.emplace(base, size);
+        mFreeBySize.emplace(size, base);
 }
 
 void
-awsbwhal::MemoryManager::free(uint64_t buf)
+awsbwhal::MemoryManager::eraseFree(std::map<uint64_t, uint64_t>::iterator i)
+{
+        mFreeBySize.erase(std::make_pair(i->second, i->first));
+        mFreeByAddr.erase(i);
+}
+
+void
+awsbwhal::MemoryManager::insertBusy(uint64_t base, uint64_t size, const char *tag)
+{
+        Busy busy = {size, tag};
+        mBusy.emplace(base, busy);
+        mFreeSize -= size;
+        mAllocs++;
+        mPeakUsed = std::max(mPeakUsed, mSize - mFreeSize);
+}
+
+static uint64_t nanos_since(std::chrono::steady_clock::time_point start)
 {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t
+awsbwhal::MemoryManager::alloc(size_t size, const char *tag)
+{
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t padded = padSize(size);
+
         std::lock_guard<std::mutex> lock(mMemManagerMutex);
-        PairList::iterator i = find(buf);
-        if (i == mBusyBufferList.end())
-                return;
-        mFreeSize += i->second;
-        mFreeBufferList.push_back(std::make_pair(i->first, i->second));
-        mBusyBufferList.erase(i);
-        if (mFreeBufferList.size() > mCoalesceThreshold) {
-                coalesce();
+        // smallest block that fits; the lowest address among equals
+        auto fit = mFreeBySize.lower_bound(std::make_pair(padded, (uint64_t)0));
+        if (fit == mFreeBySize.end()) {
+                mFailedAllocs++;
+                mAllocNanos += nanos_since(start);
+                return mNull;
         }
-}
 
+        const uint64_t result = fit->second;
+        const uint64_t remaining = fit->first - padded;
+        eraseFree(mFreeByAddr.find(result));
+        if (remaining > 0)
+                insertFree(result + padded, remaining);
 
-void
-awsbwhal::MemoryManager::coalesce()
+        insertBusy(result, padded, tag);
+        mAllocNanos += nanos_since(start);
+        return result;
+}
+
+// Allocate a block whose address is #offset modulo #alignment. Both must
+// be multiples of the allocator's alignment.
+uint64_t
+awsbwhal::MemoryManager::allocAligned(size_t size, uint64_t alignment, uint64_t offset,
+                                      const char *tag)
 {
-        // First sort the free buffers and then attempt to coalesce the neighbors
-        mFreeBufferList.sort();
-
-        PairList::iterator curr = mFreeBufferList.begin();
-        PairList::iterator next = curr;
-        ++next;
-        PairList::iterator last = mFreeBufferList.end();
-        while (next != last) {
-                if ((curr->first + curr->second) != next->first) {
-                        // Non contiguous blocks
-                        curr = next;
-                        ++next;
+        if (alignment == 0 || alignment % mAlignment != 0 || offset % mAlignment != 0)
+                return mNull;
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t padded = padSize(size);
+        offset %= alignment;
+
+        std::lock_guard<std::mutex> lock(mMemManagerMutex);
+        // Walk up from the best fit. A block at least
+        // (padded + alignment - mAlignment) bytes long always fits, so
+        // only blocks shorter than that can be skipped.
+        for (auto fit = mFreeBySize.lower_bound(std::make_pair(padded, (uint64_t)0));
+             fit != mFreeBySize.end(); ++fit) {
+                const uint64_t base = fit->second;
+                const uint64_t block_size = fit->first;
+                const uint64_t lead = (offset + alignment - base % alignment) % alignment;
+                if (lead + padded > block_size)
                         continue;
-                }
-                // Coalesce curr and next
-                curr->second += next->second;
-                mFreeBufferList.erase(next);
-                next = curr;
-                ++next;
+
+                eraseFree(mFreeByAddr.find(base));
+                if (lead > 0)
+                        insertFree(base, lead);
+                if (block_size > lead + padded)
+                        insertFree(base + lead + padded, block_size - lead - padded);
+
+                insertBusy(base + lead, padded, tag);
+                mAllocNanos += nanos_since(start);
+                return base + lead;
         }
+
+        mFailedAllocs++;
+        mAllocNanos += nanos_since(start);
+        return mNull;
 }
 
-// Caller should have acquired the mutex lock before calling find();
-awsbwhal::MemoryManager::PairList::iterator
-awsbwhal::MemoryManager::find(uint64_t buf)
+void
+awsbwhal::MemoryManager::free(uint64_t buf)
 {
-#if GCC_VERSION >= 40800
-        PairList::iterator i = std::find_if(mBusyBufferList.begin(), mBusyBufferList.end(), [&] (const PairList::value_type& s)
-                                            { return s.first == buf; });
-#else
-        PairList::iterator i = mBusyBufferList.begin();
-        PairList::iterator last  = mBusyBufferList.end();
-        while(i != last) {
-                if (i->first == buf)
-                        break;
-                ++i;
+        const auto start = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mMemManagerMutex);
+        auto busy = mBusy.find(buf);
+        if (busy == mBusy.end())
+                return;
+
+        uint64_t base = busy->first;
+        uint64_t size = busy->second.size;
+        mBusy.erase(busy);
+        mFreeSize += size;
+        mFrees++;
+
+        // merge with the free block that follows, then the one that precedes
+        auto next = mFreeByAddr.lower_bound(base);
+        if (next != mFreeByAddr.end() && next->first == base + size) {
+                size += next->second;
+                auto after = std::next(next);
+                eraseFree(next);
+                next = after;
         }
-#endif
-        return i;
+
+        if (next != mFreeByAddr.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == base) {
+                        base = prev->first;
+                        size += prev->second;
+                        eraseFree(prev);
+                }
+        }
+
+        insertFree(base, size);
+        mFreeNanos += nanos_since(start);
 }
 
 void
 awsbwhal::MemoryManager::reset()
 {
         std::lock_guard<std::mutex> lock(mMemManagerMutex);
-        mFreeBufferList.clear();
-        mBusyBufferList.clear();
-        mFreeBufferList.push_back(std::make_pair(mStart, mSize));
-        mFreeSize = 0;
+        mFreeByAddr.clear();
+        mFreeBySize.clear();
+        mBusy.clear();
+        insertFree(mStart, mSize);
+        mFreeSize = mSize;
 }
 
 std::pair<uint64_t, uint64_t>
 awsbwhal::MemoryManager::lookup(uint64_t buf)
 {
         std::lock_guard<std::mutex> lock(mMemManagerMutex);
-        PairList::iterator i = find(buf);
-        if (i != mBusyBufferList.end())
-                return *i;
-        // Compiler bug -- Some versions of GCC C++11 compiler do not
-        // like mNull directly inside std::make_pair, so capture mNull
-        // in a temporary
+        auto busy = mBusy.find(buf);
+        if (busy != mBusy.end())
+                return std::make_pair(busy->first, busy->second.size);
+
         const uint64_t v = mNull;
         return std::make_pair(v, v);
 }
 
-
 bool
-awsbwhal::MemoryManager::reserve(uint64_t base, size_t size)
+awsbwhal::MemoryManager::reserve(uint64_t base, size_t size, const char *tag)
 {
         assert(size);
         if (size > mSize)
@@ -169,47 +223,70 @@ awsbwhal::MemoryManager::reserve(uint64_t base, size_t size)
         if (base > (mStart + mSize))
                 return false;
 
-        const size_t mod_size = size % mAlignment;
-        const size_t pad = (mod_size > 0) ? (mAlignment - mod_size) : 0;
-        size += pad;
+        const uint64_t padded = padSize(size);
 
         std::lock_guard<std::mutex> lock(mMemManagerMutex);
-        for (PairList::iterator i = mFreeBufferList.begin(), e = mFreeBufferList.end(); i != e; ++i) {
-                if (i->second < size)
-                        continue;
-                if (i->first > base)
-                        continue;
-                if ((base + size) > (i->first + i->second))
-                        continue;
-                uint64_t a = i->first;
-                uint64_t b = i->second;
-
-                i->second = base - i->first;
-                if ((i->first == base) && (i->second == 0)) {
-                        //Exact match
-                        mFreeBufferList.erase(i);
-                        break;
-                }
-                if (i->first == base) {
-                        // Hole at the end; Resize exisiting entry
-                        i->first = base + size;
-                        break;
-                }
-                if ((i->first + i->second) == (base + size)) {
-                        // Hole in the beginning; Resize exisiting entry
-                        i->second -= size;
-                        break;
-                }
-                // We have holes on both sides
-                // Resize hole in the beginning
-                i->second = base - i->first;
-
-                // Now create an entry for the hole at the end
-                b = b + a - base - size;
-                a = base + size;
-                mFreeBufferList.insert(++i, std::make_pair(a, b));
+        // the free block that starts at or before base must cover the whole range
+        auto i = mFreeByAddr.upper_bound(base);
+        if (i == mFreeByAddr.begin()) {
+                mFailedAllocs++;
+                return false;
         }
-        mBusyBufferList.push_back(std::make_pair(base, size));
-        mFreeSize -= size;
+        --i;
+
+        const uint64_t block_base = i->first;
+        const uint64_t block_end = i->first + i->second;
+        if (base + padded > block_end) {
+                mFailedAllocs++;
+                return false;
+        }
+
+        eraseFree(i);
+        if (base > block_base)
+                insertFree(block_base, base - block_base);
+        if (block_end > base + padded)
+                insertFree(base + padded, block_end - (base + padded));
+
+        insertBusy(base, padded, tag);
         return true;
 }
+
+void
+awsbwhal::MemoryManager::getStats(Stats &stats)
+{
+        std::lock_guard<std::mutex> lock(mMemManagerMutex);
+        stats.size = mSize;
+        stats.freeSize = mFreeSize;
+        stats.peakUsed = mPeakUsed;
+        stats.largestFree = mFreeBySize.empty() ? 0 : mFreeBySize.rbegin()->first;
+        stats.freeBlocks = mFreeByAddr.size();
+        std::fill(stats.freeHistogram, stats.freeHistogram + mHistogramBins, 0);
+        for (const auto &block : mFreeByAddr) {
+                unsigned bin = 63 - __builtin_clzll(block.second);
+                stats.freeHistogram[bin]++;
+        }
+        stats.liveBuffers = mBusy.size();
+        stats.allocs = mAllocs;
+        stats.failedAllocs = mFailedAllocs;
+        stats.frees = mFrees;
+        stats.allocNanos = mAllocNanos;
+        stats.freeNanos = mFreeNanos;
+}
+
+// Busy blocks in address order
+std::vector<awsbwhal::MemoryManager::Buffer>
+awsbwhal::MemoryManager::liveBuffers()
+{
+        std::vector<Buffer> buffers;
+        {
+                std::lock_guard<std::mutex> lock(mMemManagerMutex);
+                buffers.reserve(mBusy.size());
+                for (const auto &busy : mBusy) {
+                        Buffer b = {busy.first, busy.second.size, busy.second.tag};
+                        buffers.push_back(b);
+                }
+        }
+        std::sort(buffers.begin(), buffers.end(),
+                  [](const Buffer &a, const Buffer &b) { return a.base < b.base; });
+        return buffers;
+}
@@ -23,33 +23,90 @@
 #include <bsg_manycore_features.h>
 
 #include <mutex>
-#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#ifndef EMULATION
 #include "xclhal.h"
+#else
+#include <cstddef>
+#include <cstdint>
+#endif
 
 namespace awsbwhal {
+        /*
+          Best-fit allocator. Free blocks are indexed twice: by (size,
+          address), to find the smallest block that fits, and by address, to
+          find the neighbours a freed block merges with. Busy blocks are hashed by address.
+          alloc(), free() and reserve() are O(log n) in the number of free
+          blocks; lookup() is O(1). allocAligned() places a block at a given
+          offset modulo a (larger) alignment, e.g. on a chosen DRAM channel.
+
+          Each busy block carries an optional tag naming who allocated it,
+          and the manager keeps running counters (see Stats) so callers can
+          tell a full heap from a fragmented one.
+        */
         class MemoryManager {
+        public:
+                static const uint64_t mNull = 0xffffffffffffffffull;
+                static const unsigned mHistogramBins = 64;
+
+                struct Stats {
+                        uint64_t size;                  // bytes managed
+                        uint64_t freeSize;              // bytes free
+                        uint64_t peakUsed;              // most bytes ever busy at once
+                        uint64_t largestFree;           // size of the largest free block
+                        uint64_t freeBlocks;            // number of free blocks
+                        uint64_t freeHistogram[mHistogramBins]; // free blocks of size [2^i, 2^(i+1))
+                        uint64_t liveBuffers;           // number of busy blocks
+                        uint64_t allocs;                // successful alloc()/allocAligned()/reserve() calls
+                        uint64_t failedAllocs;          // alloc()/allocAligned()/reserve() calls that returned mNull/false
+                        uint64_t frees;                 // free() calls that released a block
+                        uint64_t allocNanos;            // total time spent in alloc()/allocAligned()
+                        uint64_t freeNanos;             // total time spent in free()
+                };
+
+                struct Buffer {
+                        uint64_t base;
+                        uint64_t size;
+                        const char *tag;                // NULL if untagged
+                };
+
+        private:
+                struct Busy {
+                        uint64_t size;
+                        const char *tag;
+                };
+
                 std::mutex mMemManagerMutex;
-                std::list<std::pair<uint64_t, uint64_t> > mFreeBufferList;
-                std::list<std::pair<uint64_t, uint64_t> > mBusyBufferList;
+                std::map<uint64_t, uint64_t> mFreeByAddr;              // address -> size
+                std::set<std::pair<uint64_t, uint64_t> > mFreeBySize;  // (size, address)
+                std::unordered_map<uint64_t, Busy> mBusy;              // address -> (size, tag)
                 const uint64_t mSize;
                 const uint64_t mStart;
                 const uint64_t mAlignment;
-                const unsigned mCoalesceThreshold;
                 uint64_t mFreeSize;
-
-                typedef std::list<std::pair<uint64_t, uint64_t> > PairList;
-
-        public:
-                static const uint64_t mNull = 0xffffffffffffffffull;
+                uint64_t mPeakUsed;
+                uint64_t mAllocs;
+                uint64_t mFailedAllocs;
+                uint64_t mFrees;
+                uint64_t mAllocNanos;
+                uint64_t mFreeNanos;
 
         public:
                 MemoryManager(uint64_t size, uint64_t start, unsigned alignment);
                 ~MemoryManager();
-                uint64_t alloc(size_t size);
+                /* #tag must outlive the block, e.g. a string literal or __func__ */
+                uint64_t alloc(size_t size, const char *tag = NULL);
+                uint64_t allocAligned(size_t size, uint64_t alignment, uint64_t offset,
+                                      const char *tag = NULL);
                 void free(uint64_t buf);
                 void reset();
                 std::pair<uint64_t, uint64_t>lookup(uint64_t buf);
-                bool reserve(uint64_t base, size_t size);
+                bool reserve(uint64_t base, size_t size, const char *tag = NULL);
+                void getStats(Stats &stats);
+                std::vector<Buffer> liveBuffers();
 
                 uint64_t size() const {
                         return mSize;
@@ -69,8 +126,10 @@ namespace awsbwhal {
 
         private:
                 /* Note that these should be called after acquiring mMemManagerMutex */
-                void coalesce();
-                PairList::iterator find(uint64_t buf);
+                uint64_t padSize(size_t size) const;
+                void insertFree(uint64_t base, uint64_t size);
+                void eraseFree(std::map<uint64_t, uint64_t>::iterator i);
+                void insertBusy(uint64_t base, uint64_t size, const char *tag);
         };
 }
 
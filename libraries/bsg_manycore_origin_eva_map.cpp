@@ -108,6 +108,9 @@ int hb_mc_origin_eva_map_exit(hb_mc_eva_map_t *map)
                 return HB_MC_INVALID;
         }
 
+        /* drop cached translations before the map goes away */
+        hb_mc_eva_map_invalidate(map);
+
         /* free the private data */
         origin = (hb_mc_coordinate_t*) map->priv;
         if (!origin) {
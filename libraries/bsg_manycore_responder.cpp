@@ -28,12 +28,17 @@
 #include <bsg_manycore_responder.h>
 #include <bsg_manycore_errno.h>
 #include <list>
+#include <mutex>
 #include <stdint.h>
 
 typedef std::list<hb_mc_responder_t *> responder_list;
 
 static responder_list *responders = nullptr;
 
+/* responders are shared by every manycore in the process */
+static std::mutex responders_lock;
+static unsigned responders_users = 0;
+
 int hb_mc_responder_init(hb_mc_responder_t *responder, hb_mc_manycore_t *mc)
 {
         int err;
@@ -49,6 +54,11 @@ int hb_mc_responder_init(hb_mc_responder_t *responder, hb_mc_manycore_t *mc)
 
 int hb_mc_responders_init(hb_mc_manycore_t *mc)
 {
+        std::lock_guard<std::mutex> guard(responders_lock);
+
+        if (responders_users++ != 0)
+                return HB_MC_SUCCESS; // already initialized by another manycore
+
         if (responders == nullptr)
                 return HB_MC_SUCCESS; //  no responders
 
@@ -80,6 +90,10 @@ int hb_mc_responder_quit(hb_mc_responder_t *responder, hb_mc_manycore_t *mc)
 int hb_mc_responders_quit(hb_mc_manycore_t *mc)
 {
         int err;
+        std::lock_guard<std::mutex> guard(responders_lock);
+
+        if (responders_users == 0 || --responders_users != 0)
+                return HB_MC_SUCCESS; // still in use by another manycore
 
         if (responders == nullptr)
                 return HB_MC_SUCCESS; // no responders
@@ -77,6 +77,8 @@ extern "C" {
         /**
          * Initialze all registered responders.
          * This function is generally called from within the manycore init interface.
+         * Responders are shared by all manycores in a process: they are initialized
+         * by the first call and cleaned up by the matching last hb_mc_responders_quit().
          * @param[in] mc  A manycore.
          * @return HB_MC_SUCCESS if succesful. An error code otherwise.
          */
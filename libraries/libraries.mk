@@ -30,7 +30,9 @@ LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_bits.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_config.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_cuda.cpp
+LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_device_set.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_elf.cpp
+LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_emulation.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_eva.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_loader.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_memory_manager.cpp
@@ -47,7 +49,9 @@ LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_bits.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_config.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_cuda.h
+LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_device_set.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_elf.h
+LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_emulation.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_eva.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_loader.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_memory_manager.h
@@ -80,6 +84,15 @@ $(LIB_OBJECTS): CFLAGS    = -std=c11 -fPIC -D_GNU_SOURCE $(INCLUDES)
 $(LIB_OBJECTS): CXXFLAGS  = -std=c++11 -fPIC -D_GNU_SOURCE $(INCLUDES)
 $(LIB_OBJECTS): LDFLAGS   = -lfpga_mgmt -fPIC
 
+# EMULATION=1 builds the runtime against an in-process software model of the
+# manycore (bsg_manycore_emulation.cpp) instead of the FPGA. No AWS libraries
+# are required.
+ifeq ($(EMULATION),1)
+$(LIB_OBJECTS): CFLAGS   += -DEMULATION
+$(LIB_OBJECTS): CXXFLAGS += -DEMULATION
+$(LIB_OBJECTS): LDFLAGS   = -fPIC
+endif
+
 # Objects that should be compiled with debug flags
 LIB_DEBUG_OBJECTS  +=
 #LIB_DEBUG_OBJECTS  += $(LIBRARIES_PATH)/bsg_manycore_responder.o
@@ -100,7 +113,11 @@ $(LIB_STRICT_OBJECTS): CXXFLAGS += -Wno-unused-function
 $(LIB_STRICT_OBJECTS): CXXFLAGS += -Wno-unused-but-set-variable
 
 $(LIBRARIES_PATH)/libbsg_manycore_runtime.so.1.0: LD = $(CXX)
+ifeq ($(EMULATION),1)
+$(LIBRARIES_PATH)/libbsg_manycore_runtime.so.1.0: LDFLAGS = -fPIC -lpthread
+else
 $(LIBRARIES_PATH)/libbsg_manycore_runtime.so.1.0: LDFLAGS = -lfpga_mgmt -fPIC
+endif
 $(LIBRARIES_PATH)/libbsg_manycore_runtime.so.1.0: $(LIB_OBJECTS) $(HEADERS)
 	$(LD) -shared -Wl,-soname,$(basename $(notdir $@)) -o $@ $^ $(LDFLAGS)
 
@@ -34,6 +34,7 @@
 #include <cstdio>
 #include <cstdbool>
 #include <cfloat>
+#include <ctime>
 
 using std::isnormal;
 
@@ -44,6 +45,7 @@ using std::isnormal;
 #include <stdint.h>
 #include <stdbool.h>
 #include <float.h>
+#include <time.h>
 
 #endif
 
@@ -204,6 +206,16 @@ static inline bool hb_mc_floats_match(float a, float b) {
 
         return (diff / fminf(abs_a + abs_b, FLT_MAX)) < MAX_FLOAT_ERROR_TOLERANCE;
 }
+
+// Returns the seconds between two clock_gettime() samples
+static inline double elapsed_s(const struct timespec *start, const struct timespec *end) {
+        return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Returns the microseconds between two clock_gettime() samples
+static inline double elapsed_us(const struct timespec *start, const struct timespec *end) {
+        return (end->tv_sec - start->tv_sec) * 1e6 + (end->tv_nsec - start->tv_nsec) / 1e3;
+}
 #ifdef __cplusplus
 extern "C" {
 void cosim_main(uint32_t *exit_code, char * args);
@@ -32,7 +32,16 @@ CUDALITE_SRC_PATH = $(SPMD_SRC_PATH)/bsg_cuda_lite_runtime
 
 .PHONY:
 
-$(USER_RULES): test_%.rule: $(CUDALITE_SRC_PATH)/%/main.riscv
+# Tests that run the empty_parallel kernel instead of one of their own
+SHARED_KERNEL_RULES  = test_device_set.rule
+SHARED_KERNEL_RULES += test_dram_channel_placement.rule
+SHARED_KERNEL_RULES += test_kernel_args_arena.rule
+SHARED_KERNEL_RULES += test_program_symbols.rule
+SHARED_KERNEL_RULES += test_loader_plan.rule
+SHARED_KERNEL_RULES += test_loader_incremental.rule
+$(SHARED_KERNEL_RULES): $(CUDALITE_SRC_PATH)/empty_parallel/main.riscv
+
+$(filter-out $(SHARED_KERNEL_RULES),$(USER_RULES)): test_%.rule: $(CUDALITE_SRC_PATH)/%/main.riscv
 
 $(USER_CLEAN_RULES):
 	CL_DIR=$(CL_DIR) \
@@ -0,0 +1,196 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "test_device_set.h"
+
+#define ALLOC_NAME "default_allocator"
+#define MAX_DEVICES 4
+#define BUFFER_WORDS 1001
+#define BUFFER_SIZE (BUFFER_WORDS * sizeof(uint32_t))
+
+/*!
+ * Runs an empty kernel on a 4x2 grid of 2x2 tile groups sharded across a set of manycores,
+ * and copies a buffer sharded across the same set to and from the host.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+int kernel_device_set (int argc, char **argv) {
+        int rc, num_devices;
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        rc = hb_mc_manycore_get_device_count(&num_devices);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to count devices.\n");
+                return rc;
+        }
+        if (num_devices > MAX_DEVICES)
+                num_devices = MAX_DEVICES;
+
+        bsg_pr_test_info("Running the CUDA Empty Parallel Kernel on a set of %d devices.\n\n", num_devices);
+
+
+        /*****************************************************************************************************************
+        * Initialize device set, load binary and unfreeze tiles.
+        ******************************************************************************************************************/
+        hb_mc_device_set_t set;
+        hb_mc_manycore_id_t ids[MAX_DEVICES];
+        for (int i = 0; i < num_devices; i++)
+                ids[i] = i;
+
+        rc = hb_mc_device_set_init(&set, test_name, ids, num_devices);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize device set.\n");
+                return rc;
+        }
+
+
+        rc = hb_mc_device_set_program_init(&set, bin_path, ALLOC_NAME, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize program.\n");
+                return rc;
+        }
+
+
+        /*****************************************************************************************************************
+        * Copy a sharded buffer to the devices and back.
+        ******************************************************************************************************************/
+        hb_mc_device_set_buffer_t buffer;
+        rc = hb_mc_device_set_malloc(&set, BUFFER_SIZE, &buffer);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to allocate sharded buffer.\n");
+                return rc;
+        }
+
+        uint32_t host_in[BUFFER_WORDS], host_out[BUFFER_WORDS];
+        srand(time(0));
+        for (int i = 0; i < BUFFER_WORDS; i++)
+                host_in[i] = rand();
+
+        rc = hb_mc_device_set_memcpy(&set, &buffer, host_in, HB_MC_MEMCPY_TO_DEVICE);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to copy buffer to devices.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_set_memcpy(&set, &buffer, host_out, HB_MC_MEMCPY_TO_HOST);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to copy buffer from devices.\n");
+                return rc;
+        }
+
+        for (int i = 0; i < BUFFER_WORDS; i++) {
+                if (host_out[i] != host_in[i]) {
+                        bsg_pr_err("mismatch at word %d: wrote 0x%08x, read 0x%08x.\n",
+                                   i, host_in[i], host_out[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+
+        /*****************************************************************************************************************
+        * Enqueue a grid sharded across the devices, launch it and wait for every device to finish.
+        ******************************************************************************************************************/
+        hb_mc_dimension_t grid_dim = { .x = 4, .y = 2};
+        hb_mc_dimension_t tg_dim = { .x = 2, .y = 2};
+
+        uint32_t cuda_argv[1];
+        const uint32_t *device_argv[MAX_DEVICES];
+        for (int i = 0; i < num_devices; i++)
+                device_argv[i] = cuda_argv;
+
+        rc = hb_mc_device_set_kernel_enqueue(&set, grid_dim, tg_dim, "kernel_empty", 0, device_argv);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize grid.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_set_tile_groups_execute(&set);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to execute tile groups.\n");
+                return rc;
+        }
+
+
+        /*****************************************************************************************************************
+        * Check the buffer survived, then free it, freeze the tiles and clean up.
+        ******************************************************************************************************************/
+        rc = hb_mc_device_set_memcpy(&set, &buffer, host_out, HB_MC_MEMCPY_TO_HOST);
+        if (rc != HB_MC_SUCCESS || memcmp(host_in, host_out, BUFFER_SIZE) != 0) {
+                bsg_pr_err("buffer changed while running kernel.\n");
+                return HB_MC_FAIL;
+        }
+
+        rc = hb_mc_device_set_free(&set, &buffer);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to free sharded buffer.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_set_finish(&set);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to de-initialize device set.\n");
+                return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_device_set Regression Test (COSIMULATION)\n");
+        int rc = kernel_device_set(argc, argv);
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_device_set Regression Test (F1)\n");
+        int rc = kernel_device_set(argc, argv);
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
+
@@ -0,0 +1,302 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "test_dram_channel_placement.h"
+#ifdef EMULATION
+#include <bsg_manycore_emulation.h>
+#endif
+
+#define ALLOC_NAME "default_allocator"
+
+/*!
+ * Allocates device buffers on chosen and staggered DRAM channels and checks
+ * where they landed.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static int check_start_channel(hb_mc_device_t *device, hb_mc_eva_t eva, uint32_t size, hb_mc_idx_t expected) {
+        int rc;
+        hb_mc_idx_t channel;
+        uint64_t channels;
+
+        rc = default_eva_get_dram_channel(device->mc, &eva, &channel);
+        if (rc != HB_MC_SUCCESS || channel != expected) {
+                bsg_pr_err("buffer at 0x%08x starts on channel %d, expected %d.\n", eva, channel, expected);
+                return HB_MC_FAIL;
+        }
+
+        rc = hb_mc_device_get_dram_channels(device, eva, size, &channels);
+        if (rc != HB_MC_SUCCESS || !(channels & (1ull << expected))) {
+                bsg_pr_err("channel mask of buffer at 0x%08x misses channel %d.\n", eva, expected);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int kernel_dram_channel_placement (int argc, char **argv) {
+        int rc;
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA DRAM Channel Placement test.\n\n");
+
+
+        /*****************************************************************************************************************
+        * Initialize device and load binary.
+        ******************************************************************************************************************/
+        hb_mc_device_t device;
+        rc = hb_mc_device_init(&device, test_name, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize device.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize program.\n");
+                return rc;
+        }
+
+        uint32_t stripe_size, stride, num_channels;
+        rc = default_eva_get_dram_interleave(device.mc, &stripe_size, &stride, &num_channels);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to get DRAM interleaving.\n");
+                return rc;
+        }
+        bsg_pr_test_info("DRAM is interleaved across %u channels every %u bytes.\n", num_channels, stripe_size);
+
+
+        /*****************************************************************************************************************
+        * Start one buffer on each channel, with a stray allocation in between to misalign the allocator.
+        ******************************************************************************************************************/
+        uint32_t size = 2 * stripe_size + sizeof(uint32_t);
+        for (hb_mc_idx_t c = 0; c < num_channels; c++) {
+                hb_mc_eva_t eva, stray;
+                rc = hb_mc_device_malloc(&device, sizeof(uint32_t), &stray);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to allocate memory on device.\n");
+                        return rc;
+                }
+
+                rc = hb_mc_device_malloc_placed(&device, size, HB_MC_DEVICE_MALLOC_CHANNEL, c, &eva);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to allocate memory on channel %d.\n", c);
+                        return rc;
+                }
+
+                rc = check_start_channel(&device, eva, size, c);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+
+        /*****************************************************************************************************************
+        * Staggered buffers start on consecutive channels.
+        ******************************************************************************************************************/
+        hb_mc_eva_t first;
+        hb_mc_idx_t first_channel;
+        for (uint32_t i = 0; i <= num_channels; i++) {
+                hb_mc_eva_t eva;
+                rc = hb_mc_device_malloc_placed(&device, size, HB_MC_DEVICE_MALLOC_STAGGER, 0, &eva);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to allocate staggered buffer %u.\n", i);
+                        return rc;
+                }
+
+                if (i == 0) {
+                        first = eva;
+                        rc = default_eva_get_dram_channel(device.mc, &first, &first_channel);
+                        if (rc != HB_MC_SUCCESS)
+                                return rc;
+                }
+
+                rc = check_start_channel(&device, eva, size, (first_channel + i) % num_channels);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+
+        /*****************************************************************************************************************
+        * A buffer spanning a whole interleave period covers every channel, and data round-trips through it.
+        ******************************************************************************************************************/
+        uint32_t words = stripe_size * num_channels / sizeof(uint32_t);
+        uint32_t host_in[words], host_out[words];
+        uint64_t channels;
+        hb_mc_eva_t wide;
+
+        // with holes past the last channel, only a buffer starting on channel 0 avoids them
+        hb_mc_idx_t wide_channel = stride == stripe_size * num_channels ? 1 % num_channels : 0;
+        rc = hb_mc_device_malloc_placed(&device, words * sizeof(uint32_t), HB_MC_DEVICE_MALLOC_CHANNEL, wide_channel, &wide);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to allocate memory on device.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_get_dram_channels(&device, wide, words * sizeof(uint32_t), &channels);
+        uint64_t all = num_channels == 64 ? ~0ull : (1ull << num_channels) - 1;
+        if (rc != HB_MC_SUCCESS || channels != all) {
+                bsg_pr_err("buffer spanning all channels has mask 0x%llx.\n", (unsigned long long)channels);
+                return HB_MC_FAIL;
+        }
+
+        srand(time(0));
+        for (uint32_t i = 0; i < words; i++)
+                host_in[i] = rand();
+
+        void *dst = (void *) ((intptr_t) wide);
+        rc = hb_mc_device_memcpy(&device, dst, host_in, words * sizeof(uint32_t), HB_MC_MEMCPY_TO_DEVICE);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to copy memory to device.\n");
+                return rc;
+        }
+
+        void *src = (void *) ((intptr_t) wide);
+        rc = hb_mc_device_memcpy(&device, host_out, src, words * sizeof(uint32_t), HB_MC_MEMCPY_TO_HOST);
+        if (rc != HB_MC_SUCCESS || memcmp(host_in, host_out, sizeof(host_in)) != 0) {
+                bsg_pr_err("data did not round-trip through placed buffer.\n");
+                return HB_MC_FAIL;
+        }
+
+
+        /*****************************************************************************************************************
+        * Placed buffers are listed with the call site that allocated them.
+        ******************************************************************************************************************/
+        FILE *dump = tmpfile();
+        if (dump == NULL) {
+                bsg_pr_err("failed to create a temporary file.\n");
+                return HB_MC_FAIL;
+        }
+
+        char line[512];
+        int tagged = 0, untagged = 0;
+        rc = hb_mc_device_memory_dump(&device, dump);
+        rewind(dump);
+        while (rc == HB_MC_SUCCESS && fgets(line, sizeof(line), dump) != NULL) {
+                tagged |= strstr(line, __FILE__ ":") != NULL;
+                untagged |= strstr(line, "hb_mc_device_malloc_placed") != NULL;
+        }
+        fclose(dump);
+
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        if (!tagged || untagged) {
+                bsg_pr_err("buffers from hb_mc_device_malloc_placed() are not tagged with %s.\n", __FILE__);
+                return HB_MC_FAIL;
+        }
+
+
+        /*****************************************************************************************************************
+        * Freeze the tiles and memory manager cleanup.
+        ******************************************************************************************************************/
+        rc = hb_mc_device_finish(&device);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to de-initialize device.\n");
+                return rc;
+        }
+
+#ifdef EMULATION
+        /*****************************************************************************************************************
+        * A DRAM stripe smaller than the allocator alignment cannot be placed on and is rejected up front.
+        ******************************************************************************************************************/
+        hb_mc_emulation_params_t params;
+        hb_mc_emulation_get_default_params(&params);
+        params.vcache_block_words = 4;
+        params.vcache_stripe_words = 4;
+        rc = hb_mc_emulation_set_params(1, &params);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to configure a narrow-stripe manycore.\n");
+                return rc;
+        }
+
+        hb_mc_device_t narrow;
+        rc = hb_mc_device_init(&narrow, test_name, 1);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize narrow-stripe device.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_program_init(&narrow, bin_path, ALLOC_NAME, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize program on narrow-stripe device.\n");
+                return rc;
+        }
+
+        hb_mc_eva_t narrow_eva;
+        rc = hb_mc_device_malloc_placed(&narrow, sizeof(uint32_t), HB_MC_DEVICE_MALLOC_CHANNEL, 0, &narrow_eva);
+        if (rc != HB_MC_INVALID) {
+                bsg_pr_err("placing a buffer on a %u byte stripe returned %s, expected %s.\n",
+                           params.vcache_stripe_words * (unsigned) sizeof(uint32_t),
+                           hb_mc_strerror(rc), hb_mc_strerror(HB_MC_INVALID));
+                return HB_MC_FAIL;
+        }
+
+        rc = hb_mc_device_finish(&narrow);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to de-initialize narrow-stripe device.\n");
+                return rc;
+        }
+#endif
+
+        return HB_MC_SUCCESS;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_dram_channel_placement Regression Test (COSIMULATION)\n");
+        int rc = kernel_dram_channel_placement(argc, argv);
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_dram_channel_placement Regression Test (F1)\n");
+        int rc = kernel_dram_channel_placement(argc, argv);
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
+
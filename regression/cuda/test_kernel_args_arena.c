@@ -0,0 +1,306 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "test_kernel_args_arena.h"
+
+#define ALLOC_NAME "default_allocator"
+#define NUM_ARGS 4
+
+/*!
+ * Launches waves of tile groups with distinct arguments and checks that every
+ * tile sees its own arguments, and that argument space is reused between waves.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static int read_tile_args(hb_mc_device_t *device, hb_mc_coordinate_t tile,
+                          hb_mc_eva_t *argv_ptr, uint32_t *args) {
+        int rc;
+        hb_mc_eva_t argc_eva, argv_ptr_eva;
+        uint32_t argc;
+
+        rc = hb_mc_loader_symbol_to_eva(device->program->bin, device->program->bin_size, "cuda_argc", &argc_eva);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        rc = hb_mc_loader_symbol_to_eva(device->program->bin, device->program->bin_size, "cuda_argv_ptr", &argv_ptr_eva);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        rc = hb_mc_manycore_eva_read(device->mc, &default_map, &tile, &argc_eva, &argc, sizeof(argc));
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        if (argc != NUM_ARGS) {
+                bsg_pr_err("tile (%d,%d) has argc %u, expected %d.\n", tile.x, tile.y, argc, NUM_ARGS);
+                return HB_MC_FAIL;
+        }
+
+        rc = hb_mc_manycore_eva_read(device->mc, &default_map, &tile, &argv_ptr_eva, argv_ptr, sizeof(*argv_ptr));
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        void *src = (void *) ((intptr_t) *argv_ptr);
+        return hb_mc_device_memcpy(device, args, src, NUM_ARGS * sizeof(uint32_t), HB_MC_MEMCPY_TO_HOST);
+}
+
+int kernel_kernel_args_arena (int argc, char **argv) {
+        int rc;
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Kernel Argument Arena test.\n\n");
+
+
+        /*****************************************************************************************************************
+        * Initialize device and load binary.
+        ******************************************************************************************************************/
+        hb_mc_device_t device;
+        rc = hb_mc_device_init(&device, test_name, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize device.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize program.\n");
+                return rc;
+        }
+
+        hb_mc_coordinate_t origin = device.mesh->origin;
+        hb_mc_dimension_t mesh_dim = device.mesh->dim;
+        uint32_t num_tiles = hb_mc_dimension_to_length(mesh_dim);
+        hb_mc_eva_t first_argv_ptr[num_tiles];
+        hb_mc_eva_t arena_base = 0;
+
+
+        /*****************************************************************************************************************
+        * Fill the mesh with 1x1 grids that each have their own arguments, a few times over.
+        * Every tile must see its own arguments, and each wave must reuse the space of the previous one.
+        ******************************************************************************************************************/
+        hb_mc_dimension_t one = { .x = 1, .y = 1 };
+        for (uint32_t iter = 0; iter < 3; iter++) {
+                for (uint32_t i = 0; i < num_tiles; i++) {
+                        uint32_t cuda_argv[NUM_ARGS] = { iter, i, ~i, 0xA5A50000 | i };
+                        rc = hb_mc_kernel_enqueue(&device, one, one, "kernel_empty", NUM_ARGS, cuda_argv);
+                        if (rc != HB_MC_SUCCESS) {
+                                bsg_pr_err("failed to initialize grid %u.\n", i);
+                                return rc;
+                        }
+                }
+
+                rc = hb_mc_device_tile_groups_execute(&device);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to execute tile groups.\n");
+                        return rc;
+                }
+
+                hb_mc_eva_t lo = ~0u, hi = 0;
+                for (uint32_t t = 0; t < num_tiles; t++) {
+                        hb_mc_coordinate_t tile = hb_mc_coordinate(origin.x + t % mesh_dim.x, origin.y + t / mesh_dim.x);
+                        hb_mc_eva_t argv_ptr;
+                        uint32_t a[NUM_ARGS];
+
+                        rc = read_tile_args(&device, tile, &argv_ptr, a);
+                        if (rc != HB_MC_SUCCESS) {
+                                bsg_pr_err("failed to read arguments of tile (%d,%d).\n", tile.x, tile.y);
+                                return rc;
+                        }
+
+                        uint32_t i = a[1];
+                        if (a[0] != iter || i >= num_tiles || a[2] != ~i || a[3] != (0xA5A50000 | i)) {
+                                bsg_pr_err("tile (%d,%d) has arguments {0x%x, 0x%x, 0x%x, 0x%x} in iteration %u.\n",
+                                           tile.x, tile.y, a[0], a[1], a[2], a[3], iter);
+                                return HB_MC_FAIL;
+                        }
+
+                        if (iter == 0)
+                                first_argv_ptr[t] = argv_ptr;
+                        else if (argv_ptr != first_argv_ptr[t]) {
+                                bsg_pr_err("tile (%d,%d) arguments moved from 0x%08x to 0x%08x; argument space was not reused.\n",
+                                           tile.x, tile.y, first_argv_ptr[t], argv_ptr);
+                                return HB_MC_FAIL;
+                        }
+
+                        lo = argv_ptr < lo ? argv_ptr : lo;
+                        hi = argv_ptr > hi ? argv_ptr : hi;
+                }
+
+                if (hi - lo >= num_tiles * NUM_ARGS * sizeof(uint32_t)) {
+                        bsg_pr_err("arguments of one wave span 0x%08x-0x%08x.\n", lo, hi);
+                        return HB_MC_FAIL;
+                }
+
+                if (iter == 0)
+                        arena_base = lo;
+        }
+
+
+        /*****************************************************************************************************************
+        * A grid larger than the mesh runs in several waves, which all fit in the space already reserved.
+        ******************************************************************************************************************/
+        hb_mc_dimension_t grid_dim = { .x = 2 * mesh_dim.x, .y = mesh_dim.y };
+        uint32_t cuda_argv[NUM_ARGS] = { 0xCAFE, 1, 2, 3 };
+        rc = hb_mc_kernel_enqueue(&device, grid_dim, one, "kernel_empty", NUM_ARGS, cuda_argv);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize grid.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_tile_groups_execute(&device);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to execute tile groups.\n");
+                return rc;
+        }
+
+        for (uint32_t t = 0; t < num_tiles; t++) {
+                hb_mc_coordinate_t tile = hb_mc_coordinate(origin.x + t % mesh_dim.x, origin.y + t / mesh_dim.x);
+                hb_mc_eva_t argv_ptr;
+                uint32_t a[NUM_ARGS];
+
+                rc = read_tile_args(&device, tile, &argv_ptr, a);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to read arguments of tile (%d,%d).\n", tile.x, tile.y);
+                        return rc;
+                }
+
+                if (memcmp(a, cuda_argv, sizeof(cuda_argv)) != 0 ||
+                    argv_ptr < arena_base || argv_ptr >= arena_base + HB_MC_CUDA_ARGS_CHUNK_SIZE) {
+                        bsg_pr_err("tile (%d,%d) has arguments {0x%x, 0x%x, 0x%x, 0x%x} at 0x%08x.\n",
+                                   tile.x, tile.y, a[0], a[1], a[2], a[3], argv_ptr);
+                        return HB_MC_FAIL;
+                }
+        }
+
+
+        /*****************************************************************************************************************
+        * All those launches leave a single argument chunk behind.
+        ******************************************************************************************************************/
+        hb_mc_device_memory_stats_t stats;
+        rc = hb_mc_device_get_memory_stats(&device, &stats);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to get device memory statistics.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_memory_dump(&device, stdout);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        if (stats.num_live_buffers != 1 || stats.peak_used != HB_MC_CUDA_ARGS_CHUNK_SIZE) {
+                bsg_pr_err("expected one %d byte argument chunk, found %llu buffers (peak %llu bytes).\n",
+                           HB_MC_CUDA_ARGS_CHUNK_SIZE,
+                           (unsigned long long) stats.num_live_buffers,
+                           (unsigned long long) stats.peak_used);
+                return HB_MC_FAIL;
+        }
+
+
+        /*****************************************************************************************************************
+        * A buffer from hb_mc_device_malloc() is listed with the call site that allocated it.
+        ******************************************************************************************************************/
+        hb_mc_eva_t buffer;
+        rc = hb_mc_device_malloc(&device, sizeof(cuda_argv), &buffer);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to allocate device memory.\n");
+                return rc;
+        }
+
+        FILE *dump = tmpfile();
+        if (dump == NULL) {
+                bsg_pr_err("failed to create a temporary file.\n");
+                return HB_MC_FAIL;
+        }
+
+        char line[512];
+        int found = 0;
+        rc = hb_mc_device_memory_dump(&device, dump);
+        rewind(dump);
+        while (rc == HB_MC_SUCCESS && fgets(line, sizeof(line), dump) != NULL)
+                found |= strstr(line, __FILE__ ":") != NULL;
+        fclose(dump);
+
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        if (!found) {
+                bsg_pr_err("buffer from hb_mc_device_malloc() is not tagged with %s.\n", __FILE__);
+                return HB_MC_FAIL;
+        }
+
+        rc = hb_mc_device_free(&device, buffer);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to free device memory.\n");
+                return rc;
+        }
+
+
+        /*****************************************************************************************************************
+        * Freeze the tiles and memory manager cleanup.
+        ******************************************************************************************************************/
+        rc = hb_mc_device_finish(&device);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to de-initialize device.\n");
+                return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_kernel_args_arena Regression Test (COSIMULATION)\n");
+        int rc = kernel_kernel_args_arena(argc, argv);
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_kernel_args_arena Regression Test (F1)\n");
+        int rc = kernel_kernel_args_arena(argc, argv);
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
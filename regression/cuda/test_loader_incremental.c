@@ -0,0 +1,354 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "test_loader_incremental.h"
+
+#define ALLOC_NAME "default_allocator"
+#define RELOADS 10
+
+/*!
+ * Checks that incremental loads write only what differs from the resident image,
+ * and leave DMEM and DRAM as a full load does, when switching between binaries.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+/* Find a word in the binary's read-only DRAM segment to patch */
+static int find_text_word(const unsigned char *bin, size_t sz, size_t *offset, hb_mc_eva_t *eva) {
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *) bin;
+        const Elf32_Phdr *phdr = (const Elf32_Phdr *) &bin[ehdr->e_phoff];
+
+        for (int i = 0; i < ehdr->e_phnum; i++) {
+                if (phdr[i].p_type != PT_LOAD || (phdr[i].p_flags & PF_W)
+                    || !(phdr[i].p_paddr & 0x80000000) || phdr[i].p_filesz < 8)
+                        continue;
+
+                /* a word in the middle, away from the ICACHE image */
+                size_t word = (phdr[i].p_filesz / 2) & ~0x3;
+                *offset = phdr[i].p_offset + word;
+                *eva = phdr[i].p_paddr + word;
+                return HB_MC_SUCCESS;
+        }
+
+        return HB_MC_NOTFOUND;
+}
+
+/* Read every tile's DMEM */
+static int read_dmem(hb_mc_manycore_t *mc, const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                     size_t dmem_sz, unsigned char *dmem) {
+        int rc;
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                hb_mc_npa_t npa = hb_mc_npa(tiles[i], HB_MC_TILE_EPA_DMEM_BASE);
+                rc = hb_mc_manycore_read_mem(mc, &npa, &dmem[i * dmem_sz], dmem_sz);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* Overwrite every tile's DMEM */
+static int clobber_dmem(hb_mc_manycore_t *mc, const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                        size_t dmem_sz) {
+        int rc;
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                hb_mc_npa_t npa = hb_mc_npa(tiles[i], HB_MC_TILE_EPA_DMEM_BASE);
+                rc = hb_mc_manycore_memset(mc, &npa, 0xA5, dmem_sz);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* Load a binary incrementally and check the resident DRAM word */
+static int load_and_check(const hb_mc_loader_plan_t *plan, const unsigned char *bin, size_t sz,
+                          hb_mc_manycore_t *mc, const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                          hb_mc_loader_resident_t *res, size_t word_offset, hb_mc_eva_t word_eva,
+                          size_t *written, size_t *skipped) {
+        uint32_t expect, found;
+        int rc;
+
+        rc = hb_mc_loader_plan_load_incremental(plan, bin, sz, mc, &default_map, tiles, ntiles, res);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("incremental load failed: %s\n", hb_mc_strerror(rc));
+                return rc;
+        }
+        hb_mc_loader_resident_get_stats(res, written, skipped);
+
+        rc = hb_mc_manycore_eva_read(mc, &default_map, &tiles[0], &word_eva, &found, sizeof(found));
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        memcpy(&expect, &bin[word_offset], sizeof(expect));
+        if (found != expect) {
+                bsg_pr_err("DRAM word 0x%08x: expected 0x%08x, found 0x%08x.\n",
+                           word_eva, expect, found);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int kernel_loader_incremental (int argc, char **argv) {
+        int rc;
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Incremental Loader test.\n\n");
+
+
+        /*****************************************************************************************************************
+        * Initialize device and load binary.
+        ******************************************************************************************************************/
+        hb_mc_device_t device;
+        rc = hb_mc_device_init(&device, test_name, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize device.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize program.\n");
+                return rc;
+        }
+
+        hb_mc_manycore_t *mc = device.mc;
+        const unsigned char *bin_a = device.program->bin;
+        size_t sz = device.program->bin_size;
+        uint32_t ntiles = hb_mc_dimension_to_length(device.mesh->dim);
+        hb_mc_coordinate_t tiles[ntiles];
+        for (uint32_t i = 0; i < ntiles; i++) {
+                tiles[i] = device.mesh->tiles[i].coord;
+                rc = hb_mc_tile_freeze(mc, &tiles[i]);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to freeze tile.\n");
+                        return rc;
+                }
+        }
+
+        /* binary B differs from A in one word of read-only DRAM */
+        size_t word_offset;
+        hb_mc_eva_t word_eva;
+        rc = find_text_word(bin_a, sz, &word_offset, &word_eva);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to find a read-only DRAM segment.\n");
+                return rc;
+        }
+
+        unsigned char *bin_b = (unsigned char *) malloc(sz);
+        size_t dmem_sz = hb_mc_tile_get_size_dmem(mc, &tiles[0]);
+        unsigned char *expect_dmem = (unsigned char *) malloc(ntiles * dmem_sz);
+        unsigned char *found_dmem = (unsigned char *) malloc(ntiles * dmem_sz);
+        if (!bin_b || !expect_dmem || !found_dmem) {
+                bsg_pr_err("failed to allocate buffers.\n");
+                return HB_MC_NOMEM;
+        }
+        memcpy(bin_b, bin_a, sz);
+        bin_b[word_offset] ^= 0xFF;
+
+        hb_mc_loader_plan_t *plan_a, *plan_b;
+        rc = hb_mc_loader_plan_init(bin_a, sz, mc, &default_map, tiles, ntiles, &plan_a);
+        rc |= hb_mc_loader_plan_init(bin_b, sz, mc, &default_map, tiles, ntiles, &plan_b);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to compile load plans.\n");
+                return HB_MC_FAIL;
+        }
+
+        hb_mc_loader_resident_t *res;
+        rc = hb_mc_loader_resident_init(&res);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to create resident image.\n");
+                return rc;
+        }
+
+
+        /*****************************************************************************************************************
+        * The first load writes everything; reloading the same binary skips read-only DRAM.
+        ******************************************************************************************************************/
+        size_t full_written, written, skipped;
+
+        rc = clobber_dmem(mc, tiles, ntiles, dmem_sz);
+        rc |= hb_mc_loader_plan_load(plan_a, bin_a, sz, mc, &default_map, tiles, ntiles);
+        rc |= read_dmem(mc, tiles, ntiles, dmem_sz, expect_dmem);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to load binary.\n");
+                return HB_MC_FAIL;
+        }
+
+        rc = load_and_check(plan_a, bin_a, sz, mc, tiles, ntiles, res, word_offset, word_eva,
+                            &full_written, &skipped);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+        if (skipped != 0) {
+                bsg_pr_err("the first load skipped %zu bytes.\n", skipped);
+                return HB_MC_FAIL;
+        }
+
+        rc = clobber_dmem(mc, tiles, ntiles, dmem_sz);
+        rc |= load_and_check(plan_a, bin_a, sz, mc, tiles, ntiles, res, word_offset, word_eva,
+                             &written, &skipped);
+        rc |= read_dmem(mc, tiles, ntiles, dmem_sz, found_dmem);
+        if (rc != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+        if (skipped == 0 || written + skipped != full_written) {
+                bsg_pr_err("reload wrote %zu bytes and skipped %zu of %zu.\n",
+                           written, skipped, full_written);
+                return HB_MC_FAIL;
+        }
+
+        /* writable segments are always rewritten */
+        if (memcmp(expect_dmem, found_dmem, ntiles * dmem_sz)) {
+                bsg_pr_err("DMEM differs after an incremental reload.\n");
+                return HB_MC_FAIL;
+        }
+
+        bsg_pr_test_info("reload: wrote %zu bytes, skipped %zu bytes\n", written, skipped);
+
+
+        /*****************************************************************************************************************
+        * Switching binaries writes the page that differs, and switching back restores it.
+        ******************************************************************************************************************/
+        size_t switch_written;
+        rc = load_and_check(plan_b, bin_b, sz, mc, tiles, ntiles, res, word_offset, word_eva,
+                            &switch_written, &skipped);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+        if (switch_written <= written || switch_written >= full_written) {
+                bsg_pr_err("switch wrote %zu bytes; reload wrote %zu, full load %zu.\n",
+                           switch_written, written, full_written);
+                return HB_MC_FAIL;
+        }
+
+        rc = load_and_check(plan_a, bin_a, sz, mc, tiles, ntiles, res, word_offset, word_eva,
+                            &written, &skipped);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+        bsg_pr_test_info("switch: wrote %zu bytes, skipped %zu bytes\n", switch_written, skipped);
+
+        /* forgetting the image makes the next load write everything */
+        hb_mc_loader_resident_forget(res);
+        rc = load_and_check(plan_a, bin_a, sz, mc, tiles, ntiles, res, word_offset, word_eva,
+                            &written, &skipped);
+        if (rc != HB_MC_SUCCESS || written != full_written || skipped != 0) {
+                bsg_pr_err("a load after forgetting the image skipped %zu bytes.\n", skipped);
+                return HB_MC_FAIL;
+        }
+
+
+        /*****************************************************************************************************************
+        * Compare the cost of switching between binaries.
+        ******************************************************************************************************************/
+        struct timespec start, end;
+        double full_us, incremental_us;
+
+        rc = HB_MC_SUCCESS;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < RELOADS; i++) {
+                rc |= hb_mc_loader_plan_load(plan_b, bin_b, sz, mc, &default_map, tiles, ntiles);
+                rc |= hb_mc_loader_plan_load(plan_a, bin_a, sz, mc, &default_map, tiles, ntiles);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        full_us = elapsed_us(&start, &end) / (2 * RELOADS);
+
+        /* the full loads above went behind the resident image's back */
+        hb_mc_loader_resident_forget(res);
+        rc |= hb_mc_loader_plan_load_incremental(plan_a, bin_a, sz, mc, &default_map, tiles, ntiles, res);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < RELOADS; i++) {
+                rc |= hb_mc_loader_plan_load_incremental(plan_b, bin_b, sz, mc, &default_map,
+                                                         tiles, ntiles, res);
+                rc |= hb_mc_loader_plan_load_incremental(plan_a, bin_a, sz, mc, &default_map,
+                                                         tiles, ntiles, res);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        incremental_us = elapsed_us(&start, &end) / (2 * RELOADS);
+
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("timed loads failed.\n");
+                return HB_MC_FAIL;
+        }
+
+        bsg_pr_test_info("%" PRIu32 " tiles: full load %.1f us, incremental load %.1f us\n",
+                         ntiles, full_us, incremental_us);
+
+        hb_mc_loader_resident_exit(res);
+        hb_mc_loader_plan_exit(plan_a);
+        hb_mc_loader_plan_exit(plan_b);
+        free(bin_b);
+        free(expect_dmem);
+        free(found_dmem);
+
+
+        /*****************************************************************************************************************
+        * Freeze the tiles and memory manager cleanup.
+        ******************************************************************************************************************/
+        rc = hb_mc_device_finish(&device);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to de-initialize device.\n");
+                return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_loader_incremental Regression Test (COSIMULATION)\n");
+        int rc = kernel_loader_incremental(argc, argv);
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_loader_incremental Regression Test (F1)\n");
+        int rc = kernel_loader_incremental(argc, argv);
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,419 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "test_loader_plan.h"
+
+#define ALLOC_NAME "default_allocator"
+#define DRAM_CHECK_BYTES 64
+
+/* Byte offset of the run count in a plan file's header */
+#define PLAN_NRUNS_OFFSET 32
+
+/*!
+ * Checks that replaying a load plan leaves the tiles and DRAM as hb_mc_loader_load() does,
+ * that plans are cached on disk by binary and machine, and compares the cost of each load.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+/* Count (or, if remove is set, delete) the plan files in a directory */
+static int plan_files(const char *dir, int remove) {
+        char path[PATH_MAX];
+        struct dirent *ent;
+        int n = 0;
+        DIR *d;
+
+        if (!(d = opendir(dir)))
+                return -1;
+
+        while ((ent = readdir(d)) != NULL) {
+                if (ent->d_name[0] == '.')
+                        continue;
+                n++;
+                if (remove) {
+                        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+                        unlink(path);
+                }
+        }
+
+        closedir(d);
+        return n;
+}
+
+/* Claim an impossible number of runs in every plan file in a directory */
+static int corrupt_plan_files(const char *dir) {
+        char path[PATH_MAX];
+        struct dirent *ent;
+        uint32_t nruns = 0xFFFFFFFF;
+        int n = 0;
+        DIR *d;
+
+        if (!(d = opendir(dir)))
+                return -1;
+
+        while ((ent = readdir(d)) != NULL) {
+                if (ent->d_name[0] == '.')
+                        continue;
+                snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+                FILE *f = fopen(path, "r+b");
+                if (!f)
+                        continue;
+                if (fseek(f, PLAN_NRUNS_OFFSET, SEEK_SET) == 0
+                    && fwrite(&nruns, sizeof(nruns), 1, f) == 1)
+                        n++;
+                fclose(f);
+        }
+
+        closedir(d);
+        return n;
+}
+
+/* Read every tile's DMEM and the start of DRAM */
+static int snapshot(hb_mc_manycore_t *mc, const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                    size_t dmem_sz, unsigned char *dmem, unsigned char *dram) {
+        hb_mc_eva_t dram_eva = 0x80000000;
+        int rc;
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                hb_mc_npa_t npa = hb_mc_npa(tiles[i], HB_MC_TILE_EPA_DMEM_BASE);
+                rc = hb_mc_manycore_read_mem(mc, &npa, &dmem[i * dmem_sz], dmem_sz);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+        return hb_mc_manycore_eva_read(mc, &default_map, &tiles[0], &dram_eva,
+                                       dram, DRAM_CHECK_BYTES);
+}
+
+/* Overwrite every tile's DMEM and the start of DRAM */
+static int clobber(hb_mc_manycore_t *mc, const hb_mc_coordinate_t *tiles, uint32_t ntiles,
+                   size_t dmem_sz) {
+        hb_mc_eva_t dram_eva = 0x80000000;
+        int rc;
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                hb_mc_npa_t npa = hb_mc_npa(tiles[i], HB_MC_TILE_EPA_DMEM_BASE);
+                rc = hb_mc_manycore_memset(mc, &npa, 0xA5, dmem_sz);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+        return hb_mc_manycore_eva_memset(mc, &default_map, &tiles[0], &dram_eva,
+                                         0xA5, DRAM_CHECK_BYTES);
+}
+
+int kernel_loader_plan (int argc, char **argv) {
+        int rc;
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Loader Plan test.\n\n");
+
+
+        /*****************************************************************************************************************
+        * Initialize device and load binary.
+        ******************************************************************************************************************/
+        hb_mc_device_t device;
+        rc = hb_mc_device_init(&device, test_name, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize device.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize program.\n");
+                return rc;
+        }
+
+        hb_mc_manycore_t *mc = device.mc;
+        const hb_mc_program_t *program = device.program;
+        uint32_t ntiles = hb_mc_dimension_to_length(device.mesh->dim);
+        hb_mc_coordinate_t tiles[ntiles];
+        for (uint32_t i = 0; i < ntiles; i++) {
+                tiles[i] = device.mesh->tiles[i].coord;
+                rc = hb_mc_tile_freeze(mc, &tiles[i]);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to freeze tile.\n");
+                        return rc;
+                }
+        }
+
+        size_t dmem_sz = hb_mc_tile_get_size_dmem(mc, &tiles[0]);
+        unsigned char *expect_dmem = (unsigned char *) malloc(ntiles * dmem_sz);
+        unsigned char *found_dmem = (unsigned char *) malloc(ntiles * dmem_sz);
+        unsigned char expect_dram[DRAM_CHECK_BYTES], found_dram[DRAM_CHECK_BYTES];
+        if (!expect_dmem || !found_dmem) {
+                bsg_pr_err("failed to allocate snapshots.\n");
+                return HB_MC_NOMEM;
+        }
+
+
+        /*****************************************************************************************************************
+        * Replaying a plan leaves DMEM and DRAM as hb_mc_loader_load() does.
+        ******************************************************************************************************************/
+        struct timespec start, end;
+        double load_us, compile_us, replay_us, miss_us, hit_us;
+        hb_mc_loader_plan_t *plan;
+
+        /* memory the binary does not cover keeps the clobbered value */
+        rc = clobber(mc, tiles, ntiles, dmem_sz);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to clobber memory.\n");
+                return rc;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        rc = hb_mc_loader_load(program->bin, program->bin_size, mc, &default_map, tiles, ntiles);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        load_us = elapsed_us(&start, &end);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to load binary.\n");
+                return rc;
+        }
+
+        rc = snapshot(mc, tiles, ntiles, dmem_sz, expect_dmem, expect_dram);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to read loaded memory.\n");
+                return rc;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        rc = hb_mc_loader_plan_init(program->bin, program->bin_size, mc, &default_map,
+                                    tiles, ntiles, &plan);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        compile_us = elapsed_us(&start, &end);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to compile load plan: %s\n", hb_mc_strerror(rc));
+                return rc;
+        }
+
+        rc = clobber(mc, tiles, ntiles, dmem_sz);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to clobber memory.\n");
+                return rc;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        rc = hb_mc_loader_plan_load(plan, program->bin, program->bin_size, mc, &default_map,
+                                    tiles, ntiles);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        replay_us = elapsed_us(&start, &end);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to replay load plan.\n");
+                return rc;
+        }
+
+        rc = snapshot(mc, tiles, ntiles, dmem_sz, found_dmem, found_dram);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to read replayed memory.\n");
+                return rc;
+        }
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                if (memcmp(&expect_dmem[i * dmem_sz], &found_dmem[i * dmem_sz], dmem_sz)) {
+                        bsg_pr_err("tile (%d,%d): DMEM differs after replay.\n",
+                                   hb_mc_coordinate_get_x(tiles[i]),
+                                   hb_mc_coordinate_get_y(tiles[i]));
+                        return HB_MC_FAIL;
+                }
+        }
+
+        if (memcmp(expect_dram, found_dram, DRAM_CHECK_BYTES)) {
+                bsg_pr_err("DRAM differs after replay.\n");
+                return HB_MC_FAIL;
+        }
+
+        /* a plan carries the program's symbols */
+        hb_mc_loader_symbols_t *plan_symbols;
+        hb_mc_eva_t expect_eva, found_eva;
+        rc = hb_mc_loader_plan_get_symbols(plan, &plan_symbols);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to get plan symbols.\n");
+                return rc;
+        }
+
+        rc = hb_mc_loader_symbols_lookup(program->symbols, "cuda_kernel_ptr", &expect_eva, NULL);
+        rc |= hb_mc_loader_symbols_lookup(plan_symbols, "cuda_kernel_ptr", &found_eva, NULL);
+        hb_mc_loader_symbols_exit(plan_symbols);
+        if (rc != HB_MC_SUCCESS || expect_eva != found_eva) {
+                bsg_pr_err("plan symbols disagree with the program.\n");
+                return HB_MC_FAIL;
+        }
+
+        size_t nruns = hb_mc_loader_plan_get_num_runs(plan);
+        hb_mc_loader_plan_exit(plan);
+
+
+        /*****************************************************************************************************************
+        * Plans are cached by binary and machine.
+        ******************************************************************************************************************/
+        char cache_dir[] = "/tmp/test_loader_plan.XXXXXX";
+        if (!mkdtemp(cache_dir)) {
+                bsg_pr_err("failed to create a cache directory.\n");
+                return HB_MC_FAIL;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        rc = hb_mc_loader_plan_cached(program->bin, program->bin_size, mc, &default_map,
+                                      tiles, ntiles, cache_dir, &plan);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        miss_us = elapsed_us(&start, &end);
+        if (rc != HB_MC_SUCCESS || plan_files(cache_dir, 0) != 1) {
+                bsg_pr_err("a cache miss did not save a plan.\n");
+                rc = HB_MC_FAIL;
+                goto cleanup;
+        }
+        hb_mc_loader_plan_exit(plan);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        rc = hb_mc_loader_plan_cached(program->bin, program->bin_size, mc, &default_map,
+                                      tiles, ntiles, cache_dir, &plan);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        hit_us = elapsed_us(&start, &end);
+        if (rc != HB_MC_SUCCESS || plan_files(cache_dir, 0) != 1
+            || hb_mc_loader_plan_get_num_runs(plan) != nruns) {
+                bsg_pr_err("a cache hit did not return the saved plan.\n");
+                rc = HB_MC_FAIL;
+                goto cleanup;
+        }
+
+        /* a plan read from the cache replays like a compiled one */
+        rc = clobber(mc, tiles, ntiles, dmem_sz);
+        rc |= hb_mc_loader_plan_load(plan, program->bin, program->bin_size, mc, &default_map,
+                                     tiles, ntiles);
+        rc |= snapshot(mc, tiles, ntiles, dmem_sz, found_dmem, found_dram);
+        hb_mc_loader_plan_exit(plan);
+        if (rc != HB_MC_SUCCESS
+            || memcmp(expect_dmem, found_dmem, ntiles * dmem_sz)
+            || memcmp(expect_dram, found_dram, DRAM_CHECK_BYTES)) {
+                bsg_pr_err("a cached plan did not replay correctly.\n");
+                rc = HB_MC_FAIL;
+                goto cleanup;
+        }
+
+        /* a corrupt plan file is a cache miss */
+        if (corrupt_plan_files(cache_dir) != 1) {
+                bsg_pr_err("failed to corrupt the plan file.\n");
+                rc = HB_MC_FAIL;
+                goto cleanup;
+        }
+        rc = hb_mc_loader_plan_cached(program->bin, program->bin_size, mc, &default_map,
+                                      tiles, ntiles, cache_dir, &plan);
+        if (rc != HB_MC_SUCCESS || plan_files(cache_dir, 0) != 1
+            || hb_mc_loader_plan_get_num_runs(plan) != nruns) {
+                bsg_pr_err("a corrupt plan file was not recompiled.\n");
+                rc = HB_MC_FAIL;
+                goto cleanup;
+        }
+        hb_mc_loader_plan_exit(plan);
+
+        /* a different binary gets its own plan */
+        unsigned char *other_bin = (unsigned char *) calloc(1, program->bin_size + 4);
+        if (!other_bin) {
+                rc = HB_MC_NOMEM;
+                goto cleanup;
+        }
+        memcpy(other_bin, program->bin, program->bin_size);
+        rc = hb_mc_loader_plan_cached(other_bin, program->bin_size + 4, mc, &default_map,
+                                      tiles, ntiles, cache_dir, &plan);
+        if (rc != HB_MC_SUCCESS || plan_files(cache_dir, 0) != 2) {
+                bsg_pr_err("a different binary did not get its own plan.\n");
+                free(other_bin);
+                rc = HB_MC_FAIL;
+                goto cleanup;
+        }
+
+        /* a plan will not replay a binary of the same size with different contents */
+        other_bin[program->bin_size + 3] ^= 0xFF;
+        rc = hb_mc_loader_plan_load(plan, other_bin, program->bin_size + 4, mc, &default_map,
+                                    tiles, ntiles);
+        free(other_bin);
+        hb_mc_loader_plan_exit(plan);
+        if (rc != HB_MC_INVALID) {
+                bsg_pr_err("a plan replayed a binary it was not compiled for.\n");
+                rc = HB_MC_FAIL;
+                goto cleanup;
+        }
+        rc = HB_MC_SUCCESS;
+
+        bsg_pr_test_info("%" PRIu32 " tiles, %zu runs: load %.1f us, compile %.1f us, replay %.1f us, "
+                         "cache miss %.1f us, cache hit %.1f us\n",
+                         ntiles, nruns, load_us, compile_us, replay_us, miss_us, hit_us);
+
+cleanup:
+        plan_files(cache_dir, 1);
+        rmdir(cache_dir);
+        free(expect_dmem);
+        free(found_dmem);
+        if (rc != HB_MC_SUCCESS)
+                return rc;
+
+
+        /*****************************************************************************************************************
+        * Freeze the tiles and memory manager cleanup.
+        ******************************************************************************************************************/
+        rc = hb_mc_device_finish(&device);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to de-initialize device.\n");
+                return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_loader_plan Regression Test (COSIMULATION)\n");
+        int rc = kernel_loader_plan(argc, argv);
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_loader_plan Regression Test (F1)\n");
+        int rc = kernel_loader_plan(argc, argv);
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
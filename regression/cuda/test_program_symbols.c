@@ -0,0 +1,214 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "test_program_symbols.h"
+
+#define ALLOC_NAME "default_allocator"
+#define LOOKUPS 10000
+
+/*!
+ * Checks that the symbol index built when a program is loaded agrees with
+ * a scan of the binary's symbol tables, and compares the cost of the two.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static const char *symbols [] = {
+        "cuda_kernel_ptr",
+        "cuda_argc",
+        "cuda_argv_ptr",
+        "cuda_finish_signal_addr",
+        "cuda_finish_signal_val",
+        "__bsg_id",
+        "__bsg_x",
+        "__bsg_y",
+        "__bsg_grp_org_x",
+        "__bsg_grp_org_y",
+        "__bsg_tile_group_id_x",
+        "__bsg_tile_group_id_y",
+        "__bsg_grid_dim_x",
+        "__bsg_grid_dim_y",
+        "kernel_empty",
+        "_bsg_dram_end_addr",
+};
+
+#define NUM_SYMBOLS (sizeof(symbols)/sizeof(symbols[0]))
+
+int kernel_program_symbols (int argc, char **argv) {
+        int rc;
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Program Symbol Index test.\n\n");
+
+
+        /*****************************************************************************************************************
+        * Initialize device and load binary.
+        ******************************************************************************************************************/
+        hb_mc_device_t device;
+        rc = hb_mc_device_init(&device, test_name, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize device.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize program.\n");
+                return rc;
+        }
+
+        const hb_mc_program_t *program = device.program;
+        if (!program->symbols) {
+                bsg_pr_err("program has no symbol index.\n");
+                return HB_MC_FAIL;
+        }
+
+
+        /*****************************************************************************************************************
+        * Every symbol resolves to the same EVA through the index as through a scan of the binary.
+        ******************************************************************************************************************/
+        for (uint32_t i = 0; i < NUM_SYMBOLS; i++) {
+                hb_mc_eva_t scanned, indexed;
+                size_t size;
+
+                rc = hb_mc_loader_symbol_to_eva(program->bin, program->bin_size, symbols[i], &scanned);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to find %s in the binary.\n", symbols[i]);
+                        return rc;
+                }
+
+                rc = hb_mc_loader_symbols_lookup(program->symbols, symbols[i], &indexed, &size);
+                if (rc != HB_MC_SUCCESS) {
+                        bsg_pr_err("failed to find %s in the symbol index.\n", symbols[i]);
+                        return rc;
+                }
+
+                if (indexed != scanned) {
+                        bsg_pr_err("%s: index has EVA 0x%08x, binary has 0x%08x.\n",
+                                   symbols[i], indexed, scanned);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        hb_mc_eva_t eva;
+        rc = hb_mc_loader_symbols_lookup(program->symbols, "no_such_symbol", &eva, NULL);
+        if (rc != HB_MC_NOTFOUND) {
+                bsg_pr_err("lookup of a missing symbol returned %s.\n", hb_mc_strerror(rc));
+                return HB_MC_FAIL;
+        }
+
+
+        /*****************************************************************************************************************
+        * Compare the cost of the lookups made when a program is launched.
+        ******************************************************************************************************************/
+        struct timespec start, end;
+        double scan_us, index_us;
+
+        rc = HB_MC_SUCCESS;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint32_t i = 0; i < LOOKUPS; i++)
+                rc |= hb_mc_loader_symbol_to_eva(program->bin, program->bin_size, symbols[i % NUM_SYMBOLS], &eva);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        scan_us = elapsed_us(&start, &end);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (uint32_t i = 0; i < LOOKUPS; i++)
+                rc |= hb_mc_loader_symbols_lookup(program->symbols, symbols[i % NUM_SYMBOLS], &eva, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        index_us = elapsed_us(&start, &end);
+
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("symbol lookups failed.\n");
+                return HB_MC_FAIL;
+        }
+
+        bsg_pr_test_info("%d lookups: scan %.1f us, index %.1f us\n", LOOKUPS, scan_us, index_us);
+
+
+        /*****************************************************************************************************************
+        * Launches resolve the kernel and runtime symbols through the index.
+        ******************************************************************************************************************/
+        hb_mc_dimension_t tg_dim = { .x = 2, .y = 2 };
+        hb_mc_dimension_t grid_dim = { .x = 2, .y = 1 };
+        uint32_t cuda_argv[1] = { 0 };
+        rc = hb_mc_kernel_enqueue(&device, grid_dim, tg_dim, "kernel_empty", 1, cuda_argv);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to initialize grid.\n");
+                return rc;
+        }
+
+        rc = hb_mc_device_tile_groups_execute(&device);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to execute tile groups.\n");
+                return rc;
+        }
+
+
+        /*****************************************************************************************************************
+        * Freeze the tiles and memory manager cleanup.
+        ******************************************************************************************************************/
+        rc = hb_mc_device_finish(&device);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to de-initialize device.\n");
+                return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_program_symbols Regression Test (COSIMULATION)\n");
+        int rc = kernel_program_symbols(argc, argv);
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_program_symbols Regression Test (F1)\n");
+        int rc = kernel_program_symbols(argc, argv);
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,244 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_coordinate.h>
+#include "test_manycore_async_transfers.h"
+
+#define TEST_NAME "test_manycore_async_transfers"
+
+#define ARRAY_LEN  1024
+#define N_BUFFERS  4
+#define BASE_ADDR 0x0000
+
+/* counts completed transfers and remembers the first failure */
+typedef struct completions {
+        int count;
+        int status;
+} completions_t;
+
+static void count_completion(hb_mc_manycore_t *mc, hb_mc_transfer_t *xfer,
+                             int status, void *context)
+{
+        completions_t *c = (completions_t*)context;
+        c->count++;
+        if (status != HB_MC_SUCCESS && c->status == HB_MC_SUCCESS)
+                c->status = status;
+}
+
+int test_manycore_async_transfers() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        static uint32_t write_data[N_BUFFERS][ARRAY_LEN];
+        static uint32_t read_data[N_BUFFERS][ARRAY_LEN];
+        static hb_mc_npa_t gather_npas[ARRAY_LEN];
+        static uint32_t gather_data[ARRAY_LEN];
+        hb_mc_transfer_t *reads[N_BUFFERS], *gather;
+        completions_t writes = {0, HB_MC_SUCCESS};
+        size_t polls = 0;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
+        hb_mc_idx_t dram_y = hb_mc_config_get_dram_y(config);
+
+        /*************************************************************/
+        /* Submit detached writes of N_BUFFERS arrays, then memset a */
+        /* scratch region after them. Completion is counted by the  */
+        /* callback.                                                 */
+        /*************************************************************/
+        for (int b = 0; b < N_BUFFERS; b++) {
+                hb_mc_npa_t npa = hb_mc_npa_from_x_y(0, dram_y, BASE_ADDR + b * sizeof(write_data[b]));
+
+                for (size_t i = 0; i < ARRAY_LEN; i++)
+                        write_data[b][i] = rand();
+
+                err = hb_mc_manycore_write_mem_async(mc, &npa, write_data[b], sizeof(write_data[b]),
+                                                     count_completion, &writes, NULL);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to submit write %d: %s\n",
+                                   __func__, b, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+        }
+
+        hb_mc_npa_t scratch = hb_mc_npa_from_x_y(0, dram_y, BASE_ADDR + sizeof(write_data));
+        err = hb_mc_manycore_memset_async(mc, &scratch, 0x5a, ARRAY_LEN * sizeof(uint32_t),
+                                          count_completion, &writes, NULL);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to submit memset: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /****************************************************************/
+        /* Submit reads of every array plus a gather of the memset      */
+        /* region in reverse order. They are ordered after the writes. */
+        /****************************************************************/
+        for (int b = 0; b < N_BUFFERS; b++) {
+                hb_mc_npa_t npa = hb_mc_npa_from_x_y(0, dram_y, BASE_ADDR + b * sizeof(read_data[b]));
+
+                err = hb_mc_manycore_read_mem_async(mc, &npa, read_data[b], sizeof(read_data[b]),
+                                                    NULL, NULL, &reads[b]);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to submit read %d: %s\n",
+                                   __func__, b, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+        }
+
+        for (size_t i = 0; i < ARRAY_LEN; i++)
+                gather_npas[i] = hb_mc_npa_from_x_y(0, dram_y,
+                                                    hb_mc_npa_get_epa(&scratch) +
+                                                    (ARRAY_LEN - 1 - i) * sizeof(uint32_t));
+
+        err = hb_mc_manycore_read_mem_scatter_gather_async(mc, gather_npas, gather_data, ARRAY_LEN,
+                                                           NULL, NULL, &gather);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to submit gather: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /*************************************************************/
+        /* Poll the last read while the host is free to do other work */
+        /*************************************************************/
+        while ((err = hb_mc_manycore_transfer_test(mc, reads[N_BUFFERS-1])) == HB_MC_BUSY)
+                polls++;
+
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: read %d failed: %s\n",
+                           __func__, N_BUFFERS-1, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        bsg_pr_test_info("%s: last read completed after %zu polls\n", __func__, polls);
+
+        /* earlier reads were issued first, so they have completed too */
+        for (int b = 0; b < N_BUFFERS; b++) {
+                err = hb_mc_manycore_transfer_wait(mc, reads[b]);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: read %d failed: %s\n",
+                                   __func__, b, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+        }
+
+        err = hb_mc_manycore_transfer_wait(mc, gather);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: gather failed: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        err = hb_mc_manycore_transfer_wait_all(mc);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to wait for transfers: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /********************/
+        /* Check the result */
+        /********************/
+        if (writes.count != N_BUFFERS + 1 || writes.status != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: expected %d successful write callbacks, got %d (%s)\n",
+                           __func__, N_BUFFERS + 1, writes.count, hb_mc_strerror(writes.status));
+                goto cleanup;
+        }
+
+        for (int b = 0; b < N_BUFFERS; b++) {
+                for (size_t i = 0; i < ARRAY_LEN; i++) {
+                        if (read_data[b][i] != write_data[b][i]) {
+                                bsg_pr_err("%s: mismatch in buffer %d @ index %zu: "
+                                           "wrote 0x%08" PRIx32 " -- "
+                                           "read 0x%08" PRIx32 "\n",
+                                           __func__, b, i, write_data[b][i], read_data[b][i]);
+                                goto cleanup;
+                        }
+                }
+        }
+
+        for (size_t i = 0; i < ARRAY_LEN; i++) {
+                if (gather_data[i] != 0x5a5a5a5a) {
+                        bsg_pr_err("%s: memset mismatch @ index %zu: read 0x%08" PRIx32 "\n",
+                                   __func__, i, gather_data[i]);
+                        goto cleanup;
+                }
+        }
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_async_transfers();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_async_transfers();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,237 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <pthread.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_coordinate.h>
+#include "test_manycore_concurrent_transfers.h"
+
+#define TEST_NAME "test_manycore_concurrent_transfers"
+
+#define ARRAY_LEN   1024
+#define ROUNDS      16
+#define WRITE_ADDR  0x0000
+#define READ_ADDR   (ARRAY_LEN * sizeof(uint32_t))
+#define SINGLE_ADDR (2 * ARRAY_LEN * sizeof(uint32_t))
+
+typedef struct thread_args {
+        hb_mc_manycore_t *mc;
+        hb_mc_npa_t npa;
+        const uint32_t *expected;
+        int result;
+} thread_args_t;
+
+/* stream a buffer to DRAM over and over */
+static void *writer(void *p)
+{
+        thread_args_t *args = (thread_args_t*)p;
+        int err;
+
+        args->result = HB_MC_FAIL;
+        for (int round = 0; round < ROUNDS; round++) {
+                err = hb_mc_manycore_write_mem(args->mc, &args->npa, args->expected,
+                                               ARRAY_LEN * sizeof(uint32_t));
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to write round %d: %s\n",
+                                   __func__, round, hb_mc_strerror(err));
+                        return NULL;
+                }
+        }
+
+        args->result = HB_MC_SUCCESS;
+        return NULL;
+}
+
+/* read a buffer back from DRAM over and over and check it every time */
+static void *reader(void *p)
+{
+        thread_args_t *args = (thread_args_t*)p;
+        uint32_t read_data[ARRAY_LEN];
+        int err;
+
+        args->result = HB_MC_FAIL;
+        for (int round = 0; round < ROUNDS; round++) {
+                err = hb_mc_manycore_read_mem(args->mc, &args->npa, read_data, sizeof(read_data));
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to read round %d: %s\n",
+                                   __func__, round, hb_mc_strerror(err));
+                        return NULL;
+                }
+
+                for (size_t i = 0; i < ARRAY_LEN; i++) {
+                        if (read_data[i] != args->expected[i]) {
+                                bsg_pr_err("%s: mismatch in round %d @ index %zu: "
+                                           "expected 0x%08" PRIx32 " -- "
+                                           "read 0x%08" PRIx32 "\n",
+                                           __func__, round, i, args->expected[i], read_data[i]);
+                                return NULL;
+                        }
+                }
+        }
+
+        args->result = HB_MC_SUCCESS;
+        return NULL;
+}
+
+/* read one word at a time with the single-word API */
+static void *single_reader(void *p)
+{
+        thread_args_t *args = (thread_args_t*)p;
+        uint32_t v;
+        int err;
+
+        args->result = HB_MC_FAIL;
+        for (int round = 0; round < ROUNDS * 16; round++) {
+                err = hb_mc_manycore_read32(args->mc, &args->npa, &v);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to read: %s\n", __func__, hb_mc_strerror(err));
+                        return NULL;
+                }
+
+                if (v != args->expected[0]) {
+                        bsg_pr_err("%s: expected 0x%08" PRIx32 ", read 0x%08" PRIx32 "\n",
+                                   __func__, args->expected[0], v);
+                        return NULL;
+                }
+        }
+
+        args->result = HB_MC_SUCCESS;
+        return NULL;
+}
+
+int test_manycore_concurrent_transfers() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        uint32_t write_data[ARRAY_LEN], read_data[ARRAY_LEN], single_data = 0;
+        thread_args_t wargs, rargs, sargs;
+        pthread_t wthread, rthread, sthread;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
+        hb_mc_idx_t dram_y = hb_mc_config_get_dram_y(config);
+        hb_mc_npa_t write_npa  = { .x = 0, .y = dram_y, .epa = WRITE_ADDR };
+        hb_mc_npa_t read_npa   = { .x = 0, .y = dram_y, .epa = READ_ADDR };
+        hb_mc_npa_t single_npa = { .x = 0, .y = dram_y, .epa = SINGLE_ADDR };
+
+        for (size_t i = 0; i < ARRAY_LEN; i++) {
+                write_data[i] = rand();
+                read_data[i] = rand();
+        }
+        single_data = rand();
+
+        /*********************************************/
+        /* Seed the regions the readers will check   */
+        /*********************************************/
+        err = hb_mc_manycore_write_mem(mc, &read_npa, read_data, sizeof(read_data));
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_write32(mc, &single_npa, single_data);
+
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to seed DRAM: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /**************************************************/
+        /* Stream writes while two other threads read back */
+        /**************************************************/
+        wargs = (thread_args_t){ .mc = mc, .npa = write_npa,  .expected = write_data };
+        rargs = (thread_args_t){ .mc = mc, .npa = read_npa,   .expected = read_data };
+        sargs = (thread_args_t){ .mc = mc, .npa = single_npa, .expected = &single_data };
+
+        pthread_create(&wthread, NULL, writer, &wargs);
+        pthread_create(&rthread, NULL, reader, &rargs);
+        pthread_create(&sthread, NULL, single_reader, &sargs);
+
+        pthread_join(wthread, NULL);
+        pthread_join(rthread, NULL);
+        pthread_join(sthread, NULL);
+
+        if (wargs.result != HB_MC_SUCCESS ||
+            rargs.result != HB_MC_SUCCESS ||
+            sargs.result != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /**************************************/
+        /* Check what the writer left behind */
+        /**************************************/
+        rargs.npa = write_npa;
+        rargs.expected = write_data;
+        reader(&rargs);
+        if (rargs.result != HB_MC_SUCCESS)
+                goto cleanup;
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_concurrent_transfers();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_concurrent_transfers();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,286 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_eva.h>
+#ifdef EMULATION
+#include <bsg_manycore_emulation.h>
+#endif
+#include "test_manycore_dram_interleave.h"
+
+#define TEST_NAME "test_manycore_dram_interleave"
+
+#define DRAM_BASE_EVA  0x80000000
+#define BUFFER_SIZE    (4 << 20)
+
+/*
+ * Write #sz bytes at #offset with one request order and read them back with
+ * the other, so that each order is checked against the other.
+ */
+static int check_transfer(hb_mc_manycore_t *mc, uint32_t *write_data, uint32_t *read_data,
+                          size_t offset, size_t sz, int write_interleaved)
+{
+        hb_mc_coordinate_t tgt = hb_mc_coordinate(0, 0);
+        hb_mc_eva_t eva = DRAM_BASE_EVA + offset;
+        int err;
+
+        for (size_t i = 0; i < sz / sizeof(uint32_t); i++)
+                write_data[i] = rand();
+
+        err = hb_mc_manycore_set_dram_interleave(mc, write_interleaved);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_eva_write(mc, &default_map, &tgt, &eva, write_data, sz);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to write %zu bytes at offset %zu: %s\n",
+                           __func__, sz, offset, hb_mc_strerror(err));
+                return err;
+        }
+
+        memset(read_data, 0, sz);
+        err = hb_mc_manycore_set_dram_interleave(mc, !write_interleaved);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_eva_read(mc, &default_map, &tgt, &eva, read_data, sz);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read %zu bytes at offset %zu: %s\n",
+                           __func__, sz, offset, hb_mc_strerror(err));
+                return err;
+        }
+
+        for (size_t i = 0; i < sz / sizeof(uint32_t); i++) {
+                if (read_data[i] != write_data[i]) {
+                        bsg_pr_err("%s: %s write of %zu bytes at offset %zu: mismatch @ index %zu: "
+                                   "wrote 0x%08" PRIx32 " -- read 0x%08" PRIx32 "\n",
+                                   __func__, write_interleaved ? "interleaved" : "in-order",
+                                   sz, offset, i, write_data[i], read_data[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* read BUFFER_SIZE bytes with the given request order and return the time taken */
+static int time_read(hb_mc_manycore_t *mc, uint32_t *read_data, int interleaved, double *seconds)
+{
+        hb_mc_coordinate_t tgt = hb_mc_coordinate(0, 0);
+        hb_mc_eva_t eva = DRAM_BASE_EVA;
+        struct timespec start, end;
+        int err;
+
+        err = hb_mc_manycore_set_dram_interleave(mc, interleaved);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        err = hb_mc_manycore_eva_read(mc, &default_map, &tgt, &eva, read_data, BUFFER_SIZE);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        *seconds = elapsed_s(&start, &end);
+
+        if (err != HB_MC_SUCCESS)
+                bsg_pr_err("%s: failed to read %d bytes: %s\n",
+                           __func__, BUFFER_SIZE, hb_mc_strerror(err));
+        return err;
+}
+
+#ifdef EMULATION
+/* a DRAM X dimension that is not a power of two leaves holes past the last channel */
+#define HOLES_DIM_X 5
+
+/* check that exactly the channels reported by default_eva_get_dram_interleave() translate */
+static int check_holes()
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_emulation_params_t params;
+        uint32_t stripe_size, stride, num_channels;
+        int err, r = HB_MC_FAIL;
+
+        hb_mc_emulation_get_default_params(&params);
+        params.dim_x = HOLES_DIM_X;
+        err = hb_mc_emulation_set_params(1, &params);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to configure a %d-wide machine: %s\n",
+                           __func__, HOLES_DIM_X, hb_mc_strerror(err));
+                return err;
+        }
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 1);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__, hb_mc_strerror(err));
+                return err;
+        }
+
+        err = default_eva_get_dram_interleave(mc, &stripe_size, &stride, &num_channels);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        bsg_pr_test_info("%s: %d-wide machine: %" PRIu32 " channels, pattern repeats every %" PRIu32 " bytes\n",
+                         __func__, HOLES_DIM_X, num_channels, stride);
+
+        if (num_channels >= stride / stripe_size) {
+                bsg_pr_err("%s: expected holes in a %" PRIu32 " byte pattern of %" PRIu32 " byte stripes\n",
+                           __func__, stride, stripe_size);
+                goto cleanup;
+        }
+
+        for (uint32_t slot = 0; slot < stride / stripe_size; slot++) {
+                hb_mc_eva_t eva = DRAM_BASE_EVA + slot * stripe_size;
+                hb_mc_idx_t channel;
+
+                err = default_eva_get_dram_channel(mc, &eva, &channel);
+                if ((err == HB_MC_SUCCESS) != (slot < num_channels)) {
+                        bsg_pr_err("%s: stripe %" PRIu32 " %s, but there are %" PRIu32 " channels\n",
+                                   __func__, slot, err == HB_MC_SUCCESS ? "translated" : "did not translate",
+                                   num_channels);
+                        goto cleanup;
+                }
+        }
+
+        r = HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+#endif
+
+int test_manycore_dram_interleave() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        uint32_t *write_data = NULL, *read_data = NULL;
+        uint32_t stripe_size, stride, num_channels;
+        double in_order_s, interleaved_s;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        write_data = (uint32_t *)malloc(BUFFER_SIZE);
+        read_data = (uint32_t *)malloc(BUFFER_SIZE);
+        if (write_data == NULL || read_data == NULL) {
+                bsg_pr_err("%s: failed to allocate host buffers\n", __func__);
+                goto cleanup;
+        }
+
+        err = default_eva_get_dram_interleave(mc, &stripe_size, &stride, &num_channels);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to get the DRAM interleave: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        bsg_pr_test_info("%s: %" PRIu32 " channels, %" PRIu32 " byte stripes\n",
+                         __func__, num_channels, stripe_size);
+
+        /*****************************************************************/
+        /* Transfers with partial stripes at the start and end, exactly  */
+        /* one block, and many blocks, in both request orders            */
+        /*****************************************************************/
+        const size_t block = stride;
+        const size_t offsets[] = { 0, 4, stripe_size - 4, block + stripe_size / 2 };
+        const size_t sizes[] = { block - 4, block, block + 4, 3 * block + stripe_size / 2, BUFFER_SIZE / 2 };
+
+        for (size_t o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++) {
+                for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+                        for (int interleaved = 0; interleaved <= 1; interleaved++) {
+                                if (check_transfer(mc, write_data, read_data, offsets[o],
+                                                   sizes[s], interleaved) != HB_MC_SUCCESS)
+                                        goto cleanup;
+                        }
+                }
+        }
+
+        /************************************************/
+        /* Compare in-order and interleaved read times  */
+        /************************************************/
+        if (time_read(mc, read_data, 0, &in_order_s) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (time_read(mc, read_data, 1, &interleaved_s) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        bsg_pr_test_info("%s: in-order reads:    %d bytes in %f s (%.0f bytes/s)\n",
+                         __func__, BUFFER_SIZE, in_order_s, BUFFER_SIZE / in_order_s);
+        bsg_pr_test_info("%s: interleaved reads: %d bytes in %f s (%.0f bytes/s)\n",
+                         __func__, BUFFER_SIZE, interleaved_s, BUFFER_SIZE / interleaved_s);
+
+#ifdef EMULATION
+        if (check_holes() != HB_MC_SUCCESS)
+                goto cleanup;
+#endif
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        free(write_data);
+        free(read_data);
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_dram_interleave();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_dram_interleave();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,193 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_eva.h>
+#include "test_manycore_eva_read_bandwidth.h"
+
+#define TEST_NAME "test_manycore_eva_read_bandwidth"
+
+#define MIN_COPY_SIZE (1 << 10)
+#define MAX_COPY_SIZE (64 << 20)
+#define DRAM_BASE_EVA 0x80000000
+
+/*
+ * Read an EVA range one NPA segment at a time, waiting for each segment's
+ * responses before requesting the next, as hb_mc_manycore_eva_read() did
+ * before reads were streamed.
+ */
+static int eva_read_by_segment(hb_mc_manycore_t *mc, const hb_mc_coordinate_t *tgt,
+                               hb_mc_eva_t eva, void *data, size_t sz)
+{
+        char *dst = (char *)data;
+        hb_mc_npa_t npa;
+        size_t npa_sz;
+        int err;
+
+        while (sz > 0) {
+                err = hb_mc_eva_to_npa(mc, &default_map, tgt, &eva, &npa, &npa_sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                npa_sz = npa_sz < sz ? npa_sz : sz;
+                err = hb_mc_manycore_read_mem(mc, &npa, dst, npa_sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                dst += npa_sz;
+                sz -= npa_sz;
+                eva += npa_sz;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int test_manycore_eva_read_bandwidth() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_coordinate_t tgt = hb_mc_coordinate(0, 0);
+        hb_mc_eva_t eva = DRAM_BASE_EVA;
+        uint32_t *write_data = NULL, *read_data = NULL;
+        struct timespec start, end;
+        double segment_s, stream_s;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        write_data = (uint32_t *)malloc(MAX_COPY_SIZE);
+        read_data = (uint32_t *)malloc(MAX_COPY_SIZE);
+        if (write_data == NULL || read_data == NULL) {
+                bsg_pr_err("%s: failed to allocate host buffers\n", __func__);
+                goto cleanup;
+        }
+
+        for (size_t i = 0; i < MAX_COPY_SIZE / sizeof(uint32_t); i++)
+                write_data[i] = rand();
+
+        err = hb_mc_manycore_eva_write(mc, &default_map, &tgt, &eva, write_data, MAX_COPY_SIZE);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to write %d bytes to DRAM: %s\n",
+                           __func__, MAX_COPY_SIZE, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /*****************************************************/
+        /* Read back 1 KB to 64 MB, per segment and streamed */
+        /*****************************************************/
+        for (size_t sz = MIN_COPY_SIZE; sz <= MAX_COPY_SIZE; sz *= 4) {
+                memset(read_data, 0, sz);
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                err = eva_read_by_segment(mc, &tgt, eva, read_data, sz);
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                segment_s = elapsed_s(&start, &end);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to read %zu bytes per segment: %s\n",
+                                   __func__, sz, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+
+                if (memcmp(read_data, write_data, sz) != 0) {
+                        bsg_pr_err("%s: per-segment read of %zu bytes returned the wrong data\n",
+                                   __func__, sz);
+                        goto cleanup;
+                }
+
+                memset(read_data, 0, sz);
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                err = hb_mc_manycore_eva_read(mc, &default_map, &tgt, &eva, read_data, sz);
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                stream_s = elapsed_s(&start, &end);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to read %zu bytes: %s\n",
+                                   __func__, sz, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+
+                if (memcmp(read_data, write_data, sz) != 0) {
+                        bsg_pr_err("%s: streamed read of %zu bytes returned the wrong data\n",
+                                   __func__, sz);
+                        goto cleanup;
+                }
+
+                bsg_pr_test_info("%s: %8zu KB: per segment %10.0f bytes/s, "
+                                 "streamed %10.0f bytes/s (%.2fx)\n",
+                                 __func__, sz >> 10, sz / segment_s, sz / stream_s,
+                                 segment_s / stream_s);
+        }
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        free(write_data);
+        free(read_data);
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_eva_read_bandwidth();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_eva_read_bandwidth();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,219 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_tile.h>
+#include "test_manycore_eva_runs.h"
+
+#define TEST_NAME "test_manycore_eva_runs"
+
+#define CHUNK_SIZE  64
+#define DATA_SIZE   1024
+#define DATA_WORDS  (DATA_SIZE / sizeof(uint32_t))
+
+/* translate with the default map, but never more than CHUNK_SIZE bytes at a time */
+static int chunked_eva_to_npa(hb_mc_manycore_t *mc, const void *priv,
+                              const hb_mc_coordinate_t *src, const hb_mc_eva_t *eva,
+                              hb_mc_npa_t *npa, size_t *sz)
+{
+        int err = default_map.eva_to_npa(mc, priv, src, eva, npa, sz);
+        if (err == HB_MC_SUCCESS && *sz > CHUNK_SIZE)
+                *sz = CHUNK_SIZE;
+        return err;
+}
+
+/* memset, write, and read back DATA_SIZE bytes at #eva; count the *_mem calls made */
+static int check_runs(hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                      const hb_mc_coordinate_t *tgt, hb_mc_eva_t eva,
+                      uint64_t *memsets, uint64_t *writes)
+{
+        uint32_t write_data[DATA_WORDS], read_data[DATA_WORDS];
+        hb_mc_manycore_stats_t stats;
+        int err;
+
+        for (size_t i = 0; i < DATA_WORDS; i++)
+                write_data[i] = rand();
+
+        err = hb_mc_manycore_reset_stats(mc);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = hb_mc_manycore_eva_memset(mc, map, tgt, &eva, 0x5a, DATA_SIZE);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to memset EVA 0x%08" PRIx32 ": %s\n",
+                           __func__, eva, hb_mc_strerror(err));
+                return err;
+        }
+
+        err = hb_mc_manycore_eva_read(mc, map, tgt, &eva, read_data, DATA_SIZE);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read EVA 0x%08" PRIx32 ": %s\n",
+                           __func__, eva, hb_mc_strerror(err));
+                return err;
+        }
+
+        for (size_t i = 0; i < DATA_WORDS; i++) {
+                if (read_data[i] != 0x5a5a5a5a) {
+                        bsg_pr_err("%s: memset mismatch @ index %zu: read 0x%08" PRIx32 "\n",
+                                   __func__, i, read_data[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        err = hb_mc_manycore_eva_write(mc, map, tgt, &eva, write_data, DATA_SIZE);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to write EVA 0x%08" PRIx32 ": %s\n",
+                           __func__, eva, hb_mc_strerror(err));
+                return err;
+        }
+
+        err = hb_mc_manycore_eva_read(mc, map, tgt, &eva, read_data, DATA_SIZE);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read EVA 0x%08" PRIx32 ": %s\n",
+                           __func__, eva, hb_mc_strerror(err));
+                return err;
+        }
+
+        for (size_t i = 0; i < DATA_WORDS; i++) {
+                if (read_data[i] != write_data[i]) {
+                        bsg_pr_err("%s: mismatch @ index %zu: "
+                                   "wrote 0x%08" PRIx32 " -- read 0x%08" PRIx32 "\n",
+                                   __func__, i, write_data[i], read_data[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        err = hb_mc_manycore_get_stats(mc, &stats);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        *memsets = stats.api_calls[HB_MC_MANYCORE_API_MEMSET];
+        *writes = stats.api_calls[HB_MC_MANYCORE_API_WRITE_MEM];
+        return HB_MC_SUCCESS;
+}
+
+int test_manycore_eva_runs() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_eva_map_t chunked_map;
+        hb_mc_coordinate_t origin;
+        uint32_t stripe_size, stride, num_channels;
+        uint64_t memsets, writes;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        origin = hb_mc_config_get_origin_vcore(hb_mc_manycore_get_config(mc));
+        chunked_map = default_map;
+        chunked_map.eva_to_npa = chunked_eva_to_npa;
+
+        /****************************************************************/
+        /* DMEM is contiguous, so the chunks merge into a single run    */
+        /****************************************************************/
+        if (check_runs(mc, &chunked_map, &origin, HB_MC_TILE_EVA_DMEM_BASE,
+                       &memsets, &writes) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        bsg_pr_test_info("%s: DMEM: %" PRIu64 " memset calls, %" PRIu64 " write calls\n",
+                         __func__, memsets, writes);
+        if (memsets != 1 || writes != 1) {
+                bsg_pr_err("%s: DMEM chunks were not merged into one run\n", __func__);
+                goto cleanup;
+        }
+
+        /*****************************************************************/
+        /* Consecutive DRAM stripes are on different channels and are    */
+        /* never merged                                                  */
+        /*****************************************************************/
+        err = default_eva_get_dram_interleave(mc, &stripe_size, &stride, &num_channels);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (check_runs(mc, &chunked_map, &origin, 0x80000000,
+                       &memsets, &writes) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        bsg_pr_test_info("%s: DRAM: %" PRIu64 " memset calls, %" PRIu64 " write calls\n",
+                         __func__, memsets, writes);
+        if (num_channels > 1 && stripe_size <= CHUNK_SIZE &&
+            (memsets != DATA_SIZE / stripe_size || writes != DATA_SIZE / stripe_size)) {
+                bsg_pr_err("%s: expected one call per %" PRIu32 " byte DRAM stripe\n",
+                           __func__, stripe_size);
+                goto cleanup;
+        }
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_eva_runs();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_eva_runs();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
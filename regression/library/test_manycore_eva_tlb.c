@@ -0,0 +1,262 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_origin_eva_map.h>
+#include <bsg_manycore_tile.h>
+#include "test_manycore_eva_tlb.h"
+
+#define TEST_NAME "test_manycore_eva_tlb"
+
+#define NUM_EVAS  128
+#define ROUNDS    4096
+
+static uint64_t map_calls;
+
+/* the origin map's translation, counting how often the map is called */
+static int counted_eva_to_npa(hb_mc_manycore_t *mc, const void *priv,
+                              const hb_mc_coordinate_t *src, const hb_mc_eva_t *eva,
+                              hb_mc_npa_t *npa, size_t *sz)
+{
+        map_calls++;
+        return default_eva_to_npa(mc, priv, src, eva, npa, sz);
+}
+
+/* translate every EVA and compare against #gold, if given; returns the time taken */
+static int translate_all(hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                         const hb_mc_coordinate_t *src, const hb_mc_eva_t *evas,
+                         hb_mc_npa_t *npas, size_t *szs,
+                         const hb_mc_npa_t *gold_npas, const size_t *gold_szs,
+                         int rounds, double *seconds)
+{
+        struct timespec start, end;
+        int err;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int round = 0; round < rounds; round++) {
+                for (size_t i = 0; i < NUM_EVAS; i++) {
+                        err = hb_mc_eva_to_npa(mc, map, src, &evas[i], &npas[i], &szs[i]);
+                        if (err != HB_MC_SUCCESS) {
+                                bsg_pr_err("%s: failed to translate EVA 0x%08" PRIx32 ": %s\n",
+                                           __func__, evas[i], hb_mc_strerror(err));
+                                return err;
+                        }
+                }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (seconds != NULL)
+                *seconds = elapsed_s(&start, &end);
+
+        if (gold_npas == NULL)
+                return HB_MC_SUCCESS;
+
+        for (size_t i = 0; i < NUM_EVAS; i++) {
+                if (hb_mc_npa_get_x(&npas[i]) != hb_mc_npa_get_x(&gold_npas[i]) ||
+                    hb_mc_npa_get_y(&npas[i]) != hb_mc_npa_get_y(&gold_npas[i]) ||
+                    hb_mc_npa_get_epa(&npas[i]) != hb_mc_npa_get_epa(&gold_npas[i]) ||
+                    szs[i] != gold_szs[i]) {
+                        bsg_pr_err("%s: EVA 0x%08" PRIx32 " translates differently through the TLB\n",
+                                   __func__, evas[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int test_manycore_eva_tlb() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_eva_map_t map;
+        hb_mc_coordinate_t origin, other;
+        hb_mc_eva_t evas[NUM_EVAS];
+        hb_mc_npa_t gold_npas[NUM_EVAS], npas[NUM_EVAS];
+        size_t gold_szs[NUM_EVAS], szs[NUM_EVAS];
+        hb_mc_eva_tlb_stats_t stats, prev;
+        double uncached_s, cached_s;
+        uint64_t uncached_calls, cached_calls;
+        int map_live = 0;
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        origin = hb_mc_config_get_origin_vcore(hb_mc_manycore_get_config(mc));
+        other = hb_mc_coordinate(hb_mc_coordinate_get_x(origin) + 1,
+                                 hb_mc_coordinate_get_y(origin));
+
+        err = hb_mc_origin_eva_map_init(&map, origin);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to initialize origin EVA map: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+        map_live = 1;
+        map.eva_to_npa = counted_eva_to_npa;
+
+        /* half DMEM words, half DRAM words */
+        for (size_t i = 0; i < NUM_EVAS / 2; i++) {
+                evas[i] = HB_MC_TILE_EVA_DMEM_BASE + i * sizeof(uint32_t);
+                evas[NUM_EVAS / 2 + i] = 0x80000000 + i * sizeof(uint32_t);
+        }
+
+        /*****************************************************/
+        /* Translate without the TLB to get the right NPAs   */
+        /*****************************************************/
+        map_calls = 0;
+        if (translate_all(mc, &map, &origin, evas, gold_npas, gold_szs,
+                          NULL, NULL, ROUNDS, &uncached_s) != HB_MC_SUCCESS)
+                goto cleanup;
+        uncached_calls = map_calls;
+
+        /*********************************************************/
+        /* The first round fills the TLB, later rounds only hit  */
+        /*********************************************************/
+        err = hb_mc_manycore_set_eva_tlb(mc, 1);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (translate_all(mc, &map, &origin, evas, npas, szs,
+                          gold_npas, gold_szs, 1, NULL) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (hb_mc_manycore_get_eva_tlb_stats(mc, &prev) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        map_calls = 0;
+        if (translate_all(mc, &map, &origin, evas, npas, szs,
+                          gold_npas, gold_szs, ROUNDS, &cached_s) != HB_MC_SUCCESS)
+                goto cleanup;
+        cached_calls = map_calls;
+
+        if (hb_mc_manycore_get_eva_tlb_stats(mc, &stats) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        bsg_pr_test_info("%s: first round: %" PRIu64 " hits, %" PRIu64 " misses\n",
+                         __func__, prev.hits, prev.misses);
+        if (prev.misses == 0 || stats.misses != prev.misses ||
+            stats.hits != prev.hits + (uint64_t)NUM_EVAS * ROUNDS) {
+                bsg_pr_err("%s: repeated translations missed the TLB "
+                           "(%" PRIu64 " hits, %" PRIu64 " misses)\n",
+                           __func__, stats.hits, stats.misses);
+                goto cleanup;
+        }
+
+        /*********************************************************/
+        /* Destroying the map drops its entries; a new map at    */
+        /* the same address must not see them                    */
+        /*********************************************************/
+        err = hb_mc_origin_eva_map_exit(&map);
+        map_live = 0;
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (hb_mc_manycore_get_eva_tlb_stats(mc, &stats) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (stats.invalidations == 0) {
+                bsg_pr_err("%s: destroying the map did not invalidate its entries\n", __func__);
+                goto cleanup;
+        }
+
+        err = hb_mc_origin_eva_map_init(&map, other);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+        map_live = 1;
+        map.eva_to_npa = counted_eva_to_npa;
+
+        err = hb_mc_manycore_set_eva_tlb(mc, 0);
+        if (err == HB_MC_SUCCESS)
+                err = translate_all(mc, &map, &other, evas, gold_npas, gold_szs,
+                                    NULL, NULL, 1, NULL);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_set_eva_tlb(mc, 1);
+        if (err == HB_MC_SUCCESS)
+                err = translate_all(mc, &map, &other, evas, npas, szs,
+                                    gold_npas, gold_szs, 2, NULL);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /******************/
+        /* Report results */
+        /******************/
+        bsg_pr_test_info("%s: %d invalidations\n", __func__, (int)stats.invalidations);
+        bsg_pr_test_info("%s: map:  %d translations in %f s, %" PRIu64 " map calls\n",
+                         __func__, NUM_EVAS * ROUNDS, uncached_s, uncached_calls);
+        bsg_pr_test_info("%s: TLB:  %d translations in %f s, %" PRIu64 " map calls\n",
+                         __func__, NUM_EVAS * ROUNDS, cached_s, cached_calls);
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        if (map_live && hb_mc_origin_eva_map_exit(&map) != HB_MC_SUCCESS)
+                r = HB_MC_FAIL;
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_eva_tlb();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_eva_tlb();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
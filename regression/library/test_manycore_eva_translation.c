@@ -0,0 +1,297 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_tile.h>
+#include "test_manycore_eva_translation.h"
+
+#define TEST_NAME "test_manycore_eva_translation"
+
+#define NUM_EVAS     4096
+#define ROUNDS       256
+
+/* translate every EVA ROUNDS times and return the time taken */
+static int time_translations(hb_mc_manycore_t *mc, const hb_mc_eva_t *evas,
+                             hb_mc_npa_t *npas, size_t *szs, double *seconds)
+{
+        hb_mc_coordinate_t src = hb_mc_coordinate(0, 0);
+        struct timespec start, end;
+        int err;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int round = 0; round < ROUNDS; round++) {
+                for (size_t i = 0; i < NUM_EVAS; i++) {
+                        err = hb_mc_eva_to_npa(mc, &default_map, &src, &evas[i], &npas[i], &szs[i]);
+                        if (err != HB_MC_SUCCESS) {
+                                bsg_pr_err("%s: failed to translate EVA 0x%08" PRIx32 ": %s\n",
+                                           __func__, evas[i], hb_mc_strerror(err));
+                                return err;
+                        }
+                }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        *seconds = elapsed_s(&start, &end);
+
+        return HB_MC_SUCCESS;
+}
+
+/* translate all EVAs with one batch call ROUNDS times and return the time taken */
+static int time_batch_translations(hb_mc_manycore_t *mc, const hb_mc_eva_t *evas,
+                                   hb_mc_npa_t *npas, size_t *szs, double *seconds)
+{
+        hb_mc_coordinate_t src = hb_mc_coordinate(0, 0);
+        struct timespec start, end;
+        int err;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int round = 0; round < ROUNDS; round++) {
+                err = hb_mc_eva_to_npa_batch(mc, &default_map, &src, evas, npas, szs, NUM_EVAS);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to translate EVAs: %s\n",
+                                   __func__, hb_mc_strerror(err));
+                        return err;
+                }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        *seconds = elapsed_s(&start, &end);
+
+        return HB_MC_SUCCESS;
+}
+
+/* compare a batch translation against one hb_mc_eva_to_npa() call per EVA */
+static int check_translations(hb_mc_manycore_t *mc, const hb_mc_coordinate_t *src,
+                              const hb_mc_eva_t *evas, const hb_mc_npa_t *npas,
+                              const size_t *szs, size_t count, const char *what)
+{
+        hb_mc_npa_t npa;
+        size_t sz;
+        int err;
+
+        for (size_t i = 0; i < count; i++) {
+                err = hb_mc_eva_to_npa(mc, &default_map, src, &evas[i], &npa, &sz);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to translate EVA 0x%08" PRIx32 ": %s\n",
+                                   __func__, evas[i], hb_mc_strerror(err));
+                        return err;
+                }
+
+                if (hb_mc_npa_get_x(&npa) != hb_mc_npa_get_x(&npas[i]) ||
+                    hb_mc_npa_get_y(&npa) != hb_mc_npa_get_y(&npas[i]) ||
+                    hb_mc_npa_get_epa(&npa) != hb_mc_npa_get_epa(&npas[i]) ||
+                    sz != szs[i]) {
+                        bsg_pr_err("%s: %s: EVA 0x%08" PRIx32 " translates differently\n",
+                                   __func__, what, evas[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* a map that is not default_map, so batch translation takes the generic path */
+static int wrapped_eva_to_npa(hb_mc_manycore_t *mc, const void *priv,
+                              const hb_mc_coordinate_t *src, const hb_mc_eva_t *eva,
+                              hb_mc_npa_t *npa, size_t *sz)
+{
+        return default_map.eva_to_npa(mc, priv, src, eva, npa, sz);
+}
+
+int test_manycore_eva_translation() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        static hb_mc_eva_t evas[NUM_EVAS];
+        static hb_mc_npa_t cached_npas[NUM_EVAS], computed_npas[NUM_EVAS];
+        static size_t cached_szs[NUM_EVAS], computed_szs[NUM_EVAS];
+        static hb_mc_eva_t mixed_evas[NUM_EVAS];
+        static hb_mc_npa_t batch_npas[NUM_EVAS];
+        static size_t batch_szs[NUM_EVAS];
+        hb_mc_eva_map_t wrapped_map;
+        hb_mc_coordinate_t src = hb_mc_coordinate(0, 0), origin;
+        uint32_t dmem_size;
+        double cached_s, computed_s, batch_s;
+        const size_t translations = (size_t)NUM_EVAS * ROUNDS;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        // random word addresses in the first half of DRAM
+        const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
+        uint32_t span = hb_mc_config_get_dram_size(config) / 2;
+        for (size_t i = 0; i < NUM_EVAS; i++)
+                evas[i] = 0x80000000 | ((rand() % span) & ~0x3);
+
+        /*****************************************/
+        /* Translate with the cached descriptor  */
+        /*****************************************/
+        if (time_translations(mc, evas, cached_npas, cached_szs, &cached_s) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /*****************************************************/
+        /* Translate with constants derived on every call,   */
+        /* as the default map did before they were cached    */
+        /*****************************************************/
+        mc->dram_eva.valid = 0;
+        err = time_translations(mc, evas, computed_npas, computed_szs, &computed_s);
+        default_eva_dram_desc_init(mc);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        for (size_t i = 0; i < NUM_EVAS; i++) {
+                if (hb_mc_npa_get_x(&cached_npas[i]) != hb_mc_npa_get_x(&computed_npas[i]) ||
+                    hb_mc_npa_get_y(&cached_npas[i]) != hb_mc_npa_get_y(&computed_npas[i]) ||
+                    hb_mc_npa_get_epa(&cached_npas[i]) != hb_mc_npa_get_epa(&computed_npas[i]) ||
+                    cached_szs[i] != computed_szs[i]) {
+                        bsg_pr_err("%s: EVA 0x%08" PRIx32 " translates differently with cached constants\n",
+                                   __func__, evas[i]);
+                        goto cleanup;
+                }
+        }
+
+        /**************************************/
+        /* Translate all EVAs in one call     */
+        /**************************************/
+        if (time_batch_translations(mc, evas, batch_npas, batch_szs, &batch_s) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (check_translations(mc, &src, evas, batch_npas, batch_szs, NUM_EVAS, "batch") != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /*****************************************************/
+        /* DRAM EVAs interleaved with tile-local DMEM EVAs   */
+        /*****************************************************/
+        origin = hb_mc_config_get_origin_vcore(config);
+        dmem_size = hb_mc_config_get_dmem_size(config);
+        for (size_t i = 0; i < NUM_EVAS; i++)
+                mixed_evas[i] = (rand() % 2) ? evas[i] :
+                        HB_MC_TILE_EVA_DMEM_BASE + ((rand() % dmem_size) & ~0x3);
+
+        err = hb_mc_eva_to_npa_batch(mc, &default_map, &origin, mixed_evas,
+                                     batch_npas, batch_szs, NUM_EVAS);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to translate mixed EVAs: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        if (check_translations(mc, &origin, mixed_evas, batch_npas, batch_szs, NUM_EVAS, "mixed") != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /*************************************/
+        /* Strided EVAs across DRAM stripes  */
+        /*************************************/
+        err = hb_mc_eva_to_npa_strided(mc, &default_map, &src, evas[0] & ~0xFFFF, 132,
+                                       batch_npas, batch_szs, NUM_EVAS);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to translate strided EVAs: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        for (size_t i = 0; i < NUM_EVAS; i++)
+                mixed_evas[i] = (evas[0] & ~0xFFFF) + i * 132;
+
+        if (check_translations(mc, &src, mixed_evas, batch_npas, batch_szs, NUM_EVAS, "strided") != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /*********************************************/
+        /* Maps other than default_map go per-EVA    */
+        /*********************************************/
+        wrapped_map = default_map;
+        wrapped_map.eva_to_npa = wrapped_eva_to_npa;
+        err = hb_mc_eva_to_npa_batch(mc, &wrapped_map, &src, evas,
+                                     batch_npas, batch_szs, NUM_EVAS);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to translate EVAs with a custom map: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        if (check_translations(mc, &src, evas, batch_npas, batch_szs, NUM_EVAS, "custom map") != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /******************/
+        /* Report results */
+        /******************/
+        bsg_pr_test_info("%s: derived constants: %zu translations in %f s (%.0f translations/s)\n",
+                         __func__, translations, computed_s, translations / computed_s);
+        bsg_pr_test_info("%s: cached constants:  %zu translations in %f s (%.0f translations/s)\n",
+                         __func__, translations, cached_s, translations / cached_s);
+        bsg_pr_test_info("%s: batch:             %zu translations in %f s (%.0f translations/s)\n",
+                         __func__, translations, batch_s, translations / batch_s);
+        bsg_pr_test_info("%s: speedup: %.2fx cached, %.2fx batch\n", __func__,
+                         computed_s / cached_s, computed_s / batch_s);
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_eva_translation();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_eva_translation();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
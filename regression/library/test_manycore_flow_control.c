@@ -0,0 +1,197 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_coordinate.h>
+#ifdef EMULATION
+#include <bsg_manycore_emulation.h>
+#endif
+#include "test_manycore_flow_control.h"
+
+#define TEST_NAME "test_manycore_flow_control"
+
+#define ARRAY_LEN  1024
+#define BASE_ADDR 0x0000
+
+#ifdef EMULATION
+/* FIFOs that hold two packets and fewer credits than the FIFO has slots for */
+#define FIFO_PACKETS 2
+#define HOST_CREDITS 3
+#define LATENCY_NS   20000
+#endif
+
+int test_manycore_flow_control() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_manycore_stats_t stats;
+        uint32_t write_data[ARRAY_LEN];
+        uint32_t read_data[ARRAY_LEN];
+
+        srand(time(0));
+
+#ifdef EMULATION
+        hb_mc_emulation_params_t params;
+
+        hb_mc_emulation_get_default_params(&params);
+        params.fifo_words = FIFO_PACKETS * sizeof(hb_mc_packet_t) / sizeof(uint32_t);
+        params.host_credits = HOST_CREDITS;
+        params.latency_ns = LATENCY_NS;
+
+        err = hb_mc_emulation_set_params(0, &params);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to configure emulation: %s\n",
+                           __func__, hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+#endif
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
+        hb_mc_npa_t base = { .x = 0, .y = hb_mc_config_get_dram_y(config), .epa = BASE_ADDR };
+
+        for (size_t i = 0; i < ARRAY_LEN; i++)
+                write_data[i] = rand();
+
+        err = hb_mc_manycore_reset_stats(mc);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to reset stats: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /**************************************************/
+        /* Stream many more packets than the FIFO can hold */
+        /**************************************************/
+        err = hb_mc_manycore_write_mem(mc, &base, write_data, sizeof(write_data));
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to write %zu bytes: %s\n",
+                           __func__, sizeof(write_data), hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /*****************************************************/
+        /* Read back with more loads than credits to hold them */
+        /*****************************************************/
+        err = hb_mc_manycore_read_mem(mc, &base, read_data, sizeof(read_data));
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read %zu bytes: %s\n",
+                           __func__, sizeof(read_data), hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        for (size_t i = 0; i < ARRAY_LEN; i++) {
+                if (read_data[i] != write_data[i]) {
+                        bsg_pr_err("%s: mismatch @ index %zu: "
+                                   "wrote 0x%08" PRIx32 " -- "
+                                   "read 0x%08" PRIx32 "\n",
+                                   __func__, i, write_data[i], read_data[i]);
+                        goto cleanup;
+                }
+        }
+
+        /******************************************/
+        /* Check the estimates were refreshed     */
+        /******************************************/
+        err = hb_mc_manycore_get_stats(mc, &stats);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to get stats: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        bsg_pr_test_info("%s: %" PRIu64 " requests, %" PRIu64 " vacancy polls, "
+                         "%" PRIu64 " TX-Complete spins, %" PRIu64 " load id stalls\n",
+                         __func__, stats.tx_packets[HB_MC_FIFO_TX_REQ], stats.vacancy_polls,
+                         stats.tc_spins, stats.load_id_stalls);
+
+        if (stats.tx_packets[HB_MC_FIFO_TX_REQ] < 2 * ARRAY_LEN) {
+                bsg_pr_err("%s: expected at least %d requests, counted %" PRIu64 "\n",
+                           __func__, 2 * ARRAY_LEN, stats.tx_packets[HB_MC_FIFO_TX_REQ]);
+                goto cleanup;
+        }
+
+#ifdef EMULATION
+        /*
+         * Every burst fills the FIFO, so the vacancy estimate must have been
+         * re-read from hardware to stream the rest.
+         */
+        if (stats.vacancy_polls < ARRAY_LEN / FIFO_PACKETS) {
+                bsg_pr_err("%s: FIFO vacancy re-read %" PRIu64 " times for %d packets, "
+                           "expected at least %d\n",
+                           __func__, stats.vacancy_polls, ARRAY_LEN,
+                           ARRAY_LEN / FIFO_PACKETS);
+                goto cleanup;
+        }
+#endif
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_flow_control();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_flow_control();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
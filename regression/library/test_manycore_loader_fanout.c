@@ -0,0 +1,215 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_tile.h>
+#ifdef EMULATION
+#include <bsg_manycore_emulation.h>
+#endif
+#include "test_manycore_loader_fanout.h"
+
+#define TEST_NAME "test_manycore_loader_fanout"
+
+#define IMAGE_SIZE 4096
+
+/*
+ * Load the same DMEM image into every tile, first one tile at a time and
+ * then with a single fan-out transfer, and check that every tile got it.
+ */
+static int load_mesh(hb_mc_manycore_id_t id)
+{
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_npa_t *targets = NULL;
+        uint32_t *image = NULL, *readback = NULL;
+        struct timespec start, end;
+        double per_tile_us, fanout_us;
+        hb_mc_transfer_t *xfer;
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, id);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_dimension_t dim = hb_mc_config_get_dimension_vcore(cfg);
+        hb_mc_coordinate_t origin = hb_mc_config_get_origin_vcore(cfg);
+        size_t ntiles = hb_mc_dimension_to_length(dim);
+        size_t sz = IMAGE_SIZE;
+
+        if (hb_mc_tile_get_size_dmem(mc, &origin) < sz)
+                sz = hb_mc_tile_get_size_dmem(mc, &origin);
+
+        targets = (hb_mc_npa_t *)malloc(ntiles * sizeof(*targets));
+        image = (uint32_t *)malloc(sz);
+        readback = (uint32_t *)malloc(sz);
+        if (targets == NULL || image == NULL || readback == NULL) {
+                bsg_pr_err("%s: failed to allocate host buffers\n", __func__);
+                goto cleanup;
+        }
+
+        for (size_t t = 0; t < ntiles; t++) {
+                hb_mc_coordinate_t tile = hb_mc_coordinate(hb_mc_coordinate_get_x(origin) + t % hb_mc_dimension_get_x(dim),
+                                                           hb_mc_coordinate_get_y(origin) + t / hb_mc_dimension_get_x(dim));
+                targets[t] = hb_mc_npa(tile, HB_MC_TILE_EPA_DMEM_BASE);
+        }
+
+        /******************************/
+        /* Load one tile at a time    */
+        /******************************/
+        for (size_t i = 0; i < sz / sizeof(uint32_t); i++)
+                image[i] = rand();
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t t = 0; t < ntiles; t++) {
+                err = hb_mc_manycore_write_mem(mc, &targets[t], image, sz);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to load tile %zu: %s\n",
+                                   __func__, t, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        per_tile_us = elapsed_us(&start, &end);
+
+        /******************************/
+        /* Load all tiles at once     */
+        /******************************/
+        for (size_t i = 0; i < sz / sizeof(uint32_t); i++)
+                image[i] = rand();
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        err = hb_mc_manycore_write_mem_fanout_async(mc, targets, ntiles, image, sz,
+                                                    NULL, NULL, &xfer);
+        if (err == HB_MC_SUCCESS)
+                err = hb_mc_manycore_transfer_wait(mc, xfer);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        fanout_us = elapsed_us(&start, &end);
+
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to fan out to %zu tiles: %s\n",
+                           __func__, ntiles, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        for (size_t t = 0; t < ntiles; t++) {
+                memset(readback, 0, sz);
+                err = hb_mc_manycore_read_mem(mc, &targets[t], readback, sz);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to read tile %zu: %s\n",
+                                   __func__, t, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+
+                if (memcmp(readback, image, sz) != 0) {
+                        bsg_pr_err("%s: tile %zu does not hold the fanned out image\n",
+                                   __func__, t);
+                        goto cleanup;
+                }
+        }
+
+        bsg_pr_test_info("%s: %2" PRIu32 "x%-2" PRIu32 " (%3zu tiles, %zu bytes each): "
+                         "per-tile %8.1f us, fan-out %8.1f us (%.2fx)\n",
+                         __func__,
+                         hb_mc_dimension_get_x(dim), hb_mc_dimension_get_y(dim),
+                         ntiles, sz, per_tile_us, fanout_us, per_tile_us / fanout_us);
+
+        r = HB_MC_SUCCESS;
+
+cleanup:
+        free(targets);
+        free(image);
+        free(readback);
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+int test_manycore_loader_fanout() {
+        srand(time(0));
+
+#ifdef EMULATION
+        /* the 4x4 through 4x32 machines under machines/ */
+        const hb_mc_idx_t widths[] = { 4, 8, 16, 32 };
+
+        for (hb_mc_manycore_id_t id = 0; id < sizeof(widths) / sizeof(widths[0]); id++) {
+                hb_mc_emulation_params_t params;
+                int err;
+
+                hb_mc_emulation_get_default_params(&params);
+                params.dim_x = widths[id];
+                params.dim_y = 4;
+
+                err = hb_mc_emulation_set_params(id, &params);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to configure a %ux4 machine: %s\n",
+                                   __func__, widths[id], hb_mc_strerror(err));
+                        return HB_MC_FAIL;
+                }
+
+                if (load_mesh(id) != HB_MC_SUCCESS)
+                        return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+#else
+        return load_mesh(0);
+#endif
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_loader_fanout();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_loader_fanout();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
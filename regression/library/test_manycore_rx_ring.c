@@ -0,0 +1,222 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_coordinate.h>
+#include <bsg_manycore_request_packet.h>
+#include <bsg_manycore_response_packet.h>
+#include "test_manycore_rx_ring.h"
+
+#define TEST_NAME "test_manycore_rx_ring"
+
+/* loads sent before any response is received: no more than the host's credits */
+#define BATCH      16
+/* enough batches to wrap the host-side receive ring more than once */
+#define ROUNDS     40
+#define ARRAY_LEN  (BATCH * ROUNDS)
+#define BASE_ADDR  0x0000
+/* time to let a batch of responses arrive in the response FIFO */
+#define SETTLE_US  1000
+
+/* send a batch of loads, tagging each one with its index in the batch */
+static int send_loads(hb_mc_manycore_t *mc, const hb_mc_npa_t *base, size_t first)
+{
+        hb_mc_coordinate_t host = hb_mc_manycore_get_host_coordinate(mc);
+        hb_mc_request_packet_t req;
+        int err;
+
+        for (uint32_t i = 0; i < BATCH; i++) {
+                hb_mc_request_packet_set_x_dst(&req, hb_mc_npa_get_x(base));
+                hb_mc_request_packet_set_y_dst(&req, hb_mc_npa_get_y(base));
+                hb_mc_request_packet_set_x_src(&req, hb_mc_coordinate_get_x(host));
+                hb_mc_request_packet_set_y_src(&req, hb_mc_coordinate_get_y(host));
+                hb_mc_request_packet_set_mask(&req, HB_MC_PACKET_REQUEST_MASK_WORD);
+                hb_mc_request_packet_set_op(&req, HB_MC_PACKET_OP_REMOTE_LOAD);
+                hb_mc_request_packet_set_epa(&req, hb_mc_npa_get_epa(base) + (first + i) * sizeof(uint32_t));
+                hb_mc_request_packet_set_data(&req, i);
+
+                err = hb_mc_manycore_request_tx(mc, &req, -1);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to send load %zu: %s\n",
+                                   __func__, first + i, hb_mc_strerror(err));
+                        return err;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* receive a batch of responses and check they arrive in order with the expected data */
+static int recv_loads(hb_mc_manycore_t *mc, const uint32_t *expected, size_t first)
+{
+        hb_mc_response_packet_t rsp;
+        int err;
+
+        for (uint32_t i = 0; i < BATCH; i++) {
+                err = hb_mc_manycore_response_rx(mc, &rsp, -1);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to receive response %zu: %s\n",
+                                   __func__, first + i, hb_mc_strerror(err));
+                        return err;
+                }
+
+                if (hb_mc_response_packet_get_load_id(&rsp) != i) {
+                        bsg_pr_err("%s: response %zu out of order: load id %" PRIu32 ", expected %" PRIu32 "\n",
+                                   __func__, first + i, hb_mc_response_packet_get_load_id(&rsp), i);
+                        return HB_MC_FAIL;
+                }
+
+                if (hb_mc_response_packet_get_data(&rsp) != expected[first + i]) {
+                        bsg_pr_err("%s: mismatch @ index %zu: "
+                                   "wrote 0x%08" PRIx32 " -- "
+                                   "read 0x%08" PRIx32 "\n",
+                                   __func__, first + i, expected[first + i],
+                                   hb_mc_response_packet_get_data(&rsp));
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int test_manycore_rx_ring() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_manycore_stats_t before, after;
+        uint32_t write_data[ARRAY_LEN];
+        uint64_t polls = 0, received = 0;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
+        hb_mc_npa_t base = { .x = 0, .y = hb_mc_config_get_dram_y(config), .epa = BASE_ADDR };
+
+        for (size_t i = 0; i < ARRAY_LEN; i++)
+                write_data[i] = rand();
+
+        err = hb_mc_manycore_write_mem(mc, &base, write_data, sizeof(write_data));
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to write %zu bytes: %s\n",
+                           __func__, sizeof(write_data), hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        /**************************************************/
+        /* Let each batch of responses queue up, then     */
+        /* receive them through the host-side ring        */
+        /**************************************************/
+        for (size_t first = 0; first < ARRAY_LEN; first += BATCH) {
+                if (send_loads(mc, &base, first) != HB_MC_SUCCESS)
+                        goto cleanup;
+
+                usleep(SETTLE_US);
+
+                err = hb_mc_manycore_get_stats(mc, &before);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to get stats: %s\n", __func__, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+
+                if (recv_loads(mc, write_data, first) != HB_MC_SUCCESS)
+                        goto cleanup;
+
+                err = hb_mc_manycore_get_stats(mc, &after);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to get stats: %s\n", __func__, hb_mc_strerror(err));
+                        goto cleanup;
+                }
+
+                polls += after.occupancy_polls - before.occupancy_polls;
+                received += after.rx_packets[HB_MC_FIFO_RX_RSP] - before.rx_packets[HB_MC_FIFO_RX_RSP];
+        }
+
+        bsg_pr_test_info("%s: %" PRIu64 " responses received with %" PRIu64 " occupancy reads\n",
+                         __func__, received, polls);
+
+        if (received != ARRAY_LEN) {
+                bsg_pr_err("%s: expected %d responses from the FIFO, counted %" PRIu64 "\n",
+                           __func__, ARRAY_LEN, received);
+                goto cleanup;
+        }
+
+        /* queued responses are pulled into the ring together, not one occupancy read each */
+        if (polls >= received) {
+                bsg_pr_err("%s: %" PRIu64 " occupancy reads for %" PRIu64 " responses\n",
+                           __func__, polls, received);
+                goto cleanup;
+        }
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_rx_ring();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_rx_ring();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
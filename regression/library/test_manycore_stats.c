@@ -0,0 +1,207 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_coordinate.h>
+#include "test_manycore_stats.h"
+
+#define TEST_NAME "test_manycore_stats"
+
+#define ARRAY_LEN  1024
+#define BASE_ADDR 0x0000
+
+static void print_stats(const hb_mc_manycore_stats_t *stats)
+{
+        bsg_pr_test_info("mmio reads:          %" PRIu64 "\n", stats->mmio_reads);
+        bsg_pr_test_info("mmio writes:         %" PRIu64 "\n", stats->mmio_writes);
+        bsg_pr_test_info("tx request packets:  %" PRIu64 "\n", stats->tx_packets[HB_MC_FIFO_TX_REQ]);
+        bsg_pr_test_info("rx response packets: %" PRIu64 "\n", stats->rx_packets[HB_MC_FIFO_RX_RSP]);
+        bsg_pr_test_info("bytes read:          %" PRIu64 "\n", stats->bytes_read);
+        bsg_pr_test_info("bytes written:       %" PRIu64 "\n", stats->bytes_written);
+        bsg_pr_test_info("tc spins:            %" PRIu64 "\n", stats->tc_spins);
+        bsg_pr_test_info("occupancy polls:     %" PRIu64 "\n", stats->occupancy_polls);
+        bsg_pr_test_info("vacancy polls:       %" PRIu64 "\n", stats->vacancy_polls);
+        bsg_pr_test_info("load id stalls:      %" PRIu64 "\n", stats->load_id_stalls);
+
+        for (int api = 0; api < HB_MC_MANYCORE_API_COUNT; api++) {
+                if (stats->api_calls[api] == 0)
+                        continue;
+
+                bsg_pr_test_info("%-24s %8" PRIu64 " calls %12" PRIu64 " ns\n",
+                                 hb_mc_manycore_api_to_string((hb_mc_manycore_api_t)api),
+                                 stats->api_calls[api], stats->api_ns[api]);
+        }
+}
+
+int test_manycore_stats() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        uint32_t write_data[ARRAY_LEN], read_data[ARRAY_LEN], v;
+        hb_mc_manycore_stats_t stats;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
+        hb_mc_npa_t base = { .x = 0, .y = hb_mc_config_get_dram_y(config), .epa = BASE_ADDR };
+
+        for (size_t i = 0; i < ARRAY_LEN; i++)
+                write_data[i] = rand();
+
+        err = hb_mc_manycore_reset_stats(mc);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /*******************************************/
+        /* Write and read back an array, then one  */
+        /* more word with the single-word API      */
+        /*******************************************/
+        err = hb_mc_manycore_write_mem(mc, &base, write_data, sizeof(write_data));
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to write to DRAM: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        err = hb_mc_manycore_read_mem(mc, &base, read_data, sizeof(read_data));
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read from DRAM: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        err = hb_mc_manycore_read32(mc, &base, &v);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read a word from DRAM: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        err = hb_mc_manycore_get_stats(mc, &stats);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        print_stats(&stats);
+
+        /*******************************************/
+        /* Every word moved must be accounted for  */
+        /*******************************************/
+        if (stats.bytes_written != sizeof(write_data) ||
+            stats.bytes_read != sizeof(read_data) + sizeof(v)) {
+                bsg_pr_err("%s: byte counters do not match the data transferred\n", __func__);
+                goto cleanup;
+        }
+
+        if (stats.tx_packets[HB_MC_FIFO_TX_REQ] != 2 * ARRAY_LEN + 1 ||
+            stats.rx_packets[HB_MC_FIFO_RX_RSP] != ARRAY_LEN + 1) {
+                bsg_pr_err("%s: packet counters do not match the requests sent\n", __func__);
+                goto cleanup;
+        }
+
+        if (stats.mmio_writes < 4 * stats.tx_packets[HB_MC_FIFO_TX_REQ] ||
+            stats.mmio_reads < 4 * stats.rx_packets[HB_MC_FIFO_RX_RSP]) {
+                bsg_pr_err("%s: MMIO counters are lower than the packets moved\n", __func__);
+                goto cleanup;
+        }
+
+        /*******************************************/
+        /* Time is charged to the outermost call   */
+        /*******************************************/
+        if (stats.api_calls[HB_MC_MANYCORE_API_WRITE_MEM] != 1 ||
+            stats.api_calls[HB_MC_MANYCORE_API_READ_MEM] != 1 ||
+            stats.api_calls[HB_MC_MANYCORE_API_READ] != 1 ||
+            stats.api_calls[HB_MC_MANYCORE_API_TRANSFER_SUBMIT] != 0 ||
+            stats.api_calls[HB_MC_MANYCORE_API_TRANSFER_WAIT] != 0 ||
+            stats.api_calls[HB_MC_MANYCORE_API_REQUEST_TX] != 0) {
+                bsg_pr_err("%s: nested API calls were counted\n", __func__);
+                goto cleanup;
+        }
+
+        /*******************************************/
+        /* Reset clears every counter              */
+        /*******************************************/
+        err = hb_mc_manycore_reset_stats(mc);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        err = hb_mc_manycore_get_stats(mc, &stats);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (stats.mmio_reads != 0 || stats.bytes_read != 0 ||
+            stats.api_calls[HB_MC_MANYCORE_API_READ_MEM] != 0) {
+                bsg_pr_err("%s: counters were not reset\n", __func__);
+                goto cleanup;
+        }
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_stats();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_stats();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,332 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#ifdef EMULATION
+#include <bsg_manycore_emulation.h>
+#endif
+#include "test_manycore_timeout.h"
+
+#define TEST_NAME "test_manycore_timeout"
+
+#define TIMEOUT_US 20000
+
+#ifdef EMULATION
+/* credits that do not come back until long after a wait should have timed out */
+#define STALL_CREDITS    4
+#define STALL_LATENCY_NS (50ull * TIMEOUT_US * 1000)
+#define STALL_WORDS      64
+
+/* timed waits must give up on requests that backpressure keeps on the host */
+static int test_manycore_timeout_backpressure() {
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_emulation_params_t params;
+        hb_mc_transfer_t *xfer;
+        hb_mc_npa_t npa;
+        uint32_t words[STALL_WORDS] = {0};
+        struct timespec start, end;
+        double elapsed_us;
+
+        hb_mc_emulation_get_default_params(&params);
+        params.host_credits = STALL_CREDITS;
+        params.latency_ns = STALL_LATENCY_NS;
+
+        err = hb_mc_emulation_set_params(1, &params);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to configure emulation: %s\n",
+                           __func__, hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 1);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__, hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        /* submit without waiting for credits, leaving most of the write pending */
+        err = hb_mc_manycore_set_transfer_timeout(mc, 0);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        npa = hb_mc_npa_from_x_y(0, hb_mc_config_get_dram_y(hb_mc_manycore_get_config(mc)), 0);
+        err = hb_mc_manycore_write_mem_async(mc, &npa, words, sizeof(words), NULL, NULL, &xfer);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to submit write: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        err = hb_mc_manycore_transfer_wait_timeout(mc, xfer, TIMEOUT_US);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+
+        if (err != HB_MC_TIMEOUT || elapsed_us > 10 * TIMEOUT_US) {
+                bsg_pr_err("%s: expected transfer_wait_timeout to time out in %d us, "
+                           "got %s after %.0f us\n",
+                           __func__, TIMEOUT_US, hb_mc_strerror(err), elapsed_us);
+                goto cleanup;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        err = hb_mc_manycore_transfer_wait_all_timeout(mc, TIMEOUT_US);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+
+        if (err != HB_MC_TIMEOUT || elapsed_us > 10 * TIMEOUT_US) {
+                bsg_pr_err("%s: expected transfer_wait_all_timeout to time out in %d us, "
+                           "got %s after %.0f us\n",
+                           __func__, TIMEOUT_US, hb_mc_strerror(err), elapsed_us);
+                goto cleanup;
+        }
+
+        /* a blocking write is bounded by the transfer timeout */
+        err = hb_mc_manycore_set_transfer_timeout(mc, TIMEOUT_US);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        err = hb_mc_manycore_write_mem(mc, &npa, words, sizeof(words));
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+
+        if (err != HB_MC_TIMEOUT || elapsed_us > 10 * TIMEOUT_US) {
+                bsg_pr_err("%s: expected write_mem to time out in %d us, "
+                           "got %s after %.0f us\n",
+                           __func__, TIMEOUT_US, hb_mc_strerror(err), elapsed_us);
+                goto cleanup;
+        }
+
+        /* give up on the stalled write, which releases it */
+        err = hb_mc_manycore_transfer_wait(mc, xfer);
+        if (err != HB_MC_TIMEOUT) {
+                bsg_pr_err("%s: expected transfer_wait to time out, got %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        r = HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+#endif
+
+int test_manycore_timeout() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        hb_mc_request_packet_t request;
+        hb_mc_backoff_policy_t policy, bad_policy;
+        hb_mc_backoff_stats_t stats;
+        hb_mc_transfer_t *xfer;
+        hb_mc_npa_t npa;
+        uint32_t word;
+        struct timespec start, end;
+        double elapsed_us;
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        /**********************************************/
+        /* An invalid backoff policy must be rejected */
+        /**********************************************/
+        err = hb_mc_manycore_get_backoff_policy(mc, &policy);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to get backoff policy: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        bad_policy = policy;
+        bad_policy.sleep_min_us = 0;
+        if (hb_mc_manycore_set_backoff_policy(mc, &bad_policy) != HB_MC_INVALID) {
+                bsg_pr_err("%s: accepted a zero minimum sleep\n", __func__);
+                goto cleanup;
+        }
+
+        /*******************************************************/
+        /* Use a short schedule so that every phase is visited */
+        /*******************************************************/
+        policy.spin_iterations = 10;
+        policy.yield_iterations = 10;
+        policy.sleep_min_us = 1;
+        policy.sleep_max_us = 1000;
+        err = hb_mc_manycore_set_backoff_policy(mc, &policy);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to set backoff policy: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        err = hb_mc_manycore_reset_backoff_stats(mc);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /*************************************************************/
+        /* Nothing sends requests to the host, so a receive must time */
+        /* out after roughly TIMEOUT_US.                               */
+        /*************************************************************/
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        err = hb_mc_manycore_request_rx(mc, &request, TIMEOUT_US);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+
+        if (err != HB_MC_TIMEOUT) {
+                bsg_pr_err("%s: expected request_rx to time out, got: %s\n",
+                           __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        if (elapsed_us < TIMEOUT_US) {
+                bsg_pr_err("%s: request_rx returned after %.0f us, before its %d us timeout\n",
+                           __func__, elapsed_us, TIMEOUT_US);
+                goto cleanup;
+        }
+
+        err = hb_mc_manycore_get_backoff_stats(mc, &stats);
+        if (err != HB_MC_SUCCESS)
+                goto cleanup;
+
+        bsg_pr_test_info("%s: timed out after %.0f us\n", __func__, elapsed_us);
+        bsg_pr_test_info("%s: spin:  %" PRIu64 " polls, %" PRIu64 " ns\n", __func__,
+                         stats.polls[HB_MC_BACKOFF_SPIN], stats.ns[HB_MC_BACKOFF_SPIN]);
+        bsg_pr_test_info("%s: yield: %" PRIu64 " polls, %" PRIu64 " ns\n", __func__,
+                         stats.polls[HB_MC_BACKOFF_YIELD], stats.ns[HB_MC_BACKOFF_YIELD]);
+        bsg_pr_test_info("%s: sleep: %" PRIu64 " polls, %" PRIu64 " ns\n", __func__,
+                         stats.polls[HB_MC_BACKOFF_SLEEP], stats.ns[HB_MC_BACKOFF_SLEEP]);
+
+        if (stats.timeouts != 1 ||
+            stats.polls[HB_MC_BACKOFF_SPIN] != policy.spin_iterations ||
+            stats.polls[HB_MC_BACKOFF_YIELD] != policy.yield_iterations ||
+            stats.polls[HB_MC_BACKOFF_SLEEP] == 0) {
+                bsg_pr_err("%s: unexpected backoff statistics (%" PRIu64 " timeouts)\n",
+                           __func__, stats.timeouts);
+                goto cleanup;
+        }
+
+        /*******************************************************/
+        /* A zero timeout polls once; a negative one is invalid */
+        /*******************************************************/
+        if (hb_mc_manycore_request_rx(mc, &request, 0) != HB_MC_TIMEOUT) {
+                bsg_pr_err("%s: expected a zero timeout to time out\n", __func__);
+                goto cleanup;
+        }
+
+        if (hb_mc_manycore_request_rx(mc, &request, -2) != HB_MC_INVALID) {
+                bsg_pr_err("%s: accepted a timeout of -2\n", __func__);
+                goto cleanup;
+        }
+
+        /*********************************************************/
+        /* Transfer waits honour a timeout too: a DRAM read must */
+        /* complete well within TIMEOUT_US.                      */
+        /*********************************************************/
+        npa = hb_mc_npa_from_x_y(0, hb_mc_config_get_dram_y(hb_mc_manycore_get_config(mc)), 0);
+        err = hb_mc_manycore_read_mem_async(mc, &npa, &word, sizeof(word), NULL, NULL, &xfer);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to submit read: %s\n", __func__, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        err = hb_mc_manycore_transfer_wait_timeout(mc, xfer, TIMEOUT_US);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: read did not complete within %d us: %s\n",
+                           __func__, TIMEOUT_US, hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        if (hb_mc_manycore_transfer_wait_all_timeout(mc, 0) != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: wait_all timed out with nothing outstanding\n", __func__);
+                goto cleanup;
+        }
+
+        if (hb_mc_manycore_transfer_wait_all_timeout(mc, -2) != HB_MC_INVALID) {
+                bsg_pr_err("%s: wait_all accepted a timeout of -2\n", __func__);
+                goto cleanup;
+        }
+
+        if (hb_mc_manycore_set_transfer_timeout(mc, -2) != HB_MC_INVALID) {
+                bsg_pr_err("%s: accepted a transfer timeout of -2\n", __func__);
+                goto cleanup;
+        }
+
+#ifdef EMULATION
+        if (test_manycore_timeout_backpressure() != HB_MC_SUCCESS)
+                goto cleanup;
+#endif
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_timeout();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_timeout();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
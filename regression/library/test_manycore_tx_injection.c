@@ -0,0 +1,178 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <inttypes.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_coordinate.h>
+#include "test_manycore_tx_injection.h"
+
+#define TEST_NAME "test_manycore_tx_injection"
+
+#define ARRAY_LEN  4096
+#define ROUNDS     8
+#define BASE_ADDR 0x0000
+
+/* read back ARRAY_LEN words from DRAM and compare them against expected */
+static int check_dram(hb_mc_manycore_t *mc, const hb_mc_npa_t *base,
+                      const uint32_t *expected, const char *what)
+{
+        uint32_t read_data[ARRAY_LEN];
+        int err;
+
+        err = hb_mc_manycore_read_mem(mc, base, read_data, sizeof(read_data));
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read back %s data: %s\n",
+                           __func__, what, hb_mc_strerror(err));
+                return err;
+        }
+
+        for (size_t i = 0; i < ARRAY_LEN; i++) {
+                if (read_data[i] != expected[i]) {
+                        bsg_pr_err("%s: %s mismatch @ index %zu: "
+                                   "wrote 0x%08" PRIx32 " -- "
+                                   "read 0x%08" PRIx32 "\n",
+                                   __func__, what, i, expected[i], read_data[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+/* write ARRAY_LEN words to DRAM ROUNDS times with an injection mode and return the time taken */
+static int time_writes(hb_mc_manycore_t *mc, const hb_mc_npa_t *base,
+                       hb_mc_tx_injection_t mode, const char *what, double *seconds)
+{
+        uint32_t write_data[ARRAY_LEN];
+        struct timespec start, end;
+        int err;
+
+        err = hb_mc_manycore_set_tx_injection(mc, mode);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to select %s injection: %s\n",
+                           __func__, what, hb_mc_strerror(err));
+                return err;
+        }
+
+        for (size_t i = 0; i < ARRAY_LEN; i++)
+                write_data[i] = rand();
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int round = 0; round < ROUNDS; round++) {
+                err = hb_mc_manycore_write_mem(mc, base, write_data, sizeof(write_data));
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to write %zu bytes with %s injection: %s\n",
+                                   __func__, sizeof(write_data), what, hb_mc_strerror(err));
+                        return err;
+                }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        *seconds = elapsed_s(&start, &end);
+
+        return check_dram(mc, base, write_data, what);
+}
+
+int test_manycore_tx_injection() {
+        /********/
+        /* INIT */
+        /********/
+        int err, r = HB_MC_FAIL;
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        double scalar_s, burst_s;
+        const size_t packets = (size_t)ARRAY_LEN * ROUNDS;
+
+        srand(time(0));
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to intialize manycore: %s\n",
+                           __func__,
+                           hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
+        hb_mc_npa_t base = { .x = 0, .y = hb_mc_config_get_dram_y(config), .epa = BASE_ADDR };
+
+        /**********************************/
+        /* Inject packets word by word    */
+        /**********************************/
+        if (time_writes(mc, &base, HB_MC_TX_INJECTION_SCALAR, "scalar", &scalar_s) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /**********************************/
+        /* Inject packets a burst at once */
+        /**********************************/
+        if (time_writes(mc, &base, HB_MC_TX_INJECTION_BURST, "burst", &burst_s) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /******************/
+        /* Report results */
+        /******************/
+        bsg_pr_test_info("%s: scalar injection: %zu packets in %f s (%.0f packets/s)\n",
+                         __func__, packets, scalar_s, packets / scalar_s);
+        bsg_pr_test_info("%s: burst injection:  %zu packets in %f s (%.0f packets/s)\n",
+                         __func__, packets, burst_s, packets / burst_s);
+        bsg_pr_test_info("%s: burst speedup: %.2fx\n", __func__, scalar_s / burst_s);
+
+        r = HB_MC_SUCCESS;
+
+        /********/
+        /* EXIT */
+        /********/
+cleanup:
+        hb_mc_manycore_exit(mc);
+        return r;
+}
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info(TEST_NAME " Regression Test (COSIMULATION)\n");
+        int rc = test_manycore_tx_injection();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info(TEST_NAME " Regression Test (F1)\n");
+        int rc = test_manycore_tx_injection();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -0,0 +1,352 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <cstring>
+#include <inttypes.h>
+#include "test_memory_manager.hpp"
+
+#define DRAM_START   0x80000000ull
+#define DRAM_SIZE    0x80000000ull
+#define ALIGNMENT    32
+
+#define CHECK_OPS    20000
+#define BENCH_LIVE   4096
+#define BENCH_OPS    40000
+
+typedef std::map<uint64_t, uint64_t> shadow_t; // address -> padded size
+
+static uint64_t padded(uint64_t size)
+{
+        if (size == 0)
+                size = ALIGNMENT;
+        return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+/*
+  The first-fit list allocator MemoryManager replaced, kept here only as the
+  baseline for bench(). Free and busy blocks live in lists, so alloc() and
+  free() are linear in the number of blocks.
+*/
+class ListMemoryManager {
+        typedef std::list<std::pair<uint64_t, uint64_t> > PairList;
+
+        std::mutex mMemManagerMutex;
+        PairList mFreeBufferList;
+        PairList mBusyBufferList;
+        const uint64_t mAlignment;
+
+public:
+        static const uint64_t mNull = 0xffffffffffffffffull;
+
+        ListMemoryManager(uint64_t size, uint64_t start, unsigned alignment) : mAlignment(alignment) {
+                mFreeBufferList.push_back(std::make_pair(start, size));
+        }
+
+        uint64_t alloc(size_t size) {
+                if (size == 0)
+                        size = mAlignment;
+                size = (size + mAlignment - 1) / mAlignment * mAlignment;
+
+                std::lock_guard<std::mutex> lock(mMemManagerMutex);
+                for (PairList::iterator i = mFreeBufferList.begin(); i != mFreeBufferList.end(); ++i) {
+                        if (i->second < size)
+                                continue;
+                        uint64_t result = i->first;
+                        if (i->second > size) {
+                                i->first += size;
+                                i->second -= size;
+                        } else {
+                                mFreeBufferList.erase(i);
+                        }
+                        mBusyBufferList.push_back(std::make_pair(result, size));
+                        return result;
+                }
+                return mNull;
+        }
+
+        void free(uint64_t buf) {
+                std::lock_guard<std::mutex> lock(mMemManagerMutex);
+                PairList::iterator i = mBusyBufferList.begin();
+                while (i != mBusyBufferList.end() && i->first != buf)
+                        ++i;
+                if (i == mBusyBufferList.end())
+                        return;
+                mFreeBufferList.push_back(*i);
+                mBusyBufferList.erase(i);
+                if (mFreeBufferList.size() > 4)
+                        coalesce();
+        }
+
+private:
+        // sort the free blocks and merge the ones that touch
+        void coalesce() {
+                mFreeBufferList.sort();
+                PairList::iterator curr = mFreeBufferList.begin();
+                PairList::iterator next = std::next(curr);
+                while (next != mFreeBufferList.end()) {
+                        if (curr->first + curr->second != next->first) {
+                                curr = next++;
+                                continue;
+                        }
+                        curr->second += next->second;
+                        next = mFreeBufferList.erase(next);
+                }
+        }
+};
+
+/* check a new allocation against the allocations that are already live */
+static int check_alloc(const shadow_t &live, uint64_t addr, uint64_t size)
+{
+        if (addr % ALIGNMENT != 0 || addr < DRAM_START || addr + size > DRAM_START + DRAM_SIZE) {
+                bsg_pr_err("%s: bad block 0x%" PRIx64 " (+%" PRIu64 ")\n", __func__, addr, size);
+                return HB_MC_FAIL;
+        }
+
+        auto next = live.lower_bound(addr);
+        if (next != live.end() && next->first < addr + size) {
+                bsg_pr_err("%s: block 0x%" PRIx64 " overlaps 0x%" PRIx64 "\n",
+                           __func__, addr, next->first);
+                return HB_MC_FAIL;
+        }
+
+        if (next != live.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second > addr) {
+                        bsg_pr_err("%s: block 0x%" PRIx64 " overlaps 0x%" PRIx64 "\n",
+                                   __func__, addr, prev->first);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* random allocs, placed allocs, frees and reserves checked against a shadow copy */
+static int test_correctness(void)
+{
+        awsbwhal::MemoryManager mm(DRAM_SIZE, DRAM_START, ALIGNMENT);
+        shadow_t live;
+        uint64_t used = 0;
+
+        // reserve a block in the middle first
+        uint64_t reserved = DRAM_START + DRAM_SIZE / 2 + ALIGNMENT;
+        if (!mm.reserve(reserved, 1000) || mm.reserve(reserved + ALIGNMENT, 10)) {
+                bsg_pr_err("%s: reserve failed\n", __func__);
+                return HB_MC_FAIL;
+        }
+        live[reserved] = padded(1000);
+        used += padded(1000);
+
+        for (int op = 0; op < CHECK_OPS; op++) {
+                if (!live.empty() && rand() % 3 == 0) {
+                        auto victim = live.begin();
+                        std::advance(victim, rand() % live.size());
+                        mm.free(victim->first);
+                        used -= victim->second;
+                        live.erase(victim);
+                } else {
+                        // every fourth block is placed at an offset modulo 4KB
+                        uint64_t size = rand() % (1 << (rand() % 20));
+                        uint64_t offset = (rand() % (4096 / ALIGNMENT)) * ALIGNMENT;
+                        bool placed = rand() % 4 == 0;
+                        uint64_t addr = placed ? mm.allocAligned(size, 4096, offset) : mm.alloc(size);
+                        if (addr == awsbwhal::MemoryManager::mNull) {
+                                bsg_pr_err("%s: alloc of %" PRIu64 " bytes failed\n", __func__, size);
+                                return HB_MC_FAIL;
+                        }
+                        if (check_alloc(live, addr, padded(size)) != HB_MC_SUCCESS)
+                                return HB_MC_FAIL;
+                        if (placed && addr % 4096 != offset) {
+                                bsg_pr_err("%s: block 0x%" PRIx64 " is not at offset 0x%" PRIx64 "\n",
+                                           __func__, addr, offset);
+                                return HB_MC_FAIL;
+                        }
+                        if (mm.lookup(addr).second != padded(size)) {
+                                bsg_pr_err("%s: lookup of 0x%" PRIx64 " returned the wrong size\n",
+                                           __func__, addr);
+                                return HB_MC_FAIL;
+                        }
+                        live[addr] = padded(size);
+                        used += padded(size);
+                }
+
+                if (mm.freeSize() != DRAM_SIZE - used) {
+                        bsg_pr_err("%s: free size is %" PRIu64 ", expected %" PRIu64 "\n",
+                                   __func__, mm.freeSize(), DRAM_SIZE - used);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        // once everything is freed, the free blocks must merge back into one
+        for (auto &block : live)
+                mm.free(block.first);
+
+        if (mm.alloc(DRAM_SIZE) != DRAM_START) {
+                bsg_pr_err("%s: free blocks did not coalesce\n", __func__);
+                return HB_MC_FAIL;
+        }
+
+        mm.reset();
+        if (mm.freeSize() != DRAM_SIZE || mm.alloc(DRAM_SIZE) != DRAM_START) {
+                bsg_pr_err("%s: reset did not restore the whole region\n", __func__);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* counters, fragmentation and tags reported by getStats() and liveBuffers() */
+static int test_stats(void)
+{
+        awsbwhal::MemoryManager mm(DRAM_SIZE, DRAM_START, ALIGNMENT);
+        awsbwhal::MemoryManager::Stats stats;
+        uint64_t block[8];
+
+        // free every other block; the last merges with the tail, leaving three 1KB holes
+        for (int i = 0; i < 8; i++)
+                block[i] = mm.alloc(1024, i % 2 ? "odd" : "even");
+        for (int i = 1; i < 8; i += 2)
+                mm.free(block[i]);
+
+        if (mm.alloc(DRAM_SIZE) != awsbwhal::MemoryManager::mNull) {
+                bsg_pr_err("%s: oversized alloc succeeded\n", __func__);
+                return HB_MC_FAIL;
+        }
+
+        mm.getStats(stats);
+        if (stats.freeSize != DRAM_SIZE - 4 * 1024 || stats.peakUsed != 8 * 1024 ||
+            stats.largestFree != DRAM_SIZE - 7 * 1024 || stats.freeBlocks != 4 ||
+            stats.freeHistogram[10] != 3 || stats.liveBuffers != 4 ||
+            stats.allocs != 8 || stats.failedAllocs != 1 || stats.frees != 4) {
+                bsg_pr_err("%s: wrong stats: free %" PRIu64 ", peak %" PRIu64 ", largest %" PRIu64
+                           ", %" PRIu64 " free blocks, %" PRIu64 " live, %" PRIu64 " allocs, %" PRIu64
+                           " failed, %" PRIu64 " frees\n", __func__,
+                           stats.freeSize, stats.peakUsed, stats.largestFree, stats.freeBlocks,
+                           stats.liveBuffers, stats.allocs, stats.failedAllocs, stats.frees);
+                return HB_MC_FAIL;
+        }
+
+        std::vector<awsbwhal::MemoryManager::Buffer> buffers = mm.liveBuffers();
+        for (int i = 0; i < 4; i++) {
+                if (buffers[i].base != block[2 * i] || buffers[i].size != 1024 ||
+                    strcmp(buffers[i].tag, "even") != 0) {
+                        bsg_pr_err("%s: live buffer %d is wrong\n", __func__, i);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/* many live buffers with random frees and allocs, as a tensor workload makes */
+template <typename Manager>
+static int bench(const char *name, double *seconds)
+{
+        Manager mm(DRAM_SIZE, DRAM_START, ALIGNMENT);
+        std::vector<uint64_t> live;
+        struct timespec start, end;
+
+        srand(1);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        for (int i = 0; i < BENCH_LIVE + BENCH_OPS; i++) {
+                if (i >= BENCH_LIVE && rand() % 2) {
+                        size_t victim = rand() % live.size();
+                        mm.free(live[victim]);
+                        live[victim] = live.back();
+                        live.pop_back();
+                } else {
+                        uint64_t addr = mm.alloc(64 + rand() % (64 << 10));
+                        if (addr == Manager::mNull) {
+                                bsg_pr_err("%s: %s ran out of memory\n", __func__, name);
+                                return HB_MC_FAIL;
+                        }
+                        live.push_back(addr);
+                }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        *seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        bsg_pr_test_info("%-18s %d operations in %.3f s (%.0f ops/s)\n",
+                         name, BENCH_LIVE + BENCH_OPS, *seconds,
+                         (BENCH_LIVE + BENCH_OPS) / *seconds);
+        return HB_MC_SUCCESS;
+}
+
+int test_memory_manager() {
+        double list_seconds, tree_seconds;
+
+        srand(time(0));
+        if (test_correctness() != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        if (test_stats() != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        if (bench<ListMemoryManager>("ListMemoryManager", &list_seconds) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        if (bench<awsbwhal::MemoryManager>("MemoryManager", &tree_seconds) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        bsg_pr_test_info("MemoryManager speedup: %.1fx\n", list_seconds / tree_seconds);
+        return HB_MC_SUCCESS;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_memory_manager Regression Test (COSIMULATION)\n");
+        int rc = test_memory_manager();
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_memory_manager Regression Test (F1)\n");
+        int rc = test_memory_manager();
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif
@@ -34,7 +34,11 @@ SPMD_SRC_PATH = $(BSG_MANYCORE_DIR)/software/spmd
 
 .PHONY: test_%.clean $(USER_RULES)
 
-$(USER_RULES): test_%.rule: $(SPMD_SRC_PATH)/%/main.riscv
+# Tests that share another test's program
+SHARED_PROGRAM_RULES = test_symbol_to_eva_file.rule
+$(SHARED_PROGRAM_RULES): $(SPMD_SRC_PATH)/symbol_to_eva/main.riscv
+
+$(filter-out $(SHARED_PROGRAM_RULES),$(USER_RULES)): test_%.rule: $(SPMD_SRC_PATH)/%/main.riscv
 
 $(USER_CLEAN_RULES): 
 	CL_DIR=$(CL_DIR) \
@@ -0,0 +1,202 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include "test_symbol_to_eva_file.h"
+
+#define SYMBOL "_start"
+#define LOOKUPS 1000
+
+/* Write a buffer to a new file, then rename it over #path, like a linker would */
+static int replace_file(const char *path, const void *data, size_t size)
+{
+        char tmp[PATH_MAX];
+        FILE *f;
+        int ok;
+
+        snprintf(tmp, sizeof(tmp), "%s.new", path);
+        if (!(f = fopen(tmp, "wb"))) {
+                bsg_pr_err("failed to create '%s': %m\n", tmp);
+                return HB_MC_FAIL;
+        }
+
+        ok = fwrite(data, size, 1, f) == 1;
+        ok = fclose(f) == 0 && ok;
+        if (!ok || rename(tmp, path) != 0) {
+                bsg_pr_err("failed to write '%s': %m\n", path);
+                unlink(tmp);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int test_symbol_to_eva_file (int argc, char **argv) {
+        unsigned char *program_data, *garbage = NULL;
+        size_t program_size;
+        hb_mc_eva_t expect, eva;
+        char copy[] = "/tmp/test_symbol_to_eva_file.XXXXXX";
+        int err, r = HB_MC_FAIL, fd;
+        char *bin_path;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+
+        err = hb_mc_loader_read_program_file(bin_path, &program_data, &program_size);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to read '%s': %s\n", bin_path, hb_mc_strerror(err));
+                return err;
+        }
+
+        /* the buffer API is the reference for the file API */
+        err = hb_mc_loader_symbol_to_eva(program_data, program_size, SYMBOL, &expect);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("failed to find '%s' in '%s'\n", SYMBOL, bin_path);
+                goto cleanup;
+        }
+
+        /*****************************************************************************************************************
+        * Repeated lookups in the same file return the same EVA.
+        ******************************************************************************************************************/
+        for (int i = 0; i < LOOKUPS; i++) {
+                err = symbol_to_eva(bin_path, SYMBOL, &eva);
+                if (err != HB_MC_SUCCESS || eva != expect) {
+                        bsg_pr_err("lookup %d of '%s' returned %s, 0x%08" PRIx32 "; "
+                                   "expected 0x%08" PRIx32 "\n",
+                                   i, SYMBOL, hb_mc_strerror(err), eva, expect);
+                        goto cleanup;
+                }
+        }
+
+        /*****************************************************************************************************************
+        * A symbol that is not in the binary is not found.
+        ******************************************************************************************************************/
+        err = symbol_to_eva(bin_path, "@two-wild^and*crazy(guys?", &eva);
+        if (err != HB_MC_NOTFOUND) {
+                bsg_pr_err("missing symbol returned %s, expected %s\n",
+                           hb_mc_strerror(err), hb_mc_strerror(HB_MC_NOTFOUND));
+                goto cleanup;
+        }
+
+        /*****************************************************************************************************************
+        * A missing file is an error, not an exit.
+        ******************************************************************************************************************/
+        err = symbol_to_eva("/nonexistent/test_symbol_to_eva_file.riscv", SYMBOL, &eva);
+        if (err != HB_MC_FAIL) {
+                bsg_pr_err("missing file returned %s, expected %s\n",
+                           hb_mc_strerror(err), hb_mc_strerror(HB_MC_FAIL));
+                goto cleanup;
+        }
+
+        /*****************************************************************************************************************
+        * A file that is rebuilt in place is indexed again.
+        ******************************************************************************************************************/
+        if ((fd = mkstemp(copy)) < 0) {
+                bsg_pr_err("failed to create a copy of '%s': %m\n", bin_path);
+                goto cleanup;
+        }
+        close(fd);
+
+        if (replace_file(copy, program_data, program_size) != HB_MC_SUCCESS)
+                goto cleanup_copy;
+
+        err = symbol_to_eva(copy, SYMBOL, &eva);
+        if (err != HB_MC_SUCCESS || eva != expect) {
+                bsg_pr_err("lookup in a copy returned %s\n", hb_mc_strerror(err));
+                goto cleanup_copy;
+        }
+
+        /* a rebuild that is no longer a valid binary must not hit the stale index */
+        garbage = (unsigned char *) calloc(1, program_size);
+        if (!garbage || replace_file(copy, garbage, program_size) != HB_MC_SUCCESS)
+                goto cleanup_copy;
+
+        err = symbol_to_eva(copy, SYMBOL, &eva);
+        if (err == HB_MC_SUCCESS) {
+                bsg_pr_err("lookup in a rebuilt file returned a stale EVA\n");
+                goto cleanup_copy;
+        }
+
+        /* and rebuilding it again makes it usable again */
+        if (replace_file(copy, program_data, program_size) != HB_MC_SUCCESS)
+                goto cleanup_copy;
+
+        err = symbol_to_eva(copy, SYMBOL, &eva);
+        if (err != HB_MC_SUCCESS || eva != expect) {
+                bsg_pr_err("lookup in a restored file returned %s\n", hb_mc_strerror(err));
+                goto cleanup_copy;
+        }
+
+        r = HB_MC_SUCCESS;
+
+cleanup_copy:
+        unlink(copy);
+cleanup:
+        free(garbage);
+        free(program_data);
+        return r;
+}
+
+#ifdef COSIM
+void cosim_main(uint32_t *exit_code, char * args) {
+        // We aren't passed command line arguments directly so we parse them
+        // from *args. args is a string from VCS - to pass a string of arguments
+        // to args, pass c_args to VCS as follows: +c_args="<space separated
+        // list of args>"
+        int argc = get_argc(args);
+        char *argv[argc];
+        get_argv(args, argc, argv);
+
+#ifdef VCS
+        svScope scope;
+        scope = svGetScopeFromName("tb");
+        svSetScope(scope);
+#endif
+        bsg_pr_test_info("test_symbol_to_eva_file Regression Test (COSIMULATION)\n");
+        int rc = test_symbol_to_eva_file(argc, argv);
+        *exit_code = rc;
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return;
+}
+#else
+int main(int argc, char ** argv) {
+        bsg_pr_test_info("test_symbol_to_eva_file Regression Test (F1)\n");
+        int rc = test_symbol_to_eva_file(argc, argv);
+        bsg_pr_test_pass_fail(rc == HB_MC_SUCCESS);
+        return rc;
+}
+#endif